@@ -3,6 +3,10 @@
 #include <unordered_set>
 #include <fstream>
 #include <filesystem>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <cmath>
 namespace fs = std::filesystem;
 
 #include "lz4/lz4.h"
@@ -21,11 +25,17 @@ namespace fs = std::filesystem;
 #include "texture_asset.h"
 #include "cubemap_asset.h"
 #include "model_asset.h"
+#include "ktx2.h"
 using namespace assets;
 
 #define assert_release(expression) ((void)0)
 
 #define Min(x, y) (x < y ? x : y)
+#define Max(x, y) (x > y ? x : y)
+#define Pi32 3.14159265359f
+
+#include "pixel_kernels.cpp"
+#include "image_resampler.cpp"
 
 b32 epsilonComparison(f32 a, f32 b, f32 epsilon) {
   f32 diff = a - b;
@@ -35,12 +45,18 @@ b32 epsilonComparison(f32 a, f32 b, f32 epsilon) {
 struct {
   const char* texture = ".tx";
   const char* cubeMap = ".cbtx";
+  const char* cubeMapArray = ".cbta";
   const char* model = ".modl";
 } bakedExtensions;
 
+const char* ktx2Extension = ".ktx2";
+// NOTE: KTX2 key holding the json of the asset a KTX2 was exported from, letting cube maps keep their irradiance SH
+const char* ktx2AssetJsonKey = "scenes.assetJson";
+
 const char* assetBakerCacheFileName = "Asset-Baker-Cache.asb";
 struct {
   const char* cacheFiles = "cacheFiles";
+  const char* assetLibVersion = "assetLibVersion";
   const char* originalFileName = "originalFileName";
   const char* originalFileLastModified = "originalFileLastModified";
   const char* bakedFiles = "bakedFiles";
@@ -54,7 +70,7 @@ struct ConverterState {
   std::vector<fs::path> bakedFilePaths;
 };
 
-// TODO: Caching should note the version of the AssetLib used when asset was baked
+// NOTE: The cache records the ASSET_LIB_VERSION it was baked with and is discarded whole when that version changes
 struct AssetBakeCachedItem {
   struct BakedFile {
     std::string path;
@@ -69,7 +85,15 @@ struct AssetBakeCachedItem {
 
 bool convertTexture(const fs::path& inputPath, const char* outputFilename);
 bool convertCubeMapTexture(const fs::path& inputDir, const char* outputFilename);
+std::vector<std::string> readSkyboxArrayList(const fs::path& layerListPath);
+bool packCubeMapArrayTexture(const fs::path& layerListPath, const fs::path& bakedSkyboxesDir, const char* outputFilename);
+bool convertKTX2Texture(const fs::path& inputPath, const char* outputFilename);
+bool convertKTX2CubeMap(const fs::path& inputPath, const char* outputFilename);
+bool exportKTX2(const fs::path& assetPath);
 bool convertModel(const fs::path& inputPath, const char* outputFileName);
+void convertModelsWithTextureAtlases(const std::vector<fs::path>& modelFiles, const fs::path& modelsExportDir,
+                                     const fs::path& texturesExportDir, std::vector<fs::path>* bakedFilePaths);
+bool isModelFile(const fs::path& path);
 
 void saveCache(const std::unordered_map<std::string, AssetBakeCachedItem>& oldCache, const std::vector<AssetBakeCachedItem>& newBakedItems);
 void loadCache(std::unordered_map<std::string, AssetBakeCachedItem>& assetBakeCache);
@@ -83,11 +107,53 @@ bool fileUpToDate(const std::unordered_map<std::string, AssetBakeCachedItem>& ca
 void replace(std::string& str, const char* oldTokens, u32 oldTokensCount, char newToken);
 
 bool CompressionCallback(float fProgress, CMP_DWORD_PTR pUser1, CMP_DWORD_PTR pUser2);
+void printBakedTierSelection(u64 sizeBudget);
 
 bool bakeFailed = false;
 
+enum PanoramaFilter {
+  PanoramaFilter_Bilinear,
+  PanoramaFilter_Bicubic,
+};
+
+struct {
+  // NOTE: When set, every candidate compression mode is attempted for each model and the smallest result is kept
+  bool autoModelCompression = true;
+  CompressionMode modelCompression = CompressionMode_None;
+  // NOTE: Vertices whose attributes are all within this distance of each other are merged, 0 only merges exact duplicates
+  f32 weldEpsilon = 1e-5f;
+  // NOTE: Face width & height of skyboxes resampled from a panorama, 0 picks a size matching the panorama's resolution
+  u32 skyboxFaceSize = 0;
+  PanoramaFilter skyboxFilter = PanoramaFilter_Bicubic;
+  // NOTE: Filter used whenever a texture or skybox is downscaled
+  ResampleFilter resampleFilter = ResampleFilter_Kaiser;
+  // NOTE: Textures & skyboxes are baked at full resolution plus (textureTierCount - 1) successively halved tiers
+  u32 textureTierCount = 3;
+  // NOTE: Skybox tiers are large (a 2048 face ETC2 tier alone is ~17MB), so their downscaled tiers are opt in
+  u32 skyboxTierCount = 1;
+  bool astcTier = true;
+  // NOTE: Faces of a skybox's ASTC tier are downscaled until they are at most this size, 0 keeps them at full resolution
+  u32 skyboxASTCMaxSize = 1024;
+  // NOTE: When set, small model textures are packed into shared atlases so models can share texture binds & batches
+  bool textureAtlas = false;
+  u32 textureAtlasMaxImageSize = 256; // larger images keep a texture of their own
+  u32 textureAtlasMaxSize = 2048;
+  // NOTE: When set, skyboxes packed into a cube map array are also baked on their own for devices without cube map arrays
+  // Switching this on requires a --clean bake, as up-to-date skyboxes are not re-exported
+  bool skyboxArrayFallback = false;
+  // NOTE: When set, raw KTX2 textures are also shipped as is, which the app uploads straight from the APK when it can
+  // sample their format, falling back to the baked tiers otherwise
+  bool shipKTX2 = false;
+} bakeOptions;
+
+// NOTE: Text file listing, one per line, the skyboxes to be packed into a cube map array
+const char* skyboxArrayListExtension = ".skyboxarray";
+
 const char* rawAssetsDir = "native_scenes/src/main/assets_raw";
 const char* bakedAssetsDir = "native_scenes/src/main/assets";
+// NOTE: Skyboxes only needed as the layers of a cube map array are baked here, outside of the app's assets
+const char* skyboxArrayLayersDir = "build/asset_baker/skyboxes";
+const char* drawablesDir = "app/src/main/res/drawable-xxhdpi";
 
 void outputErrorMsg(const char* format, ...) {
   va_list args;
@@ -100,9 +166,25 @@ void outputErrorMsg(const char* format, ...) {
 
 int main(int argc, char* argv[]) {
   // NOTE: Count is often at least 1, as argv[0] is full path of the program being run
-  if(argc > 1) {
-    char* arg1 = {argv[1]};
-    if(strcmp(arg1, "--clean") == 0) {
+  for(s32 argIndex = 1; argIndex < argc; argIndex++) {
+    char* arg = {argv[argIndex]};
+    const char* modelCompressionArg = "--model-compression=";
+    const char* weldEpsilonArg = "--weld-epsilon=";
+    const char* skyboxFaceSizeArg = "--skybox-face-size=";
+    const char* skyboxFilterArg = "--skybox-filter=";
+    const char* textureTiersArg = "--texture-tiers=";
+    const char* astcTierArg = "--astc-tier=";
+    const char* skyboxTiersArg = "--skybox-tiers=";
+    const char* skyboxASTCMaxSizeArg = "--skybox-astc-max-size=";
+    const char* selectTiersArg = "--select-tiers=";
+    const char* resampleFilterArg = "--resample-filter=";
+    const char* textureAtlasArg = "--texture-atlas";
+    const char* skyboxArrayFallbackArg = "--skybox-array-fallback";
+    const char* shipKTX2Arg = "--ship-ktx2";
+    const char* exportKTX2Arg = "--export-ktx2=";
+    const char* benchmarkResamplerArg = "--benchmark-resampler";
+    const char* benchmarkPixelKernelsArg = "--benchmark-pixel-kernels";
+    if(strcmp(arg, "--clean") == 0) {
       fs::path cacheFile{assetBakerCacheFileName};
       if(fs::remove(cacheFile)) {
         printf("Successfully deleted cache.");
@@ -110,10 +192,80 @@ int main(int argc, char* argv[]) {
         printf("Attempted to clean but cache file was not found.");
       }
       return 0;
+    } else if(strncmp(arg, modelCompressionArg, strlen(modelCompressionArg)) == 0) {
+      const char* mode = arg + strlen(modelCompressionArg);
+      bakeOptions.autoModelCompression = false;
+      if(strcmp(mode, "auto") == 0) { bakeOptions.autoModelCompression = true; }
+      else if(strcmp(mode, "none") == 0) { bakeOptions.modelCompression = CompressionMode_None; }
+      else if(strcmp(mode, "lz4") == 0) { bakeOptions.modelCompression = CompressionMode_LZ4; }
+      else if(strcmp(mode, "mesh") == 0) { bakeOptions.modelCompression = CompressionMode_MeshFilterLZ4; }
+      else {
+        outputErrorMsg("Unsupported model compression: %s\n", mode);
+        return -1;
+      }
+      continue;
+    } else if(strncmp(arg, weldEpsilonArg, strlen(weldEpsilonArg)) == 0) {
+      bakeOptions.weldEpsilon = strtof(arg + strlen(weldEpsilonArg), nullptr);
+      continue;
+    } else if(strncmp(arg, skyboxFaceSizeArg, strlen(skyboxFaceSizeArg)) == 0) {
+      bakeOptions.skyboxFaceSize = (u32)strtoul(arg + strlen(skyboxFaceSizeArg), nullptr, 10);
+      continue;
+    } else if(strncmp(arg, skyboxFilterArg, strlen(skyboxFilterArg)) == 0) {
+      const char* filter = arg + strlen(skyboxFilterArg);
+      if(strcmp(filter, "bilinear") == 0) { bakeOptions.skyboxFilter = PanoramaFilter_Bilinear; }
+      else if(strcmp(filter, "bicubic") == 0) { bakeOptions.skyboxFilter = PanoramaFilter_Bicubic; }
+      else {
+        outputErrorMsg("Unsupported skybox filter: %s\n", filter);
+        return -1;
+      }
+      continue;
+    } else if(strncmp(arg, textureTiersArg, strlen(textureTiersArg)) == 0) {
+      bakeOptions.textureTierCount = Max((u32)strtoul(arg + strlen(textureTiersArg), nullptr, 10), 1u);
+      continue;
+    } else if(strncmp(arg, astcTierArg, strlen(astcTierArg)) == 0) {
+      bakeOptions.astcTier = strcmp(arg + strlen(astcTierArg), "off") != 0;
+      continue;
+    } else if(strncmp(arg, skyboxTiersArg, strlen(skyboxTiersArg)) == 0) {
+      bakeOptions.skyboxTierCount = Max((u32)strtoul(arg + strlen(skyboxTiersArg), nullptr, 10), 1u);
+      continue;
+    } else if(strncmp(arg, skyboxASTCMaxSizeArg, strlen(skyboxASTCMaxSizeArg)) == 0) {
+      bakeOptions.skyboxASTCMaxSize = (u32)strtoul(arg + strlen(skyboxASTCMaxSizeArg), nullptr, 10);
+      continue;
+    } else if(strncmp(arg, selectTiersArg, strlen(selectTiersArg)) == 0) {
+      u64 budgetKB = strtoull(arg + strlen(selectTiersArg), nullptr, 10);
+      printBakedTierSelection(budgetKB * 1024);
+      return 0;
+    } else if(strcmp(arg, benchmarkPixelKernelsArg) == 0) {
+      benchmarkPixelKernels();
+      return 0;
+    } else if(strncmp(arg, resampleFilterArg, strlen(resampleFilterArg)) == 0) {
+      const char* filter = arg + strlen(resampleFilterArg);
+      if(strcmp(filter, "box") == 0) { bakeOptions.resampleFilter = ResampleFilter_Box; }
+      else if(strcmp(filter, "kaiser") == 0) { bakeOptions.resampleFilter = ResampleFilter_Kaiser; }
+      else if(strcmp(filter, "lanczos") == 0) { bakeOptions.resampleFilter = ResampleFilter_Lanczos3; }
+      else {
+        outputErrorMsg("Unsupported resample filter: %s\n", filter);
+        return -1;
+      }
+      continue;
+    } else if(strncmp(arg, exportKTX2Arg, strlen(exportKTX2Arg)) == 0) {
+      return exportKTX2(arg + strlen(exportKTX2Arg)) ? 0 : -1;
+    } else if(strcmp(arg, textureAtlasArg) == 0) {
+      bakeOptions.textureAtlas = true;
+      continue;
+    } else if(strcmp(arg, skyboxArrayFallbackArg) == 0) {
+      bakeOptions.skyboxArrayFallback = true;
+      continue;
+    } else if(strcmp(arg, shipKTX2Arg) == 0) {
+      bakeOptions.shipKTX2 = true;
+      continue;
+    } else if(strcmp(arg, benchmarkResamplerArg) == 0) {
+      benchmarkResampler(drawablesDir, fs::path(rawAssetsDir) / "skyboxes");
+      return 0;
     }
 
     outputErrorMsg("Unsupported options.\n");
-    outputErrorMsg("Use ex: .\\assetbaker {--clean}\n");
+    outputErrorMsg("Use ex: .\\assetbaker {--clean} {--model-compression=auto|none|lz4|mesh} {--weld-epsilon=0.00001} {--skybox-face-size=1024} {--skybox-filter=bilinear|bicubic} {--texture-tiers=3} {--skybox-tiers=1} {--astc-tier=on|off} {--skybox-astc-max-size=1024} {--select-tiers=<budget in KB>} {--resample-filter=box|kaiser|lanczos} {--texture-atlas} {--skybox-array-fallback} {--ship-ktx2} {--export-ktx2=<baked .tx or .cbtx>} {--benchmark-pixel-kernels} {--benchmark-resampler}\n");
     return -1;
   }
 
@@ -145,6 +297,21 @@ int main(int argc, char* argv[]) {
   fs::create_directory(converterState.bakedAssetDir / "skyboxes");
   fs::create_directory(converterState.bakedAssetDir / "textures");
 
+  std::unordered_set<std::string> skyboxArrayLayerNames;
+  if(!bakeOptions.skyboxArrayFallback) {
+    for(auto const& skyboxArrayList: std::filesystem::directory_iterator(asset_skyboxes_dir)) {
+      if(fs::is_regular_file(skyboxArrayList) && skyboxArrayList.path().extension() == skyboxArrayListExtension) {
+        for(const std::string& layerName: readSkyboxArrayList(skyboxArrayList)) { skyboxArrayLayerNames.insert(layerName); }
+      }
+    }
+    fs::create_directories(skyboxArrayLayersDir);
+  }
+  // NOTE: A skybox packed into a cube map array is only shipped as part of that array, see bakeOptions.skyboxArrayFallback
+  auto skyboxExportDir = [&](const fs::path& skybox) {
+    bool arrayLayer = skyboxArrayLayerNames.count(skybox.stem().string()) != 0;
+    return arrayLayer ? fs::path(skyboxArrayLayersDir) : converterState.bakedAssetDir / "skyboxes";
+  };
+
   // TODO: Bring back with a cache that respects file formats
   size_t skyboxDirCount = dirCountInDir(asset_skyboxes_dir);
   printf("skybox directories found: %d\n", (int)skyboxDirCount);
@@ -152,13 +319,32 @@ int main(int argc, char* argv[]) {
     if(fileUpToDate(oldAssetBakeCache, skyboxDir)) {
       continue;
     } else if(fs::is_directory(skyboxDir)) {
-      fs::path exportPath = converterState.bakedAssetDir / "skyboxes" / skyboxDir.path().filename().replace_extension(bakedExtensions.cubeMap);
+      fs::path exportPath = skyboxExportDir(skyboxDir) / skyboxDir.path().filename().replace_extension(bakedExtensions.cubeMap);
       printf("Beginning bake of skybox asset: %s\n", skyboxDir.path().string().c_str());
       if(convertCubeMapTexture(skyboxDir, exportPath.string().c_str())) {
         converterState.bakedFilePaths.push_back(skyboxDir);
       } else {
         outputErrorMsg("Failed to bake skybox asset: %s\n", skyboxDir.path().string().c_str());
       }
+    } else if(fs::is_regular_file(skyboxDir) && skyboxDir.path().extension() == ktx2Extension) {
+      fs::path exportPath = skyboxExportDir(skyboxDir) / skyboxDir.path().filename().replace_extension(bakedExtensions.cubeMap);
+      printf("Beginning import of KTX2 skybox asset: %s\n", skyboxDir.path().string().c_str());
+      if(convertKTX2CubeMap(skyboxDir, exportPath.string().c_str())) {
+        converterState.bakedFilePaths.push_back(skyboxDir);
+      } else {
+        outputErrorMsg("Failed to import KTX2 skybox asset: %s\n", skyboxDir.path().string().c_str());
+      }
+    }
+  }
+
+  // NOTE: Packing only copies already baked skyboxes, so arrays are always repacked in case a layer was rebaked
+  for(auto const& skyboxArrayList: std::filesystem::directory_iterator(asset_skyboxes_dir)) {
+    if(fs::is_regular_file(skyboxArrayList) && skyboxArrayList.path().extension() == skyboxArrayListExtension) {
+      fs::path exportPath = converterState.bakedAssetDir / "skyboxes" / skyboxArrayList.path().filename().replace_extension(bakedExtensions.cubeMapArray);
+      printf("Beginning pack of skybox array asset: %s\n", skyboxArrayList.path().string().c_str());
+      if(!packCubeMapArrayTexture(skyboxArrayList, converterState.bakedAssetDir / "skyboxes", exportPath.string().c_str())) {
+        outputErrorMsg("Failed to pack skybox array asset: %s\n", skyboxArrayList.path().string().c_str());
+      }
     }
   }
 
@@ -169,8 +355,12 @@ int main(int argc, char* argv[]) {
       } else if(fs::is_regular_file(textureFileEntry)) {
         fs::path exportPath = converterState.bakedAssetDir / "textures" / textureFileEntry.path().filename().replace_extension(bakedExtensions.texture);
         printf("Beginning bake of texture asset: %s\n", textureFileEntry.path().string().c_str());
-        if(convertTexture(textureFileEntry, exportPath.string().c_str())) {
+        bool isKTX2 = textureFileEntry.path().extension() == ktx2Extension;
+        if(isKTX2 ? convertKTX2Texture(textureFileEntry, exportPath.string().c_str()) : convertTexture(textureFileEntry, exportPath.string().c_str())) {
           converterState.bakedFilePaths.push_back(textureFileEntry);
+          if(isKTX2 && bakeOptions.shipKTX2) {
+            fs::copy_file(textureFileEntry, fs::path(exportPath).replace_extension(ktx2Extension), fs::copy_options::overwrite_existing);
+          }
         } else {
           outputErrorMsg("Failed to bake texture asset: %s\n", textureFileEntry.path().string().c_str());
         }
@@ -180,11 +370,20 @@ int main(int argc, char* argv[]) {
     outputErrorMsg("Could not find textures asset directory at: %s", asset_textures_dir.string().c_str());
   }
 
-  if(exists(asset_models_dir)) {
+  if(exists(asset_models_dir) && bakeOptions.textureAtlas) {
+    // NOTE: Atlas layouts depend on every model, so all models are rebaked together whether or not they changed
+    std::vector<fs::path> modelFiles;
+    for(auto const& modelFileEntry: std::filesystem::directory_iterator(asset_models_dir)) {
+      if(fs::is_regular_file(modelFileEntry) && isModelFile(modelFileEntry)) { modelFiles.push_back(modelFileEntry); }
+    }
+    std::sort(modelFiles.begin(), modelFiles.end()); // NOTE: Directory order is unspecified, keep atlas layouts stable
+    convertModelsWithTextureAtlases(modelFiles, converterState.bakedAssetDir / "models", converterState.bakedAssetDir / "textures",
+                                    &converterState.bakedFilePaths);
+  } else if(exists(asset_models_dir)) {
     for(auto const& modelFileEntry: std::filesystem::directory_iterator(asset_models_dir)) {
       if(fileUpToDate(oldAssetBakeCache, modelFileEntry)) {
         continue;
-      } else if(fs::is_regular_file(modelFileEntry)) {
+      } else if(fs::is_regular_file(modelFileEntry) && isModelFile(modelFileEntry)) { // NOTE: Skips material/texture files referenced by OBJs
         fs::path exportPath = converterState.bakedAssetDir / "models" / modelFileEntry.path().filename().replace_extension(bakedExtensions.model);
         printf("%s\n", modelFileEntry.path().string().c_str());
         if(convertModel(modelFileEntry, exportPath.string().c_str())) {
@@ -218,39 +417,21 @@ int main(int argc, char* argv[]) {
   return bakeFailed ? -1 : 0;
 }
 
-/* Arguments
- *  - u8** compressedBytes: If the image was not compressed, the returned pointer may be the same as uncompressedBytes
- *              - If it is not the same as uncompressed bytes, it must be manually free'd by the callee.
- * Returns false if error occurred during compression.
- */
-bool compressImage(u8* uncompressedBytes, u32 width, u32 height, u32 numChannels, u8** compressedBytes, u32* compressedImageSize, TextureFormat* compressedFormat) {
-  u32 imageSize = width * height * numChannels;
-
-  struct LOCAL_FUNCS {
-    // NOTE: This is only necessary as a workaround for a bug in the Compressinator lib that swizzles red and blue
-    // https://github.com/GPUOpen-Tools/compressonator/issues/244 & https://github.com/GPUOpen-Tools/compressonator/issues/247
-    static void swizzleRB(u8* pixelChannels, u32 pixelCount, u32 numChannels) {
-      u8 tmp;
-      for(u32 i = 0; i < pixelCount; i++) {
-        u8* redChannel = &pixelChannels[i * numChannels];
-        u8* blueChannel = redChannel + 2;
-        tmp = *redChannel;
-        *redChannel = *blueChannel;
-        *blueChannel = tmp;
-      }
-    }
-  };
+internal_func CMP_FORMAT textureFormatToCMPFormat(TextureFormat format) {
+  switch(format) {
+    case TextureFormat_ETC2_RGB: return CMP_FORMAT_ETC2_RGB;
+    case TextureFormat_ETC2_RGBA: return CMP_FORMAT_ETC2_RGBA;
+    case TextureFormat_ASTC_RGBA_4x4: return CMP_FORMAT_ASTC;
+    default: return CMP_FORMAT_Unknown;
+  }
+}
 
-  CMP_FORMAT srcFormat = CMP_FORMAT_Unknown;
-  CMP_FORMAT dstFormat = CMP_FORMAT_Unknown;
+// Format an image is compressed to unless a tier asks for another
+bool defaultTextureFormat(u32 numChannels, TextureFormat* compressedFormat) {
   switch(numChannels) {
     case 1: {
       // TODO: Single channel textures should be able to be compacted for GL_COMPRESSED_R11_EAC
       *compressedFormat = TextureFormat_R8;
-      *compressedImageSize = imageSize;
-      *compressedBytes = (u8*)malloc(*compressedImageSize);
-      memcpy(*compressedBytes, uncompressedBytes, *compressedImageSize);
-      *compressedBytes = uncompressedBytes;
       return true;
     }
     case 3: {
@@ -260,85 +441,305 @@ bool compressImage(u8* uncompressedBytes, u32 width, u32 height, u32 numChannels
        *      - My personal device also supports a few ATC formats.
        *      - Determine best format from limited selection.
        */
-      CMP_FORMAT normalDesiredFormat = CMP_FORMAT_ETC2_RGB;
-      srcFormat = CMP_FORMAT_RGB_888;
-      dstFormat = CMP_FORMAT_ETC2_RGB;
       *compressedFormat = TextureFormat_ETC2_RGB;
-
-      // TODO: Compressinator lib workaround. Remove when it is fixed.
-      LOCAL_FUNCS::swizzleRB(uncompressedBytes, width * height, numChannels);
-
-      break;
+      return true;
     }
     case 4: {
-      srcFormat = CMP_FORMAT_RGBA_8888;
-      dstFormat = CMP_FORMAT_ETC2_RGBA;
       *compressedFormat = TextureFormat_ETC2_RGBA;
-
-      // TODO: Compressinator lib workaround. Remove when it is fixed.
-      LOCAL_FUNCS::swizzleRB(uncompressedBytes, width * height, numChannels);
-
-      break;
+      return true;
     }
     default: {
       assert_release(false && "Error: Asset baker does not yet support images with 2 or greater than 4 channels.");
+      return false;
     }
   }
+}
 
-  CMP_Texture srcTexture = {0};
-  srcTexture.dwSize = sizeof(srcTexture);
-  srcTexture.dwWidth = (CMP_DWORD)width;
-  srcTexture.dwHeight = (CMP_DWORD)height;
-  srcTexture.dwPitch = (CMP_DWORD)(width * numChannels);
-  srcTexture.format = srcFormat;
-  srcTexture.dwDataSize = (CMP_DWORD)imageSize;
-  srcTexture.pData = (CMP_BYTE *)uncompressedBytes;
-  srcTexture.pMipSet = nullptr;
+u32 compressedImageSize(u32 width, u32 height, TextureFormat format) {
+  if(format == TextureFormat_R8) { return width * height; }
 
   CMP_Texture destTexture = {0};
   destTexture.dwSize = sizeof(destTexture);
-  destTexture.dwWidth = srcTexture.dwWidth;
-  destTexture.dwHeight = srcTexture.dwHeight;
-  destTexture.format = dstFormat;
+  destTexture.dwWidth = (CMP_DWORD)width;
+  destTexture.dwHeight = (CMP_DWORD)height;
+  destTexture.format = textureFormatToCMPFormat(format);
   destTexture.nBlockHeight = 4;
   destTexture.nBlockWidth = 4;
   destTexture.nBlockDepth = 1;
-  *compressedImageSize = CMP_CalculateBufferSize(&destTexture);
-  *compressedBytes = (u8*)malloc(*compressedImageSize);
-  destTexture.dwDataSize = *compressedImageSize;
-  destTexture.pData = *compressedBytes;
+  return CMP_CalculateBufferSize(&destTexture);
+}
 
-  CMP_CompressOptions options = {0};
-  options.dwSize = sizeof(options);
-  options.fquality = 1.0f; // Quality
-  options.dwnumThreads = 0; // Number of threads to use per texture set to auto
-  options.SourceFormat = srcTexture.format;
-  options.DestFormat = destTexture.format;
+// Format & size an image will have once compressed, without doing any of the compression
+bool compressedImageInfo(u32 width, u32 height, u32 numChannels, TextureFormat* compressedFormat, u32* compressedImageSize) {
+  if(!defaultTextureFormat(numChannels, compressedFormat)) { return false; }
+  *compressedImageSize = ::compressedImageSize(width, height, *compressedFormat);
+  return true;
+}
 
-  // TODO: Uncomment and get compressinator to generate mipmap levels
+/*
+ * Compresses an image in horizontal strips of block rows, handing each strip's blocks to writeBlocks as soon as they
+ * are ready. Blocks are laid out row by row, so the strips concatenated in order are the whole compressed image.
+ * Only one strip of converted pixels & one strip of blocks are held at once, whatever the size of the image.
+ * NOTE: threadCount of 0 lets Compressonator decide, callers compressing several images in parallel should pass 1
+ */
+bool compressImageStrips(const u8* uncompressedBytes, u32 width, u32 height, u32 numChannels, TextureFormat compressedFormat,
+                         const std::function<bool(const u8* blocks, u32 size)>& writeBlocks, u32 threadCount = 0) {
+  if(compressedFormat == TextureFormat_R8) {
+    assert(numChannels == 1);
+    return writeBlocks(uncompressedBytes, width * height);
+  }
+
+  // NOTE: Compressonator is fed a copy, as red and blue need to be swizzled as a workaround for a bug in the library
+  // https://github.com/GPUOpen-Tools/compressonator/issues/244 & https://github.com/GPUOpen-Tools/compressonator/issues/247
+  // ASTC is always encoded from RGBA, so 3 channel images are given an opaque alpha along the way.
+  u32 srcChannels = (compressedFormat == TextureFormat_ASTC_RGBA_4x4) ? 4 : numChannels;
+  if(srcChannels != 3 && srcChannels != 4) { return false; }
+
+  // NOTE: Strips are kept around 4MB of pixels, large enough for Compressonator to spread over its threads
+  const u32 stripTargetBytes = 4 * 1024 * 1024;
+  const u32 targetRows = Max(stripTargetBytes / (width * srcChannels), 4u) & ~3u;
+  const u32 paddedHeight = (height + 3) & ~3u;
+  const u32 stripRows = Min(targetRows, paddedHeight);
+  std::vector<u8> srcPixels((size_t)width * stripRows * srcChannels);
+  std::vector<u8> blocks(::compressedImageSize(width, stripRows, compressedFormat));
+  // TODO: Compressinator lib workaround. Remove when it is fixed.
+  const u8 bgrOrder[4] = {2, 1, 0, (u8)(numChannels == 4 ? 3 : PIXEL_CHANNEL_OPAQUE)};
+
+  for(u32 stripY = 0; stripY < height; stripY += stripRows) {
+    const u32 rows = Min(stripRows, height - stripY);
+    const u32 stripSize = ::compressedImageSize(width, rows, compressedFormat);
+    swizzlePixels(uncompressedBytes + (size_t)stripY * width * numChannels, numChannels, srcPixels.data(), srcChannels, bgrOrder, (u64)width * rows);
+
+    CMP_Texture srcTexture = {0};
+    srcTexture.dwSize = sizeof(srcTexture);
+    srcTexture.dwWidth = (CMP_DWORD)width;
+    srcTexture.dwHeight = (CMP_DWORD)rows;
+    srcTexture.dwPitch = (CMP_DWORD)(width * srcChannels);
+    srcTexture.format = srcChannels == 4 ? CMP_FORMAT_RGBA_8888 : CMP_FORMAT_RGB_888;
+    srcTexture.dwDataSize = (CMP_DWORD)(width * rows * srcChannels);
+    srcTexture.pData = (CMP_BYTE *)srcPixels.data();
+    srcTexture.pMipSet = nullptr;
+
+    CMP_Texture destTexture = {0};
+    destTexture.dwSize = sizeof(destTexture);
+    destTexture.dwWidth = srcTexture.dwWidth;
+    destTexture.dwHeight = srcTexture.dwHeight;
+    destTexture.format = textureFormatToCMPFormat(compressedFormat);
+    destTexture.nBlockHeight = 4;
+    destTexture.nBlockWidth = 4;
+    destTexture.nBlockDepth = 1;
+    destTexture.dwDataSize = stripSize;
+    destTexture.pData = blocks.data();
+
+    CMP_CompressOptions options = {0};
+    options.dwSize = sizeof(options);
+    options.fquality = 1.0f; // Quality
+    options.dwnumThreads = threadCount;
+    options.SourceFormat = srcTexture.format;
+    options.DestFormat = destTexture.format;
+
+    // TODO: Uncomment and get compressinator to generate mipmap levels
 //    options.genGPUMipMaps = true;
 //    options.miplevels = 3;
 
-  try {
-    CMP_ERROR cmp_status = CMP_ConvertTexture(&srcTexture, &destTexture, &options, &CompressionCallback);
-    if(cmp_status != CMP_OK) { return false; }
-  } catch (const std::exception &ex) {
-    outputErrorMsg("Error: %s\n", ex.what());
-    return false;
+    try {
+      CMP_ERROR cmp_status = CMP_ConvertTexture(&srcTexture, &destTexture, &options, nullptr);
+      if(cmp_status != CMP_OK) { return false; }
+    } catch (const std::exception &ex) {
+      outputErrorMsg("Error: %s\n", ex.what());
+      return false;
+    }
+
+    if(!writeBlocks(blocks.data(), stripSize)) { return false; }
+    // NOTE: Progress is only reported for auto threaded compressions, parallel callers would interleave their output
+    if(threadCount == 0) { CompressionCallback(100.0f * (stripY + rows) / height, 0, 0); }
   }
 
   return true;
 }
 
-bool convertModel(const fs::path& inputPath, const char* outputFileName) {
+// Compresses into a caller owned buffer of the size given by compressedImageSize(), uncompressedBytes are left untouched
+bool compressImageInto(const u8* uncompressedBytes, u32 width, u32 height, u32 numChannels, TextureFormat compressedFormat,
+                       u8* compressedBytes, u32 compressedImageSize, u32 threadCount = 0) {
+  assert(compressedImageSize == ::compressedImageSize(width, height, compressedFormat));
+  u32 written = 0;
+  return compressImageStrips(uncompressedBytes, width, height, numChannels, compressedFormat,
+                             [&](const u8* blocks, u32 size) {
+                               memcpy(compressedBytes + written, blocks, size);
+                               written += size;
+                               return true;
+                             }, threadCount);
+}
+
+/* Arguments
+ *  - u8** compressedBytes: Allocated with malloc(), it must be manually free'd by the caller.
+ * Returns false if error occurred during compression.
+ */
+bool compressImage(u8* uncompressedBytes, u32 width, u32 height, u32 numChannels, u8** compressedBytes, u32* compressedImageSize, TextureFormat* compressedFormat) {
+  if(!compressedImageInfo(width, height, numChannels, compressedFormat, compressedImageSize)) { return false; }
+  *compressedBytes = (u8*)malloc(*compressedImageSize);
+  return compressImageInto(uncompressedBytes, width, height, numChannels, *compressedFormat, *compressedBytes, *compressedImageSize);
+}
+
+struct TextureTierSpec {
+  TextureFormat format;
+  u32 downscale; // number of times the image's dimensions are halved
+};
+
+// NOTE: Ordered from largest to smallest, which is the order the runtime considers them in
+// NOTE: The ASTC tier is downscaled until it is no larger than astcMaxSize, 0 leaves it at full resolution
+std::vector<TextureTierSpec> textureTierSpecs(u32 numChannels, u32 width, u32 height, u32 tierCount, u32 astcMaxSize) {
+  std::vector<TextureTierSpec> specs;
+  TextureFormat defaultFormat;
+  if(!defaultTextureFormat(numChannels, &defaultFormat)) { return specs; }
+
+  // NOTE: Lower tiers must remain evenly divisible by 4 for block compression
+  auto downscaleCompressible = [width, height](u32 downscale) {
+    u32 tierWidth = width >> downscale;
+    u32 tierHeight = height >> downscale;
+    return downscale == 0 || (tierWidth >= 4 && tierHeight >= 4 && (tierWidth % 4) == 0 && (tierHeight % 4) == 0);
+  };
+
+  // NOTE: ASTC 4x4 doubles the size of ETC2 RGB but holds up far better on smooth gradients, like those in skies
+  if(bakeOptions.astcTier && numChannels != 1) {
+    u32 astcDownscale = 0;
+    while(astcMaxSize != 0 && Max(width >> astcDownscale, height >> astcDownscale) > astcMaxSize &&
+          downscaleCompressible(astcDownscale + 1)) {
+      astcDownscale++;
+    }
+    specs.push_back({TextureFormat_ASTC_RGBA_4x4, astcDownscale});
+  }
+  for(u32 downscale = 0; downscale < tierCount; downscale++) {
+    if(!downscaleCompressible(downscale)) { break; }
+    specs.push_back({defaultFormat, downscale});
+  }
+
+  // NOTE: A downscaled ASTC tier can be smaller than the full resolution ETC2 tier, which should then be preferred
+  std::stable_sort(specs.begin(), specs.end(), [width, height](const TextureTierSpec& a, const TextureTierSpec& b) {
+    return compressedImageSize(width >> a.downscale, height >> a.downscale, a.format) >
+           compressedImageSize(width >> b.downscale, height >> b.downscale, b.format);
+  });
+  return specs;
+}
+
+
+u32 readIndex(const u8* indices, u32 indexTypeSize, u64 i) {
+  switch(indexTypeSize) {
+    case sizeof(u8): return indices[i];
+    case sizeof(u16): return ((const u16*)indices)[i];
+    case sizeof(u32): return ((const u32*)indices)[i];
+  }
+  assert(false && "Unsupported index type size");
+  return 0;
+}
+
+// NOTE: Tangents are accumulated per vertex from each triangle's position/uv gradients (Lengyel) and then orthogonalized
+// against the vertex normal. w is the handedness of the frame: bitangent = cross(normal, tangent.xyz) * w
+// NOTE: As in glTF, uvs have their origin at the top left, so the bitangent points along -v (up the normal map)
+void generateTangents(const f32* positions, const f32* normals, const f32* uvs, u32 vertexCount,
+                      const u8* indices, u32 indexTypeSize, u32 indexCount,
+                      f32* tangents /*vertexCount * 4*/) {
+  std::vector<f32> accumulatedTangents(vertexCount * 3, 0.0f);
+  std::vector<f32> accumulatedBitangents(vertexCount * 3, 0.0f);
+
+  for(u32 triIndex = 0; triIndex + 2 < indexCount; triIndex += 3) {
+    u32 v[3] = {
+            readIndex(indices, indexTypeSize, triIndex),
+            readIndex(indices, indexTypeSize, triIndex + 1),
+            readIndex(indices, indexTypeSize, triIndex + 2)
+    };
+    const f32* p0 = positions + (v[0] * 3);
+    const f32* p1 = positions + (v[1] * 3);
+    const f32* p2 = positions + (v[2] * 3);
+    const f32* uv0 = uvs + (v[0] * 2);
+    const f32* uv1 = uvs + (v[1] * 2);
+    const f32* uv2 = uvs + (v[2] * 2);
+
+    f32 e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    f32 e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+    f32 du1 = uv1[0] - uv0[0], dv1 = uv1[1] - uv0[1];
+    f32 du2 = uv2[0] - uv0[0], dv2 = uv2[1] - uv0[1];
+
+    f32 det = (du1 * dv2) - (du2 * dv1);
+    if(epsilonComparison(det, 0.0f, 1e-12f)) { continue; } // degenerate uv mapping, contributes nothing
+    f32 r = 1.0f / det;
+
+    // NOTE: Not normalized so that larger triangles contribute more to the shared vertices
+    f32 sDir[3] = { ((e1[0] * dv2) - (e2[0] * dv1)) * r, ((e1[1] * dv2) - (e2[1] * dv1)) * r, ((e1[2] * dv2) - (e2[2] * dv1)) * r };
+    f32 tDir[3] = { ((e2[0] * du1) - (e1[0] * du2)) * r, ((e2[1] * du1) - (e1[1] * du2)) * r, ((e2[2] * du1) - (e1[2] * du2)) * r };
+    for(u32 i = 0; i < 3; i++) {
+      for(u32 c = 0; c < 3; c++) {
+        accumulatedTangents[(v[i] * 3) + c] += sDir[c];
+        accumulatedBitangents[(v[i] * 3) + c] += tDir[c];
+      }
+    }
+  }
+
+  for(u32 vertIndex = 0; vertIndex < vertexCount; vertIndex++) {
+    const f32* n = normals + (vertIndex * 3);
+    const f32* t = accumulatedTangents.data() + (vertIndex * 3);
+    const f32* b = accumulatedBitangents.data() + (vertIndex * 3);
+    f32* outTangent = tangents + (vertIndex * 4);
+
+    // Gram-Schmidt
+    f32 nDotT = (n[0] * t[0]) + (n[1] * t[1]) + (n[2] * t[2]);
+    f32 orthoTangent[3] = { t[0] - (n[0] * nDotT), t[1] - (n[1] * nDotT), t[2] - (n[2] * nDotT) };
+    f32 lengthSquared = (orthoTangent[0] * orthoTangent[0]) + (orthoTangent[1] * orthoTangent[1]) + (orthoTangent[2] * orthoTangent[2]);
+    if(lengthSquared < 1e-20f) { // no usable uv gradient, pick any vector perpendicular to the normal
+      bool xMostlyAligned = fabsf(n[0]) > 0.9f;
+      f32 axis[3] = { xMostlyAligned ? 0.0f : 1.0f, xMostlyAligned ? 1.0f : 0.0f, 0.0f };
+      f32 nDotAxis = (n[0] * axis[0]) + (n[1] * axis[1]);
+      orthoTangent[0] = axis[0] - (n[0] * nDotAxis);
+      orthoTangent[1] = axis[1] - (n[1] * nDotAxis);
+      orthoTangent[2] = -(n[2] * nDotAxis);
+      lengthSquared = (orthoTangent[0] * orthoTangent[0]) + (orthoTangent[1] * orthoTangent[1]) + (orthoTangent[2] * orthoTangent[2]);
+    }
+    f32 invLength = 1.0f / sqrtf(lengthSquared);
+    outTangent[0] = orthoTangent[0] * invLength;
+    outTangent[1] = orthoTangent[1] * invLength;
+    outTangent[2] = orthoTangent[2] * invLength;
+
+    f32 nCrossT[3] = {
+            (n[1] * outTangent[2]) - (n[2] * outTangent[1]),
+            (n[2] * outTangent[0]) - (n[0] * outTangent[2]),
+            (n[0] * outTangent[1]) - (n[1] * outTangent[0])
+    };
+    outTangent[3] = ((nCrossT[0] * b[0]) + (nCrossT[1] * b[1]) + (nCrossT[2] * b[2])) < 0.0f ? 1.0f : -1.0f;
+  }
+}
+
+struct BakeImage {
+  std::vector<u8> pixels; // empty when the image is not present
+  u32 width;
+  u32 height;
+  u32 channels;
+};
+
+// NOTE: Every supported model format is loaded into a BakeMesh before being welded & packed into a model asset
+struct BakeMesh {
+  std::vector<f32> positions; // 3 components
+  std::vector<f32> normals; // 3 components, empty when not present
+  std::vector<f32> uvs; // 2 components, empty when not present
+  std::vector<f32> tangents; // 4 components, empty when not present
+  std::vector<u32> indices;
+  f32 baseColor[4];
+  BakeImage albedoImage;
+  BakeImage normalImage;
+  // NOTE: Set when the images were packed into shared atlases, uvs are then remapped into the atlas rect when baked
+  std::string albedoAtlasName;
+  std::string normalAtlasName;
+  f32 atlasUVOffset[2];
+  f32 atlasUVScale[2];
+
+  u32 vertexCount() const { return (u32)(positions.size() / 3); }
+};
+
+bool loadGLTFMesh(const fs::path& inputPath, BakeMesh* mesh) {
   tinygltf::TinyGLTF loader;
   std::string err;
   std::string warn;
   tinygltf::Model tinyGLTFModel;
 
-  ModelInfo modelInfo = {};
-  modelInfo.originalFileName = inputPath.string();
-
   std::vector<char> modelBytes;
   readFile(inputPath.string().c_str(), modelBytes);
 
@@ -357,146 +758,549 @@ bool convertModel(const fs::path& inputPath, const char* outputFileName) {
     return false;
   }
 
-  struct gltfAttributeMetadata {
-    u32 accessorIndex;
-    u32 numComponents;
-    u32 bufferViewIndex;
-    u32 bufferIndex;
-    u64 bufferByteOffset;
-    u64 bufferByteLength;
+  struct LOCAL_FUNCS {
+    // NOTE: Copies the accessor into a tightly packed array regardless of the buffer view's stride
+    static void copyFloatAccessor(const tinygltf::Model& model, s32 accessorIndex, u32 numComponents, std::vector<f32>* out) {
+      const tinygltf::Accessor& accessor = model.accessors[accessorIndex];
+      const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
+      assert_release(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+      assert_release(tinygltf::GetNumComponentsInType(accessor.type) == numComponents);
+      const u8* src = model.buffers[bufferView.buffer].data.data() + bufferView.byteOffset + accessor.byteOffset;
+      const u64 srcStride = accessor.ByteStride(bufferView);
+      const u64 elementSize = numComponents * sizeof(f32);
+      out->resize(accessor.count * numComponents);
+      for(u64 i = 0; i < accessor.count; i++) {
+        memcpy(out->data() + (i * numComponents), src + (i * srcStride), elementSize);
+      }
+    }
+
+    static void copyImage(const tinygltf::Image& image, BakeImage* out) {
+      out->pixels = image.image;
+      out->width = image.width;
+      out->height = image.height;
+      out->channels = image.component;
+    }
   };
 
   const char* positionIndexKeyString = "POSITION";
   const char* normalIndexKeyString = "NORMAL";
   const char* texture0IndexKeyString = "TEXCOORD_0";
+  const char* tangentIndexKeyString = "TANGENT";
 
-  u32 meshCount = (u32)tinyGLTFModel.meshes.size();
-  assert_release(meshCount != 0);
-  std::vector<tinygltf::Accessor>* gltfAccessors = &tinyGLTFModel.accessors;
-  std::vector<tinygltf::BufferView>* gltfBufferViews = &tinyGLTFModel.bufferViews;
-
-  auto populateAttributeMetadata = [gltfAccessors, gltfBufferViews](const char* keyString, const tinygltf::Primitive& gltfPrimitive) -> gltfAttributeMetadata {
-    gltfAttributeMetadata result{};
-    result.accessorIndex = gltfPrimitive.attributes.at(keyString);
-    result.numComponents = tinygltf::GetNumComponentsInType(gltfAccessors->at(result.accessorIndex).type);
-    result.bufferViewIndex = gltfAccessors->at(result.accessorIndex).bufferView;
-    result.bufferIndex = gltfBufferViews->at(result.bufferViewIndex).buffer;
-    result.bufferByteOffset = gltfBufferViews->at(result.bufferViewIndex).byteOffset;
-    result.bufferByteLength = gltfBufferViews->at(result.bufferViewIndex).byteLength;
-    return result;
-  };
+  assert_release(!tinyGLTFModel.meshes.empty());
 
   // TODO: Handle models with more than one mesh
-  tinygltf::Mesh gltfMesh = tinyGLTFModel.meshes[0];
+  const tinygltf::Mesh& gltfMesh = tinyGLTFModel.meshes[0];
 
   assert_release(!gltfMesh.primitives.empty());
   // TODO: handle meshes that have more than one primitive
-  tinygltf::Primitive gltfPrimitive = gltfMesh.primitives[0];
+  const tinygltf::Primitive& gltfPrimitive = gltfMesh.primitives[0];
   assert_release(gltfPrimitive.indices > -1); // TODO: Should we deal with models that don't have indices?
 
-  // TODO: Allow variability in attributes beyond POSITION, NORMAL, TEXCOORD_0?
+  // TODO: Allow variability in attributes beyond POSITION, NORMAL, TEXCOORD_0, TANGENT?
   assert_release(gltfPrimitive.attributes.find(positionIndexKeyString) != gltfPrimitive.attributes.end());
-  gltfAttributeMetadata positionAttribute = populateAttributeMetadata(positionIndexKeyString, gltfPrimitive);
+  LOCAL_FUNCS::copyFloatAccessor(tinyGLTFModel, gltfPrimitive.attributes.at(positionIndexKeyString), 3, &mesh->positions);
+  if(gltfPrimitive.attributes.find(normalIndexKeyString) != gltfPrimitive.attributes.end()) {
+    LOCAL_FUNCS::copyFloatAccessor(tinyGLTFModel, gltfPrimitive.attributes.at(normalIndexKeyString), 3, &mesh->normals);
+  }
+  if(gltfPrimitive.attributes.find(texture0IndexKeyString) != gltfPrimitive.attributes.end()) {
+    LOCAL_FUNCS::copyFloatAccessor(tinyGLTFModel, gltfPrimitive.attributes.at(texture0IndexKeyString), 2, &mesh->uvs);
+  }
+  if(gltfPrimitive.attributes.find(tangentIndexKeyString) != gltfPrimitive.attributes.end()) {
+    // glTF tangents follow the same xyz + w handedness convention
+    LOCAL_FUNCS::copyFloatAccessor(tinyGLTFModel, gltfPrimitive.attributes.at(tangentIndexKeyString), 4, &mesh->tangents);
+  }
+
+  const tinygltf::Accessor& indicesAccessor = tinyGLTFModel.accessors[gltfPrimitive.indices];
+  const tinygltf::BufferView& indicesBufferView = tinyGLTFModel.bufferViews[indicesAccessor.bufferView];
+  const u8* indicesData = tinyGLTFModel.buffers[indicesBufferView.buffer].data.data() + indicesBufferView.byteOffset + indicesAccessor.byteOffset;
+  u32 indexTypeSize = tinygltf::GetComponentSizeInBytes(indicesAccessor.componentType);
+  mesh->indices.resize(indicesAccessor.count);
+  for(u64 i = 0; i < indicesAccessor.count; i++) {
+    mesh->indices[i] = readIndex(indicesData, indexTypeSize, i);
+  }
+
+  s32 gltfMaterialIndex = gltfPrimitive.material;
+  if(gltfMaterialIndex >= 0) {
+    const tinygltf::Material& gltfMaterial = tinyGLTFModel.materials[gltfMaterialIndex];
+    // TODO: Handle more then just TEXCOORD_0 vertex attribute?
+    assert_release(gltfMaterial.normalTexture.texCoord == 0 && gltfMaterial.pbrMetallicRoughness.baseColorTexture.texCoord == 0);
 
-  f64* minValues = tinyGLTFModel.accessors[positionAttribute.accessorIndex].minValues.data();
-  f64* maxValues = tinyGLTFModel.accessors[positionAttribute.accessorIndex].maxValues.data();
+    const f64* baseColor = gltfMaterial.pbrMetallicRoughness.baseColorFactor.data();
+    mesh->baseColor[0] = (f32)baseColor[0];
+    mesh->baseColor[1] = (f32)baseColor[1];
+    mesh->baseColor[2] = (f32)baseColor[2];
+    mesh->baseColor[3] = (f32)baseColor[3];
 
-  modelInfo.boundingBoxMin[0] = (f32)minValues[0];
-  modelInfo.boundingBoxMin[1] = (f32)minValues[1];
-  modelInfo.boundingBoxMin[2] = (f32)minValues[2];
-  modelInfo.boundingBoxDiagonal[0] = (f32)(maxValues[0] - minValues[0]);
-  modelInfo.boundingBoxDiagonal[1] = (f32)(maxValues[1] - minValues[1]);
-  modelInfo.boundingBoxDiagonal[2] = (f32)(maxValues[2] - minValues[2]);
+    // NOTE: gltf.textures.samplers gives info about how to magnify/minify textures and how texture wrapping should work
+    s32 normalTextureIndex = gltfMaterial.normalTexture.index;
+    if(normalTextureIndex >= 0) {
+      LOCAL_FUNCS::copyImage(tinyGLTFModel.images[tinyGLTFModel.textures[normalTextureIndex].source], &mesh->normalImage);
+    }
 
-  b32 normalAttributesAvailable = gltfPrimitive.attributes.find(normalIndexKeyString) != gltfPrimitive.attributes.end();
-  gltfAttributeMetadata normalAttribute = {0};
-  if(normalAttributesAvailable) { // normal attribute data
-    normalAttribute = populateAttributeMetadata(normalIndexKeyString, gltfPrimitive);
-    assert_release(positionAttribute.bufferIndex == normalAttribute.bufferIndex);
+    s32 baseColorTextureIndex = gltfMaterial.pbrMetallicRoughness.baseColorTexture.index;
+    if(baseColorTextureIndex >= 0) {
+      LOCAL_FUNCS::copyImage(tinyGLTFModel.images[tinyGLTFModel.textures[baseColorTextureIndex].source], &mesh->albedoImage);
+    }
   }
 
-  b32 texture0AttributesAvailable = gltfPrimitive.attributes.find(texture0IndexKeyString) != gltfPrimitive.attributes.end();
-  gltfAttributeMetadata texture0Attribute = {0};
-  if(texture0AttributesAvailable) { // texture 0 uv coord attribute data
-    texture0Attribute = populateAttributeMetadata(texture0IndexKeyString, gltfPrimitive);
-    assert_release(positionAttribute.bufferIndex == texture0Attribute.bufferIndex);
+  return true;
+}
+
+// NOTE: OBJ files are parsed in chunks split on line boundaries, each by tinyobjloader on its own thread
+#define OBJ_MIN_CHUNK_BYTES (1 << 20)
+
+struct OBJChunk {
+  const char* begin;
+  const char* end;
+  // NOTE: Counts & offsets of the v, vn & vt lines, counted ahead of parsing so relative indices can be made global
+  u64 positionCount, normalCount, uvCount;
+  u64 positionOffset, normalOffset, uvOffset;
+  std::vector<f32> positions, normals, uvs;
+  std::vector<tinyobj::index_t> corners; // of triangles, global & 0-based, -1 when missing
+  u64 cornerOffset;
+  std::string firstMaterialName; // of the chunk's first usemtl
+  std::vector<tinyobj::material_t> materials; // of the chunk's mtllib
+  std::string warning;
+  std::string error;
+  bool parsed;
+};
+
+internal_func void countOBJChunkAttributes(OBJChunk* chunk) {
+  chunk->positionCount = chunk->normalCount = chunk->uvCount = 0;
+  for(const char* line = chunk->begin; line < chunk->end; ) {
+    const char* token = line;
+    while(token < chunk->end && (*token == ' ' || *token == '\t')) { token++; }
+    if(token + 2 < chunk->end && token[0] == 'v') {
+      if(token[1] == ' ' || token[1] == '\t') { chunk->positionCount++; }
+      else if(token[1] == 'n' && (token[2] == ' ' || token[2] == '\t')) { chunk->normalCount++; }
+      else if(token[1] == 't' && (token[2] == ' ' || token[2] == '\t')) { chunk->uvCount++; }
+    }
+    const char* lineEnd = (const char*)memchr(token, '\n', chunk->end - token);
+    line = lineEnd ? lineEnd + 1 : chunk->end;
   }
+}
 
-  // TODO: Handle vertex attributes that don't share the same buffer?
-  u32 vertexAttBufferIndex = positionAttribute.bufferIndex;
-  assert_release(tinyGLTFModel.buffers.size() > vertexAttBufferIndex);
+internal_func void parseOBJChunk(OBJChunk* chunk, const std::string& materialSearchPath) {
+  struct LOCAL_FUNCS {
+    // NOTE: OBJ indices start at 1, negative ones count back from the last attribute parsed, 0 means missing
+    static s32 globalIndex(s32 index, u64 offset, u64 parsedCount) {
+      if(index > 0) { return index - 1; }
+      if(index < 0) { return (s32)(offset + parsedCount) + index; }
+      return -1;
+    }
+    static void vertex(void* userData, f32 x, f32 y, f32 z, f32 w) {
+      std::vector<f32>& positions = ((OBJChunk*)userData)->positions;
+      positions.push_back(x); positions.push_back(y); positions.push_back(z);
+    }
+    static void normal(void* userData, f32 x, f32 y, f32 z) {
+      std::vector<f32>& normals = ((OBJChunk*)userData)->normals;
+      normals.push_back(x); normals.push_back(y); normals.push_back(z);
+    }
+    static void texcoord(void* userData, f32 x, f32 y, f32 z) {
+      std::vector<f32>& uvs = ((OBJChunk*)userData)->uvs;
+      uvs.push_back(x); uvs.push_back(y);
+    }
+    // NOTE: Polygons are fanned, as exporters only write convex ones
+    static void face(void* userData, tinyobj::index_t* indices, s32 indexCount) {
+      OBJChunk* chunk = (OBJChunk*)userData;
+      for(s32 i = 0; i < indexCount; i++) {
+        indices[i].vertex_index = globalIndex(indices[i].vertex_index, chunk->positionOffset, chunk->positions.size() / 3);
+        indices[i].normal_index = globalIndex(indices[i].normal_index, chunk->normalOffset, chunk->normals.size() / 3);
+        indices[i].texcoord_index = globalIndex(indices[i].texcoord_index, chunk->uvOffset, chunk->uvs.size() / 2);
+      }
+      for(s32 i = 2; i < indexCount; i++) {
+        chunk->corners.push_back(indices[0]);
+        chunk->corners.push_back(indices[i - 1]);
+        chunk->corners.push_back(indices[i]);
+      }
+    }
+    static void useMaterial(void* userData, const char* name, s32 /*materialId*/) {
+      OBJChunk* chunk = (OBJChunk*)userData;
+      if(chunk->firstMaterialName.empty()) { chunk->firstMaterialName = name; }
+    }
+    static void materialLibrary(void* userData, const tinyobj::material_t* materials, s32 materialCount) {
+      ((OBJChunk*)userData)->materials.assign(materials, materials + materialCount);
+    }
+  };
 
-  u32 indicesAccessorIndex = gltfPrimitive.indices;
-  tinygltf::BufferView indicesGLTFBufferView = gltfBufferViews->at(gltfAccessors->at(indicesAccessorIndex).bufferView);
-  u32 indicesGLTFBufferIndex = indicesGLTFBufferView.buffer;
-  u64 indicesGLTFBufferByteOffset = indicesGLTFBufferView.byteOffset;
-  u64 indicesGLTFBufferByteLength = indicesGLTFBufferView.byteLength;
+  // NOTE: Reads the chunk in place, without copying it into a string stream
+  struct ChunkStreamBuf: std::streambuf {
+    ChunkStreamBuf(const char* begin, const char* end) { setg((char*)begin, (char*)begin, (char*)end); }
+  };
 
-  u64 minOffset = Min(positionAttribute.bufferByteOffset, Min(texture0Attribute.bufferByteOffset, normalAttribute.bufferByteOffset));
-  u8* vertexAttributeData = tinyGLTFModel.buffers[vertexAttBufferIndex].data.data();
+  chunk->positions.reserve(chunk->positionCount * 3);
+  chunk->normals.reserve(chunk->normalCount * 3);
+  chunk->uvs.reserve(chunk->uvCount * 2);
+
+  tinyobj::callback_t callbacks;
+  callbacks.vertex_cb = LOCAL_FUNCS::vertex;
+  callbacks.normal_cb = LOCAL_FUNCS::normal;
+  callbacks.texcoord_cb = LOCAL_FUNCS::texcoord;
+  callbacks.index_cb = LOCAL_FUNCS::face;
+  callbacks.usemtl_cb = LOCAL_FUNCS::useMaterial;
+  callbacks.mtllib_cb = LOCAL_FUNCS::materialLibrary;
+  ChunkStreamBuf streamBuf(chunk->begin, chunk->end);
+  std::istream stream(&streamBuf);
+  tinyobj::MaterialFileReader materialReader(materialSearchPath);
+  chunk->parsed = tinyobj::LoadObjWithCallback(stream, callbacks, chunk, &materialReader, &chunk->warning, &chunk->error);
+}
+
+bool loadOBJMesh(const fs::path& inputPath, BakeMesh* mesh) {
+  std::vector<char> fileBytes;
+  if(!readFile(inputPath.string().c_str(), fileBytes)) { return false; }
+  const char* fileEnd = fileBytes.data() + fileBytes.size();
+
+  u32 chunkCount = Min(Max(std::thread::hardware_concurrency(), 1u), (u32)(fileBytes.size() / OBJ_MIN_CHUNK_BYTES) + 1);
+  std::vector<OBJChunk> chunks(chunkCount);
+  const char* chunkBegin = fileBytes.data();
+  for(u32 chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
+    const char* chunkEnd = fileEnd;
+    if(chunkIndex + 1 < chunkCount) {
+      chunkEnd = Max(chunkBegin, fileBytes.data() + ((fileBytes.size() * (chunkIndex + 1)) / chunkCount));
+      const char* lineEnd = (const char*)memchr(chunkEnd, '\n', fileEnd - chunkEnd);
+      chunkEnd = lineEnd ? lineEnd + 1 : fileEnd;
+    }
+    chunks[chunkIndex].begin = chunkBegin;
+    chunks[chunkIndex].end = chunkEnd;
+    chunkBegin = chunkEnd;
+  }
 
-  modelInfo.indexCount = (u32)gltfAccessors->at(indicesAccessorIndex).count;
-  modelInfo.indexTypeSize = tinygltf::GetComponentSizeInBytes(gltfAccessors->at(indicesAccessorIndex).componentType);
+  auto forEachChunk = [&](const std::function<void(OBJChunk*)>& work) {
+    std::vector<std::thread> threads;
+    for(u32 chunkIndex = 1; chunkIndex < chunkCount; chunkIndex++) {
+      threads.emplace_back(work, &chunks[chunkIndex]);
+    }
+    work(&chunks[0]);
+    for(std::thread& thread: threads) { thread.join(); }
+  };
 
-  // TODO: Handle the possibility of the three attributes not being side-by-side in the buffer
-  u64 sizeOfAttributeData = positionAttribute.bufferByteLength + normalAttribute.bufferByteLength + texture0Attribute.bufferByteLength;
-  assert_release(tinyGLTFModel.buffers[vertexAttBufferIndex].data.size() >= sizeOfAttributeData);
-  const u32 positionAttributeIndex = 0;
-  const u32 normalAttributeIndex = 1;
-  const u32 texture0AttributeIndex = 2;
+  forEachChunk(countOBJChunkAttributes);
+  u64 positionCount = 0, normalCount = 0, uvCount = 0;
+  for(OBJChunk& chunk: chunks) {
+    chunk.positionOffset = positionCount;
+    chunk.normalOffset = normalCount;
+    chunk.uvOffset = uvCount;
+    positionCount += chunk.positionCount;
+    normalCount += chunk.normalCount;
+    uvCount += chunk.uvCount;
+  }
 
-  u8* positionAttributeData = vertexAttributeData + positionAttribute.bufferByteOffset;
-  u8* normalAttributeData = vertexAttributeData + normalAttribute.bufferByteOffset;
-  u8* uvAttributeData = vertexAttributeData + texture0Attribute.bufferByteOffset;
-  u8* indicesData = tinyGLTFModel.buffers[indicesGLTFBufferIndex].data.data() + indicesGLTFBufferByteOffset;
+  const std::string materialSearchPath = inputPath.parent_path().string();
+  forEachChunk([&materialSearchPath](OBJChunk* chunk) { parseOBJChunk(chunk, materialSearchPath); });
+
+  u64 cornerCount = 0;
+  bool hasNormals = normalCount > 0;
+  bool hasUVs = uvCount > 0;
+  std::string materialName;
+  std::vector<tinyobj::material_t> materials;
+  for(OBJChunk& chunk: chunks) {
+    if(!chunk.warning.empty()) { printf("Warning: %s\n", chunk.warning.c_str()); }
+    if(!chunk.parsed || !chunk.error.empty()) {
+      printf("Error: %s\n", chunk.error.c_str());
+      return false;
+    }
+    for(const tinyobj::index_t& corner: chunk.corners) {
+      if(corner.vertex_index < 0 || (u64)corner.vertex_index >= positionCount ||
+         (u64)(corner.normal_index + 1) > normalCount || (u64)(corner.texcoord_index + 1) > uvCount) {
+        printf("Error: %s has a face index out of range\n", inputPath.string().c_str());
+        return false;
+      }
+      hasNormals = hasNormals && corner.normal_index >= 0;
+      hasUVs = hasUVs && corner.texcoord_index >= 0;
+    }
+    chunk.cornerOffset = cornerCount;
+    cornerCount += chunk.corners.size();
+    if(materialName.empty()) { materialName = chunk.firstMaterialName; }
+    if(materials.empty()) { materials = std::move(chunk.materials); }
+  }
+  // NOTE: All faces are flattened into a single mesh, each triangle corner becomes its own vertex until welded
+  if(cornerCount == 0) {
+    printf("Error: %s contains no faces\n", inputPath.string().c_str());
+    return false;
+  }
+  if(!hasNormals) {
+    printf("Warning: %s is missing normals for some or all faces, normals will not be baked\n", inputPath.string().c_str());
+  }
 
-  s32 normalImageIndex = -1;
-  s32 albedoImageIndex = -1;
+  std::vector<f32> positions(positionCount * 3), normals(normalCount * 3), uvs(uvCount * 2);
+  forEachChunk([&](OBJChunk* chunk) {
+    std::copy(chunk->positions.begin(), chunk->positions.end(), positions.begin() + (chunk->positionOffset * 3));
+    std::copy(chunk->normals.begin(), chunk->normals.end(), normals.begin() + (chunk->normalOffset * 3));
+    std::copy(chunk->uvs.begin(), chunk->uvs.end(), uvs.begin() + (chunk->uvOffset * 2));
+  });
+
+  mesh->positions.resize(cornerCount * 3);
+  if(hasNormals) { mesh->normals.resize(cornerCount * 3); }
+  if(hasUVs) { mesh->uvs.resize(cornerCount * 2); }
+  mesh->indices.resize(cornerCount);
+  forEachChunk([&](OBJChunk* chunk) {
+    for(u64 chunkCorner = 0; chunkCorner < chunk->corners.size(); chunkCorner++) {
+      const tinyobj::index_t& corner = chunk->corners[chunkCorner];
+      u64 i = chunk->cornerOffset + chunkCorner;
+      memcpy(&mesh->positions[i * 3], &positions[corner.vertex_index * 3], 3 * sizeof(f32));
+      if(hasNormals) {
+        memcpy(&mesh->normals[i * 3], &normals[corner.normal_index * 3], 3 * sizeof(f32));
+      }
+      if(hasUVs) {
+        // NOTE: OBJ uvs have their origin at the bottom left, flip to match the top left origin of glTF
+        mesh->uvs[(i * 2)] = uvs[corner.texcoord_index * 2];
+        mesh->uvs[(i * 2) + 1] = 1.0f - uvs[(corner.texcoord_index * 2) + 1];
+      }
+      mesh->indices[i] = (u32)i;
+    }
+  });
 
-  s32 gltfMaterialIndex = gltfPrimitive.material;
-  if(gltfMaterialIndex >= 0) {
-    tinygltf::Material gltfMaterial = tinyGLTFModel.materials[gltfMaterialIndex];
-    // TODO: Handle more then just TEXCOORD_0 vertex attribute?
-    assert_release(gltfMaterial.normalTexture.texCoord == 0 && gltfMaterial.pbrMetallicRoughness.baseColorTexture.texCoord == 0);
+  // TODO: Handle models with more than one material
+  const tinyobj::material_t* materialPtr = nullptr;
+  for(const tinyobj::material_t& candidate: materials) {
+    if(candidate.name == materialName) { materialPtr = &candidate; break; }
+  }
+  if(materialPtr != nullptr) {
+    const tinyobj::material_t& material = *materialPtr;
+    mesh->baseColor[0] = material.diffuse[0];
+    mesh->baseColor[1] = material.diffuse[1];
+    mesh->baseColor[2] = material.diffuse[2];
+    mesh->baseColor[3] = material.dissolve;
+
+    auto loadMaterialImage = [&inputPath](const std::string& textureName, BakeImage* image) {
+      if(textureName.empty()) { return; }
+      std::string texturePath = (inputPath.parent_path() / textureName).string();
+      s32 width, height, channels;
+      if(!stbi_info(texturePath.c_str(), &width, &height, &channels)) {
+        printf("Warning: Could not load material texture %s\n", texturePath.c_str());
+        return;
+      }
+      u32 desiredChannels = (channels == 3) ? 3 : 4;
+      u8* pixels = stbi_load(texturePath.c_str(), &width, &height, &channels, desiredChannels);
+      image->pixels.assign(pixels, pixels + (width * height * desiredChannels));
+      image->width = width;
+      image->height = height;
+      image->channels = desiredChannels;
+      stbi_image_free(pixels);
+    };
+    loadMaterialImage(material.diffuse_texname, &mesh->albedoImage);
+    loadMaterialImage(!material.normal_texname.empty() ? material.normal_texname : material.bump_texname, &mesh->normalImage);
+  }
 
-    f64* baseColor = gltfMaterial.pbrMetallicRoughness.baseColorFactor.data();
-    modelInfo.baseColor[0] = (f32)baseColor[0];
-    modelInfo.baseColor[1] = (f32)baseColor[1];
-    modelInfo.baseColor[2] = (f32)baseColor[2];
-    modelInfo.baseColor[3] = (f32)baseColor[3];
+  return true;
+}
 
-    // NOTE: gltf.textures.samplers gives info about how to magnify/minify textures and how texture wrapping should work
-    s32 normalTextureIndex = gltfMaterial.normalTexture.index;
-    if(normalTextureIndex >= 0) {
-      normalImageIndex = tinyGLTFModel.textures[normalTextureIndex].source;
+/*
+ * Merges vertices whose attributes all lie within epsilon of each other (per component).
+ * Positions are hashed into a grid of cells 2 * epsilon wide, so a vertex only needs to be compared against vertices in its own cell
+ * and, when it sits within epsilon of a cell wall, the neighboring cell across that wall.
+ * Triangles that collapse as a result of welding are removed.
+ */
+void weldVertices(BakeMesh* mesh, f32 epsilon) {
+  struct WeldCell {
+    s64 x, y, z;
+    bool operator==(const WeldCell& other) const { return x == other.x && y == other.y && z == other.z; }
+  };
+  struct WeldCellHash {
+    size_t operator()(const WeldCell& cell) const {
+      return (size_t)((cell.x * 73856093LL) ^ (cell.y * 19349663LL) ^ (cell.z * 83492791LL));
     }
+  };
 
-    s32 baseColorTextureIndex = gltfMaterial.pbrMetallicRoughness.baseColorTexture.index;
-    if(baseColorTextureIndex >= 0) {
-      albedoImageIndex = tinyGLTFModel.textures[baseColorTextureIndex].source;
+  const u32 vertexCount = mesh->vertexCount();
+  const f32 cellSize = (epsilon > 0.0f) ? (epsilon * 2.0f) : 1.0f;
+  const bool hasNormals = !mesh->normals.empty();
+  const bool hasUVs = !mesh->uvs.empty();
+  const bool hasTangents = !mesh->tangents.empty();
+
+  BakeMesh welded;
+  welded.positions.reserve(mesh->positions.size());
+  if(hasNormals) { welded.normals.reserve(mesh->normals.size()); }
+  if(hasUVs) { welded.uvs.reserve(mesh->uvs.size()); }
+  if(hasTangents) { welded.tangents.reserve(mesh->tangents.size()); }
+
+  std::unordered_map<WeldCell, u32, WeldCellHash> cellFirstVertex;
+  cellFirstVertex.reserve(vertexCount);
+  std::vector<u32> nextVertexInCell;
+  nextVertexInCell.reserve(vertexCount);
+  std::vector<u32> remap(vertexCount);
+
+  auto componentsMatch = [epsilon](const f32* a, const f32* b, u32 count) -> bool {
+    for(u32 i = 0; i < count; i++) {
+      if(!epsilonComparison(a[i], b[i], epsilon)) { return false; }
     }
+    return true;
+  };
+  auto verticesMatch = [&](u32 vertexIndex, u32 weldedIndex) -> bool {
+    return componentsMatch(&mesh->positions[vertexIndex * 3], &welded.positions[weldedIndex * 3], 3) &&
+           (!hasNormals || componentsMatch(&mesh->normals[vertexIndex * 3], &welded.normals[weldedIndex * 3], 3)) &&
+           (!hasUVs || componentsMatch(&mesh->uvs[vertexIndex * 2], &welded.uvs[weldedIndex * 2], 2)) &&
+           (!hasTangents || componentsMatch(&mesh->tangents[vertexIndex * 4], &welded.tangents[weldedIndex * 4], 4));
+  };
+
+  for(u32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
+    const f32* position = &mesh->positions[vertexIndex * 3];
+    s64 cellCoords[3];
+    s64 neighborCellCoords[3];
+    for(u32 axis = 0; axis < 3; axis++) {
+      f32 scaled = position[axis] / cellSize;
+      cellCoords[axis] = (s64)floorf(scaled);
+      f32 distanceIntoCell = (scaled - (f32)cellCoords[axis]) * cellSize;
+      neighborCellCoords[axis] = cellCoords[axis];
+      if(distanceIntoCell < epsilon) { neighborCellCoords[axis] = cellCoords[axis] - 1; }
+      else if(distanceIntoCell > (cellSize - epsilon)) { neighborCellCoords[axis] = cellCoords[axis] + 1; }
+    }
+
+    u32 match = U32_MAX;
+    for(u32 probe = 0; probe < 8 && match == U32_MAX; probe++) {
+      WeldCell cell = {
+              (probe & 1) ? neighborCellCoords[0] : cellCoords[0],
+              (probe & 2) ? neighborCellCoords[1] : cellCoords[1],
+              (probe & 4) ? neighborCellCoords[2] : cellCoords[2]
+      };
+      // skip probes that would revisit a cell since the neighbor on that axis is the cell itself
+      if(((probe & 1) && cell.x == cellCoords[0]) || ((probe & 2) && cell.y == cellCoords[1]) || ((probe & 4) && cell.z == cellCoords[2])) { continue; }
+
+      auto cellIter = cellFirstVertex.find(cell);
+      if(cellIter == cellFirstVertex.end()) { continue; }
+      for(u32 candidate = cellIter->second; candidate != U32_MAX; candidate = nextVertexInCell[candidate]) {
+        if(verticesMatch(vertexIndex, candidate)) {
+          match = candidate;
+          break;
+        }
+      }
+    }
+
+    if(match == U32_MAX) {
+      match = welded.vertexCount();
+      welded.positions.insert(welded.positions.end(), position, position + 3);
+      if(hasNormals) { welded.normals.insert(welded.normals.end(), &mesh->normals[vertexIndex * 3], &mesh->normals[vertexIndex * 3] + 3); }
+      if(hasUVs) { welded.uvs.insert(welded.uvs.end(), &mesh->uvs[vertexIndex * 2], &mesh->uvs[vertexIndex * 2] + 2); }
+      if(hasTangents) { welded.tangents.insert(welded.tangents.end(), &mesh->tangents[vertexIndex * 4], &mesh->tangents[vertexIndex * 4] + 4); }
+
+      WeldCell cell = {cellCoords[0], cellCoords[1], cellCoords[2]};
+      auto inserted = cellFirstVertex.insert({cell, match});
+      nextVertexInCell.push_back(inserted.second ? U32_MAX : inserted.first->second);
+      inserted.first->second = match;
+    }
+    remap[vertexIndex] = match;
   }
 
-  modelInfo.positionAttributeSize = positionAttribute.bufferByteLength;
-  modelInfo.normalAttributeSize = normalAttribute.bufferByteLength;
-  modelInfo.uvAttributeSize = texture0Attribute.bufferByteLength;
-  modelInfo.indicesSize = indicesGLTFBufferByteLength;
+  welded.indices.reserve(mesh->indices.size());
+  for(u64 i = 0; i + 2 < mesh->indices.size(); i += 3) {
+    u32 a = remap[mesh->indices[i]];
+    u32 b = remap[mesh->indices[i + 1]];
+    u32 c = remap[mesh->indices[i + 2]];
+    if(a == b || b == c || c == a) { continue; }
+    welded.indices.push_back(a);
+    welded.indices.push_back(b);
+    welded.indices.push_back(c);
+  }
 
-  u8* compressedAlbedo = nullptr;
-  if(albedoImageIndex != -1) {
-    tinygltf::Image& albedoImage = tinyGLTFModel.images[albedoImageIndex];
-    u8* albedoImageData = albedoImage.image.data();
-    u64 albedoImageSize = albedoImage.image.size();
-    u64 albedoImageWidth = albedoImage.width;
-    u64 albedoImageHeight = albedoImage.height;
-    u64 albedoImageChannels = albedoImage.component;
+  mesh->positions.swap(welded.positions);
+  mesh->normals.swap(welded.normals);
+  mesh->uvs.swap(welded.uvs);
+  mesh->tangents.swap(welded.tangents);
+  mesh->indices.swap(welded.indices);
+}
+
+// Normal maps are baked as 3 channels of unit length normals
+void prepareNormalImage(BakeImage* normalImage) {
+  u64 pixelCount = (u64)normalImage->width * normalImage->height;
+  if(normalImage->channels == 4) {
+    rgbaToRgb(normalImage->pixels.data(), normalImage->pixels.data(), pixelCount);
+    normalImage->pixels.resize(pixelCount * 3);
+    normalImage->channels = 3;
+  } else if(normalImage->channels != 3) {
+    assert_release(false && "Normal map has insufficient number of components.");
+  }
+  // NOTE: Authoring tools and resizes leave normals slightly off unit length, which block compression only makes worse
+  renormalizeNormalMap(normalImage->pixels.data(), 3, pixelCount);
+}
 
-    modelInfo.albedoTexWidth = albedoImageWidth;
-    modelInfo.albedoTexHeight = albedoImageHeight;
+bool bakeModel(BakeMesh* mesh, const fs::path& inputPath, const char* outputFileName) {
+  ModelInfo modelInfo = {};
+  modelInfo.originalFileName = inputPath.string();
+  modelInfo.albedoAtlasName = mesh->albedoAtlasName;
+  modelInfo.normalAtlasName = mesh->normalAtlasName;
+
+  const bool normalMapped = !mesh->normalImage.pixels.empty() || !mesh->normalAtlasName.empty();
+  if(!normalMapped) { mesh->tangents.clear(); } // NOTE: Tangents are only useful in a normal mapped shader, don't let them block welding
+
+  u32 unweldedVertexCount = mesh->vertexCount();
+  u32 unweldedIndexCount = (u32)mesh->indices.size();
+  weldVertices(mesh, bakeOptions.weldEpsilon);
+  const u32 vertexCount = mesh->vertexCount();
+  printf("Welded vertices: %u -> %u, indices: %u -> %u\n", unweldedVertexCount, vertexCount, unweldedIndexCount, (u32)mesh->indices.size());
+
+  if(normalMapped && mesh->tangents.empty()) {
+    if(!mesh->normals.empty() && !mesh->uvs.empty()) {
+      mesh->tangents.resize(vertexCount * 4);
+      generateTangents(mesh->positions.data(), mesh->normals.data(), mesh->uvs.data(), vertexCount,
+                       (u8*)mesh->indices.data(), sizeof(u32), (u32)mesh->indices.size(),
+                       mesh->tangents.data());
+    } else {
+      // NOTE: Normal mapped shaders build their tangent frame from baked tangents alone, there is no fallback
+      printf("Error: %s has a normal map but is missing the normals or uvs needed to generate tangents\n", inputPath.string().c_str());
+      return false;
+    }
+  }
+
+  // NOTE: Remapped after tangents are generated, an axis aligned scale & offset of the uvs leaves tangent directions as is
+  if(!mesh->albedoAtlasName.empty()) {
+    for(u64 i = 0; i + 1 < mesh->uvs.size(); i += 2) {
+      mesh->uvs[i] = mesh->atlasUVOffset[0] + (mesh->uvs[i] * mesh->atlasUVScale[0]);
+      mesh->uvs[i + 1] = mesh->atlasUVOffset[1] + (mesh->uvs[i + 1] * mesh->atlasUVScale[1]);
+    }
+  }
+
+  f32 boundingBoxMax[3];
+  for(u32 axis = 0; axis < 3; axis++) {
+    modelInfo.boundingBoxMin[axis] = mesh->positions[axis];
+    boundingBoxMax[axis] = mesh->positions[axis];
+  }
+  for(u32 vertexIndex = 1; vertexIndex < vertexCount; vertexIndex++) {
+    for(u32 axis = 0; axis < 3; axis++) {
+      f32 value = mesh->positions[(vertexIndex * 3) + axis];
+      modelInfo.boundingBoxMin[axis] = Min(modelInfo.boundingBoxMin[axis], value);
+      boundingBoxMax[axis] = Max(boundingBoxMax[axis], value);
+    }
+  }
+  for(u32 axis = 0; axis < 3; axis++) {
+    modelInfo.boundingBoxDiagonal[axis] = boundingBoxMax[axis] - modelInfo.boundingBoxMin[axis];
+  }
+
+  BVH bvh;
+  buildBVH(mesh->positions.data(), mesh->indices.data(), (u32)mesh->indices.size(), &bvh);
+  printf("BVH: %u nodes, %u triangles, SAH cost %.2f\n", (u32)bvh.nodes.size(), (u32)bvh.triangles.size(), bvhSAHCost(bvh));
+
+  // NOTE: u8 indices are skipped as many mobile GPUs lack native support for them
+  std::vector<u16> shortIndices;
+  void* indexData = mesh->indices.data();
+  modelInfo.indexCount = (u32)mesh->indices.size();
+  modelInfo.indexTypeSize = sizeof(u32);
+  if(vertexCount <= (1 << 16)) {
+    shortIndices.assign(mesh->indices.begin(), mesh->indices.end());
+    indexData = shortIndices.data();
+    modelInfo.indexTypeSize = sizeof(u16);
+  }
+
+  modelInfo.positionAttributeSize = mesh->positions.size() * sizeof(f32);
+  modelInfo.normalAttributeSize = mesh->normals.size() * sizeof(f32);
+  modelInfo.uvAttributeSize = mesh->uvs.size() * sizeof(f32);
+  modelInfo.tangentAttributeSize = mesh->tangents.size() * sizeof(f32);
+  modelInfo.indicesSize = (u64)modelInfo.indexCount * modelInfo.indexTypeSize;
+
+  modelInfo.baseColor[0] = mesh->baseColor[0];
+  modelInfo.baseColor[1] = mesh->baseColor[1];
+  modelInfo.baseColor[2] = mesh->baseColor[2];
+  modelInfo.baseColor[3] = mesh->baseColor[3];
+
+  u8* compressedAlbedo = nullptr;
+  BakeImage& albedoImage = mesh->albedoImage;
+  if(!albedoImage.pixels.empty()) {
+    modelInfo.albedoTexWidth = albedoImage.width;
+    modelInfo.albedoTexHeight = albedoImage.height;
 
     u32 compressedSize;
     TextureFormat compressedFormat;
-    bool success = compressImage(albedoImageData, albedoImageWidth, albedoImageHeight, albedoImageChannels, &compressedAlbedo, &compressedSize, &compressedFormat);
+    bool success = compressImage(albedoImage.pixels.data(), albedoImage.width, albedoImage.height, albedoImage.channels, &compressedAlbedo, &compressedSize, &compressedFormat);
 
     if(!success) {
       std::printf("Error: Something went wrong with compressing albedo texture for %s\n", inputPath.string().c_str());
@@ -507,58 +1311,57 @@ bool convertModel(const fs::path& inputPath, const char* outputFileName) {
   }
 
   u8* compressedNormal = nullptr;
-  if(normalImageIndex != -1) {
-    tinygltf::Image& normalImage = tinyGLTFModel.images[normalImageIndex];
-    u64 normalImageWidth = normalImage.width;
-    u64 normalImageHeight = normalImage.height;
-
-    u8* normalImageData;
-    u64 normalImageSize;
-    u64 normalImageChannels = 3;
-    if(normalImage.component == 3) {
-      normalImageData = normalImage.image.data();
-      normalImageSize = normalImage.image.size();
-    } else if(normalImage.component == 4) {
-      u8* normalImageData_fourComponent = normalImage.image.data();
-      normalImageSize = normalImageWidth * normalImageHeight * 3;
-      normalImageData = (u8*)malloc(normalImageSize);
-      u64 pixelCount = normalImageWidth * normalImageHeight;
-      for(u64 i = 0; i < pixelCount; i++) {
-        u8* fourComponentPixel = &normalImageData_fourComponent[i * 4];
-        u8* threeComponentPixel = &normalImageData[i * 3];
-        threeComponentPixel[0] = fourComponentPixel[0];
-        threeComponentPixel[1] = fourComponentPixel[1];
-        threeComponentPixel[2] = fourComponentPixel[2];
-      }
-    } else {
-      assert_release(false && "Normal map has insufficient number of components.");
-    }
+  BakeImage& normalImage = mesh->normalImage;
+  if(!normalImage.pixels.empty()) {
+    prepareNormalImage(&normalImage);
 
-    modelInfo.normalTexWidth = normalImageWidth;
-    modelInfo.normalTexHeight = normalImageHeight;
+    modelInfo.normalTexWidth = normalImage.width;
+    modelInfo.normalTexHeight = normalImage.height;
 
     u32 compressedSize;
     TextureFormat compressedFormat;
 
     // TODO: Enable normals when normal compression is better and the project needs more of a need for normals.
-    compressedNormal = normalImageData;
-    bool success = compressImage(normalImageData, normalImageWidth, normalImageHeight, normalImageChannels, &compressedNormal, &compressedSize, &compressedFormat);
+    bool success = compressImage(normalImage.pixels.data(), normalImage.width, normalImage.height, normalImage.channels, &compressedNormal, &compressedSize, &compressedFormat);
     if(!success) {
       std::printf("Error: Something went wrong with compressing normal texture for %s\n", inputPath.string().c_str());
     }
     modelInfo.normalTexSize = compressedSize;
     modelInfo.normalTexFormat = compressedFormat;
-
-    if(normalImage.component == 4) { free(normalImageData); }
   }
 
-  AssetFile modelAsset = packModel(&modelInfo,
-                                   positionAttributeData,
-                                   normalAttributeData,
-                                   uvAttributeData,
-                                   indicesData,
-                                   compressedNormal,
-                                   compressedAlbedo);
+  AssetFile modelAsset;
+  if(bakeOptions.autoModelCompression) {
+    CompressionMode candidateModes[] = { CompressionMode_None, CompressionMode_LZ4, CompressionMode_MeshFilterLZ4 };
+    for(u32 i = 0; i < ArrayCount(candidateModes); i++) {
+      modelInfo.geometryCompression = candidateModes[i];
+      AssetFile candidateAsset = packModel(&modelInfo,
+                                           mesh->positions.data(),
+                                           mesh->normals.data(),
+                                           mesh->uvs.data(),
+                                           mesh->tangents.data(),
+                                           indexData,
+                                           compressedNormal,
+                                           compressedAlbedo,
+                                           &bvh);
+      printf("Model geometry compression %s: %llu -> %llu bytes\n", compressionModeToString(modelInfo.geometryCompression),
+             (unsigned long long)modelInfo.geometrySize(), (unsigned long long)modelInfo.packedGeometrySize);
+      if(i == 0 || candidateAsset.binaryBlob.size() < modelAsset.binaryBlob.size()) {
+        modelAsset = std::move(candidateAsset);
+      }
+    }
+  } else {
+    modelInfo.geometryCompression = bakeOptions.modelCompression;
+    modelAsset = packModel(&modelInfo,
+                           mesh->positions.data(),
+                           mesh->normals.data(),
+                           mesh->uvs.data(),
+                           mesh->tangents.data(),
+                           indexData,
+                           compressedNormal,
+                           compressedAlbedo,
+                           &bvh);
+  }
 
   saveAssetFile(outputFileName, modelAsset);
 
@@ -568,16 +1371,858 @@ bool convertModel(const fs::path& inputPath, const char* outputFileName) {
   return true;
 }
 
-bool convertCubeMapTexture(const fs::path& inputDir, const char* outputFilename) {
+bool isModelFile(const fs::path& path) {
+  fs::path ext = path.extension();
+  return ext == ".glb" || ext == ".obj";
+}
+
+bool loadModelMesh(const fs::path& inputPath, BakeMesh* mesh) {
+  fs::path ext = inputPath.extension();
+  if(ext == ".glb") {
+    return loadGLTFMesh(inputPath, mesh);
+  } else if(ext == ".obj") {
+    return loadOBJMesh(inputPath, mesh);
+  }
+  printf("Error: Unsupported model format %s\n", ext.string().c_str());
+  return false;
+}
+
+bool convertModel(const fs::path& inputPath, const char* outputFileName) {
+  BakeMesh mesh{};
+  return loadModelMesh(inputPath, &mesh) && bakeModel(&mesh, inputPath, outputFileName);
+}
+
+// NOTE: Images are placed on 4 texel boundaries & surrounded by a gutter of their edge texels, so that no compressed
+// block straddles two images and bilinear filtering doesn't bleed in a neighbour. Atlases are uploaded without mips
+// (see loadTextureAtlas()), so one texel of gutter would do, it is a whole block wide to keep images block aligned.
+#define TEXTURE_ATLAS_GUTTER 4
+
+struct AtlasRect {
+  u32 meshIndex;
+  u32 x; // of the image itself, inside the gutter
+  u32 y;
+};
+
+struct TextureAtlas {
+  u32 width;
+  u32 height;
+  u32 channels; // of the albedo atlas, normal atlases are always 3 channels
+  bool normalMapped;
+  std::vector<AtlasRect> rects;
+};
+
+inline u32 atlasPaddedSize(u32 imageSize) { return ((imageSize + 3) & ~3u) + (2 * TEXTURE_ATLAS_GUTTER); }
+
+// Only small textures whose uvs stay within the image are packed, atlased textures can no longer repeat
+bool textureAtlasCandidate(const BakeMesh& mesh) {
+  const BakeImage& albedo = mesh.albedoImage;
+  const BakeImage& normal = mesh.normalImage;
+  if(albedo.pixels.empty() || mesh.uvs.empty() || (albedo.channels != 3 && albedo.channels != 4)) { return false; }
+  if(albedo.width > bakeOptions.textureAtlasMaxImageSize || albedo.height > bakeOptions.textureAtlasMaxImageSize) { return false; }
+  // NOTE: Normal atlases share the layout of their albedo atlas
+  if(!normal.pixels.empty() && (normal.width != albedo.width || normal.height != albedo.height)) { return false; }
+  const f32 uvEpsilon = 1e-3f;
+  for(f32 uv: mesh.uvs) {
+    if(uv < -uvEpsilon || uv > 1.0f + uvEpsilon) { return false; }
+  }
+  return true;
+}
+
+// Shelf packs the albedo images of meshIndices, tallest first, into as few atlases as fit in textureAtlasMaxSize
+void packTextureAtlases(const std::vector<BakeMesh>& meshes, std::vector<u32> meshIndices, std::vector<TextureAtlas>* atlases) {
+  std::stable_sort(meshIndices.begin(), meshIndices.end(), [&meshes](u32 a, u32 b) {
+    return meshes[a].albedoImage.height > meshes[b].albedoImage.height;
+  });
+
+  u64 paddedArea = 0;
+  u32 widestPadded = 0;
+  for(u32 meshIndex: meshIndices) {
+    const BakeImage& image = meshes[meshIndex].albedoImage;
+    paddedArea += (u64)atlasPaddedSize(image.width) * atlasPaddedSize(image.height);
+    widestPadded = Max(widestPadded, atlasPaddedSize(image.width));
+  }
+  // NOTE: Roughly square atlases, height is trimmed to the shelves used
+  u32 atlasWidth = 64;
+  while(atlasWidth < bakeOptions.textureAtlasMaxSize && (u64)atlasWidth * atlasWidth < paddedArea) { atlasWidth *= 2; }
+  atlasWidth = Max(Min(atlasWidth, bakeOptions.textureAtlasMaxSize), widestPadded);
+
+  const BakeMesh& firstMesh = meshes[meshIndices[0]];
+  TextureAtlas atlas{atlasWidth, 0, firstMesh.albedoImage.channels, !firstMesh.normalImage.pixels.empty()};
+  u32 shelfX = 0, shelfY = 0, shelfHeight = 0;
+  for(u32 meshIndex: meshIndices) {
+    const BakeImage& image = meshes[meshIndex].albedoImage;
+    u32 paddedWidth = atlasPaddedSize(image.width);
+    u32 paddedHeight = atlasPaddedSize(image.height);
+    if(shelfX + paddedWidth > atlasWidth) {
+      shelfX = 0;
+      shelfY += shelfHeight;
+      shelfHeight = 0;
+    }
+    if(shelfY + paddedHeight > bakeOptions.textureAtlasMaxSize && !atlas.rects.empty()) {
+      atlases->push_back(atlas);
+      atlas.rects.clear();
+      shelfX = shelfY = shelfHeight = 0;
+    }
+    atlas.rects.push_back({meshIndex, shelfX + TEXTURE_ATLAS_GUTTER, shelfY + TEXTURE_ATLAS_GUTTER});
+    shelfX += paddedWidth;
+    shelfHeight = Max(shelfHeight, paddedHeight);
+    atlas.height = shelfY + shelfHeight;
+  }
+  atlases->push_back(atlas);
+}
+
+// Copies the image into its rect, extending its edge texels out through the gutter
+void blitAtlasImage(const BakeImage& image, u32 x, u32 y, u8* atlasPixels, u32 atlasWidth) {
+  const u32 channels = image.channels;
+  const u32 paddedWidth = atlasPaddedSize(image.width);
+  const u32 paddedHeight = atlasPaddedSize(image.height);
+  for(u32 row = 0; row < paddedHeight; row++) {
+    s32 srcRow = Min(Max((s32)row - TEXTURE_ATLAS_GUTTER, 0), (s32)image.height - 1);
+    const u8* src = image.pixels.data() + (size_t)srcRow * image.width * channels;
+    u8* dst = atlasPixels + ((size_t)(y - TEXTURE_ATLAS_GUTTER + row) * atlasWidth + (x - TEXTURE_ATLAS_GUTTER)) * channels;
+    for(u32 column = 0; column < paddedWidth; column++) {
+      s32 srcColumn = Min(Max((s32)column - TEXTURE_ATLAS_GUTTER, 0), (s32)image.width - 1);
+      memcpy(dst + (column * channels), src + (srcColumn * channels), channels);
+    }
+  }
+}
+
+// NOTE: Atlases are baked as a single tier, halving them would break the 4 texel alignment of their rects
+bool saveTextureAtlas(const std::vector<u8>& pixels, u32 width, u32 height, u32 channels, const char* outputFilename) {
+  TextureInfo texInfo;
+  texInfo.width = width;
+  texInfo.height = height;
+  texInfo.originalFileName = outputFilename;
+  if(!compressedImageInfo(width, height, channels, &texInfo.format, &texInfo.size)) { return false; }
+  texInfo.tiers = {{texInfo.format, width, height, texInfo.size}};
+
+  assets::AssetFile atlasAsset = assets::packTexture(&texInfo, nullptr);
+  AssetFileWriter writer;
+  bool success = beginAssetFile(outputFilename, atlasAsset, texInfo.size, &writer);
+  success = success && compressImageStrips(pixels.data(), width, height, channels, texInfo.format,
+                                           [&](const u8* blocks, u32 size) { return writeAssetFileBlob(&writer, blocks, size); });
+  return endAssetFile(&writer) && success;
+}
+
+/*
+ * Loads every model, packs the small textures of those that qualify (see textureAtlasCandidate) into atlases shared by
+ * models with the same albedo channels & normal mapping, then bakes the models with their uvs remapped into the atlases.
+ */
+void convertModelsWithTextureAtlases(const std::vector<fs::path>& modelFiles, const fs::path& modelsExportDir,
+                                     const fs::path& texturesExportDir, std::vector<fs::path>* bakedFilePaths) {
+  std::vector<BakeMesh> meshes(modelFiles.size());
+  std::vector<bool> loaded(modelFiles.size());
+  // NOTE: Indexed by albedo channels (3 or 4) & whether the group is normal mapped
+  std::vector<u32> atlasGroups[2][2];
+  for(u32 modelIndex = 0; modelIndex < modelFiles.size(); modelIndex++) {
+    loaded[modelIndex] = loadModelMesh(modelFiles[modelIndex], &meshes[modelIndex]);
+    if(!loaded[modelIndex]) {
+      outputErrorMsg("Failed to bake model asset: %s\n", modelFiles[modelIndex].string().c_str());
+    } else if(textureAtlasCandidate(meshes[modelIndex])) {
+      const BakeMesh& mesh = meshes[modelIndex];
+      atlasGroups[mesh.albedoImage.channels - 3][mesh.normalImage.pixels.empty() ? 0 : 1].push_back(modelIndex);
+    }
+  }
+
+  std::vector<TextureAtlas> atlases;
+  for(u32 channelsGroup = 0; channelsGroup < 2; channelsGroup++) {
+    for(u32 normalGroup = 0; normalGroup < 2; normalGroup++) {
+      // NOTE: A lone texture gains nothing from an atlas but its gutter
+      if(atlasGroups[channelsGroup][normalGroup].size() > 1) {
+        packTextureAtlases(meshes, atlasGroups[channelsGroup][normalGroup], &atlases);
+      }
+    }
+  }
+
+  for(u32 atlasIndex = 0; atlasIndex < atlases.size(); atlasIndex++) {
+    const TextureAtlas& atlas = atlases[atlasIndex];
+    std::string albedoAtlasName = "model_atlas_" + std::to_string(atlasIndex);
+    std::string normalAtlasName = atlas.normalMapped ? albedoAtlasName + "_normal" : "";
+    printf("Texture atlas %s: %u textures in %ux%u\n", albedoAtlasName.c_str(), (u32)atlas.rects.size(), atlas.width, atlas.height);
+
+    std::vector<u8> albedoPixels((size_t)atlas.width * atlas.height * atlas.channels);
+    std::vector<u8> normalPixels(atlas.normalMapped ? (size_t)atlas.width * atlas.height * 3 : 0);
+    for(const AtlasRect& rect: atlas.rects) {
+      BakeMesh& mesh = meshes[rect.meshIndex];
+      blitAtlasImage(mesh.albedoImage, rect.x, rect.y, albedoPixels.data(), atlas.width);
+      if(atlas.normalMapped) {
+        prepareNormalImage(&mesh.normalImage);
+        blitAtlasImage(mesh.normalImage, rect.x, rect.y, normalPixels.data(), atlas.width);
+      }
+
+      mesh.albedoAtlasName = albedoAtlasName;
+      mesh.normalAtlasName = normalAtlasName;
+      mesh.atlasUVOffset[0] = (f32)rect.x / atlas.width;
+      mesh.atlasUVOffset[1] = (f32)rect.y / atlas.height;
+      mesh.atlasUVScale[0] = (f32)mesh.albedoImage.width / atlas.width;
+      mesh.atlasUVScale[1] = (f32)mesh.albedoImage.height / atlas.height;
+      mesh.albedoImage = {};
+      mesh.normalImage = {};
+    }
+
+    std::string exportPath = (texturesExportDir / albedoAtlasName).replace_extension(bakedExtensions.texture).string();
+    bool success = saveTextureAtlas(albedoPixels, atlas.width, atlas.height, atlas.channels, exportPath.c_str());
+    if(atlas.normalMapped) {
+      exportPath = (texturesExportDir / normalAtlasName).replace_extension(bakedExtensions.texture).string();
+      success = saveTextureAtlas(normalPixels, atlas.width, atlas.height, 3, exportPath.c_str()) && success;
+    }
+    if(!success) {
+      outputErrorMsg("Error: Something went wrong with compressing texture atlas %s\n", albedoAtlasName.c_str());
+    }
+  }
+
+  for(u32 modelIndex = 0; modelIndex < modelFiles.size(); modelIndex++) {
+    if(!loaded[modelIndex]) { continue; }
+    const fs::path& modelFile = modelFiles[modelIndex];
+    fs::path exportPath = modelsExportDir / modelFile.filename().replace_extension(bakedExtensions.model);
+    printf("%s\n", modelFile.string().c_str());
+    if(bakeModel(&meshes[modelIndex], modelFile, exportPath.string().c_str())) {
+      bakedFilePaths->push_back(modelFile);
+    } else {
+      outputErrorMsg("Failed to bake model asset: %s\n", modelFile.string().c_str());
+    }
+    meshes[modelIndex] = {}; // NOTE: Release each model's geometry & images once baked
+  }
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PANORAMA_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// NOTE: Panorama texels are stored as tightly packed linear RGB f32 with one float of padding at the end,
+// so that a 4-wide load of the last texel never reads past the buffer. The 4th lane of every load is ignored.
+struct Panorama {
+  std::vector<f32> texels;
+  u32 width;
+  u32 height;
+  bool hdr;
+};
+
+#ifdef PANORAMA_SSE2
+typedef __m128 TexelVec;
+inline TexelVec texelLoad(const f32* texel) { return _mm_loadu_ps(texel); }
+inline TexelVec texelZero() { return _mm_setzero_ps(); }
+inline TexelVec texelMulAdd(TexelVec acc, TexelVec texel, f32 weight) { return _mm_add_ps(acc, _mm_mul_ps(texel, _mm_set1_ps(weight))); }
+inline void texelStore(f32 rgb[3], TexelVec texel) {
+  alignas(16) f32 lanes[4];
+  _mm_store_ps(lanes, texel);
+  rgb[0] = lanes[0]; rgb[1] = lanes[1]; rgb[2] = lanes[2];
+}
+#else
+struct TexelVec { f32 lanes[3]; };
+inline TexelVec texelLoad(const f32* texel) { return {texel[0], texel[1], texel[2]}; }
+inline TexelVec texelZero() { return {0.0f, 0.0f, 0.0f}; }
+inline TexelVec texelMulAdd(TexelVec acc, TexelVec texel, f32 weight) {
+  for(u32 i = 0; i < 3; i++) { acc.lanes[i] += texel.lanes[i] * weight; }
+  return acc;
+}
+inline void texelStore(f32 rgb[3], TexelVec texel) { rgb[0] = texel.lanes[0]; rgb[1] = texel.lanes[1]; rgb[2] = texel.lanes[2]; }
+#endif
+
+// NOTE: Longitude wraps around the panorama, latitude clamps at the poles
+inline const f32* panoramaTexel(const Panorama& panorama, s32 x, s32 y) {
+  s32 width = (s32)panorama.width;
+  x %= width;
+  if(x < 0) { x += width; }
+  y = Min(Max(y, 0), (s32)panorama.height - 1);
+  return panorama.texels.data() + ((size_t)y * panorama.width + x) * 3;
+}
+
+void samplePanoramaBilinear(const Panorama& panorama, f32 x, f32 y, f32 rgb[3]) {
+  f32 floorX = floorf(x), floorY = floorf(y);
+  f32 tx = x - floorX, ty = y - floorY;
+  s32 x0 = (s32)floorX, y0 = (s32)floorY;
+  TexelVec result = texelZero();
+  result = texelMulAdd(result, texelLoad(panoramaTexel(panorama, x0, y0)), (1.0f - tx) * (1.0f - ty));
+  result = texelMulAdd(result, texelLoad(panoramaTexel(panorama, x0 + 1, y0)), tx * (1.0f - ty));
+  result = texelMulAdd(result, texelLoad(panoramaTexel(panorama, x0, y0 + 1)), (1.0f - tx) * ty);
+  result = texelMulAdd(result, texelLoad(panoramaTexel(panorama, x0 + 1, y0 + 1)), tx * ty);
+  texelStore(rgb, result);
+}
+
+// Catmull-Rom weights for the four taps surrounding a sample that lies t of the way between taps 1 & 2
+inline void catmullRomWeights(f32 t, f32 weights[4]) {
+  f32 t2 = t * t, t3 = t2 * t;
+  weights[0] = 0.5f * (-t3 + 2.0f * t2 - t);
+  weights[1] = 0.5f * (3.0f * t3 - 5.0f * t2 + 2.0f);
+  weights[2] = 0.5f * (-3.0f * t3 + 4.0f * t2 + t);
+  weights[3] = 0.5f * (t3 - t2);
+}
+
+void samplePanoramaBicubic(const Panorama& panorama, f32 x, f32 y, f32 rgb[3]) {
+  f32 floorX = floorf(x), floorY = floorf(y);
+  s32 x0 = (s32)floorX - 1, y0 = (s32)floorY - 1;
+  f32 weightsX[4], weightsY[4];
+  catmullRomWeights(x - floorX, weightsX);
+  catmullRomWeights(y - floorY, weightsY);
+  TexelVec result = texelZero();
+  for(s32 row = 0; row < 4; row++) {
+    TexelVec rowResult = texelZero();
+    for(s32 col = 0; col < 4; col++) {
+      rowResult = texelMulAdd(rowResult, texelLoad(panoramaTexel(panorama, x0 + col, y0 + row)), weightsX[col]);
+    }
+    result = texelMulAdd(result, rowResult, weightsY[row]);
+  }
+  texelStore(rgb, result);
+  // NOTE: Catmull-Rom has negative lobes that can overshoot below zero around sharp edges
+  for(u32 i = 0; i < 3; i++) { rgb[i] = Max(rgb[i], 0.0f); }
+}
+
+// Direction through the center of a cube map face texel, following the OpenGL cube map face conventions
+void cubeMapTexelDirection(SkyboxFace face, u32 x, u32 y, u32 faceSize, f32 dir[3]) {
+  f32 sc = 2.0f * ((f32)x + 0.5f) / (f32)faceSize - 1.0f;
+  f32 tc = 2.0f * ((f32)y + 0.5f) / (f32)faceSize - 1.0f;
+  switch(face) {
+    case SKYBOX_FACE_FRONT: dir[0] = 1.0f; dir[1] = -tc; dir[2] = -sc; break; // +X
+    case SKYBOX_FACE_BACK: dir[0] = -1.0f; dir[1] = -tc; dir[2] = sc; break; // -X
+    case SKYBOX_FACE_TOP: dir[0] = sc; dir[1] = 1.0f; dir[2] = tc; break; // +Y
+    case SKYBOX_FACE_BOTTOM: dir[0] = sc; dir[1] = -1.0f; dir[2] = -tc; break; // -Y
+    case SKYBOX_FACE_RIGHT: dir[0] = sc; dir[1] = -tc; dir[2] = 1.0f; break; // +Z
+    case SKYBOX_FACE_LEFT: dir[0] = -sc; dir[1] = -tc; dir[2] = -1.0f; break; // -Z
+    default: InvalidCodePath;
+  }
+}
+
+// NOTE: Narkowicz's fit of the ACES filmic curve, the result is still linear and encoded with linearToSRGB()
+inline f32 toneMapHDR(f32 linear) {
+  f32 mapped = (linear * (2.51f * linear + 0.03f)) / (linear * (2.43f * linear + 0.59f) + 0.14f);
+  return Min(Max(mapped, 0.0f), 1.0f);
+}
+
+bool loadPanorama(const fs::path& panoramaPath, Panorama* panorama) {
+  std::string path = panoramaPath.u8string();
+  int width, height, channels;
+  panorama->hdr = stbi_is_hdr(path.c_str());
+  if(panorama->hdr) {
+    f32* pixels = stbi_loadf(path.c_str(), &width, &height, &channels, STBI_rgb);
+    if(!pixels) { return false; }
+    panorama->texels.resize((size_t)width * height * 3 + 1);
+    memcpy(panorama->texels.data(), pixels, (size_t)width * height * 3 * sizeof(f32));
+    stbi_image_free(pixels);
+  } else {
+    // NOTE: LDR panoramas are resampled as is, in their own (gamma) space
+    stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb);
+    if(!pixels) { return false; }
+    panorama->texels.resize((size_t)width * height * 3 + 1);
+    for(size_t i = 0; i < (size_t)width * height * 3; i++) {
+      panorama->texels[i] = pixels[i] * (1.0f / 255.0f);
+    }
+    stbi_image_free(pixels);
+  }
+  panorama->texels.back() = 0.0f;
+  panorama->width = width;
+  panorama->height = height;
+  return true;
+}
+
+// Resamples an equirectangular panorama into six RGB8 faces, ordered by SkyboxFace
+void resamplePanorama(const Panorama& panorama, u32 faceSize, PanoramaFilter filter, std::vector<u8> faces[6]) {
+  const u32 tileSize = 64;
+  const u32 tilesPerRow = (faceSize + tileSize - 1) / tileSize;
+  const u32 tilesPerFace = tilesPerRow * tilesPerRow;
+  const u32 tileCount = tilesPerFace * 6;
+  for(u32 face = 0; face < 6; face++) {
+    faces[face].resize((size_t)faceSize * faceSize * 3);
+  }
+
+  // NOTE: Tiles are handed out from a shared counter so threads stay busy regardless of tile cost near the poles
+  std::atomic<u32> nextTile{0};
+  auto resampleTiles = [&]() {
+    for(u32 tile = nextTile++; tile < tileCount; tile = nextTile++) {
+      SkyboxFace face = SkyboxFace(tile / tilesPerFace);
+      u32 tileX = (tile % tilesPerFace) % tilesPerRow * tileSize;
+      u32 tileY = (tile % tilesPerFace) / tilesPerRow * tileSize;
+      u32 tileMaxX = Min(tileX + tileSize, faceSize);
+      u32 tileMaxY = Min(tileY + tileSize, faceSize);
+      for(u32 y = tileY; y < tileMaxY; y++) {
+        f32 rowTexels[tileSize * 3];
+        f32* texel = rowTexels;
+        for(u32 x = tileX; x < tileMaxX; x++, texel += 3) {
+          f32 dir[3];
+          cubeMapTexelDirection(face, x, y, faceSize, dir);
+          // NOTE: The center of the panorama faces the front (+X) face, the top row of the panorama is straight up (+Y)
+          f32 longitude = atan2f(-dir[2], dir[0]);
+          f32 latitude = atan2f(dir[1], sqrtf(dir[0] * dir[0] + dir[2] * dir[2]));
+          f32 u = 0.5f + longitude * (0.5f / Pi32);
+          f32 v = 0.5f - latitude * (1.0f / Pi32);
+          f32 panoramaX = u * panorama.width - 0.5f;
+          f32 panoramaY = v * panorama.height - 0.5f;
+
+          f32 rgb[3];
+          if(filter == PanoramaFilter_Bicubic) {
+            samplePanoramaBicubic(panorama, panoramaX, panoramaY, rgb);
+          } else {
+            samplePanoramaBilinear(panorama, panoramaX, panoramaY, rgb);
+          }
+          for(u32 i = 0; i < 3; i++) {
+            texel[i] = panorama.hdr ? toneMapHDR(rgb[i]) : Min(rgb[i], 1.0f);
+          }
+        }
+
+        u8* dst = faces[face].data() + ((size_t)y * faceSize + tileX) * 3;
+        u32 rowCount = (tileMaxX - tileX) * 3;
+        if(panorama.hdr) {
+          linearToSRGB(rowTexels, dst, rowCount);
+        } else {
+          for(u32 i = 0; i < rowCount; i++) { dst[i] = (u8)(rowTexels[i] * 255.0f + 0.5f); }
+        }
+      }
+    }
+  };
+
+  u32 threadCount = Max(std::thread::hardware_concurrency(), 1u);
+  std::vector<std::thread> threads;
+  for(u32 i = 1; i < threadCount; i++) {
+    threads.emplace_back(resampleTiles);
+  }
+  resampleTiles();
+  for(std::thread& thread: threads) {
+    thread.join();
+  }
+}
+
+// RGB8 faces of a cube map at a single mip level, ordered by SkyboxFace
+struct CubeMapFaces {
+  u32 width;
+  std::vector<u8> faces[6];
+};
+
+// Same padded RGB f32 texel layout as Panorama, for each face of a cube map at a single mip level
+struct CubeMapLevel {
+  u32 width;
+  std::vector<f32> faces[6];
+};
+
+inline const f32* cubeMapLevelTexel(const CubeMapLevel& level, u32 face, s32 x, s32 y) {
+  x = Min(Max(x, 0), (s32)level.width - 1);
+  y = Min(Max(y, 0), (s32)level.width - 1);
+  return level.faces[face].data() + ((size_t)y * level.width + x) * 3;
+}
+
+// Inverse of cubeMapTexelDirection(), dir does not need to be normalized and the returned coordinates are in texels
+void cubeMapDirectionTexel(const f32 dir[3], u32 faceWidth, SkyboxFace* face, f32* x, f32* y) {
+  f32 absX = fabsf(dir[0]), absY = fabsf(dir[1]), absZ = fabsf(dir[2]);
+  f32 sc, tc, majorAxis;
+  if(absX >= absY && absX >= absZ) {
+    majorAxis = absX;
+    tc = -dir[1];
+    if(dir[0] > 0.0f) { *face = SKYBOX_FACE_FRONT; sc = -dir[2]; }
+    else { *face = SKYBOX_FACE_BACK; sc = dir[2]; }
+  } else if(absY >= absZ) {
+    majorAxis = absY;
+    sc = dir[0];
+    if(dir[1] > 0.0f) { *face = SKYBOX_FACE_TOP; tc = dir[2]; }
+    else { *face = SKYBOX_FACE_BOTTOM; tc = -dir[2]; }
+  } else {
+    majorAxis = absZ;
+    tc = -dir[1];
+    if(dir[2] > 0.0f) { *face = SKYBOX_FACE_RIGHT; sc = dir[0]; }
+    else { *face = SKYBOX_FACE_LEFT; sc = -dir[0]; }
+  }
+  *x = (sc / majorAxis + 1.0f) * 0.5f * faceWidth - 0.5f;
+  *y = (tc / majorAxis + 1.0f) * 0.5f * faceWidth - 0.5f;
+}
+
+// NOTE: Bilinear within a single face, taps past an edge clamp to the edge rather than continuing onto the neighboring face
+TexelVec sampleCubeMapLevel(const CubeMapLevel& level, const f32 dir[3]) {
+  SkyboxFace face;
+  f32 x, y;
+  cubeMapDirectionTexel(dir, level.width, &face, &x, &y);
+  f32 floorX = floorf(x), floorY = floorf(y);
+  f32 tx = x - floorX, ty = y - floorY;
+  s32 x0 = (s32)floorX, y0 = (s32)floorY;
+  TexelVec result = texelZero();
+  result = texelMulAdd(result, texelLoad(cubeMapLevelTexel(level, face, x0, y0)), (1.0f - tx) * (1.0f - ty));
+  result = texelMulAdd(result, texelLoad(cubeMapLevelTexel(level, face, x0 + 1, y0)), tx * (1.0f - ty));
+  result = texelMulAdd(result, texelLoad(cubeMapLevelTexel(level, face, x0, y0 + 1)), (1.0f - tx) * ty);
+  result = texelMulAdd(result, texelLoad(cubeMapLevelTexel(level, face, x0 + 1, y0 + 1)), tx * ty);
+  return result;
+}
+
+// Real spherical harmonics basis, bands 0 through 2
+inline void shBasis(const f32 dir[3], f32 basis[CUBE_MAP_SH_COEFFICIENT_COUNT]) {
+  f32 x = dir[0], y = dir[1], z = dir[2];
+  basis[0] = 0.282095f;
+  basis[1] = 0.488603f * y;
+  basis[2] = 0.488603f * z;
+  basis[3] = 0.488603f * x;
+  basis[4] = 1.092548f * x * y;
+  basis[5] = 1.092548f * y * z;
+  basis[6] = 0.315392f * (3.0f * z * z - 1.0f);
+  basis[7] = 1.092548f * x * z;
+  basis[8] = 0.546274f * (x * x - y * y);
+}
+
+// Projects the radiance of the cube map onto spherical harmonics and convolves it with a cosine lobe, see CubeMapInfo.irradianceSH
+void projectIrradianceSH(const CubeMapLevel& level, f32 irradianceSH[CUBE_MAP_SH_COEFFICIENT_COUNT][3]) {
+  f64 faceSH[6][CUBE_MAP_SH_COEFFICIENT_COUNT][3] = {};
+  f64 faceSolidAngle[6] = {};
+  std::thread faceThreads[6];
+  for(u32 face = 0; face < 6; face++) {
+    faceThreads[face] = std::thread([&, face]() {
+      const f32 texelArea = (2.0f / level.width) * (2.0f / level.width);
+      for(u32 y = 0; y < level.width; y++) {
+        // NOTE: Accumulate a row at a time in f32, then the rows in f64 to keep precision for large faces
+        TexelVec rowSH[CUBE_MAP_SH_COEFFICIENT_COUNT];
+        for(TexelVec& coefficient: rowSH) { coefficient = texelZero(); }
+        f32 rowSolidAngle = 0.0f;
+        for(u32 x = 0; x < level.width; x++) {
+          f32 dir[3];
+          cubeMapTexelDirection(SkyboxFace(face), x, y, level.width, dir);
+          f32 lengthSq = dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2];
+          f32 invLength = 1.0f / sqrtf(lengthSq);
+          for(f32& component: dir) { component *= invLength; }
+          f32 solidAngle = texelArea * invLength / lengthSq;
+
+          f32 basis[CUBE_MAP_SH_COEFFICIENT_COUNT];
+          shBasis(dir, basis);
+          TexelVec radiance = texelLoad(cubeMapLevelTexel(level, face, x, y));
+          for(u32 i = 0; i < CUBE_MAP_SH_COEFFICIENT_COUNT; i++) {
+            rowSH[i] = texelMulAdd(rowSH[i], radiance, basis[i] * solidAngle);
+          }
+          rowSolidAngle += solidAngle;
+        }
+        for(u32 i = 0; i < CUBE_MAP_SH_COEFFICIENT_COUNT; i++) {
+          f32 rgb[3];
+          texelStore(rgb, rowSH[i]);
+          for(u32 c = 0; c < 3; c++) { faceSH[face][i][c] += rgb[c]; }
+        }
+        faceSolidAngle[face] += rowSolidAngle;
+      }
+    });
+  }
+  for(std::thread& faceThread: faceThreads) {
+    faceThread.join();
+  }
+
+  // NOTE: The texel solid angles are an approximation, normalize so that they cover exactly the full sphere
+  f64 totalSolidAngle = 0.0;
+  for(u32 face = 0; face < 6; face++) { totalSolidAngle += faceSolidAngle[face]; }
+  const f64 normalization = 4.0 * Pi32 / totalSolidAngle;
+  // NOTE: Cosine lobe convolution per band (PI, 2PI/3, PI/4), divided by PI so that irradiance becomes ambient light color
+  const f32 bandConvolution[CUBE_MAP_SH_COEFFICIENT_COUNT] = { 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+  for(u32 i = 0; i < CUBE_MAP_SH_COEFFICIENT_COUNT; i++) {
+    for(u32 c = 0; c < 3; c++) {
+      f64 coefficient = 0.0;
+      for(u32 face = 0; face < 6; face++) { coefficient += faceSH[face][i][c]; }
+      irradianceSH[i][c] = (f32)(coefficient * normalization) * bandConvolution[i];
+    }
+  }
+}
+
+void downsampleCubeMapLevel(const CubeMapLevel& src, CubeMapLevel* dst) {
+  dst->width = Max(src.width / 2, 1u);
+  for(u32 face = 0; face < 6; face++) {
+    dst->faces[face].resize((size_t)dst->width * dst->width * 3 + 1, 0.0f);
+    for(u32 y = 0; y < dst->width; y++) {
+      for(u32 x = 0; x < dst->width; x++) {
+        TexelVec average = texelZero();
+        average = texelMulAdd(average, texelLoad(cubeMapLevelTexel(src, face, 2 * x, 2 * y)), 0.25f);
+        average = texelMulAdd(average, texelLoad(cubeMapLevelTexel(src, face, 2 * x + 1, 2 * y)), 0.25f);
+        average = texelMulAdd(average, texelLoad(cubeMapLevelTexel(src, face, 2 * x, 2 * y + 1)), 0.25f);
+        average = texelMulAdd(average, texelLoad(cubeMapLevelTexel(src, face, 2 * x + 1, 2 * y + 1)), 0.25f);
+        texelStore(dst->faces[face].data() + ((size_t)y * dst->width + x) * 3, average);
+      }
+    }
+  }
+}
+
+inline f32 radicalInverse(u32 bits) {
+  bits = (bits << 16u) | (bits >> 16u);
+  bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+  bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+  bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+  bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+  return (f32)bits * 2.3283064365386963e-10f;
+}
+
+/*
+ * Fills mips[1..] with the cube map in mips[0] prefiltered by GGX lobes of increasing roughness, assuming view == normal.
+ * Each sample reads from a box filtered copy of the cube map picked by the sample's solid angle (filtered importance
+ * sampling), which avoids the fireflies plain importance sampling produces with few samples.
+ * NOTE: Takes the linear cube map, which becomes the first of the box filtered copies rather than being duplicated
+ */
+void prefilterSpecularMips(CubeMapLevel&& source, std::vector<CubeMapFaces>& mips) {
+  const u32 sampleCount = 64;
+  struct PrefilterSample {
+    f32 dir[3]; // tangent space, normal is +Z
+    f32 weight;
+    f32 lod;
+  };
+
+  const u32 mipCount = (u32)mips.size();
+  if(mipCount < 2) { return; }
+
+  const f32 texelSolidAngle = 4.0f * Pi32 / (6.0f * source.width * source.width);
+  std::vector<CubeMapLevel> sourceLevels;
+  sourceLevels.push_back(std::move(source));
+  while(sourceLevels.back().width > 1) {
+    CubeMapLevel downsampled;
+    downsampleCubeMapLevel(sourceLevels.back(), &downsampled);
+    sourceLevels.push_back(std::move(downsampled));
+  }
+
+  std::vector<std::vector<PrefilterSample>> mipSamples(mipCount);
+  for(u32 mip = 1; mip < mipCount; mip++) {
+    f32 roughness = (f32)mip / (mipCount - 1);
+    f32 alphaSq = roughness * roughness * roughness * roughness;
+    for(u32 i = 0; i < sampleCount; i++) {
+      // NOTE: GGX distributed half vectors from the Hammersley sequence
+      f32 phi = 2.0f * Pi32 * ((f32)i / sampleCount);
+      f32 cosTheta = sqrtf((1.0f - radicalInverse(i)) / (1.0f + (alphaSq - 1.0f) * radicalInverse(i)));
+      f32 sinTheta = sqrtf(1.0f - cosTheta * cosTheta);
+      f32 half[3] = { cosf(phi) * sinTheta, sinf(phi) * sinTheta, cosTheta };
+      PrefilterSample sample;
+      sample.dir[0] = 2.0f * cosTheta * half[0];
+      sample.dir[1] = 2.0f * cosTheta * half[1];
+      sample.dir[2] = 2.0f * cosTheta * half[2] - 1.0f;
+      sample.weight = sample.dir[2];
+      if(sample.weight <= 0.0f) { continue; }
+
+      // NOTE: With view == normal the pdf of a light direction is D(cosTheta) / 4
+      f32 distributionDenom = cosTheta * cosTheta * (alphaSq - 1.0f) + 1.0f;
+      f32 pdf = alphaSq / (Pi32 * distributionDenom * distributionDenom) * 0.25f;
+      f32 sampleSolidAngle = 1.0f / (sampleCount * pdf);
+      sample.lod = Min(Max(0.5f * log2f(sampleSolidAngle / texelSolidAngle) + 1.0f, 0.0f), (f32)(sourceLevels.size() - 1));
+      mipSamples[mip].push_back(sample);
+    }
+  }
+
+  // NOTE: Work is split into bands of rows pulled from a shared counter, the smaller mips are cheap and finish quickly
+  struct PrefilterTile { u32 mip, face, rowStart, rowEnd; };
+  std::vector<PrefilterTile> tiles;
+  const u32 tileRows = 16;
+  for(u32 mip = 1; mip < mipCount; mip++) {
+    mips[mip].width = Max(mips[0].width >> mip, 1u);
+    for(u32 face = 0; face < 6; face++) {
+      mips[mip].faces[face].resize((size_t)mips[mip].width * mips[mip].width * 3);
+      for(u32 row = 0; row < mips[mip].width; row += tileRows) {
+        tiles.push_back({mip, face, row, Min(row + tileRows, mips[mip].width)});
+      }
+    }
+  }
+
+  std::atomic<u32> nextTile{0};
+  auto prefilterTiles = [&]() {
+    for(u32 tileIndex = nextTile++; tileIndex < tiles.size(); tileIndex = nextTile++) {
+      const PrefilterTile& tile = tiles[tileIndex];
+      const u32 width = mips[tile.mip].width;
+      const std::vector<PrefilterSample>& samples = mipSamples[tile.mip];
+      std::vector<f32> linearRow((size_t)width * 3);
+      for(u32 y = tile.rowStart; y < tile.rowEnd; y++) {
+        f32* dst = linearRow.data();
+        for(u32 x = 0; x < width; x++, dst += 3) {
+          f32 normal[3];
+          cubeMapTexelDirection(SkyboxFace(tile.face), x, y, width, normal);
+          f32 invLength = 1.0f / sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+          for(f32& component: normal) { component *= invLength; }
+          f32 up[3] = { 0.0f, 0.0f, 1.0f };
+          if(fabsf(normal[2]) > 0.999f) { up[0] = 1.0f; up[2] = 0.0f; }
+          f32 tangent[3] = { up[1] * normal[2] - up[2] * normal[1], up[2] * normal[0] - up[0] * normal[2], up[0] * normal[1] - up[1] * normal[0] };
+          f32 invTangentLength = 1.0f / sqrtf(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
+          for(f32& component: tangent) { component *= invTangentLength; }
+          f32 bitangent[3] = { normal[1] * tangent[2] - normal[2] * tangent[1], normal[2] * tangent[0] - normal[0] * tangent[2], normal[0] * tangent[1] - normal[1] * tangent[0] };
+
+          TexelVec filtered = texelZero();
+          f32 totalWeight = 0.0f;
+          for(const PrefilterSample& sample: samples) {
+            f32 dir[3];
+            for(u32 i = 0; i < 3; i++) {
+              dir[i] = tangent[i] * sample.dir[0] + bitangent[i] * sample.dir[1] + normal[i] * sample.dir[2];
+            }
+            u32 lod = (u32)sample.lod;
+            f32 lodFraction = sample.lod - lod;
+            filtered = texelMulAdd(filtered, sampleCubeMapLevel(sourceLevels[lod], dir), sample.weight * (1.0f - lodFraction));
+            if(lodFraction > 0.0f) {
+              filtered = texelMulAdd(filtered, sampleCubeMapLevel(sourceLevels[lod + 1], dir), sample.weight * lodFraction);
+            }
+            totalWeight += sample.weight;
+          }
+
+          f32 rgb[3];
+          texelStore(rgb, filtered);
+          for(u32 i = 0; i < 3; i++) {
+            dst[i] = rgb[i] / totalWeight;
+          }
+        }
+        // NOTE: The prefiltered mips share the sRGB encoding of the skybox in mips[0]
+        linearToSRGB(linearRow.data(), mips[tile.mip].faces[tile.face].data() + (size_t)y * width * 3, linearRow.size());
+      }
+    }
+  };
+
+  u32 threadCount = Max(std::thread::hardware_concurrency(), 1u);
+  std::vector<std::thread> threads;
+  for(u32 i = 1; i < threadCount; i++) {
+    threads.emplace_back(prefilterTiles);
+  }
+  prefilterTiles();
+  for(std::thread& thread: threads) {
+    thread.join();
+  }
+}
+
+// Bakes the irradiance SH & the prefiltered specular mips of the skybox in mips[0], then compresses every tier into its own asset
+bool bakeCubeMap(std::vector<CubeMapFaces>& mips, const fs::path& inputDir, const char* outputFilename) {
+  const u32 faceWidth = mips[0].width;
+  const u32 faceChannelCount = 3;
+
+  // NOTE: Every mip level must remain evenly divisible by 4 for block compression
+  u32 mipCount = 1;
+  while((faceWidth >> mipCount) >= 4 && ((faceWidth >> mipCount) % 4) == 0) {
+    mipCount++;
+  }
+  mips.resize(mipCount);
+
+  CubeMapLevel source;
+  source.width = faceWidth;
+  for(u32 face = 0; face < 6; face++) {
+    // NOTE: Radiance is integrated in linear space, the skybox's texels are sRGB encoded
+    const std::vector<u8>& pixels = mips[0].faces[face];
+    source.faces[face].resize(pixels.size() + 1, 0.0f);
+    srgbToLinear(pixels.data(), source.faces[face].data(), pixels.size());
+  }
+
+  f32 irradianceSH[CUBE_MAP_SH_COEFFICIENT_COUNT][3];
+  projectIrradianceSH(source, irradianceSH);
+  prefilterSpecularMips(std::move(source), mips);
+  printf("Baked irradiance SH (ambient: %.3f %.3f %.3f) and %d prefiltered specular mips\n",
+         irradianceSH[0][0] * 0.282095f, irradianceSH[0][1] * 0.282095f, irradianceSH[0][2] * 0.282095f, mipCount - 1);
+
+  /*
+   * A tier downscaled d times keeps the chain's structure by starting from the sharp skybox resampled to 1/2^d of its
+   * size, followed by the full resolution chain's prefiltered levels that already match its smaller mip sizes.
+   */
+  std::vector<TextureTierSpec> tierSpecs = textureTierSpecs(faceChannelCount, faceWidth, faceWidth, bakeOptions.skyboxTierCount,
+                                                            bakeOptions.skyboxASTCMaxSize);
+  // NOTE: Indexed by downscale, the full resolution tiers start from mips[0] itself
+  std::vector<CubeMapFaces> sharpLevels(1);
+  std::vector<CubeMapInfo> tierInfos;
+  std::vector<TextureTier> tiers;
+  for(const TextureTierSpec& spec: tierSpecs) {
+    if(spec.downscale >= mipCount) { break; }
+    while(sharpLevels.size() <= spec.downscale) {
+      // NOTE: Always resampled from the full resolution faces, repeated halving would compound the filter's blur
+      CubeMapFaces downscaled;
+      downscaled.width = faceWidth >> sharpLevels.size();
+      for(u32 face = 0; face < 6; face++) {
+        downscaled.faces[face].resize((size_t)downscaled.width * downscaled.width * faceChannelCount);
+        resampleImage(mips[0].faces[face].data(), faceWidth, faceWidth, faceChannelCount, downscaled.faces[face].data(),
+                      downscaled.width, downscaled.width, bakeOptions.resampleFilter, true);
+      }
+      sharpLevels.push_back(std::move(downscaled));
+    }
+
+    CubeMapInfo info;
+    info.format = spec.format;
+    info.faceWidth = faceWidth >> spec.downscale;
+    info.faceHeight = info.faceWidth;
+    info.originalFolder = inputDir.string();
+    info.mipCount = mipCount - spec.downscale;
+    for(u32 mip = 0; mip < info.mipCount; mip++) {
+      info.mipFaceSizes.push_back(compressedImageSize(info.faceWidth >> mip, info.faceWidth >> mip, spec.format));
+      info.mipRoughness.push_back(mip == 0 ? 0.0f : (f32)(mip + spec.downscale) / (mipCount - 1));
+    }
+    info.faceSize = info.mipFaceSizes[0];
+    memcpy(info.irradianceSH, irradianceSH, sizeof(irradianceSH));
+    tierInfos.push_back(info);
+    tiers.push_back({spec.format, info.faceWidth, info.faceHeight, (u32)info.size()});
+  }
+  tierInfos[0].tiers = tiers;
+
+  for(u32 tier = 0; tier < tierInfos.size(); tier++) {
+    const CubeMapInfo& info = tierInfos[tier];
+    const TextureTierSpec& spec = tierSpecs[tier];
+    assets::AssetFile cubeMapAssetFile = assets::packCubeMap(&tierInfos[tier], nullptr);
+    char* cubeMapData = cubeMapAssetFile.binaryBlob.data();
+
+    // Each face's mip chain is compressed on its own thread, straight into its slots of the blob
+    bool faceBaked[6] = {};
+    std::thread faceThreads[6];
+    for(u32 face = 0; face < 6; face++) {
+      faceThreads[face] = std::thread([&, face]() {
+        faceBaked[face] = true;
+        for(u32 mip = 0; mip < info.mipCount && faceBaked[face]; mip++) {
+          const CubeMapFaces& level = (mip != 0) ? mips[mip + spec.downscale] : (spec.downscale == 0) ? mips[0] : sharpLevels[spec.downscale];
+          faceBaked[face] = compressImageInto(level.faces[face].data(), level.width, level.width, faceChannelCount, info.format,
+                                              (u8*)info.faceData(cubeMapData, SkyboxFace(face), mip), info.mipFaceSizes[mip], 1);
+        }
+      });
+    }
+    for(std::thread& faceThread: faceThreads) {
+      faceThread.join();
+    }
+
+    for(u32 face = 0; face < 6; face++) {
+      if(!faceBaked[face]) {
+        outputErrorMsg("Error: Something went wrong with compressing face %d of %s\n", face, inputDir.string().c_str());
+        return false;
+      }
+    }
+
+    std::string tierPath = textureTierPath(outputFilename, tier);
+    printf("Cube map tier %d: %s %dx%d, %d bytes\n", tier, textureFormatToString(info.format), info.faceWidth, info.faceHeight, (u32)info.size());
+    saveAssetFile(tierPath.c_str(), cubeMapAssetFile);
+  }
+
+  return true;
+}
+
+bool convertPanoramaCubeMap(const fs::path& panoramaPath, const fs::path& inputDir, const char* outputFilename) {
+  Panorama panorama;
+  if(!loadPanorama(panoramaPath, &panorama)) {
+    outputErrorMsg("Failed to load panorama: %s\n", panoramaPath.string().c_str());
+    return false;
+  }
+
+  if(panorama.width != panorama.height * 2) {
+    printf("Warning: panorama %s is %dx%d, equirectangular panoramas are expected to be twice as wide as they are tall\n",
+           panoramaPath.string().c_str(), panorama.width, panorama.height);
+  }
+
+  // NOTE: A quarter of the panorama width matches the panorama's texel density along the horizon
+  u32 faceWidth = bakeOptions.skyboxFaceSize != 0 ? bakeOptions.skyboxFaceSize : panorama.width / 4;
+  faceWidth &= ~3u; // faces must be evenly divisible by 4 for block compression
+  if(faceWidth == 0) {
+    outputErrorMsg("Panorama is too small to be resampled into a cube map: %s\n", panoramaPath.string().c_str());
+    return false;
+  }
+
+  /*
+   * Bilinear & bicubic sampling only look at the nearest few texels, so a panorama much denser than the faces would
+   * alias. It is first resampled down to the faces' density.
+   * NOTE: LDR panoramas are filtered in their own (gamma) space & the left and right edges are clamped rather than wrapped
+   */
+  if(panorama.width > faceWidth * 4 * 2) {
+    u32 prefilteredWidth = faceWidth * 4;
+    u32 prefilteredHeight = Max(panorama.height * prefilteredWidth / panorama.width, 1u);
+    std::vector<f32> prefiltered((size_t)prefilteredWidth * prefilteredHeight * 3 + 1, 0.0f);
+    resampleImage(panorama.texels.data(), panorama.width, panorama.height, 3, prefiltered.data(), prefilteredWidth,
+                  prefilteredHeight, bakeOptions.resampleFilter);
+    printf("Prefiltered panorama from %dx%d to %dx%d\n", panorama.width, panorama.height, prefilteredWidth, prefilteredHeight);
+    panorama.texels.swap(prefiltered);
+    panorama.width = prefilteredWidth;
+    panorama.height = prefilteredHeight;
+  }
+
+  std::vector<CubeMapFaces> mips(1);
+  mips[0].width = faceWidth;
+  resamplePanorama(panorama, faceWidth, bakeOptions.skyboxFilter, mips[0].faces);
+  printf("Resampled %s panorama (%dx%d) into %dx%d faces\n", panorama.hdr ? "HDR" : "LDR", panorama.width, panorama.height, faceWidth, faceWidth);
 
-  int frontWidth, frontHeight, frontChannels,
-      backWidth, backHeight, backChannels,
-      topWidth, topHeight, topChannels,
-      bottomWidth, bottomHeight, bottomChannels,
-      leftWidth, leftHeight, leftChannels,
-      rightWidth, rightHeight, rightChannels;
+  return bakeCubeMap(mips, inputDir, outputFilename);
+}
 
+bool convertCubeMapTexture(const fs::path& inputDir, const char* outputFilename) {
   fs::path ext;
+  for(auto const& skyboxFaceImage: std::filesystem::directory_iterator(inputDir)) {
+    // NOTE: A single equirectangular panorama may stand in for the six hand-split faces
+    if(fs::is_regular_file(skyboxFaceImage) && skyboxFaceImage.path().stem() == "panorama") {
+      return convertPanoramaCubeMap(skyboxFaceImage.path(), inputDir, outputFilename);
+    }
+  }
+
   for(auto const& skyboxFaceImage: std::filesystem::directory_iterator(inputDir)) {
     if(fs::is_regular_file(skyboxFaceImage)) {
       ext = skyboxFaceImage.path().extension(); // pull extension from first file we find
@@ -591,81 +2236,172 @@ bool convertCubeMapTexture(const fs::path& inputDir, const char* outputFilename)
     return false;
   }
 
-  fs::path frontPath = (inputDir / "front").replace_extension(ext);
-  fs::path backPath = (inputDir / "back").replace_extension(ext);
-  fs::path topPath = (inputDir / "top").replace_extension(ext);
-  fs::path bottomPath = (inputDir / "bottom").replace_extension(ext);
-  fs::path leftPath = (inputDir / "left").replace_extension(ext);
-  fs::path rightPath = (inputDir / "right").replace_extension(ext);
-
-  stbi_uc* frontPixels = stbi_load(frontPath.u8string().c_str(), &frontWidth, &frontHeight, &frontChannels, STBI_rgb);
-  stbi_uc* backPixels = stbi_load(backPath.u8string().c_str(), &backWidth, &backHeight, &backChannels, STBI_rgb);
-  stbi_uc* topPixels = stbi_load(topPath.u8string().c_str(), &topWidth, &topHeight, &topChannels, STBI_rgb);
-  stbi_uc* bottomPixels = stbi_load(bottomPath.u8string().c_str(), &bottomWidth, &bottomHeight, &bottomChannels, STBI_rgb);
-  stbi_uc* rightPixels = stbi_load(rightPath.u8string().c_str(), &rightWidth, &rightHeight, &rightChannels, STBI_rgb);
-  stbi_uc* leftPixels = stbi_load(leftPath.u8string().c_str(), &leftWidth, &leftHeight, &leftChannels, STBI_rgb);
-
-  if(!frontPixels || !backPixels || !topPixels || !bottomPixels || !leftPixels || !rightPixels) {
-    outputErrorMsg("Failed to load CubeMap face file for directory %s\n", inputDir.string().c_str());
-    return false;
+  // NOTE: Order matches SkyboxFace
+  const char* faceNames[6] = { "front", "back", "top", "bottom", "right", "left" };
+  fs::path facePaths[6];
+  int faceWidths[6], faceHeights[6], faceChannels[6];
+  for(u32 face = 0; face < 6; face++) {
+    facePaths[face] = (inputDir / faceNames[face]).replace_extension(ext);
+    if(!stbi_info(facePaths[face].u8string().c_str(), &faceWidths[face], &faceHeights[face], &faceChannels[face])) {
+      outputErrorMsg("Failed to load CubeMap face file for directory %s\n", inputDir.string().c_str());
+      return false;
+    }
   }
 
-  if(frontWidth != backWidth || frontWidth != topWidth || frontWidth != bottomWidth || frontWidth != leftWidth || frontWidth != rightWidth ||
-      frontHeight != backHeight || frontHeight != topHeight || frontHeight != bottomHeight || frontHeight != leftHeight || frontHeight != rightHeight ||
-      frontChannels != backChannels || frontChannels != topChannels || frontChannels != bottomChannels || frontChannels != leftChannels || frontChannels != rightChannels) {
-    outputErrorMsg("One or more CubeMap faces do not match in either width, height, or number of channels for directory %s\n", inputDir.string().c_str());
-    return false;
+  const u32 faceWidth = faceWidths[0];
+  for(u32 face = 0; face < 6; face++) {
+    if((u32)faceWidths[face] != faceWidth || (u32)faceHeights[face] != faceWidth) {
+      outputErrorMsg("CubeMap faces must be square and match in size for directory %s\n", inputDir.string().c_str());
+      return false;
+    }
   }
 
-  if((frontWidth % 4) != 0 || (frontHeight % 4) != 0) {
+  if((faceWidth % 4) != 0) {
     outputErrorMsg("CubeMap face widths and heights must be evenly divisible by 4: %s\n", inputDir.string().c_str());
     return false;
   }
 
-  assert_release(topChannels == 3 && "Number of channels for cube map asset does not match desired");
+  // Each face is decoded on its own thread
+  std::vector<CubeMapFaces> mips(1);
+  mips[0].width = faceWidth;
+  bool faceDecoded[6] = {};
+  std::thread faceThreads[6];
+  for(u32 face = 0; face < 6; face++) {
+    faceThreads[face] = std::thread([&, face]() {
+      int width, height, channels;
+      stbi_uc* pixels = stbi_load(facePaths[face].u8string().c_str(), &width, &height, &channels, STBI_rgb);
+      if(!pixels) { return; }
+      mips[0].faces[face].assign(pixels, pixels + (size_t)faceWidth * faceWidth * 3);
+      stbi_image_free(pixels);
+      faceDecoded[face] = true;
+    });
+  }
+  for(std::thread& faceThread: faceThreads) {
+    faceThread.join();
+  }
 
-  u32 facePixelsSize = frontWidth * frontHeight * frontChannels;
-  unsigned char* cubeMapPixels_fbtbrl = (unsigned char*)malloc(facePixelsSize * 6);
-  memcpy(cubeMapPixels_fbtbrl, frontPixels, facePixelsSize);
-  memcpy(cubeMapPixels_fbtbrl + (1 * facePixelsSize), backPixels, facePixelsSize);
-  memcpy(cubeMapPixels_fbtbrl + (2 * facePixelsSize), topPixels, facePixelsSize);
-  memcpy(cubeMapPixels_fbtbrl + (3 * facePixelsSize), bottomPixels, facePixelsSize);
-  memcpy(cubeMapPixels_fbtbrl + (4 * facePixelsSize), rightPixels, facePixelsSize);
-  memcpy(cubeMapPixels_fbtbrl + (5 * facePixelsSize), leftPixels, facePixelsSize);
+  for(u32 face = 0; face < 6; face++) {
+    if(!faceDecoded[face]) {
+      outputErrorMsg("Error: Something went wrong with decoding %s\n", facePaths[face].string().c_str());
+      return false;
+    }
+  }
 
-  stbi_image_free(frontPixels);
-  stbi_image_free(backPixels);
-  stbi_image_free(topPixels);
-  stbi_image_free(bottomPixels);
-  stbi_image_free(leftPixels);
-  stbi_image_free(rightPixels);
+  return bakeCubeMap(mips, inputDir, outputFilename);
+}
 
-  u8* compressedBytes;
-  u32 compressedSize;
-  TextureFormat compressedFormat;
-  bool success = compressImage(cubeMapPixels_fbtbrl, topWidth, topHeight * 6, topChannels, &compressedBytes, &compressedSize, &compressedFormat);
+/*
+ * Packs baked skyboxes into a cube map array, one array per tier built from the layers' matching tiers.
+ * Layers are required to share their entire tier layout (format, face size & mip chain), which in practice means
+ * skyboxes of the same face size.
+ */
+std::vector<std::string> readSkyboxArrayList(const fs::path& layerListPath) {
+  std::vector<std::string> layerNames;
+  std::ifstream layerList(layerListPath);
+  std::string line;
+  while(std::getline(layerList, line)) {
+    line.erase(line.find_last_not_of(" \t\r") + 1);
+    if(!line.empty()) { layerNames.push_back(line); }
+  }
+  return layerNames;
+}
 
-  if(!success) {
-    outputErrorMsg("Error: Something went wrong with compressing %s\n", inputDir.string().c_str());
+// NOTE: Layers are found in skyboxArrayLayersDir, or bakedSkyboxesDir when they were baked with skyboxArrayFallback
+bool packCubeMapArrayTexture(const fs::path& layerListPath, const fs::path& bakedSkyboxesDir, const char* outputFilename) {
+  std::vector<std::string> layerNames = readSkyboxArrayList(layerListPath);
+
+  if(layerNames.empty()) {
+    outputErrorMsg("Skybox array list (%s) was found empty.\n", layerListPath.string().c_str());
     return false;
   }
 
-  CubeMapInfo info;
-  info.format = compressedFormat;
-  info.faceWidth = topWidth;
-  info.faceHeight = topHeight;
-  info.originalFolder = inputDir.string();
-  info.faceSize = compressedSize / 6;
-  assets::AssetFile cubeMapAssetFile = assets::packCubeMap(&info, compressedBytes);
+  std::vector<CubeMapInfo> layerInfos(layerNames.size());
+  std::vector<fs::path> layerPaths(layerNames.size());
+  for(u32 layer = 0; layer < layerNames.size(); layer++) {
+    fs::path layerPath = (fs::path(skyboxArrayLayersDir) / layerNames[layer]).replace_extension(bakedExtensions.cubeMap);
+    if(!fs::exists(layerPath)) { layerPath = (bakedSkyboxesDir / layerNames[layer]).replace_extension(bakedExtensions.cubeMap); }
+    layerPaths[layer] = layerPath;
+    AssetFile layerFile;
+    if(!fs::exists(layerPath) || !loadAssetFile(layerPath.string().c_str(), &layerFile, false)) {
+      outputErrorMsg("Skybox array layer %s has not been baked\n", layerPath.string().c_str());
+      return false;
+    }
+    readCubeMapInfo(layerFile, &layerInfos[layer]);
+
+    const std::vector<TextureTier>& tiers = layerInfos[layer].tiers;
+    const std::vector<TextureTier>& firstTiers = layerInfos[0].tiers;
+    bool layoutMatches = tiers.size() == firstTiers.size() && layerInfos[layer].mipCount == layerInfos[0].mipCount;
+    for(u32 tier = 0; layoutMatches && tier < tiers.size(); tier++) {
+      layoutMatches = tiers[tier].format == firstTiers[tier].format && tiers[tier].width == firstTiers[tier].width &&
+                      tiers[tier].height == firstTiers[tier].height && tiers[tier].size == firstTiers[tier].size;
+    }
+    if(!layoutMatches) {
+      outputErrorMsg("Skybox array layers %s and %s differ in size or format\n", layerNames[0].c_str(), layerNames[layer].c_str());
+      return false;
+    }
+  }
 
-  if(compressedBytes != cubeMapPixels_fbtbrl){ free(compressedBytes); }
-  free(cubeMapPixels_fbtbrl);
+  const u32 layerCount = (u32)layerNames.size();
+  for(u32 tier = 0; tier < layerInfos[0].tiers.size(); tier++) {
+    CubeMapArrayInfo info;
+    std::vector<std::string> layerTierPaths;
+    for(u32 layer = 0; layer < layerCount; layer++) {
+      std::string layerTierPath = textureTierPath(layerPaths[layer].string(), tier);
+      AssetFile layerFile;
+      CubeMapInfo layerInfo;
+      if(!loadAssetFile(layerTierPath.c_str(), &layerFile, false)) {
+        outputErrorMsg("Skybox array layer tier %s has not been baked\n", layerTierPath.c_str());
+        return false;
+      }
+      readCubeMapInfo(layerFile, &layerInfo);
+
+      if(layer == 0) {
+        info.format = layerInfo.format;
+        info.faceWidth = layerInfo.faceWidth;
+        info.faceHeight = layerInfo.faceHeight;
+        info.mipCount = layerInfo.mipCount;
+        info.mipFaceSizes = layerInfo.mipFaceSizes;
+        info.mipRoughness = layerInfo.mipRoughness;
+        info.layerCount = layerCount;
+        info.layerNames = layerNames;
+        if(tier == 0) {
+          for(TextureTier layerTier: layerInfo.tiers) {
+            layerTier.size *= layerCount;
+            info.tiers.push_back(layerTier);
+          }
+        }
+      }
+      assert(layerInfo.size() == info.layerSize());
+
+      const f32* irradianceSH = &layerInfo.irradianceSH[0][0];
+      info.layerIrradianceSH.insert(info.layerIrradianceSH.end(), irradianceSH, irradianceSH + CUBE_MAP_SH_COEFFICIENT_COUNT * 3);
+      layerTierPaths.push_back(layerTierPath);
+    }
 
-  saveAssetFile(outputFilename, cubeMapAssetFile);
+    // Layers are copied into the array's file one at a time, only a single layer is ever held in memory
+    AssetFile cubeMapArrayAssetFile = packCubeMapArray(&info, nullptr);
+    std::string tierPath = textureTierPath(outputFilename, tier);
+    AssetFileWriter writer;
+    if(!beginAssetFile(tierPath.c_str(), cubeMapArrayAssetFile, (u32)info.size(), &writer)) { return false; }
+    std::vector<char> layerData(info.layerSize());
+    for(u32 layer = 0; layer < layerCount; layer++) {
+      if(!loadAssetFileBlobRange(layerTierPaths[layer].c_str(), 0, info.layerSize(), layerData.data()) ||
+         !writeAssetFileBlob(&writer, layerData.data(), info.layerSize())) {
+        outputErrorMsg("Failed to copy skybox array layer %s\n", layerTierPaths[layer].c_str());
+        endAssetFile(&writer);
+        return false;
+      }
+    }
+    if(!endAssetFile(&writer)) { return false; }
+    printf("Cube map array tier %d: %d layers, %s %dx%d, %llu bytes\n", tier, layerCount, textureFormatToString(info.format),
+           info.faceWidth, info.faceHeight, (unsigned long long)info.size());
+  }
 
   return true;
 }
 
+// NOTE: stb_image decodes the whole source before anything else happens, so peak memory still scales with the source
+// (ex: a 16k x 16k RGB texture is 768MB decoded). Only what comes after the decode is bounded.
 bool convertTexture(const fs::path& inputPath, const char* outputFilename) {
   int texWidth, texHeight, texChannels;
 
@@ -678,29 +2414,195 @@ bool convertTexture(const fs::path& inputPath, const char* outputFilename) {
 
   assert_release(texChannels == 3 || texChannels == 1 && "Texture has an unsupported amount of channels.");
 
-  u8* compressedBytes;
-  u32 compressedSize;
-  TextureFormat compressedFormat;
-  bool success = compressImage(pixels, texWidth, texHeight, texChannels, &compressedBytes, &compressedSize, &compressedFormat);
+  std::vector<TextureTierSpec> tierSpecs = textureTierSpecs(texChannels, texWidth, texHeight, bakeOptions.textureTierCount, 0);
+  // NOTE: Indexed by downscale, the full resolution tiers read straight from the decoded pixels. Each downscaled image
+  // is freed as soon as the last tier using it is written, so at most one is alive next to the source.
+  std::vector<std::vector<u8>> downscaledImages(1);
 
-  if(!success) {
-    outputErrorMsg("Error: Something went wrong with compressing %s\n", inputPath.string().c_str());
-    return false;
+  std::vector<TextureTier> tiers;
+  for(const TextureTierSpec& spec: tierSpecs) {
+    u32 tierWidth = texWidth >> spec.downscale;
+    u32 tierHeight = texHeight >> spec.downscale;
+    tiers.push_back({spec.format, tierWidth, tierHeight, compressedImageSize(tierWidth, tierHeight, spec.format)});
   }
 
-  TextureInfo texInfo;
-  texInfo.size = compressedSize;
-  texInfo.originalFileName = inputPath.string();
-  texInfo.width = texWidth;
-  texInfo.height = texHeight;
-  texInfo.format = compressedFormat;
+  bool success = true;
+  for(u32 tier = 0; tier < tiers.size() && success; tier++) {
+    u32 downscale = tierSpecs[tier].downscale;
+    if(downscaledImages.size() <= downscale) { downscaledImages.resize(downscale + 1); }
+    if(downscale != 0 && downscaledImages[downscale].empty()) {
+      // NOTE: Always resampled from the full resolution image, repeated halving would compound the filter's blur
+      u32 downscaledWidth = texWidth >> downscale;
+      u32 downscaledHeight = texHeight >> downscale;
+      downscaledImages[downscale].resize((size_t)downscaledWidth * downscaledHeight * texChannels);
+      // NOTE: Single channel textures hold data rather than colors and are filtered as is
+      resampleImage(pixels, texWidth, texHeight, texChannels, downscaledImages[downscale].data(), downscaledWidth,
+                    downscaledHeight, bakeOptions.resampleFilter, texChannels != 1);
+    }
+    const u8* tierPixels = downscale == 0 ? pixels : downscaledImages[downscale].data();
+
+    TextureInfo texInfo;
+    texInfo.size = tiers[tier].size;
+    texInfo.originalFileName = inputPath.string();
+    texInfo.width = tiers[tier].width;
+    texInfo.height = tiers[tier].height;
+    texInfo.format = tiers[tier].format;
+    if(tier == 0) { texInfo.tiers = tiers; }
+
+    // Blocks are written to disk strip by strip as they are compressed
+    assets::AssetFile newImage = assets::packTexture(&texInfo, nullptr);
+    AssetFileWriter writer;
+    std::string tierPath = textureTierPath(outputFilename, tier);
+    success = beginAssetFile(tierPath.c_str(), newImage, texInfo.size, &writer);
+    success = success && compressImageStrips(tierPixels, texInfo.width, texInfo.height, texChannels, texInfo.format,
+                                             [&](const u8* blocks, u32 size) { return writeAssetFileBlob(&writer, blocks, size); });
+    success = endAssetFile(&writer) && success;
+    if(!success) {
+      outputErrorMsg("Error: Something went wrong with compressing %s\n", inputPath.string().c_str());
+    }
 
-  assets::AssetFile newImage = assets::packTexture(&texInfo, compressedBytes);
-  saveAssetFile(outputFilename, newImage);
+    bool downscaleUsedLater = false;
+    for(u32 laterTier = tier + 1; laterTier < tiers.size(); laterTier++) {
+      downscaleUsedLater = downscaleUsedLater || tierSpecs[laterTier].downscale == downscale;
+    }
+    if(!downscaleUsedLater) { std::vector<u8>().swap(downscaledImages[downscale]); }
+  }
 
-  if(compressedBytes != pixels){ free(compressedBytes); }
   stbi_image_free(pixels);
+  return success;
+}
 
+// NOTE: Pre-compressed blocks are kept as is, tiers are the KTX2's own mip chain starting at successively lower levels
+bool convertKTX2Texture(const fs::path& inputPath, const char* outputFilename) {
+  std::vector<char> fileBytes;
+  KTX2Texture ktx2;
+  if(!readFile(inputPath.string().c_str(), fileBytes) || !readKTX2(fileBytes.data(), fileBytes.size(), &ktx2)) {
+    outputErrorMsg("Failed to load KTX2 file %s\n", inputPath.string().c_str());
+    return false;
+  }
+  if(ktx2.faceCount != 1) {
+    outputErrorMsg("Error: %s is a cube map, KTX2 cube maps are imported from the skyboxes directory\n", inputPath.string().c_str());
+    return false;
+  }
+
+  const u32 levelCount = (u32)ktx2.levels.size();
+  const u32 tierCount = Min(bakeOptions.textureTierCount, levelCount);
+  std::vector<TextureTier> tiers;
+  for(u32 tier = 0; tier < tierCount; tier++) {
+    u64 tierSize = 0;
+    for(u32 level = tier; level < levelCount; level++) { tierSize += ktx2.levels[level].size; }
+    tiers.push_back({ktx2.format, Max(ktx2.width >> tier, 1u), Max(ktx2.height >> tier, 1u), (u32)tierSize});
+  }
+
+  bool success = true;
+  for(u32 tier = 0; tier < tierCount && success; tier++) {
+    TextureInfo texInfo;
+    texInfo.format = ktx2.format;
+    texInfo.size = tiers[tier].size;
+    texInfo.width = tiers[tier].width;
+    texInfo.height = tiers[tier].height;
+    texInfo.originalFileName = inputPath.string();
+    for(u32 level = tier; level < levelCount; level++) { texInfo.mipSizes.push_back((u32)ktx2.levels[level].size); }
+    if(tier == 0) { texInfo.tiers = tiers; }
+
+    assets::AssetFile newImage = assets::packTexture(&texInfo, nullptr);
+    AssetFileWriter writer;
+    std::string tierPath = textureTierPath(outputFilename, tier);
+    success = beginAssetFile(tierPath.c_str(), newImage, texInfo.size, &writer);
+    for(u32 level = tier; level < levelCount && success; level++) {
+      success = writeAssetFileBlob(&writer, ktx2.levels[level].data, ktx2.levels[level].size);
+    }
+    success = endAssetFile(&writer) && success;
+  }
+  return success;
+}
+
+// NOTE: Irradiance SH & mip roughness can't be derived from compressed blocks, so only cube maps carrying the json of
+// a baked cube map (as written by --export-ktx2) can be imported
+bool convertKTX2CubeMap(const fs::path& inputPath, const char* outputFilename) {
+  std::vector<char> fileBytes;
+  KTX2Texture ktx2;
+  if(!readFile(inputPath.string().c_str(), fileBytes) || !readKTX2(fileBytes.data(), fileBytes.size(), &ktx2)) {
+    outputErrorMsg("Failed to load KTX2 file %s\n", inputPath.string().c_str());
+    return false;
+  }
+  const KTX2KeyValue* assetJson = ktx2.findKeyValue(ktx2AssetJsonKey);
+  if(ktx2.faceCount != 6 || assetJson == nullptr) {
+    outputErrorMsg("Error: %s is not a cube map exported with --export-ktx2\n", inputPath.string().c_str());
+    return false;
+  }
+
+  CubeMapInfo info;
+  try {
+    AssetFile jsonFile;
+    jsonFile.json.assign(assetJson->value, strnlen(assetJson->value, assetJson->size));
+    readCubeMapInfo(jsonFile, &info);
+  } catch(const nlohmann::json::exception& ex) {
+    outputErrorMsg("Error: %s does not hold the json of a cube map: %s\n", inputPath.string().c_str(), ex.what());
+    return false;
+  }
+  if(info.mipCount != ktx2.levels.size() || info.mipRoughness.size() != ktx2.levels.size()) {
+    outputErrorMsg("Error: %s has %u mip levels where its cube map json expects %u\n", inputPath.string().c_str(), (u32)ktx2.levels.size(), info.mipCount);
+    return false;
+  }
+
+  info.format = ktx2.format;
+  info.faceWidth = ktx2.width;
+  info.faceHeight = ktx2.height;
+  info.faceSize = (u32)ktx2.faceSize(0);
+  info.mipFaceSizes.clear();
+  for(u32 level = 0; level < ktx2.levels.size(); level++) { info.mipFaceSizes.push_back((u32)ktx2.faceSize(level)); }
+  info.originalFolder = inputPath.string();
+  info.tiers = {{info.format, info.faceWidth, info.faceHeight, (u32)info.size()}};
+
+  // NOTE: Both cube map assets & KTX2 store the six faces of a level contiguously, in the same order
+  AssetFile cubeMapAsset = packCubeMap(&info, nullptr);
+  for(u32 level = 0; level < ktx2.levels.size(); level++) {
+    memcpy(info.faceData(cubeMapAsset.binaryBlob.data(), SKYBOX_FACE_FRONT, level), ktx2.levels[level].data, ktx2.levels[level].size);
+  }
+  return saveAssetFile(outputFilename, cubeMapAsset);
+}
+
+// Writes a baked texture or cube map to a KTX2 file beside it, for external tools to inspect
+bool exportKTX2(const fs::path& assetPath) {
+  AssetFile file;
+  if(!loadAssetFile(assetPath.string().c_str(), &file)) {
+    outputErrorMsg("Failed to load asset %s\n", assetPath.string().c_str());
+    return false;
+  }
+
+  KTX2Texture ktx2;
+  const char* writer = "ScenesMobile asset baker";
+  ktx2.keyValues.push_back({"KTXwriter", writer, (u32)strlen(writer) + 1});
+  ktx2.keyValues.push_back({ktx2AssetJsonKey, file.json.c_str(), (u32)file.json.size() + 1});
+
+  char* blob = file.binaryBlob.data();
+  if(assetPath.extension() == bakedExtensions.texture) {
+    TextureInfo info;
+    readTextureInfo(file, &info);
+    ktx2.format = info.format;
+    ktx2.width = info.width;
+    ktx2.height = info.height;
+    ktx2.faceCount = 1;
+    for(u32 mip = 0; mip < info.mipCount(); mip++) { ktx2.levels.push_back({info.mipData(blob, mip), info.mipSizes[mip]}); }
+  } else if(assetPath.extension() == bakedExtensions.cubeMap) {
+    CubeMapInfo info;
+    readCubeMapInfo(file, &info);
+    ktx2.format = info.format;
+    ktx2.width = info.faceWidth;
+    ktx2.height = info.faceHeight;
+    ktx2.faceCount = 6;
+    for(u32 mip = 0; mip < info.mipCount; mip++) {
+      ktx2.levels.push_back({info.faceData(blob, SKYBOX_FACE_FRONT, mip), (u64)info.mipFaceSizes[mip] * 6});
+    }
+  } else {
+    outputErrorMsg("Error: Only %s & %s assets can be exported to KTX2\n", bakedExtensions.texture, bakedExtensions.cubeMap);
+    return false;
+  }
+
+  fs::path exportPath = fs::path(assetPath).replace_extension(ktx2Extension);
+  if(!saveKTX2(exportPath.string().c_str(), ktx2)) { return false; }
+  printf("Exported %s\n", exportPath.string().c_str());
   return true;
 }
 
@@ -710,6 +2612,54 @@ f64 lastModifiedTimeStamp(const fs::path &file) {
   return lastModified;
 }
 
+// Prints the tier a device would load for every baked texture & skybox, letting tier selection be checked on desktop
+void printBakedTierSelection(u64 sizeBudget) {
+  // NOTE: GLES 3.0 guarantees ETC2/EAC, ASTC is common but optional
+  const u32 etc2Formats = TEXTURE_FORMAT_BIT(TextureFormat_R8) | TEXTURE_FORMAT_BIT(TextureFormat_RGB8) |
+                          TEXTURE_FORMAT_BIT(TextureFormat_ETC2_RGB) | TEXTURE_FORMAT_BIT(TextureFormat_ETC2_RGBA);
+  const u32 astcFormats = etc2Formats | TEXTURE_FORMAT_BIT(TextureFormat_ASTC_RGBA_4x4);
+  const char* tieredDirs[] = { "textures", "skyboxes" };
+  printf("Tier selection for a budget of %llu bytes per texture\n", (unsigned long long)sizeBudget);
+  for(const char* tieredDir: tieredDirs) {
+    fs::path dir = fs::path(bakedAssetsDir) / tieredDir;
+    if(!fs::exists(dir)) { continue; }
+    for(auto const& bakedFile: std::filesystem::directory_iterator(dir)) {
+      // NOTE: Only tier 0 files (ex: "cave.cbtx" and not "cave.t1.cbtx") list the tiers
+      if(bakedFile.path().stem().has_extension()) { continue; }
+      AssetFile assetFile;
+      if(!loadAssetFile(bakedFile.path().string().c_str(), &assetFile, false)) { continue; }
+      std::vector<TextureTier> tiers;
+      u64 tierBudget = sizeBudget;
+      if(bakedFile.path().extension() == bakedExtensions.cubeMap) {
+        CubeMapInfo info;
+        readCubeMapInfo(assetFile, &info);
+        tiers = info.tiers;
+      } else if(bakedFile.path().extension() == bakedExtensions.cubeMapArray) {
+        // NOTE: An array stands in for one texture per layer and gets the budget of all of them
+        CubeMapArrayInfo info;
+        readCubeMapArrayInfo(assetFile, &info);
+        tiers = info.tiers;
+        tierBudget *= info.layerCount;
+      } else if(bakedFile.path().extension() == bakedExtensions.texture) {
+        TextureInfo info;
+        readTextureInfo(assetFile, &info);
+        tiers = info.tiers;
+      } else {
+        continue;
+      }
+      if(tiers.empty()) { continue; }
+
+      u32 etc2Tier = selectTextureTier(tiers, tierBudget, etc2Formats);
+      u32 astcTier = selectTextureTier(tiers, tierBudget, astcFormats);
+      printf("  %s\n", bakedFile.path().string().c_str());
+      printf("    ETC2 device: tier %d (%s %dx%d, %d bytes)\n", etc2Tier, textureFormatToString(tiers[etc2Tier].format),
+             tiers[etc2Tier].width, tiers[etc2Tier].height, tiers[etc2Tier].size);
+      printf("    ASTC device: tier %d (%s %dx%d, %d bytes)\n", astcTier, textureFormatToString(tiers[astcTier].format),
+             tiers[astcTier].width, tiers[astcTier].height, tiers[astcTier].size);
+    }
+  }
+}
+
 bool CompressionCallback(float fProgress, CMP_DWORD_PTR pUser1, CMP_DWORD_PTR pUser2) {
   printf("\rCompression progress = %3.0f  ", fProgress);
   bool abortCompression = false;
@@ -812,6 +2762,7 @@ void saveCache(const std::unordered_map<std::string, AssetBakeCachedItem> &oldCa
     bakedFiles.push_back(newCacheItemJson);
   }
 
+  cacheJson[cacheJsonStrings.assetLibVersion] = ASSET_LIB_VERSION;
   cacheJson[cacheJsonStrings.cacheFiles] = bakedFiles;
   std::string jsonString = cacheJson.dump(1);
   writeFile(assetBakerCacheFileName, jsonString);
@@ -831,6 +2782,13 @@ void loadCache(std::unordered_map<std::string, AssetBakeCachedItem> &assetBakeCa
   std::string fileString(fileBytes.begin(), fileBytes.end());
   nlohmann::json cache = nlohmann::json::parse(fileString);
 
+  u32 cacheAssetLibVersion = cache.value(cacheJsonStrings.assetLibVersion, 0u);
+  if(cacheAssetLibVersion != ASSET_LIB_VERSION) {
+    printf("Asset baker cache was written by asset lib version #%d. Asset lib version is currently #%d. Every asset will be rebaked.\n",
+           cacheAssetLibVersion, ASSET_LIB_VERSION);
+    return;
+  }
+
   nlohmann::json cachedFiles = cache[cacheJsonStrings.cacheFiles];
 
   for (auto& element : cachedFiles) {
@@ -0,0 +1,354 @@
+/*
+ * Separable image resampler used for texture tiers, skybox tiers & panorama prefiltering.
+ *  - Rows are filtered horizontally into linear f32 intermediate rows, then columns are filtered vertically out of them.
+ *  - Each pass precomputes a weight table holding, for every output pixel, the same number of taps over its window of
+ *    source pixels (a polyphase filter bank where every output pixel is its own phase).
+ *  - Work is split into bands of output rows that threads pull from a shared counter.
+ *  - 8-bit sRGB images are filtered in linear light, alpha channels are always treated as linear.
+ */
+
+enum ResampleFilter {
+  ResampleFilter_Box,
+  ResampleFilter_Kaiser,
+  ResampleFilter_Lanczos3,
+};
+
+struct ResampleWeights {
+  u32 tapCount;
+  std::vector<u32> firstTaps; // source pixel of each output pixel's first tap
+  std::vector<f32> weights; // tapCount weights per output pixel
+};
+
+internal_func f32 sinc(f32 x) {
+  if(fabsf(x) < 1e-6f) { return 1.0f; }
+  return sinf(Pi32 * x) / (Pi32 * x);
+}
+
+// Zeroth order modified Bessel function of the first kind
+internal_func f32 besselI0(f32 x) {
+  f64 sum = 1.0, term = 1.0;
+  for(u32 k = 1; k < 32 && term > sum * 1e-12; k++) {
+    term *= (x * 0.5) / k * (x * 0.5) / k;
+    sum += term;
+  }
+  return (f32)sum;
+}
+
+internal_func f32 resampleFilterRadius(ResampleFilter filter) {
+  switch(filter) {
+    case ResampleFilter_Box: return 0.5f;
+    case ResampleFilter_Kaiser: return 3.0f;
+    case ResampleFilter_Lanczos3: return 3.0f;
+    default: InvalidCodePath;
+  }
+  return 0.0f;
+}
+
+internal_func f32 resampleFilterWeight(ResampleFilter filter, f32 x) {
+  switch(filter) {
+    case ResampleFilter_Box: return (x >= -0.5f && x < 0.5f) ? 1.0f : 0.0f;
+    case ResampleFilter_Kaiser: {
+      // NOTE: Kaiser windowed sinc with a width of 3 & an alpha of 4, a common choice for mip generation
+      const f32 alpha = 4.0f;
+      f32 t = x / 3.0f;
+      if(t * t >= 1.0f) { return 0.0f; }
+      return sinc(x) * besselI0(alpha * sqrtf(1.0f - t * t)) / besselI0(alpha);
+    }
+    case ResampleFilter_Lanczos3: return fabsf(x) < 3.0f ? sinc(x) * sinc(x / 3.0f) : 0.0f;
+    default: InvalidCodePath;
+  }
+  return 0.0f;
+}
+
+internal_func ResampleWeights resampleWeights(u32 srcSize, u32 dstSize, ResampleFilter filter) {
+  const f32 scale = (f32)srcSize / dstSize;
+  // NOTE: Downscaling stretches the filter so that every source pixel contributes
+  const f32 filterScale = Max(scale, 1.0f);
+  const f32 support = resampleFilterRadius(filter) * filterScale;
+
+  // NOTE: Taps falling outside of the image are folded onto the edge pixels
+  std::vector<std::vector<f32>> outputWeights(dstSize);
+  std::vector<u32> firstTaps(dstSize);
+  u32 tapCount = 1;
+  for(u32 x = 0; x < dstSize; x++) {
+    f32 center = (x + 0.5f) * scale - 0.5f;
+    s32 left = (s32)ceilf(center - support);
+    s32 right = (s32)floorf(center + support);
+    s32 first = Max(left, 0);
+    s32 last = Min(right, (s32)srcSize - 1);
+    std::vector<f32>& weights = outputWeights[x];
+    weights.assign(last - first + 1, 0.0f);
+    f32 totalWeight = 0.0f;
+    for(s32 tap = left; tap <= right; tap++) {
+      f32 weight = resampleFilterWeight(filter, (tap - center) / filterScale);
+      weights[Min(Max(tap, first), last) - first] += weight;
+      totalWeight += weight;
+    }
+    for(f32& weight: weights) { weight /= totalWeight; }
+
+    // NOTE: The edges of the box filter's window may land on zero weights
+    while(weights.size() > 1 && weights.back() == 0.0f) { weights.pop_back(); }
+    while(weights.size() > 1 && weights.front() == 0.0f) { weights.erase(weights.begin()); first++; }
+    firstTaps[x] = (u32)first;
+    tapCount = Max(tapCount, (u32)weights.size());
+  }
+
+  // Every output pixel is padded to the same tap count, keeping its window inside the image
+  ResampleWeights result;
+  result.tapCount = tapCount;
+  result.firstTaps.resize(dstSize);
+  result.weights.assign((size_t)dstSize * tapCount, 0.0f);
+  for(u32 x = 0; x < dstSize; x++) {
+    u32 first = Min(firstTaps[x], srcSize - tapCount);
+    result.firstTaps[x] = first;
+    memcpy(&result.weights[(size_t)x * tapCount + (firstTaps[x] - first)], outputWeights[x].data(), outputWeights[x].size() * sizeof(f32));
+  }
+  return result;
+}
+
+#if defined(PIXEL_KERNELS_SSE4)
+typedef __m128 Texel4;
+inline Texel4 texel4Load(const f32* texel) { return _mm_loadu_ps(texel); }
+inline Texel4 texel4Zero() { return _mm_setzero_ps(); }
+inline Texel4 texel4MulAdd(Texel4 acc, Texel4 texel, f32 weight) { return _mm_add_ps(acc, _mm_mul_ps(texel, _mm_set1_ps(weight))); }
+inline void texel4Store(f32* dst, Texel4 texel) { _mm_storeu_ps(dst, texel); }
+#elif defined(PIXEL_KERNELS_NEON)
+typedef float32x4_t Texel4;
+inline Texel4 texel4Load(const f32* texel) { return vld1q_f32(texel); }
+inline Texel4 texel4Zero() { return vdupq_n_f32(0.0f); }
+inline Texel4 texel4MulAdd(Texel4 acc, Texel4 texel, f32 weight) { return vmlaq_n_f32(acc, texel, weight); }
+inline void texel4Store(f32* dst, Texel4 texel) { vst1q_f32(dst, texel); }
+#else
+struct Texel4 { f32 lanes[4]; };
+inline Texel4 texel4Load(const f32* texel) { return {texel[0], texel[1], texel[2], texel[3]}; }
+inline Texel4 texel4Zero() { return {}; }
+inline Texel4 texel4MulAdd(Texel4 acc, Texel4 texel, f32 weight) {
+  for(u32 i = 0; i < 4; i++) { acc.lanes[i] += texel.lanes[i] * weight; }
+  return acc;
+}
+inline void texel4Store(f32* dst, Texel4 texel) { memcpy(dst, texel.lanes, sizeof(texel.lanes)); }
+#endif
+
+/*
+ * Filters one row. 3 & 4 channel pixels are filtered as 4-wide vectors, so src must have one float of padding past
+ * its last pixel & dst one float of padding past its last pixel.
+ */
+internal_func void resampleRowHorizontal(const f32* src, u32 channels, const ResampleWeights& weights, u32 dstWidth, f32* dst) {
+  const u32 tapCount = weights.tapCount;
+  const f32* pixelWeights = weights.weights.data();
+  if(channels >= 3) {
+    // NOTE: 3 channel results spill a 4th lane into the next pixel, which is overwritten by that pixel's store
+    for(u32 x = 0; x < dstWidth; x++, pixelWeights += tapCount) {
+      const f32* tap = src + (size_t)weights.firstTaps[x] * channels;
+      Texel4 result = texel4Zero();
+      for(u32 i = 0; i < tapCount; i++, tap += channels) {
+        result = texel4MulAdd(result, texel4Load(tap), pixelWeights[i]);
+      }
+      texel4Store(dst + (size_t)x * channels, result);
+    }
+  } else {
+    for(u32 x = 0; x < dstWidth; x++, pixelWeights += tapCount) {
+      const f32* tap = src + (size_t)weights.firstTaps[x] * channels;
+      for(u32 c = 0; c < channels; c++) {
+        f32 result = 0.0f;
+        for(u32 i = 0; i < tapCount; i++) { result += tap[i * channels + c] * pixelWeights[i]; }
+        dst[(size_t)x * channels + c] = result;
+      }
+    }
+  }
+}
+
+// acc[i] += row[i] * weight
+internal_func void rowMulAdd(f32* acc, const f32* row, f32 weight, u64 count) {
+  u64 i = 0;
+#if defined(PIXEL_KERNELS_AVX2)
+  const __m256 weight8 = _mm256_set1_ps(weight);
+  for(; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_mul_ps(_mm256_loadu_ps(row + i), weight8)));
+  }
+#endif
+#if defined(PIXEL_KERNELS_SSE4) || defined(PIXEL_KERNELS_NEON)
+  for(; i + 4 <= count; i += 4) {
+    texel4Store(acc + i, texel4MulAdd(texel4Load(acc + i), texel4Load(row + i), weight));
+  }
+#endif
+  for(; i < count; i++) { acc[i] += row[i] * weight; }
+}
+
+/*
+ * Core of the resampler, loadRow() hands over source rows as linear f32 (with one float of padding) & storeRow()
+ * receives every filtered row.
+ */
+internal_func void resampleRows(u32 srcWidth, u32 srcHeight, u32 channels, u32 dstWidth, u32 dstHeight, ResampleFilter filter,
+                                const std::function<void(u32 row, f32* texels)>& loadRow,
+                                const std::function<void(u32 row, const f32* texels)>& storeRow) {
+  assert(channels >= 1 && channels <= 4);
+  const ResampleWeights horizontalWeights = resampleWeights(srcWidth, dstWidth, filter);
+  const ResampleWeights verticalWeights = resampleWeights(srcHeight, dstHeight, filter);
+  const size_t srcRowFloats = (size_t)srcWidth * channels;
+  const size_t dstRowFloats = (size_t)dstWidth * channels;
+  // NOTE: Intermediate rows are padded by one float for resampleRowHorizontal()
+  const size_t intermediateStride = dstRowFloats + 1;
+
+  /*
+   * Each band of output rows filters horizontally only the source rows its vertical taps reach, into its thread's own
+   * intermediate rows. Bands overlap by a few source rows, in exchange memory is bounded by the band size rather than
+   * by the size of the image.
+   */
+  const u32 bandRows = 64;
+  const u32 bandCount = (dstHeight + bandRows - 1) / bandRows;
+  u32 maxBandSourceRows = 0;
+  for(u32 band = 0; band < bandCount; band++) {
+    u32 lastY = Min((band + 1) * bandRows, dstHeight) - 1;
+    maxBandSourceRows = Max(maxBandSourceRows, verticalWeights.firstTaps[lastY] + verticalWeights.tapCount - verticalWeights.firstTaps[band * bandRows]);
+  }
+
+  std::atomic<u32> nextBand{0};
+  auto filterBands = [&]() {
+    std::vector<f32> srcRow(srcRowFloats + 1);
+    std::vector<f32> intermediate((size_t)maxBandSourceRows * intermediateStride);
+    std::vector<f32> dstRow(dstRowFloats);
+    for(u32 band = nextBand++; band < bandCount; band = nextBand++) {
+      const u32 bandStart = band * bandRows;
+      const u32 bandEnd = Min(bandStart + bandRows, dstHeight);
+      // NOTE: firstTaps only ever increase, so the band's source rows are those between its first & last output row's
+      const u32 firstRow = verticalWeights.firstTaps[bandStart];
+      const u32 lastRow = verticalWeights.firstTaps[bandEnd - 1] + verticalWeights.tapCount - 1;
+      for(u32 row = firstRow; row <= lastRow; row++) {
+        loadRow(row, srcRow.data());
+        resampleRowHorizontal(srcRow.data(), channels, horizontalWeights, dstWidth, intermediate.data() + (size_t)(row - firstRow) * intermediateStride);
+      }
+
+      for(u32 y = bandStart; y < bandEnd; y++) {
+        const f32* rowWeights = &verticalWeights.weights[(size_t)y * verticalWeights.tapCount];
+        const f32* row = intermediate.data() + (size_t)(verticalWeights.firstTaps[y] - firstRow) * intermediateStride;
+        memset(dstRow.data(), 0, dstRowFloats * sizeof(f32));
+        for(u32 i = 0; i < verticalWeights.tapCount; i++, row += intermediateStride) {
+          if(rowWeights[i] != 0.0f) { rowMulAdd(dstRow.data(), row, rowWeights[i], dstRowFloats); }
+        }
+        storeRow(y, dstRow.data());
+      }
+    }
+  };
+
+  const u32 threadCount = Min(Max(std::thread::hardware_concurrency(), 1u), bandCount);
+  std::vector<std::thread> threads;
+  for(u32 i = 1; i < threadCount; i++) { threads.emplace_back(filterBands); }
+  filterBands();
+  for(std::thread& thread: threads) { thread.join(); }
+}
+
+/*
+ * Resamples an 8-bit image into dst, which must hold dstWidth * dstHeight * channels bytes.
+ * When srgb is set, every channel but the alpha of 2 & 4 channel images is decoded to linear before being filtered.
+ */
+void resampleImage(const u8* src, u32 srcWidth, u32 srcHeight, u32 channels, u8* dst, u32 dstWidth, u32 dstHeight,
+                   ResampleFilter filter, bool srgb) {
+  const bool hasAlpha = channels == 2 || channels == 4;
+  const u32 alphaChannel = channels - 1;
+  resampleRows(srcWidth, srcHeight, channels, dstWidth, dstHeight, filter,
+               [&](u32 row, f32* texels) {
+                 const u8* srcRow = src + (size_t)row * srcWidth * channels;
+                 const u64 count = (u64)srcWidth * channels;
+                 if(srgb) {
+                   srgbToLinear(srcRow, texels, count);
+                   if(hasAlpha) {
+                     for(u64 i = alphaChannel; i < count; i += channels) { texels[i] = srcRow[i] * (1.0f / 255.0f); }
+                   }
+                 } else {
+                   for(u64 i = 0; i < count; i++) { texels[i] = srcRow[i] * (1.0f / 255.0f); }
+                 }
+                 texels[count] = 0.0f;
+               },
+               [&](u32 row, const f32* texels) {
+                 u8* dstRow = dst + (size_t)row * dstWidth * channels;
+                 const u64 count = (u64)dstWidth * channels;
+                 // NOTE: Negative lobes of the Kaiser & Lanczos filters can overshoot, both conversions clamp
+                 if(srgb) {
+                   linearToSRGB(texels, dstRow, count);
+                   if(hasAlpha) {
+                     for(u64 i = alphaChannel; i < count; i += channels) { dstRow[i] = (u8)(Min(Max(texels[i], 0.0f), 1.0f) * 255.0f + 0.5f); }
+                   }
+                 } else {
+                   for(u64 i = 0; i < count; i++) { dstRow[i] = (u8)(Min(Max(texels[i], 0.0f), 1.0f) * 255.0f + 0.5f); }
+                 }
+               });
+}
+
+// Resamples a tightly packed f32 image as is, negative results from the filters' lobes are clamped to zero
+void resampleImage(const f32* src, u32 srcWidth, u32 srcHeight, u32 channels, f32* dst, u32 dstWidth, u32 dstHeight,
+                   ResampleFilter filter) {
+  resampleRows(srcWidth, srcHeight, channels, dstWidth, dstHeight, filter,
+               [&](u32 row, f32* texels) {
+                 const size_t count = (size_t)srcWidth * channels;
+                 memcpy(texels, src + (size_t)row * count, count * sizeof(f32));
+                 texels[count] = 0.0f;
+               },
+               [&](u32 row, const f32* texels) {
+                 const size_t count = (size_t)dstWidth * channels;
+                 f32* dstRow = dst + (size_t)row * count;
+                 for(size_t i = 0; i < count; i++) { dstRow[i] = Max(texels[i], 0.0f); }
+               });
+}
+
+const char* resampleFilterToString(ResampleFilter filter) {
+  switch(filter) {
+    case ResampleFilter_Box: return "box";
+    case ResampleFilter_Kaiser: return "kaiser";
+    case ResampleFilter_Lanczos3: return "lanczos";
+    default: InvalidCodePath;
+  }
+  return "";
+}
+
+/*
+ * Times halving every 2720x1440 drawable of the app & every raw skybox face with each filter.
+ * Throughput is measured in source megapixels per second.
+ */
+void benchmarkResampler(const fs::path& drawablesDir, const fs::path& skyboxesDir) {
+  std::vector<fs::path> imagePaths;
+  if(fs::exists(drawablesDir)) {
+    for(auto const& file: std::filesystem::directory_iterator(drawablesDir)) {
+      if(file.path().extension() == ".png" && file.path().stem().string().find("_2720_1440") != std::string::npos) { imagePaths.push_back(file.path()); }
+    }
+  }
+  if(fs::exists(skyboxesDir)) {
+    for(auto const& skyboxDir: std::filesystem::directory_iterator(skyboxesDir)) {
+      if(!fs::is_directory(skyboxDir)) { continue; }
+      for(auto const& face: std::filesystem::directory_iterator(skyboxDir)) { imagePaths.push_back(face.path()); }
+    }
+  }
+
+  printf("Resampler benchmark, %d threads\n", Max(std::thread::hardware_concurrency(), 1u));
+  const ResampleFilter filters[] = { ResampleFilter_Box, ResampleFilter_Kaiser, ResampleFilter_Lanczos3 };
+  f64 totalSeconds[ArrayCount(filters)] = {};
+  f64 totalMegapixels = 0.0;
+  for(const fs::path& imagePath: imagePaths) {
+    int width, height, channels;
+    stbi_uc* pixels = stbi_load(imagePath.u8string().c_str(), &width, &height, &channels, STBI_default);
+    if(!pixels) { continue; }
+    std::vector<u8> halved((size_t)(width / 2) * (height / 2) * channels);
+    f64 megapixels = (f64)width * height * 1e-6;
+    totalMegapixels += megapixels;
+    printf("  %s (%dx%dx%d):", imagePath.filename().string().c_str(), width, height, channels);
+    for(u32 filterIndex = 0; filterIndex < ArrayCount(filters); filterIndex++) {
+      f64 best = 1e30;
+      for(u32 run = 0; run < 3; run++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        resampleImage(pixels, width, height, channels, halved.data(), width / 2, height / 2, filters[filterIndex], true);
+        std::chrono::duration<f64> elapsed = std::chrono::high_resolution_clock::now() - start;
+        best = Min(best, elapsed.count());
+      }
+      totalSeconds[filterIndex] += best;
+      printf(" %s %.1f ms (%.0f MP/s)", resampleFilterToString(filters[filterIndex]), best * 1000.0, megapixels / best);
+    }
+    printf("\n");
+    stbi_image_free(pixels);
+  }
+
+  for(u32 filterIndex = 0; filterIndex < ArrayCount(filters); filterIndex++) {
+    if(totalSeconds[filterIndex] > 0.0) {
+      printf("  total %s: %.0f MP/s\n", resampleFilterToString(filters[filterIndex]), totalMegapixels / totalSeconds[filterIndex]);
+    }
+  }
+}
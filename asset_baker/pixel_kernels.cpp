@@ -0,0 +1,546 @@
+#include <chrono>
+#include <functional>
+#include <random>
+
+/*
+ * Pixel conversion kernels for the baker. Every kernel has a SIMD path (AVX2, SSE4.1 or NEON, picked at compile time)
+ * and a scalar reference version, suffixed Scalar, which pixel_kernels_test (asset_baker/tests) checks the SIMD path against.
+ *  - Pixels are tightly packed 8-bit channels. Unless noted otherwise, dst may equal src as long as the destination
+ *    has no more channels per pixel than the source.
+ *  - Tails that don't fill a SIMD register fall back to the scalar reference.
+ */
+#if defined(__AVX2__)
+#define PIXEL_KERNELS_AVX2 1
+#define PIXEL_KERNELS_SSE4 1
+#include <immintrin.h>
+#elif defined(__SSE4_1__) || defined(__AVX__)
+#define PIXEL_KERNELS_SSE4 1
+#include <smmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define PIXEL_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// NOTE: Used in a swizzle's channel order to write a constant 255 instead of a source channel
+#define PIXEL_CHANNEL_OPAQUE 0xFF
+
+// linearToSRGB() clamps its input to [2^-13, 1), every float in that range falls in one of 13 * 8 table buckets
+#define SRGB_TABLE_MIN_BITS 0x39000000 // 2^-13
+#define SRGB_TABLE_ALMOST_ONE_BITS 0x3f7fffff
+#define SRGB_TABLE_BUCKET_COUNT 104
+
+struct SRGBTables {
+  f32 toLinear[256];
+  // NOTE: Each bucket approximates the sRGB curve as a line over the next 8 bits of the mantissa: bias << 16 | scale
+  u32 fromLinear[SRGB_TABLE_BUCKET_COUNT];
+};
+
+inline f32 linearToSRGBExact(f32 linear) {
+  return linear <= 0.0031308f ? linear * 12.92f : 1.055f * powf(linear, 1.0f / 2.4f) - 0.055f;
+}
+
+inline f32 srgbToLinearExact(f32 srgb) {
+  return srgb <= 0.04045f ? srgb / 12.92f : powf((srgb + 0.055f) / 1.055f, 2.4f);
+}
+
+internal_func SRGBTables buildSRGBTables() {
+  SRGBTables tables;
+  for(u32 i = 0; i < 256; i++) {
+    tables.toLinear[i] = srgbToLinearExact(i / 255.0f);
+  }
+
+  // Least squares fit of a line through the middle of each of the bucket's 256 steps
+  for(u32 bucket = 0; bucket < SRGB_TABLE_BUCKET_COUNT; bucket++) {
+    f64 bucketStart = ldexp(1.0 + (bucket % 8) / 8.0, (s32)(bucket / 8) - 13);
+    f64 stepWidth = ldexp(1.0 / 8.0, (s32)(bucket / 8) - 13) / 256.0;
+    f64 sumT = 0.0, sumTT = 0.0, sumV = 0.0, sumTV = 0.0;
+    for(u32 t = 0; t < 256; t++) {
+      f64 value = linearToSRGBExact((f32)(bucketStart + (t + 0.5) * stepWidth)) * 255.0;
+      sumT += t;
+      sumTT += (f64)t * t;
+      sumV += value;
+      sumTV += t * value;
+    }
+    f64 slope = (256.0 * sumTV - sumT * sumV) / (256.0 * sumTT - sumT * sumT);
+    f64 intercept = (sumV - slope * sumT) / 256.0;
+    u32 bias = (u32)((intercept + 0.5) * 256.0 + 0.5); // NOTE: + 0.5 turns the final truncation into rounding
+    u32 scale = (u32)(slope * 65536.0 + 0.5);
+    assert(bias <= 0xFFFF && scale <= 0xFFFF);
+    tables.fromLinear[bucket] = (bias << 16) | scale;
+  }
+  return tables;
+}
+
+internal_func const SRGBTables& srgbTables() {
+  static const SRGBTables tables = buildSRGBTables();
+  return tables;
+}
+
+// Scalar references
+
+void swizzlePixelsScalar(const u8* src, u32 srcChannels, u8* dst, u32 dstChannels, const u8 dstOrder[4], u64 pixelCount) {
+  for(u64 i = 0; i < pixelCount; i++, src += srcChannels, dst += dstChannels) {
+    u8 pixel[4];
+    memcpy(pixel, src, srcChannels); // NOTE: dst may alias src
+    for(u32 c = 0; c < dstChannels; c++) {
+      dst[c] = dstOrder[c] == PIXEL_CHANNEL_OPAQUE ? 255 : pixel[dstOrder[c]];
+    }
+  }
+}
+
+// NOTE: Decodes each pixel's xyz as a [-1,1] vector, normalizes it and encodes it back. A 4th channel is left untouched.
+void renormalizeNormalMapScalar(u8* pixels, u32 channels, u64 pixelCount) {
+  for(u64 i = 0; i < pixelCount; i++, pixels += channels) {
+    f32 n[3];
+    for(u32 c = 0; c < 3; c++) { n[c] = pixels[c] * (2.0f / 255.0f) - 1.0f; }
+    // NOTE: 127.5 can't be represented, so no encoded vector has a length of zero
+    f32 invLength = 1.0f / sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    for(u32 c = 0; c < 3; c++) {
+      pixels[c] = (u8)Min(Max(n[c] * invLength * 127.5f + 128.0f, 0.0f), 255.0f);
+    }
+  }
+}
+
+void premultiplyAlphaScalar(const u8* src, u8* dst, u64 pixelCount) {
+  for(u64 i = 0; i < pixelCount; i++, src += 4, dst += 4) {
+    u32 alpha = src[3];
+    for(u32 c = 0; c < 3; c++) { dst[c] = (u8)((src[c] * alpha + 127) / 255); }
+    dst[3] = (u8)alpha;
+  }
+}
+
+// NOTE: Converts individual channel values, alpha channels should not be passed through these
+void srgbToLinearScalar(const u8* src, f32* dst, u64 count) {
+  const f32* table = srgbTables().toLinear;
+  for(u64 i = 0; i < count; i++) { dst[i] = table[src[i]]; }
+}
+
+inline u8 linearToSRGB8(f32 linear, const u32* table) {
+  const f32 minValue = 1.0f / 8192.0f;
+  const f32 almostOne = 0.99999994f;
+  if(!(linear > minValue)) { linear = minValue; } // NOTE: Also catches NaN
+  if(linear > almostOne) { linear = almostOne; }
+  u32 bits;
+  memcpy(&bits, &linear, sizeof(bits));
+  u32 entry = table[(bits - SRGB_TABLE_MIN_BITS) >> 20];
+  u32 bias = (entry >> 16) << 8;
+  u32 scale = entry & 0xFFFF;
+  u32 t = (bits >> 12) & 0xFF;
+  return (u8)((bias + scale * t) >> 16);
+}
+
+void linearToSRGBScalar(const f32* src, u8* dst, u64 count) {
+  const u32* table = srgbTables().fromLinear;
+  for(u64 i = 0; i < count; i++) { dst[i] = linearToSRGB8(src[i], table); }
+}
+
+// SIMD
+
+#ifdef PIXEL_KERNELS_SSE4
+// NOTE: 16 bytes are loaded & stored for each group of 4 pixels. Lanes of a 3 channel destination past the 4 pixels
+// are given the source bytes at the same offset, which keeps the store harmless when dst aliases src.
+internal_func __m128i swizzleShuffleMask(u32 srcChannels, u32 dstChannels, const u8 dstOrder[4]) {
+  alignas(16) u8 mask[16];
+  for(u32 lane = 0; lane < 16; lane++) { mask[lane] = (u8)lane; }
+  for(u32 pixel = 0; pixel < 4; pixel++) {
+    for(u32 c = 0; c < dstChannels; c++) {
+      mask[pixel * dstChannels + c] = dstOrder[c] == PIXEL_CHANNEL_OPAQUE ? 0x80 : (u8)(pixel * srcChannels + dstOrder[c]);
+    }
+  }
+  return _mm_load_si128((const __m128i*)mask);
+}
+
+internal_func __m128i swizzleOpaqueMask(u32 dstChannels, const u8 dstOrder[4]) {
+  alignas(16) u8 mask[16] = {};
+  for(u32 pixel = 0; pixel < 4; pixel++) {
+    for(u32 c = 0; c < dstChannels; c++) {
+      if(dstOrder[c] == PIXEL_CHANNEL_OPAQUE) { mask[pixel * dstChannels + c] = 0xFF; }
+    }
+  }
+  return _mm_load_si128((const __m128i*)mask);
+}
+#endif
+
+void swizzlePixels(const u8* src, u32 srcChannels, u8* dst, u32 dstChannels, const u8 dstOrder[4], u64 pixelCount) {
+  assert(srcChannels >= 3 && srcChannels <= 4 && dstChannels >= 3 && dstChannels <= 4);
+  assert(src != dst || dstChannels <= srcChannels);
+  u64 i = 0;
+  const u32 minChannels = Min(srcChannels, dstChannels);
+#if defined(PIXEL_KERNELS_SSE4)
+  const __m128i shuffleMask = swizzleShuffleMask(srcChannels, dstChannels, dstOrder);
+  const __m128i opaqueMask = swizzleOpaqueMask(dstChannels, dstOrder);
+#if defined(PIXEL_KERNELS_AVX2)
+  const __m256i shuffleMask256 = _mm256_broadcastsi128_si256(shuffleMask);
+  const __m256i opaqueMask256 = _mm256_broadcastsi128_si256(opaqueMask);
+  for(; i + 8 <= pixelCount && (pixelCount - i - 4) * minChannels >= 16; i += 8) {
+    __m256i pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(src + i * srcChannels))),
+                                             _mm_loadu_si128((const __m128i*)(src + (i + 4) * srcChannels)), 1);
+    pixels = _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffleMask256), opaqueMask256);
+    if(dstChannels == 4) {
+      _mm256_storeu_si256((__m256i*)(dst + i * 4), pixels);
+    } else {
+      _mm_storeu_si128((__m128i*)(dst + i * 3), _mm256_castsi256_si128(pixels));
+      _mm_storeu_si128((__m128i*)(dst + (i + 4) * 3), _mm256_extracti128_si256(pixels, 1));
+    }
+  }
+#endif
+  for(; i + 4 <= pixelCount && (pixelCount - i) * minChannels >= 16; i += 4) {
+    __m128i pixels = _mm_loadu_si128((const __m128i*)(src + i * srcChannels));
+    pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, shuffleMask), opaqueMask);
+    _mm_storeu_si128((__m128i*)(dst + i * dstChannels), pixels);
+  }
+#elif defined(PIXEL_KERNELS_NEON)
+  const uint8x16_t opaque = vdupq_n_u8(255);
+  for(; i + 16 <= pixelCount; i += 16) {
+    uint8x16_t channels[4];
+    if(srcChannels == 3) {
+      uint8x16x3_t pixels = vld3q_u8(src + i * 3);
+      channels[0] = pixels.val[0]; channels[1] = pixels.val[1]; channels[2] = pixels.val[2];
+    } else {
+      uint8x16x4_t pixels = vld4q_u8(src + i * 4);
+      channels[0] = pixels.val[0]; channels[1] = pixels.val[1]; channels[2] = pixels.val[2]; channels[3] = pixels.val[3];
+    }
+    if(dstChannels == 3) {
+      uint8x16x3_t pixels;
+      for(u32 c = 0; c < 3; c++) { pixels.val[c] = dstOrder[c] == PIXEL_CHANNEL_OPAQUE ? opaque : channels[dstOrder[c]]; }
+      vst3q_u8(dst + i * 3, pixels);
+    } else {
+      uint8x16x4_t pixels;
+      for(u32 c = 0; c < 4; c++) { pixels.val[c] = dstOrder[c] == PIXEL_CHANNEL_OPAQUE ? opaque : channels[dstOrder[c]]; }
+      vst4q_u8(dst + i * 4, pixels);
+    }
+  }
+#endif
+  (void)minChannels;
+  swizzlePixelsScalar(src + i * srcChannels, srcChannels, dst + i * dstChannels, dstChannels, dstOrder, pixelCount - i);
+}
+
+inline void rgbToRgba(const u8* src, u8* dst, u64 pixelCount) {
+  const u8 order[4] = {0, 1, 2, PIXEL_CHANNEL_OPAQUE};
+  swizzlePixels(src, 3, dst, 4, order, pixelCount);
+}
+
+inline void rgbaToRgb(const u8* src, u8* dst, u64 pixelCount) {
+  const u8 order[4] = {0, 1, 2};
+  swizzlePixels(src, 4, dst, 3, order, pixelCount);
+}
+
+// NOTE: AVX2 builds use the SSE4.1 path, a kernel this arithmetic heavy gains little from the extra width
+void renormalizeNormalMap(u8* pixels, u32 channels, u64 pixelCount) {
+  assert(channels == 3 || channels == 4);
+  u64 i = 0;
+#if defined(PIXEL_KERNELS_SSE4)
+  // NOTE: Pixels are shuffled into x, y, z & 4th channel groups of four bytes. 3 channel pixels are loaded & stored
+  // 12 bytes at a time, as overlapping 16 byte accesses stall on the previous group's store.
+  alignas(16) u8 deinterleave[16];
+  alignas(16) u8 interleave[16];
+  for(u32 lane = 0; lane < 16; lane++) { interleave[lane] = (u8)lane; }
+  for(u32 pixel = 0; pixel < 4; pixel++) {
+    for(u32 c = 0; c < 3; c++) {
+      deinterleave[c * 4 + pixel] = (u8)(pixel * channels + c);
+      interleave[pixel * channels + c] = (u8)(c * 4 + pixel);
+    }
+    deinterleave[12 + pixel] = (u8)(channels == 4 ? pixel * 4 + 3 : 12 + pixel);
+    if(channels == 4) { interleave[pixel * 4 + 3] = (u8)(12 + pixel); }
+  }
+  const __m128i deinterleaveMask = _mm_load_si128((const __m128i*)deinterleave);
+  const __m128i interleaveMask = _mm_load_si128((const __m128i*)interleave);
+  const __m128 decodeScale = _mm_set1_ps(2.0f / 255.0f);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 encodeScale = _mm_set1_ps(127.5f);
+  const __m128 encodeBias = _mm_set1_ps(128.0f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 max = _mm_set1_ps(255.0f);
+  for(; i + 4 <= pixelCount; i += 4) {
+    u8* group = pixels + i * channels;
+    __m128i bytes;
+    if(channels == 4) {
+      bytes = _mm_loadu_si128((const __m128i*)group);
+    } else {
+      s32 lastBytes;
+      memcpy(&lastBytes, group + 8, sizeof(lastBytes));
+      bytes = _mm_insert_epi32(_mm_loadl_epi64((const __m128i*)group), lastBytes, 2);
+    }
+    bytes = _mm_shuffle_epi8(bytes, deinterleaveMask);
+    __m128 x = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(bytes)), decodeScale), one);
+    __m128 y = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(bytes, 4))), decodeScale), one);
+    __m128 z = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(bytes, 8))), decodeScale), one);
+    __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+    __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSquared));
+    __m128 encoded[3] = { x, y, z };
+    __m128i encodedInts[3];
+    for(u32 c = 0; c < 3; c++) {
+      __m128 value = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(encoded[c], invLength), encodeScale), encodeBias);
+      encodedInts[c] = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(value, zero), max));
+    }
+    __m128i fourth = _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 12));
+    bytes = _mm_packus_epi16(_mm_packus_epi32(encodedInts[0], encodedInts[1]), _mm_packus_epi32(encodedInts[2], fourth));
+    bytes = _mm_shuffle_epi8(bytes, interleaveMask);
+    if(channels == 4) {
+      _mm_storeu_si128((__m128i*)group, bytes);
+    } else {
+      s32 lastBytes = _mm_extract_epi32(bytes, 2);
+      _mm_storel_epi64((__m128i*)group, bytes);
+      memcpy(group + 8, &lastBytes, sizeof(lastBytes));
+    }
+  }
+#elif defined(PIXEL_KERNELS_NEON)
+  const float32x4_t decodeScale = vdupq_n_f32(2.0f / 255.0f);
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  for(; i + 16 <= pixelCount; i += 16) {
+    u8* group = pixels + i * channels;
+    uint8x16_t xyz[3];
+    uint8x16x4_t rgba;
+    if(channels == 3) {
+      uint8x16x3_t rgb = vld3q_u8(group);
+      xyz[0] = rgb.val[0]; xyz[1] = rgb.val[1]; xyz[2] = rgb.val[2];
+    } else {
+      rgba = vld4q_u8(group);
+      xyz[0] = rgba.val[0]; xyz[1] = rgba.val[1]; xyz[2] = rgba.val[2];
+    }
+    u16 widened[3][16];
+    float32x4_t n[3][4];
+    for(u32 c = 0; c < 3; c++) {
+      uint16x8_t low = vmovl_u8(vget_low_u8(xyz[c]));
+      uint16x8_t high = vmovl_u8(vget_high_u8(xyz[c]));
+      uint32x4_t quarters[4] = { vmovl_u16(vget_low_u16(low)), vmovl_u16(vget_high_u16(low)),
+                                 vmovl_u16(vget_low_u16(high)), vmovl_u16(vget_high_u16(high)) };
+      for(u32 q = 0; q < 4; q++) { n[c][q] = vsubq_f32(vmulq_f32(vcvtq_f32_u32(quarters[q]), decodeScale), one); }
+    }
+    for(u32 q = 0; q < 4; q++) {
+      float32x4_t lengthSquared = vaddq_f32(vaddq_f32(vmulq_f32(n[0][q], n[0][q]), vmulq_f32(n[1][q], n[1][q])), vmulq_f32(n[2][q], n[2][q]));
+      float32x4_t invLength = vdivq_f32(one, vsqrtq_f32(lengthSquared));
+      for(u32 c = 0; c < 3; c++) {
+        float32x4_t value = vaddq_f32(vmulq_f32(vmulq_f32(n[c][q], invLength), vdupq_n_f32(127.5f)), vdupq_n_f32(128.0f));
+        value = vminq_f32(vmaxq_f32(value, vdupq_n_f32(0.0f)), vdupq_n_f32(255.0f));
+        vst1_u16(widened[c] + q * 4, vmovn_u32(vcvtq_u32_f32(value)));
+      }
+    }
+    for(u32 c = 0; c < 3; c++) {
+      xyz[c] = vcombine_u8(vmovn_u16(vld1q_u16(widened[c])), vmovn_u16(vld1q_u16(widened[c] + 8)));
+    }
+    if(channels == 3) {
+      uint8x16x3_t rgb = {{ xyz[0], xyz[1], xyz[2] }};
+      vst3q_u8(group, rgb);
+    } else {
+      rgba.val[0] = xyz[0]; rgba.val[1] = xyz[1]; rgba.val[2] = xyz[2];
+      vst4q_u8(group, rgba);
+    }
+  }
+#endif
+  renormalizeNormalMapScalar(pixels + i * channels, channels, pixelCount - i);
+}
+
+// NOTE: Rounds to nearest, identical to the scalar reference's division by 255 through (t + (t >> 8)) >> 8, t = x + 128
+void premultiplyAlpha(const u8* src, u8* dst, u64 pixelCount) {
+  u64 i = 0;
+#if defined(PIXEL_KERNELS_AVX2)
+  {
+    const __m256i alphaMask = _mm256_set1_epi32((s32)0xFF000000);
+    const __m256i rounding = _mm256_set1_epi16(128);
+    for(; i + 8 <= pixelCount; i += 8) {
+      __m256i pixels = _mm256_loadu_si256((const __m256i*)(src + i * 4));
+      __m256i low = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(pixels));
+      __m256i high = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(pixels, 1));
+      __m256i halves[2] = { low, high };
+      for(__m256i& half: halves) {
+        __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(half, 0xFF), 0xFF);
+        __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(half, alpha), rounding);
+        half = _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+      }
+      // NOTE: packus works within 128 bit lanes, the permute puts the pixels back in order
+      __m256i premultiplied = _mm256_permute4x64_epi64(_mm256_packus_epi16(halves[0], halves[1]), 0xD8);
+      _mm256_storeu_si256((__m256i*)(dst + i * 4), _mm256_blendv_epi8(premultiplied, pixels, alphaMask));
+    }
+  }
+#endif
+#if defined(PIXEL_KERNELS_SSE4)
+  {
+    const __m128i alphaMask = _mm_set1_epi32((s32)0xFF000000);
+    const __m128i rounding = _mm_set1_epi16(128);
+    for(; i + 4 <= pixelCount; i += 4) {
+      __m128i pixels = _mm_loadu_si128((const __m128i*)(src + i * 4));
+      __m128i halves[2] = { _mm_cvtepu8_epi16(pixels), _mm_unpackhi_epi8(pixels, _mm_setzero_si128()) };
+      for(__m128i& half: halves) {
+        __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(half, 0xFF), 0xFF);
+        __m128i t = _mm_add_epi16(_mm_mullo_epi16(half, alpha), rounding);
+        half = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+      }
+      __m128i premultiplied = _mm_packus_epi16(halves[0], halves[1]);
+      _mm_storeu_si128((__m128i*)(dst + i * 4), _mm_blendv_epi8(premultiplied, pixels, alphaMask));
+    }
+  }
+#elif defined(PIXEL_KERNELS_NEON)
+  const uint16x8_t rounding = vdupq_n_u16(128);
+  for(; i + 16 <= pixelCount; i += 16) {
+    uint8x16x4_t pixels = vld4q_u8(src + i * 4);
+    for(u32 c = 0; c < 3; c++) {
+      uint16x8_t low = vaddq_u16(vmull_u8(vget_low_u8(pixels.val[c]), vget_low_u8(pixels.val[3])), rounding);
+      uint16x8_t high = vaddq_u16(vmull_u8(vget_high_u8(pixels.val[c]), vget_high_u8(pixels.val[3])), rounding);
+      pixels.val[c] = vcombine_u8(vshrn_n_u16(vsraq_n_u16(low, low, 8), 8), vshrn_n_u16(vsraq_n_u16(high, high, 8), 8));
+    }
+    vst4q_u8(dst + i * 4, pixels);
+  }
+#endif
+  premultiplyAlphaScalar(src + i * 4, dst + i * 4, pixelCount - i);
+}
+
+// NOTE: Only AVX2 has a gather, other builds use the scalar table lookup as is
+void srgbToLinear(const u8* src, f32* dst, u64 count) {
+  u64 i = 0;
+#if defined(PIXEL_KERNELS_AVX2)
+  const f32* table = srgbTables().toLinear;
+  for(; i + 8 <= count; i += 8) {
+    __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + i)));
+    _mm256_storeu_ps(dst + i, _mm256_i32gather_ps(table, indices, 4));
+  }
+#endif
+  srgbToLinearScalar(src + i, dst + i, count - i);
+}
+
+void linearToSRGB(const f32* src, u8* dst, u64 count) {
+  const u32* table = srgbTables().fromLinear;
+  u64 i = 0;
+#if defined(PIXEL_KERNELS_AVX2)
+  {
+    const __m256 minValue = _mm256_castsi256_ps(_mm256_set1_epi32(SRGB_TABLE_MIN_BITS));
+    const __m256 almostOne = _mm256_castsi256_ps(_mm256_set1_epi32(SRGB_TABLE_ALMOST_ONE_BITS));
+    for(; i + 8 <= count; i += 8) {
+      // NOTE: max returns its second operand when the first is NaN
+      __m256 linear = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i), minValue), almostOne);
+      __m256i bits = _mm256_castps_si256(linear);
+      __m256i entries = _mm256_i32gather_epi32((const int*)table, _mm256_srli_epi32(_mm256_sub_epi32(bits, _mm256_set1_epi32(SRGB_TABLE_MIN_BITS)), 20), 4);
+      __m256i bias = _mm256_slli_epi32(_mm256_srli_epi32(entries, 16), 8);
+      __m256i scale = _mm256_and_si256(entries, _mm256_set1_epi32(0xFFFF));
+      __m256i t = _mm256_and_si256(_mm256_srli_epi32(bits, 12), _mm256_set1_epi32(0xFF));
+      __m256i srgb = _mm256_srli_epi32(_mm256_add_epi32(bias, _mm256_mullo_epi32(scale, t)), 16);
+      __m128i packed = _mm_packus_epi16(_mm_packus_epi32(_mm256_castsi256_si128(srgb), _mm256_extracti128_si256(srgb, 1)), _mm_setzero_si128());
+      _mm_storel_epi64((__m128i*)(dst + i), packed);
+    }
+  }
+#elif defined(PIXEL_KERNELS_SSE4)
+  {
+    const __m128 minValue = _mm_castsi128_ps(_mm_set1_epi32(SRGB_TABLE_MIN_BITS));
+    const __m128 almostOne = _mm_castsi128_ps(_mm_set1_epi32(SRGB_TABLE_ALMOST_ONE_BITS));
+    for(; i + 4 <= count; i += 4) {
+      // NOTE: max returns its second operand when the first is NaN
+      __m128 linear = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), minValue), almostOne);
+      __m128i bits = _mm_castps_si128(linear);
+      __m128i buckets = _mm_srli_epi32(_mm_sub_epi32(bits, _mm_set1_epi32(SRGB_TABLE_MIN_BITS)), 20);
+      __m128i entries = _mm_setr_epi32(table[_mm_extract_epi32(buckets, 0)], table[_mm_extract_epi32(buckets, 1)],
+                                       table[_mm_extract_epi32(buckets, 2)], table[_mm_extract_epi32(buckets, 3)]);
+      __m128i bias = _mm_slli_epi32(_mm_srli_epi32(entries, 16), 8);
+      __m128i scale = _mm_and_si128(entries, _mm_set1_epi32(0xFFFF));
+      __m128i t = _mm_and_si128(_mm_srli_epi32(bits, 12), _mm_set1_epi32(0xFF));
+      __m128i srgb = _mm_srli_epi32(_mm_add_epi32(bias, _mm_mullo_epi32(scale, t)), 16);
+      s32 packed = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packus_epi32(srgb, srgb), _mm_setzero_si128()));
+      memcpy(dst + i, &packed, sizeof(packed));
+    }
+  }
+#elif defined(PIXEL_KERNELS_NEON)
+  {
+    const float32x4_t minValue = vdupq_n_f32(1.0f / 8192.0f);
+    const float32x4_t almostOne = vdupq_n_f32(0.99999994f);
+    for(; i + 4 <= count; i += 4) {
+      // NOTE: maxnm returns the number when one operand is NaN
+      uint32x4_t bits = vreinterpretq_u32_f32(vminq_f32(vmaxnmq_f32(vld1q_f32(src + i), minValue), almostOne));
+      uint32x4_t buckets = vshrq_n_u32(vsubq_u32(bits, vdupq_n_u32(SRGB_TABLE_MIN_BITS)), 20);
+      u32 entryLanes[4] = { table[vgetq_lane_u32(buckets, 0)], table[vgetq_lane_u32(buckets, 1)],
+                            table[vgetq_lane_u32(buckets, 2)], table[vgetq_lane_u32(buckets, 3)] };
+      uint32x4_t entries = vld1q_u32(entryLanes);
+      uint32x4_t bias = vshlq_n_u32(vshrq_n_u32(entries, 16), 8);
+      uint32x4_t scale = vandq_u32(entries, vdupq_n_u32(0xFFFF));
+      uint32x4_t t = vandq_u32(vshrq_n_u32(bits, 12), vdupq_n_u32(0xFF));
+      uint32x4_t srgb = vshrq_n_u32(vmlaq_u32(bias, scale, t), 16);
+      for(u32 lane = 0; lane < 4; lane++) { dst[i + lane] = (u8)srgb[lane]; }
+    }
+  }
+#endif
+  for(; i < count; i++) { dst[i] = linearToSRGB8(src[i], table); }
+}
+
+/*
+ * Reports the throughput of every SIMD kernel & its scalar reference on random pixels, counting the bytes read plus
+ * the bytes written. That the two agree is checked by pixel_kernels_test in asset_baker/tests.
+ */
+void benchmarkPixelKernels() {
+  const u64 pixelCount = 1 << 22;
+  std::mt19937 random(1234);
+  std::vector<u8> rgba(pixelCount * 4);
+  for(u8& byte: rgba) { byte = (u8)random(); }
+  std::vector<f32> linear(pixelCount * 4);
+  std::uniform_real_distribution<f32> unitDistribution(-0.05f, 1.05f);
+  for(f32& value: linear) { value = unitDistribution(random); }
+
+#if defined(PIXEL_KERNELS_AVX2)
+  printf("Pixel kernels: AVX2\n");
+#elif defined(PIXEL_KERNELS_SSE4)
+  printf("Pixel kernels: SSE4.1\n");
+#elif defined(PIXEL_KERNELS_NEON)
+  printf("Pixel kernels: NEON\n");
+#else
+  printf("Pixel kernels: scalar only\n");
+#endif
+
+  struct LOCAL_FUNCS {
+    static f64 bestSeconds(const std::function<void()>& kernel) {
+      f64 best = 1e30;
+      for(u32 run = 0; run < 5; run++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        kernel();
+        std::chrono::duration<f64> elapsed = std::chrono::high_resolution_clock::now() - start;
+        best = Min(best, elapsed.count());
+      }
+      return best;
+    }
+
+    static void report(const char* name, u64 bytes, const std::function<void()>& scalar, const std::function<void()>& simd) {
+      f64 scalarSeconds = bestSeconds(scalar);
+      f64 simdSeconds = bestSeconds(simd);
+      printf("  %-24s scalar %6.2f GB/s, simd %6.2f GB/s (x%.1f)\n", name, bytes / scalarSeconds * 1e-9,
+             bytes / simdSeconds * 1e-9, scalarSeconds / simdSeconds);
+    }
+  };
+
+  struct SwizzleCase {
+    const char* name;
+    u32 srcChannels;
+    u32 dstChannels;
+    u8 order[4];
+  };
+  const SwizzleCase swizzleCases[] = {
+          {"rgb -> rgba", 3, 4, {0, 1, 2, PIXEL_CHANNEL_OPAQUE}},
+          {"rgba -> rgb", 4, 3, {0, 1, 2}},
+          {"rgb -> bgr", 3, 3, {2, 1, 0}},
+          {"rgba -> bgra", 4, 4, {2, 1, 0, 3}},
+          {"rgb -> bgra", 3, 4, {2, 1, 0, PIXEL_CHANNEL_OPAQUE}},
+  };
+  std::vector<u8> expected(pixelCount * 4), actual(pixelCount * 4);
+  for(const SwizzleCase& swizzle: swizzleCases) {
+    const u8* src = rgba.data();
+    LOCAL_FUNCS::report(swizzle.name, pixelCount * (swizzle.srcChannels + swizzle.dstChannels),
+                        [&]() { swizzlePixelsScalar(src, swizzle.srcChannels, expected.data(), swizzle.dstChannels, swizzle.order, pixelCount); },
+                        [&]() { swizzlePixels(src, swizzle.srcChannels, actual.data(), swizzle.dstChannels, swizzle.order, pixelCount); });
+  }
+
+  for(u32 channels = 3; channels <= 4; channels++) {
+    LOCAL_FUNCS::report(channels == 3 ? "renormalize rgb" : "renormalize rgba", pixelCount * channels * 2,
+                        [&]() { memcpy(expected.data(), rgba.data(), pixelCount * channels); renormalizeNormalMapScalar(expected.data(), channels, pixelCount); },
+                        [&]() { memcpy(actual.data(), rgba.data(), pixelCount * channels); renormalizeNormalMap(actual.data(), channels, pixelCount); });
+  }
+
+  LOCAL_FUNCS::report("premultiply alpha", pixelCount * 8,
+                      [&]() { premultiplyAlphaScalar(rgba.data(), expected.data(), pixelCount); },
+                      [&]() { premultiplyAlpha(rgba.data(), actual.data(), pixelCount); });
+
+  {
+    const u64 count = pixelCount * 4;
+    std::vector<f32> expectedLinear(count), actualLinear(count);
+    LOCAL_FUNCS::report("srgb -> linear", count * 5,
+                        [&]() { srgbToLinearScalar(rgba.data(), expectedLinear.data(), count); },
+                        [&]() { srgbToLinear(rgba.data(), actualLinear.data(), count); });
+    LOCAL_FUNCS::report("linear -> srgb", count * 5,
+                        [&]() { linearToSRGBScalar(linear.data(), expected.data(), count); },
+                        [&]() { linearToSRGB(linear.data(), actual.data(), count); });
+  }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+// NOTE: Failed checks are printed & counted rather than aborting, so a single run reports every failure
+global_variable u32 bakerTestFailureCount_GLOBAL = 0;
+
+#define BakerCheck(condition) \
+  if(!(condition)) { \
+    bakerTestFailureCount_GLOBAL++; \
+    printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+  }
+
+// NOTE: Meant to be returned from main(), a non-zero exit code fails the test under CTest
+internal_func int bakerTestResult(const char* testName) {
+  if(bakerTestFailureCount_GLOBAL > 0) {
+    printf("%s: %u check(s) failed\n", testName, bakerTestFailureCount_GLOBAL);
+    return 1;
+  }
+  printf("%s: passed\n", testName);
+  return 0;
+}
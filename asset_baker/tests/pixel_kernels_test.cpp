@@ -0,0 +1,161 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "noop_types.h"
+
+#define Min(x, y) (x < y ? x : y)
+#define Max(x, y) (x > y ? x : y)
+
+#include "pixel_kernels.cpp"
+
+#include "baker_test.h"
+
+#define LARGE_PIXEL_COUNT ((1 << 16) - 7) // NOTE: Odd, so the scalar tails run after many SIMD iterations
+#define SMALL_PIXEL_COUNT_MAX 67 // every count below it, for tails with & without a full SIMD register before them
+
+internal_func u32 maxDifference(const u8* a, const u8* b, u64 count) {
+  u32 maxDiff = 0;
+  for(u64 i = 0; i < count; i++) { maxDiff = Max(maxDiff, (u32)abs((s32)a[i] - (s32)b[i])); }
+  return maxDiff;
+}
+
+// NOTE: Every case is run at each of these pixel counts
+internal_func std::vector<u64> testPixelCounts() {
+  std::vector<u64> counts;
+  for(u64 count = 0; count < SMALL_PIXEL_COUNT_MAX; count++) { counts.push_back(count); }
+  counts.push_back(LARGE_PIXEL_COUNT);
+  return counts;
+}
+
+internal_func void testSwizzles(const std::vector<u8>& rgba) {
+  struct SwizzleCase {
+    const char* name;
+    u32 srcChannels;
+    u32 dstChannels;
+    u8 order[4];
+  };
+  const SwizzleCase swizzleCases[] = {
+          {"rgb -> rgba", 3, 4, {0, 1, 2, PIXEL_CHANNEL_OPAQUE}},
+          {"rgba -> rgb", 4, 3, {0, 1, 2}},
+          {"rgb -> bgr", 3, 3, {2, 1, 0}},
+          {"rgba -> bgra", 4, 4, {2, 1, 0, 3}},
+          {"rgb -> bgra", 3, 4, {2, 1, 0, PIXEL_CHANNEL_OPAQUE}},
+  };
+  std::vector<u8> expected(LARGE_PIXEL_COUNT * 4), actual(LARGE_PIXEL_COUNT * 4);
+  for(const SwizzleCase& swizzle: swizzleCases) {
+    for(u64 pixelCount: testPixelCounts()) {
+      swizzlePixelsScalar(rgba.data(), swizzle.srcChannels, expected.data(), swizzle.dstChannels, swizzle.order, pixelCount);
+      swizzlePixels(rgba.data(), swizzle.srcChannels, actual.data(), swizzle.dstChannels, swizzle.order, pixelCount);
+      u32 maxDiff = maxDifference(expected.data(), actual.data(), pixelCount * swizzle.dstChannels);
+      BakerCheck(maxDiff == 0);
+      if(maxDiff != 0) { printf("  %s, %llu pixels\n", swizzle.name, (unsigned long long)pixelCount); }
+
+      // in place, where allowed
+      if(swizzle.dstChannels <= swizzle.srcChannels) {
+        memcpy(actual.data(), rgba.data(), pixelCount * swizzle.srcChannels);
+        swizzlePixels(actual.data(), swizzle.srcChannels, actual.data(), swizzle.dstChannels, swizzle.order, pixelCount);
+        maxDiff = maxDifference(expected.data(), actual.data(), pixelCount * swizzle.dstChannels);
+        BakerCheck(maxDiff == 0);
+        if(maxDiff != 0) { printf("  %s in place, %llu pixels\n", swizzle.name, (unsigned long long)pixelCount); }
+      }
+    }
+  }
+
+  // NOTE: The rgb <-> rgba helpers are swizzles, checked once against their spelled out order
+  const u8 rgbaOrder[4] = {0, 1, 2, PIXEL_CHANNEL_OPAQUE};
+  swizzlePixelsScalar(rgba.data(), 3, expected.data(), 4, rgbaOrder, LARGE_PIXEL_COUNT);
+  rgbToRgba(rgba.data(), actual.data(), LARGE_PIXEL_COUNT);
+  BakerCheck(maxDifference(expected.data(), actual.data(), LARGE_PIXEL_COUNT * 4) == 0);
+  const u8 rgbOrder[3] = {0, 1, 2};
+  swizzlePixelsScalar(rgba.data(), 4, expected.data(), 3, rgbOrder, LARGE_PIXEL_COUNT);
+  rgbaToRgb(rgba.data(), actual.data(), LARGE_PIXEL_COUNT);
+  BakerCheck(maxDifference(expected.data(), actual.data(), LARGE_PIXEL_COUNT * 3) == 0);
+}
+
+// NOTE: May be off by one where the compiler contracts the scalar reference's multiply-adds into FMAs (ex: AVX2 builds)
+internal_func void testRenormalizeNormalMap(const std::vector<u8>& rgba) {
+  std::vector<u8> expected(LARGE_PIXEL_COUNT * 4), actual(LARGE_PIXEL_COUNT * 4);
+  for(u32 channels = 3; channels <= 4; channels++) {
+    for(u64 pixelCount: testPixelCounts()) {
+      memcpy(expected.data(), rgba.data(), pixelCount * channels);
+      memcpy(actual.data(), rgba.data(), pixelCount * channels);
+      renormalizeNormalMapScalar(expected.data(), channels, pixelCount);
+      renormalizeNormalMap(actual.data(), channels, pixelCount);
+      u32 maxDiff = maxDifference(expected.data(), actual.data(), pixelCount * channels);
+      BakerCheck(maxDiff <= 1);
+      if(maxDiff > 1) { printf("  renormalize %u channels, %llu pixels: off by %u\n", channels, (unsigned long long)pixelCount, maxDiff); }
+
+      // NOTE: Alpha is left as is
+      if(channels == 4) {
+        u32 alphaDiff = 0;
+        for(u64 pixel = 0; pixel < pixelCount; pixel++) { alphaDiff = Max(alphaDiff, (u32)(actual[(pixel * 4) + 3] != rgba[(pixel * 4) + 3])); }
+        BakerCheck(alphaDiff == 0);
+      }
+    }
+  }
+}
+
+internal_func void testPremultiplyAlpha(const std::vector<u8>& rgba) {
+  std::vector<u8> expected(LARGE_PIXEL_COUNT * 4), actual(LARGE_PIXEL_COUNT * 4);
+  for(u64 pixelCount: testPixelCounts()) {
+    premultiplyAlphaScalar(rgba.data(), expected.data(), pixelCount);
+    premultiplyAlpha(rgba.data(), actual.data(), pixelCount);
+    u32 maxDiff = maxDifference(expected.data(), actual.data(), pixelCount * 4);
+    BakerCheck(maxDiff == 0);
+    if(maxDiff != 0) { printf("  premultiply alpha, %llu pixels\n", (unsigned long long)pixelCount); }
+  }
+}
+
+internal_func void testSRGBConversions(const std::vector<u8>& rgba, const std::vector<f32>& linear) {
+  std::vector<f32> expectedLinear(LARGE_PIXEL_COUNT * 4), actualLinear(LARGE_PIXEL_COUNT * 4);
+  std::vector<u8> expected(LARGE_PIXEL_COUNT * 4), actual(LARGE_PIXEL_COUNT * 4);
+  for(u64 pixelCount: testPixelCounts()) {
+    const u64 count = pixelCount * 4;
+    srgbToLinearScalar(rgba.data(), expectedLinear.data(), count);
+    srgbToLinear(rgba.data(), actualLinear.data(), count);
+    BakerCheck(memcmp(expectedLinear.data(), actualLinear.data(), count * sizeof(f32)) == 0);
+
+    linearToSRGBScalar(linear.data(), expected.data(), count);
+    linearToSRGB(linear.data(), actual.data(), count);
+    u32 maxDiff = maxDifference(expected.data(), actual.data(), count);
+    BakerCheck(maxDiff == 0);
+    if(maxDiff != 0) { printf("  linear -> srgb, %llu values\n", (unsigned long long)count); }
+  }
+
+  // NOTE: The table is an approximation, it is checked against the exact transfer function rounded to nearest
+  const u64 count = LARGE_PIXEL_COUNT * 4;
+  linearToSRGBScalar(linear.data(), expected.data(), count);
+  u32 tableError = 0;
+  for(u64 i = 0; i < count; i++) {
+    f32 clamped = Min(Max(linear[i], 0.0f), 1.0f);
+    s32 exact = (s32)(linearToSRGBExact(clamped) * 255.0f + 0.5f);
+    tableError = Max(tableError, (u32)abs(exact - (s32)expected[i]));
+  }
+  BakerCheck(tableError <= 1);
+
+  // every 8-bit value makes the round trip
+  std::vector<u8> allValues(256);
+  for(u32 i = 0; i < 256; i++) { allValues[i] = (u8)i; }
+  srgbToLinear(allValues.data(), actualLinear.data(), 256);
+  linearToSRGB(actualLinear.data(), actual.data(), 256);
+  BakerCheck(maxDifference(allValues.data(), actual.data(), 256) == 0);
+}
+
+int main() {
+  srand(1234);
+  std::vector<u8> rgba(LARGE_PIXEL_COUNT * 4);
+  for(u8& byte: rgba) { byte = (u8)rand(); }
+  // NOTE: Slightly out of [0,1] on both ends, to check clamping
+  std::vector<f32> linear(LARGE_PIXEL_COUNT * 4);
+  for(f32& value: linear) { value = -0.05f + 1.1f * ((f32)rand() / (f32)RAND_MAX); }
+
+  testSwizzles(rgba);
+  testRenormalizeNormalMap(rgba);
+  testPremultiplyAlpha(rgba);
+  testSRGBConversions(rgba, linear);
+  return bakerTestResult("pixel_kernels_test");
+}
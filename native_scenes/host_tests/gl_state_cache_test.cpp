@@ -0,0 +1,140 @@
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include <GLES3/gl32.h>
+
+#include "noop_types.h"
+#include "android_platform.h" // host_platform/android_platform.h
+
+#include "gl_state_cache.h"
+
+#include "mock_gl.h"
+#include "host_test.h"
+
+// NOTE: Every test starts from an invalidated cache, with no GL calls counted yet
+internal_func void resetTest(GLStateCache* cache) {
+  invalidateGLStateCache(cache);
+  resetGLStateCacheCounts(cache);
+  resetMockGLCallCounts();
+}
+
+internal_func u32 glCallCount(MockGLCall call) {
+  return mockGL_GLOBAL.callCounts[call];
+}
+
+internal_func void testRedundantCallsSkipped(GLStateCache* cache) {
+  resetTest(cache);
+  for(u32 i = 0; i < 3; i++) {
+    cachedUseProgram(cache, 5);
+    cachedBindVertexArray(cache, 6);
+    cachedColorMask(cache, false);
+    cachedDepthFunc(cache, GL_LEQUAL);
+    cachedStencilFunc(cache, GL_EQUAL, 1, 0xFF);
+    cachedStencilOp(cache, GL_KEEP, GL_KEEP, GL_INCR);
+    cachedStencilMask(cache, 0xFF);
+    cachedScissor(cache, 0, 0, 1080, 1920);
+    cachedClearDepth(cache, 1.0f);
+    cachedClearStencil(cache, 1);
+  }
+  HostCheck(glCallCount(MockGLCall_glUseProgram) == 1);
+  HostCheck(glCallCount(MockGLCall_glBindVertexArray) == 1);
+  HostCheck(glCallCount(MockGLCall_glColorMask) == 1);
+  HostCheck(glCallCount(MockGLCall_glDepthFunc) == 1);
+  HostCheck(glCallCount(MockGLCall_glStencilFunc) == 1);
+  HostCheck(glCallCount(MockGLCall_glStencilOp) == 1);
+  HostCheck(glCallCount(MockGLCall_glStencilMask) == 1);
+  HostCheck(glCallCount(MockGLCall_glScissor) == 1);
+  HostCheck(glCallCount(MockGLCall_glClearDepthf) == 1);
+  HostCheck(glCallCount(MockGLCall_glClearStencil) == 1);
+  HostCheck(cache->issuedCalls[GLStateCall_UseProgram] == 1 && cache->skippedCalls[GLStateCall_UseProgram] == 2);
+  HostCheck(glStateCacheSkippedCallCount(*cache) == 10 * 2);
+
+  // any part of the state differing goes through
+  cachedStencilFunc(cache, GL_EQUAL, 2, 0xFF);
+  cachedScissor(cache, 0, 0, 1080, 1000);
+  cachedUseProgram(cache, 7);
+  HostCheck(glCallCount(MockGLCall_glStencilFunc) == 2);
+  HostCheck(glCallCount(MockGLCall_glScissor) == 2);
+  HostCheck(glCallCount(MockGLCall_glUseProgram) == 2);
+}
+
+internal_func void testTextureBinds(GLStateCache* cache) {
+  resetTest(cache);
+  cachedBindActiveTexture(cache, 0, 10, GL_TEXTURE_2D);
+  cachedBindActiveTexture(cache, 0, 10, GL_TEXTURE_2D);
+  HostCheck(glCallCount(MockGLCall_glActiveTexture) == 1);
+  HostCheck(glCallCount(MockGLCall_glBindTexture) == 1);
+
+  // NOTE: A unit keeps its texture per target, the same name bound to another target is a different bind
+  cachedBindActiveTexture(cache, 0, 10, GL_TEXTURE_CUBE_MAP);
+  HostCheck(glCallCount(MockGLCall_glActiveTexture) == 1);
+  HostCheck(glCallCount(MockGLCall_glBindTexture) == 2);
+
+  // the active unit only changes when another unit's binding does
+  cachedBindActiveTexture(cache, 1, 11, GL_TEXTURE_2D);
+  cachedBindActiveTexture(cache, 0, 10, GL_TEXTURE_CUBE_MAP);
+  cachedBindActiveTexture(cache, 1, 11, GL_TEXTURE_2D);
+  HostCheck(glCallCount(MockGLCall_glActiveTexture) == 2);
+  HostCheck(glCallCount(MockGLCall_glBindTexture) == 3);
+}
+
+internal_func void testInvalidationForcesCalls(GLStateCache* cache) {
+  resetTest(cache);
+  cachedUseProgram(cache, 5);
+  cachedBindVertexArray(cache, 6);
+  cachedBindActiveTexture(cache, 2, 12, GL_TEXTURE_2D);
+  cachedBindUniformBufferRange(cache, 1, 20, 0, 256);
+  cachedClearDepth(cache, 1.0f);
+
+  // NOTE: Stands in for GL calls made outside of the cache, which leave it out of date
+  invalidateGLStateCache(cache);
+  resetMockGLCallCounts();
+  cachedUseProgram(cache, 5);
+  cachedBindVertexArray(cache, 6);
+  cachedBindActiveTexture(cache, 2, 12, GL_TEXTURE_2D);
+  cachedBindUniformBufferRange(cache, 1, 20, 0, 256);
+  cachedClearDepth(cache, 1.0f);
+  HostCheck(glCallCount(MockGLCall_glUseProgram) == 1);
+  HostCheck(glCallCount(MockGLCall_glBindVertexArray) == 1);
+  HostCheck(glCallCount(MockGLCall_glActiveTexture) == 1);
+  HostCheck(glCallCount(MockGLCall_glBindTexture) == 1);
+  HostCheck(glCallCount(MockGLCall_glBindBufferRange) == 1);
+  HostCheck(glCallCount(MockGLCall_glClearDepthf) == 1);
+}
+
+internal_func void testUniformBufferRangeAliasing(GLStateCache* cache) {
+  resetTest(cache);
+  cachedBindUniformBufferRange(cache, 0, 20, 0, 256);
+  cachedBindUniformBufferRange(cache, 0, 20, 0, 256);
+  HostCheck(glCallCount(MockGLCall_glBindBufferRange) == 1);
+
+  // NOTE: Binding a range also binds its buffer to GL_UNIFORM_BUFFER, so binding that buffer again is skipped
+  cachedBindUniformBuffer(cache, 20);
+  HostCheck(glCallCount(MockGLCall_glBindBuffer) == 0);
+  HostCheck(cache->skippedCalls[GLStateCall_BindBuffer] == 1);
+
+  cachedBindUniformBuffer(cache, 21);
+  HostCheck(glCallCount(MockGLCall_glBindBuffer) == 1);
+  // NOTE: A skipped range bind leaves the generic binding alone, an issued one moves it to the range's buffer
+  cachedBindUniformBufferRange(cache, 0, 20, 0, 256);
+  HostCheck(glCallCount(MockGLCall_glBindBufferRange) == 1);
+  cachedBindUniformBufferRange(cache, 0, 20, 256, 256);
+  HostCheck(glCallCount(MockGLCall_glBindBufferRange) == 2);
+  cachedBindUniformBuffer(cache, 21);
+  HostCheck(glCallCount(MockGLCall_glBindBuffer) == 2);
+
+  // bindings are independent of each other
+  cachedBindUniformBufferRange(cache, 1, 20, 256, 256);
+  HostCheck(glCallCount(MockGLCall_glBindBufferRange) == 3);
+}
+
+int main() {
+  GLStateCache cache;
+  testRedundantCallsSkipped(&cache);
+  testTextureBinds(&cache);
+  testInvalidationForcesCalls(&cache);
+  testUniformBufferRangeAliasing(&cache);
+  logGLStateCacheCounts(cache);
+  return hostTestResult("gl_state_cache_test");
+}
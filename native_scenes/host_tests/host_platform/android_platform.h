@@ -0,0 +1,43 @@
+#pragma once
+
+// Host stand-in for shared_cpp/android_platform.h, lets the app's headers be built & tested on the development machine
+// NOTE: There is no APK on the host, so every asset fails to open
+
+#include <cstdio>
+#include <cstddef>
+#include <sys/types.h>
+
+#define LOGI(...) printf(__VA_ARGS__)
+#define LOGW(...) printf(__VA_ARGS__)
+#define LOGE(...) printf(__VA_ARGS__)
+
+struct AAssetManager;
+struct AAsset;
+
+enum {
+  AASSET_MODE_UNKNOWN = 0,
+  AASSET_MODE_RANDOM = 1,
+  AASSET_MODE_STREAMING = 2,
+  AASSET_MODE_BUFFER = 3
+};
+
+inline AAsset* AAssetManager_open(AAssetManager* mgr, const char* filename, int mode) { return nullptr; }
+inline const void* AAsset_getBuffer(AAsset* asset) { return nullptr; }
+inline off_t AAsset_getLength(AAsset* asset) { return 0; }
+inline off64_t AAsset_getLength64(AAsset* asset) { return 0; }
+inline int AAsset_read(AAsset* asset, void* buf, size_t count) { return -1; }
+inline off_t AAsset_seek(AAsset* asset, off_t offset, int whence) { return -1; }
+inline void AAsset_close(AAsset* asset) {}
+
+struct Asset {
+  const char *filePath;
+  AAsset *androidAsset;
+  const void *buffer;
+  std::size_t bufferLengthInBytes;
+
+  Asset(AAssetManager* assetManager, const char *filePath) : filePath(filePath), androidAsset(nullptr), buffer(nullptr), bufferLengthInBytes(0) {
+    LOGI("Failed to read asset - %s\n", filePath);
+  }
+
+  bool success() { return androidAsset != nullptr; }
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+// Host counterpart of gate_scene.h, includes the portal scene without anything that needs a device
+// NOTE: GL is provided by mock_gl.cpp, nothing drawn here ever reaches a GPU
+
+#include <memory> // memset
+#include <cassert> // asserts
+#include <chrono>
+#include <math.h>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm> // std::sort
+
+#include <EGL/egl.h>
+#include <GLES3/gl32.h> // OpenGL ES 3.2
+
+#include "noop_types.h"
+
+#include "android_platform.h" // host_platform/android_platform.h
+global_variable AAssetManager* assetManager_GLOBAL = nullptr;
+
+#include "noop_math.h"
+using namespace noop;
+
+#include "asset_loader.h"
+#include "texture_asset.h"
+#include "cubemap_asset.h"
+#include "model_asset.h"
+#include "ktx2.h"
+
+#include "shader_types_and_constants.h"
+#include "vertex_attributes.h"
+#include "file_locations.h"
+#include "world_info.h"
+#include "util.h"
+#include "textures.h"
+#include "shader_program.h"
+#include "model.h"
+#include "camera.h"
+#include "frustum_culling.h"
+#include "gl_util.h"
+#include "gl_state_cache.h"
+#include "render_commands.h"
+#include "portal_depth_controller.h"
+#include "portal_scene.h"
+
+#include "mock_gl.h"
+#include "host_test.h"
@@ -0,0 +1,20 @@
+#pragma once
+
+// NOTE: Failed checks are logged & counted rather than aborting, so a single run reports every failure
+global_variable u32 hostTestFailureCount_GLOBAL = 0;
+
+#define HostCheck(condition) \
+  if(!(condition)) { \
+    hostTestFailureCount_GLOBAL++; \
+    LOGE("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+  }
+
+// NOTE: Meant to be returned from main(), a non-zero exit code fails the test under CTest
+internal_func int hostTestResult(const char* testName) {
+  if(hostTestFailureCount_GLOBAL > 0) {
+    LOGE("%s: %u check(s) failed\n", testName, hostTestFailureCount_GLOBAL);
+    return 1;
+  }
+  LOGI("%s: passed\n", testName);
+  return 0;
+}
@@ -0,0 +1,230 @@
+#include <cstring>
+
+#include <EGL/egl.h>
+#include <GLES3/gl32.h>
+
+#include "noop_types.h"
+#include "mock_gl.h"
+
+MockGL mockGL_GLOBAL = {{}, 1, 256};
+
+void resetMockGLCallCounts() {
+  memset(mockGL_GLOBAL.callCounts, 0, sizeof(mockGL_GLOBAL.callCounts));
+}
+
+internal_func void genObjectNames(GLsizei n, GLuint* names) {
+  for(GLsizei i = 0; i < n; i++) { names[i] = mockGL_GLOBAL.nextObjectName++; }
+}
+
+extern "C" {
+
+// ==== COUNTED ==== //
+void glActiveTexture(GLenum texture) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glActiveTexture]++;
+}
+
+void glBindBuffer(GLenum target, GLuint buffer) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glBindBuffer]++;
+}
+
+void glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glBindBufferRange]++;
+}
+
+void glBindTexture(GLenum target, GLuint texture) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glBindTexture]++;
+}
+
+void glBindVertexArray(GLuint array) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glBindVertexArray]++;
+}
+
+void glClear(GLbitfield mask) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glClear]++;
+}
+
+void glClearDepthf(GLfloat d) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glClearDepthf]++;
+}
+
+void glClearStencil(GLint s) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glClearStencil]++;
+}
+
+GLenum glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glClientWaitSync]++;
+  return GL_ALREADY_SIGNALED;
+}
+
+void glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glColorMask]++;
+}
+
+void glDepthFunc(GLenum func) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glDepthFunc]++;
+}
+
+void glDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glDrawElements]++;
+}
+
+void glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instancecount) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glDrawElementsInstanced]++;
+}
+
+void glScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glScissor]++;
+}
+
+void glStencilFunc(GLenum func, GLint ref, GLuint mask) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glStencilFunc]++;
+}
+
+void glStencilMask(GLuint mask) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glStencilMask]++;
+}
+
+void glStencilOp(GLenum fail, GLenum zfail, GLenum zpass) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glStencilOp]++;
+}
+
+void glUseProgram(GLuint program) {
+  mockGL_GLOBAL.callCounts[MockGLCall_glUseProgram]++;
+}
+
+// ==== EVERYTHING ELSE ==== //
+void glAttachShader(GLuint program, GLuint shader) {}
+void glBeginQuery(GLenum target, GLuint id) {}
+void glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) {}
+void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) {}
+void glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {}
+void glCompileShader(GLuint shader) {}
+void glCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void *data) {}
+void glCompressedTexImage3D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLsizei imageSize, const void *data) {}
+void glCompressedTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLsizei imageSize, const void *data) {}
+GLuint glCreateProgram(void) {
+  return mockGL_GLOBAL.nextObjectName++;
+}
+GLuint glCreateShader(GLenum type) {
+  return mockGL_GLOBAL.nextObjectName++;
+}
+void glCullFace(GLenum mode) {}
+void glDeleteBuffers(GLsizei n, const GLuint *buffers) {}
+void glDeleteProgram(GLuint program) {}
+void glDeleteQueries(GLsizei n, const GLuint *ids) {}
+void glDeleteShader(GLuint shader) {}
+void glDeleteSync(GLsync sync) {}
+void glDeleteTextures(GLsizei n, const GLuint *textures) {}
+void glDeleteVertexArrays(GLsizei n, const GLuint *arrays) {}
+void glDetachShader(GLuint program, GLuint shader) {}
+void glEnable(GLenum cap) {}
+void glEnableVertexAttribArray(GLuint index) {}
+void glEndQuery(GLenum target) {}
+GLsync glFenceSync(GLenum condition, GLbitfield flags) {
+  return (GLsync)(u64)mockGL_GLOBAL.nextObjectName++;
+}
+void glFrontFace(GLenum mode) {}
+void glGenBuffers(GLsizei n, GLuint *buffers) {
+  genObjectNames(n, buffers);
+}
+void glGenQueries(GLsizei n, GLuint *ids) {
+  genObjectNames(n, ids);
+}
+void glGenTextures(GLsizei n, GLuint *textures) {
+  genObjectNames(n, textures);
+}
+void glGenVertexArrays(GLsizei n, GLuint *arrays) {
+  genObjectNames(n, arrays);
+}
+void glGenerateMipmap(GLenum target) {}
+void glGetActiveUniformBlockiv(GLuint program, GLuint uniformBlockIndex, GLenum pname, GLint *params) {
+  *params = 0;
+}
+void glGetIntegerv(GLenum pname, GLint *data) {
+  *data = pname == GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT ? mockGL_GLOBAL.uniformBufferOffsetAlignment : 0;
+}
+void glGetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei *length, GLchar *infoLog) {
+  if(bufSize > 0) { infoLog[0] = '\0'; }
+  if(length != nullptr) { *length = 0; }
+}
+GLuint glGetProgramResourceIndex(GLuint program, GLenum programInterface, const GLchar *name) {
+  return GL_INVALID_INDEX;
+}
+void glGetProgramiv(GLuint program, GLenum pname, GLint *params) {
+  *params = pname == GL_LINK_STATUS ? GL_TRUE : 0;
+}
+void glGetQueryObjectuiv(GLuint id, GLenum pname, GLuint *params) {
+  *params = 0;
+}
+void glGetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog) {
+  if(bufSize > 0) { infoLog[0] = '\0'; }
+  if(length != nullptr) { *length = 0; }
+}
+void glGetShaderiv(GLuint shader, GLenum pname, GLint *params) {
+  *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+const GLubyte *glGetString(GLenum name) {
+  return (const GLubyte*)"";
+}
+const GLubyte *glGetStringi(GLenum name, GLuint index) {
+  return (const GLubyte*)"";
+}
+GLint glGetUniformLocation(GLuint program, const GLchar *name) {
+  return -1;
+}
+void glLineWidth(GLfloat width) {}
+void glLinkProgram(GLuint program) {}
+void *glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+  return nullptr; // NOTE: Callers fall back to glBufferSubData()
+}
+void glShaderSource(GLuint shader, GLsizei count, const GLchar *const*string, const GLint *length) {}
+void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels) {}
+void glTexParameteri(GLenum target, GLenum pname, GLint param) {}
+void glTexStorage3D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth) {}
+void glUniform1i(GLint location, GLint v0) {}
+void glUniform3fv(GLint location, GLsizei count, const GLfloat *value) {}
+GLboolean glUnmapBuffer(GLenum target) {
+  return GL_TRUE;
+}
+void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer) {}
+void glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {}
+
+// ==== EGL ==== //
+EGLBoolean eglChooseConfig(EGLDisplay dpy, const EGLint *attrib_list, EGLConfig *configs, EGLint config_size, EGLint *num_config) {
+  return EGL_FALSE;
+}
+EGLContext eglCreateContext(EGLDisplay dpy, EGLConfig config, EGLContext share_context, const EGLint *attrib_list) {
+  return EGL_NO_CONTEXT;
+}
+EGLSurface eglCreateWindowSurface(EGLDisplay dpy, EGLConfig config, EGLNativeWindowType win, const EGLint *attrib_list) {
+  return EGL_NO_SURFACE;
+}
+EGLBoolean eglDestroyContext(EGLDisplay dpy, EGLContext ctx) {
+  return EGL_FALSE;
+}
+EGLBoolean eglDestroySurface(EGLDisplay dpy, EGLSurface surface) {
+  return EGL_FALSE;
+}
+EGLBoolean eglGetConfigAttrib(EGLDisplay dpy, EGLConfig config, EGLint attribute, EGLint *value) {
+  return EGL_FALSE;
+}
+EGLDisplay eglGetDisplay(EGLNativeDisplayType display_id) {
+  return EGL_NO_DISPLAY;
+}
+EGLBoolean eglInitialize(EGLDisplay dpy, EGLint *major, EGLint *minor) {
+  return EGL_FALSE;
+}
+EGLBoolean eglMakeCurrent(EGLDisplay dpy, EGLSurface draw, EGLSurface read, EGLContext ctx) {
+  return EGL_FALSE;
+}
+EGLBoolean eglQuerySurface(EGLDisplay dpy, EGLSurface surface, EGLint attribute, EGLint *value) {
+  return EGL_FALSE;
+}
+EGLBoolean eglSwapInterval(EGLDisplay dpy, EGLint interval) {
+  return EGL_FALSE;
+}
+EGLBoolean eglTerminate(EGLDisplay dpy) {
+  return EGL_FALSE;
+}
+
+}
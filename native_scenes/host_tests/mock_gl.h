@@ -0,0 +1,21 @@
+#pragma once
+
+/*
+ * Stand-in for the GLES 3.2 & EGL entry points used by the app, so its GL code can run on the host without a context.
+ * Calls do nothing beyond handing out made up object names, the ones a test may look at are counted in mockGL_GLOBAL.
+ */
+enum MockGLCall : u8 {
+#define MockGLCall(name) MockGLCall_##name,
+#include "mock_gl_call.incl"
+#undef MockGLCall
+  MockGLCall_Count
+};
+
+struct MockGL {
+  u32 callCounts[MockGLCall_Count];
+  GLuint nextObjectName;
+  GLint uniformBufferOffsetAlignment; // NOTE: Answers glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT)
+};
+extern MockGL mockGL_GLOBAL;
+
+void resetMockGLCallCounts();
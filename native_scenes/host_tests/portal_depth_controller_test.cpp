@@ -0,0 +1,123 @@
+#include <cassert>
+
+#include "noop_types.h"
+#include "android_platform.h" // host_platform/android_platform.h
+#include "noop_math.h"
+
+#include "portal_depth_controller.h"
+
+#include "host_test.h"
+
+#define TARGET_FRAME_MS 16.0f // lowers over 14.4ms, raises under 9.6ms
+#define OVER_BUDGET_MS 20.0f
+#define UNDER_BUDGET_MS 5.0f
+#define IN_BUDGET_MS 12.0f
+
+// NOTE: Returns true when the depth changed on the last frame of the window, fails a check if it changed any sooner
+internal_func bool feedWindow(PortalDepthController* controller, f32 cpuFrameMs, f32 gpuFrameMs) {
+  for(u32 frame = 0; frame < PORTAL_DEPTH_WINDOW_FRAMES - 1; frame++) {
+    HostCheck(!updatePortalDepthController(controller, cpuFrameMs, gpuFrameMs));
+  }
+  return updatePortalDepthController(controller, cpuFrameMs, gpuFrameMs);
+}
+
+internal_func void testOverBudgetLowers() {
+  PortalDepthController controller;
+  initPortalDepthController(&controller, TARGET_FRAME_MS, 1, 4, 3);
+  HostCheck(feedWindow(&controller, OVER_BUDGET_MS, -1.0f));
+  HostCheck(controller.depth == 2);
+  HostCheck(feedWindow(&controller, OVER_BUDGET_MS, -1.0f));
+  HostCheck(controller.depth == 1);
+  // never below the minimum
+  HostCheck(!feedWindow(&controller, OVER_BUDGET_MS, -1.0f));
+  HostCheck(controller.depth == 1);
+
+  // NOTE: The GPU alone running over budget lowers just the same
+  initPortalDepthController(&controller, TARGET_FRAME_MS, 1, 4, 3);
+  HostCheck(feedWindow(&controller, UNDER_BUDGET_MS, OVER_BUDGET_MS));
+  HostCheck(controller.depth == 2);
+}
+
+internal_func void testUnderBudgetRaises() {
+  PortalDepthController controller;
+  initPortalDepthController(&controller, TARGET_FRAME_MS, 1, 4, 2);
+  for(u32 window = 0; window < PORTAL_DEPTH_RAISE_WINDOWS - 1; window++) {
+    HostCheck(!feedWindow(&controller, UNDER_BUDGET_MS, UNDER_BUDGET_MS));
+  }
+  HostCheck(feedWindow(&controller, UNDER_BUDGET_MS, UNDER_BUDGET_MS));
+  HostCheck(controller.depth == 3);
+  for(u32 window = 0; window < PORTAL_DEPTH_RAISE_WINDOWS; window++) {
+    feedWindow(&controller, UNDER_BUDGET_MS, -1.0f);
+  }
+  HostCheck(controller.depth == 4);
+  // never above the maximum
+  for(u32 window = 0; window < PORTAL_DEPTH_RAISE_WINDOWS; window++) {
+    HostCheck(!feedWindow(&controller, UNDER_BUDGET_MS, -1.0f));
+  }
+  HostCheck(controller.depth == 4);
+}
+
+internal_func void testHysteresis() {
+  f32 lowerMs = TARGET_FRAME_MS * PORTAL_DEPTH_LOWER_BUDGET;
+  f32 raiseMs = TARGET_FRAME_MS * PORTAL_DEPTH_RAISE_BUDGET;
+  PortalDepthController controller;
+  initPortalDepthController(&controller, TARGET_FRAME_MS, 1, 4, 2);
+
+  // between the two budgets the depth holds, however long it stays there
+  for(u32 window = 0; window < 20; window++) {
+    HostCheck(!feedWindow(&controller, IN_BUDGET_MS, IN_BUDGET_MS));
+  }
+  HostCheck(!feedWindow(&controller, lowerMs - 0.1f, -1.0f));
+  HostCheck(!feedWindow(&controller, raiseMs + 0.1f, -1.0f));
+  HostCheck(!feedWindow(&controller, raiseMs + 0.1f, -1.0f));
+  HostCheck(controller.depth == 2);
+
+  // a window back between the budgets restarts the count of windows under budget
+  for(u32 window = 0; window < PORTAL_DEPTH_RAISE_WINDOWS - 1; window++) {
+    HostCheck(!feedWindow(&controller, raiseMs - 0.1f, -1.0f));
+  }
+  HostCheck(!feedWindow(&controller, IN_BUDGET_MS, -1.0f));
+  for(u32 window = 0; window < PORTAL_DEPTH_RAISE_WINDOWS - 1; window++) {
+    HostCheck(!feedWindow(&controller, raiseMs - 0.1f, -1.0f));
+  }
+  HostCheck(feedWindow(&controller, raiseMs - 0.1f, -1.0f));
+  HostCheck(controller.depth == 3);
+
+  // just over the lower budget lowers right away
+  HostCheck(feedWindow(&controller, lowerMs + 0.1f, -1.0f));
+  HostCheck(controller.depth == 2);
+}
+
+internal_func void testRaiseBackoff() {
+  PortalDepthController controller;
+  initPortalDepthController(&controller, TARGET_FRAME_MS, 1, 4, 1);
+  for(u32 window = 0; window < PORTAL_DEPTH_RAISE_WINDOWS; window++) {
+    feedWindow(&controller, UNDER_BUDGET_MS, -1.0f);
+  }
+  HostCheck(controller.depth == 2);
+
+  // NOTE: The raise was undone by the very next window, so it takes twice as many windows to try it again
+  HostCheck(feedWindow(&controller, OVER_BUDGET_MS, -1.0f));
+  HostCheck(controller.depth == 1);
+  HostCheck(controller.raiseWindowCount == PORTAL_DEPTH_RAISE_WINDOWS * 2);
+  for(u32 window = 0; window < (PORTAL_DEPTH_RAISE_WINDOWS * 2) - 1; window++) {
+    HostCheck(!feedWindow(&controller, UNDER_BUDGET_MS, -1.0f));
+  }
+  HostCheck(feedWindow(&controller, UNDER_BUDGET_MS, -1.0f));
+  HostCheck(controller.depth == 2);
+
+  // a raise that holds earns back the usual patience
+  for(u32 window = 0; window < PORTAL_DEPTH_RAISE_WINDOWS * 2; window++) {
+    feedWindow(&controller, IN_BUDGET_MS, -1.0f);
+  }
+  HostCheck(controller.depth == 2);
+  HostCheck(controller.raiseWindowCount == PORTAL_DEPTH_RAISE_WINDOWS);
+}
+
+int main() {
+  testOverBudgetLowers();
+  testUnderBudgetRaises();
+  testHysteresis();
+  testRaiseBackoff();
+  return hostTestResult("portal_depth_controller_test");
+}
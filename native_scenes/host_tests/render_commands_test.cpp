@@ -0,0 +1,124 @@
+#include "host_scene.h"
+
+/*
+ * Records frames of a small two scene world & replays them with executeRenderCommandsHeadless(), checking the draws
+ * each frame comes to. Nothing is loaded, the world's shaders, models & textures are made up GL names.
+ *  - Scene 0: an entity in front of the player, one far off to the side & a portal into scene 1 between them.
+ *  - Scene 1: an entity behind the portal.
+ */
+#define HOST_TEST_FRAME_COUNT 30
+
+struct HostWorldFixture {
+  Mesh cubeMesh;
+};
+
+internal_func VertexAtt fakeVertexAtt(GLuint arrayObject, u32 indexCount) {
+  return VertexAtt{arrayObject, arrayObject + 100, arrayObject + 200, indexCount, sizeof(u16)};
+}
+
+internal_func ShaderProgram fakeShaderProgram(GLuint id) {
+  ShaderProgram shader;
+  shader.id = id;
+  shader.noiseTextureId = TEXTURE_ID_NO_TEXTURE;
+  for(GLint& location: shader.uniformLocations) { location = -1; }
+  return shader;
+}
+
+internal_func void addFixtureEntity(Scene* scene, u32 shaderIndex, vec3 posXYZ) {
+  Entity& entity = scene->entities[scene->entityCount++];
+  entity.modelIndex = 0;
+  entity.shaderIndex = shaderIndex;
+  entity.posXYZ = posXYZ;
+  entity.scaleXYZ = vec3{1.0f, 1.0f, 1.0f};
+  entity.yaw = 0.0f;
+  entity.flags = 0;
+}
+
+internal_func void initHostWorld(World* world, HostWorldFixture* fixture) {
+  updatePortalSceneWindow(world, 1080, 1920);
+  world->player.setPolarPos(-PiOverTwo32, 12.0f);
+
+  for(u32 i = 0; i < ArrayCount(world->commonVertAtts.array); i++) {
+    world->commonVertAtts.array[i] = fakeVertexAtt(20 + i, i < 4 ? 36 : 6);
+  }
+  world->skyboxShader = fakeShaderProgram(1);
+  world->vertexStageOnlyShader = fakeShaderProgram(2);
+  world->clearDepthShader = fakeShaderProgram(3);
+  world->shaders[0] = fakeShaderProgram(10);
+  world->shaders[1] = fakeShaderProgram(11);
+  world->shaderCount = 2;
+  world->UBOs.fragUboId = 40;
+
+  fixture->cubeMesh.vertexAtt = fakeVertexAtt(30, 36);
+  fixture->cubeMesh.textureData = TextureData{TEXTURE_ID_NO_TEXTURE, TEXTURE_ID_NO_TEXTURE, vec4{0.0f, 0.0f, 0.0f, 0.0f}};
+  Model& cube = world->models[world->modelCount++];
+  cube.meshes = &fixture->cubeMesh;
+  cube.meshCount = 1;
+  cube.boundingBox = BoundingBox{vec3{-0.5f, -0.5f, -0.5f}, vec3{1.0f, 1.0f, 1.0f}};
+
+  world->sceneCount = 2;
+  Scene* outside = world->scenes + 0;
+  addFixtureEntity(outside, 0, vec3{0.0f, 0.0f, 1.5f});
+  addFixtureEntity(outside, 0, vec3{40.0f, 0.0f, 1.5f}); // NOTE: Outside of the view from either side of the portal
+  outside->skyboxTexture = 50;
+  outside->lightUboId = 41;
+  Portal& portal = outside->portals[outside->portalCount++];
+  portal.normal = vec2{0.0f, -1.0f};
+  portal.centerPosition = vec3{0.0f, -4.0f, 1.5f};
+  portal.dimens = vec3{2.0f, 0.0f, 2.0f};
+  portal.sceneDestination = 1;
+  portal.oneWay = false;
+  portal.transient = false;
+  portal.backingModelIndex = WORLD_INFO_NO_INDEX;
+  portal.backingShaderIndex = WORLD_INFO_NO_INDEX;
+
+  Scene* inside = world->scenes + 1;
+  addFixtureEntity(inside, 1, vec3{0.0f, 0.0f, 1.5f});
+  inside->skyboxTexture = 51;
+  inside->lightUboId = 42;
+
+  for(u32 sceneIndex = 0; sceneIndex < world->sceneCount; sceneIndex++) { buildCullBounds(world, sceneIndex); }
+  initPortalDepthController(&world->portalDepthController, TARGET_FRAME_MS, MIN_PORTAL_DEPTH, MAX_PORTAL_DEPTH, START_PORTAL_DEPTH);
+}
+
+// Records & replays HOST_TEST_FRAME_COUNT frames seen from theta, every one of which must come to the same draws
+internal_func void checkFrames(World* world, f32 theta, u32 expectedDrawCount, u32 expectedUseProgramCount) {
+  world->player.setPolarPos(theta, 12.0f);
+  Camera frameCamera;
+  lookAt_FirstPerson(world->player.pos.xyz, vec3{0.0f, 0.0f, 1.5f}, &frameCamera);
+  world->UBOs.projectionViewModelUbo.view = getViewMat(frameCamera);
+
+  RenderCommandStats stats;
+  for(u32 frame = 0; frame < HOST_TEST_FRAME_COUNT; frame++) {
+    recordCurrentScene(world, &world->renderCommands);
+    executeRenderCommandsHeadless(world->renderCommands, &stats);
+    HostCheck(stats.validationErrorCount == 0);
+    HostCheck(stats.commandCount == world->renderCommands.commands.size());
+    HostCheck(stats.drawCount == expectedDrawCount);
+    HostCheck(stats.commandCounts[RenderCommandType_DrawTriangles] == expectedDrawCount);
+    HostCheck(stats.commandCounts[RenderCommandType_UseProgram] == expectedUseProgramCount);
+    HostCheck(stats.commandCounts[RenderCommandType_Clear] == 1);
+  }
+  logRenderCommandStats(stats);
+  logCullStats(world->cullStats);
+}
+
+int main() {
+  World* world = new World();
+  HostWorldFixture fixture;
+  initHostWorld(world, &fixture);
+
+  // NOTE: In front of the portal, it is in focus & leads to one more scene
+  //  - scene 0: near entity & skybox, each with their own program
+  //  - portal: depth quad, stencil increment, depth clear & stencil clear, with a program each
+  //  - scene 1: entity & skybox, then the program of its (empty) pass over portals
+  checkFrames(world, -PiOverTwo32, 2 + 4 + 2, 2 + 4 + 3);
+  HostCheck(world->cullStats.viewCount == 2 && world->cullStats.testedCount == 3 && world->cullStats.visibleCount == 2);
+
+  // NOTE: Behind the portal, only scene 0's near entity & skybox are drawn. The pass over portals still sets its program.
+  checkFrames(world, PiOverTwo32, 2, 2 + 1);
+  HostCheck(world->cullStats.viewCount == 1 && world->cullStats.testedCount == 2 && world->cullStats.visibleCount == 1);
+
+  delete world;
+  return hostTestResult("render_commands_test");
+}
@@ -6,6 +6,7 @@ layout (location = 0) in vec3 inNormal;
 layout (location = 1) in vec2 inTexCoord;
 layout (location = 2) in vec3 inFragmentWorldPos;
 layout (location = 3) in vec3 inCameraWorldPos;
+layout (location = 4) in vec4 inTangent;
 
 layout (binding = 1, std140) uniform FragUBO {
   float time;
@@ -17,12 +18,12 @@ struct InLight {
 };
 
 layout (binding = 2, std140) uniform MultiLightInfoUBO {
-  vec4 ambientLightColor;
+  vec4 ambientSH[9];
   InLight dirPosLightStack[8];
   uint dirLightCount;
   uint posLightCount;
-  uint padding1;
-  uint padding2;
+  uint skyboxLayer;
+  uint padding;
 } lightInfoUbo;
 
 uniform sampler2D albedoTex;
@@ -34,6 +35,7 @@ const float noiseStength = 40.0;
 layout (location = 0) out vec4 outColor;
 
 vec3 getNormal(vec2 texCoord);
+vec3 ambientLight(vec3 normal);
 
 void main() {
   vec2 time = vec2(fragUbo.time * 10.0);
@@ -53,7 +55,7 @@ void main() {
 
   vec3 surfaceNormal = getNormal(texCoordNoiseTime);
 
-  vec3 lightContribution = lightInfoUbo.ambientLightColor.rgb * lightInfoUbo.ambientLightColor.a;
+  vec3 lightContribution = ambientLight(surfaceNormal);
 
   for(uint i = 0u; i < lightInfoUbo.dirLightCount; i++) {
     vec3 surfaceToSource = lightInfoUbo.dirPosLightStack[i].pos.xyz;
@@ -64,21 +66,30 @@ void main() {
   outColor = vec4(lightContribution * albedoColor, 1.0);
 }
 
-// Note: https://github.com/SaschaWillems/Vulkan-glTF-PBR/blob/master/data/shaders/pbr.vert
 vec3 getNormal(vec2 texCoord)
 {
-  // Perturb normal, see http://www.thetenthplanet.de/archives/1180
   vec3 tangentNormal = texture(normalTex, texCoord).xyz * 2.0 - 1.0;
 
-  vec3 q1 = dFdx(inFragmentWorldPos);
-  vec3 q2 = dFdy(inFragmentWorldPos);
-  vec2 st1 = dFdx(inTexCoord);
-  vec2 st2 = dFdy(inTexCoord);
-
+  // NOTE: Tangents are baked per vertex (see generateTangents() in the asset baker) and re-orthogonalized after interpolation
   vec3 N = normalize(inNormal);
-  vec3 T = normalize(q1 * st2.t - q2 * st1.t);
-  vec3 B = -normalize(cross(N, T));
+  vec3 T = normalize(inTangent.xyz - (N * dot(N, inTangent.xyz)));
+  vec3 B = cross(N, T) * inTangent.w;
   mat3 TBN = mat3(T, B, N);
 
   return normalize(TBN * tangentNormal);
+}
+
+// NOTE: SH coefficients are in the skybox's y-up space and already convolved with the cosine lobe
+vec3 ambientLight(vec3 normal) {
+  vec3 n = vec3(normal.x, normal.z, -normal.y);
+  vec3 irradiance = lightInfoUbo.ambientSH[0].rgb * 0.282095
+                  + lightInfoUbo.ambientSH[1].rgb * (0.488603 * n.y)
+                  + lightInfoUbo.ambientSH[2].rgb * (0.488603 * n.z)
+                  + lightInfoUbo.ambientSH[3].rgb * (0.488603 * n.x)
+                  + lightInfoUbo.ambientSH[4].rgb * (1.092548 * n.x * n.y)
+                  + lightInfoUbo.ambientSH[5].rgb * (1.092548 * n.y * n.z)
+                  + lightInfoUbo.ambientSH[6].rgb * (0.315392 * (3.0 * n.z * n.z - 1.0))
+                  + lightInfoUbo.ambientSH[7].rgb * (1.092548 * n.x * n.z)
+                  + lightInfoUbo.ambientSH[8].rgb * (0.546274 * (n.x * n.x - n.y * n.y));
+  return max(irradiance, vec3(0.0));
 }
\ No newline at end of file
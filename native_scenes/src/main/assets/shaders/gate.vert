@@ -3,6 +3,7 @@
 layout(location = 0) in vec3 inPos;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec4 inTangent; // w = bitangent handedness
 
 layout (binding = 0, std140) uniform UBO { // base alignment   // aligned offset
   mat4 projection;                         // 64               // 0
@@ -10,10 +11,21 @@ layout (binding = 0, std140) uniform UBO { // base alignment   // aligned offset
   mat4 model;                              // 64               // 128
 } ubo;
 
+// NOTE: The INSTANCED variant reads the model matrix of each instance from here instead of ubo.model
+#ifdef INSTANCED
+layout (binding = 3, std140) uniform InstanceUBO {
+  mat4 models[MAX_INSTANCES];
+} instanceUbo;
+#define MODEL_MATRIX instanceUbo.models[gl_InstanceID]
+#else
+#define MODEL_MATRIX ubo.model
+#endif
+
 layout (location = 0) out vec3 outNormal;
 layout (location = 1) out vec2 outTexCoord;
 layout (location = 2) out vec3 outFragmentWorldPos;
 layout (location = 3) out vec3 outCameraWorldPos;
+layout (location = 4) out vec4 outTangent;
 
 vec3 pullCameraPositionFromViewMat() {
   mat3 rotationTranspose = transpose(mat3(ubo.view));
@@ -24,10 +36,11 @@ vec3 pullCameraPositionFromViewMat() {
 
 void main()
 {
-  mat3 normalMat = mat3(transpose(inverse(ubo.model))); // TODO: only necessary for non-uniform scaling
-  vec4 worldPos = ubo.model * vec4(inPos, 1.0);
+  mat3 normalMat = mat3(transpose(inverse(MODEL_MATRIX))); // TODO: only necessary for non-uniform scaling
+  vec4 worldPos = MODEL_MATRIX * vec4(inPos, 1.0);
 
   outNormal = normalize(normalMat * inNormal);
+  outTangent = vec4(normalize(mat3(MODEL_MATRIX) * inTangent.xyz), inTangent.w);
   outTexCoord = inTexCoord;
   outFragmentWorldPos = worldPos.xyz;
   outCameraWorldPos = pullCameraPositionFromViewMat();
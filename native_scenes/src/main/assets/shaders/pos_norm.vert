@@ -8,11 +8,21 @@ layout (binding = 0, std140) uniform UBO { // base alignment   // aligned offset
   mat4 model;                              // 64             // 128
 } ubo;
 
+// NOTE: The INSTANCED variant reads the model matrix of each instance from here instead of ubo.model
+#ifdef INSTANCED
+layout (binding = 3, std140) uniform InstanceUBO {
+  mat4 models[MAX_INSTANCES];
+} instanceUbo;
+#define MODEL_MATRIX instanceUbo.models[gl_InstanceID]
+#else
+#define MODEL_MATRIX ubo.model
+#endif
+
 layout (location = 0) out vec3 outNormal;
 
 void main()
 {
-  mat3 normalMat = mat3(transpose(inverse(ubo.model))); // TODO: only necessary for non-uniform scaling
+  mat3 normalMat = mat3(transpose(inverse(MODEL_MATRIX))); // TODO: only necessary for non-uniform scaling
   outNormal = normalize(normalMat * inNormal);
-  gl_Position = ubo.projection * ubo.view * ubo.model * vec4(inPos, 1.0);
+  gl_Position = ubo.projection * ubo.view * MODEL_MATRIX * vec4(inPos, 1.0);
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #version 310 es
+#extension GL_EXT_texture_cube_map_array : enable
 
 precision highp float;
 
@@ -6,7 +7,28 @@ layout (location = 0) in vec3 inPos;
 layout (location = 1) in vec3 inNormal;
 layout (location = 2) in vec3 inCameraPos;
 
+struct InLight {
+  vec4 color;
+  vec4 pos;
+};
+
+layout (binding = 2, std140) uniform MultiLightInfoUBO {
+  vec4 ambientSH[9];
+  InLight dirPosLightStack[8];
+  uint dirLightCount;
+  uint posLightCount;
+  uint skyboxLayer;
+  uint padding;
+} lightInfoUbo;
+
+// NOTE: Skyboxes are cube map arrays whenever the device supports them, with the scene's layer in the light UBO
+#ifdef GL_EXT_texture_cube_map_array
+uniform mediump samplerCubeArray skyboxTex;
+#define SKYBOX_COORD(dir) vec4(dir, float(lightInfoUbo.skyboxLayer))
+#else
 uniform samplerCube skyboxTex;
+#define SKYBOX_COORD(dir) dir
+#endif
 
 layout (location = 0) out vec4 outColor;
 
@@ -16,5 +38,6 @@ void main()
   vec3 reflected = reflect(cameraToPos, inNormal);
   // NOTE: samplerCubes assume y is up, so we must adjust accordingly
   vec3 reflectedYIsUp = vec3(reflected.x, reflected.z, -reflected.y);
-  outColor = vec4(texture(skyboxTex, reflectedYIsUp).rgb, 1.0);
+  // NOTE: Perfect mirror, mip levels past 0 are prefiltered for rougher surfaces
+  outColor = vec4(textureLod(skyboxTex, SKYBOX_COORD(reflectedYIsUp), 0.0).rgb, 1.0);
 }
\ No newline at end of file
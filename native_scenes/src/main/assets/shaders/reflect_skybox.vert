@@ -9,6 +9,16 @@ layout (binding = 0, std140) uniform UBO { // base alignment   // aligned offset
   mat4 model;                              // 64             // 128
 } ubo;
 
+// NOTE: The INSTANCED variant reads the model matrix of each instance from here instead of ubo.model
+#ifdef INSTANCED
+layout (binding = 3, std140) uniform InstanceUBO {
+  mat4 models[MAX_INSTANCES];
+} instanceUbo;
+#define MODEL_MATRIX instanceUbo.models[gl_InstanceID]
+#else
+#define MODEL_MATRIX ubo.model
+#endif
+
 layout (location = 0) out vec3 outPos;
 layout (location = 1) out vec3 outNormal;
 layout (location = 2) out vec3 outCameraPos;
@@ -22,9 +32,9 @@ vec3 pullCameraPositionFromViewMat() {
 
 void main()
 {
-  mat3 normalMat = mat3(transpose(inverse(ubo.model))); // TODO: only necessary for non-uniform scaling
+  mat3 normalMat = mat3(transpose(inverse(MODEL_MATRIX))); // TODO: only necessary for non-uniform scaling
   outNormal = normalize(normalMat * inNormal);
   outCameraPos = pullCameraPositionFromViewMat();
-  outPos = vec3(ubo.model * vec4(inPos, 1.0));
+  outPos = vec3(MODEL_MATRIX * vec4(inPos, 1.0));
   gl_Position = ubo.projection * ubo.view * vec4(outPos, 1.0f);
 }
\ No newline at end of file
@@ -11,20 +11,37 @@ vec4 color;
 vec4 pos;
 };
 layout (binding = 2, std140) uniform MultiLightInfoUBO {
-  vec4 ambientLightColor;
+  highp vec4 ambientSH[9]; // NOTE: coefficients can exceed the range of lowp
   InLight dirPosLightStack[8];
   uint dirLightCount;
   uint posLightCount;
-  uint padding1;
-  uint padding2;
+  uint skyboxLayer;
+  uint padding;
 } lightInfoUbo;
 
 layout (location = 0) out vec4 outColor;
 
+highp vec3 ambientLight(highp vec3 normal);
+
 void main() {
   InLight dirLight = lightInfoUbo.dirPosLightStack[0];
   float cosNormLight = dot(inNormal, dirLight.pos.xyz);
   vec3 dirColorContribution = (baseColor * dirLight.color.xyz) * (cosNormLight * dirLight.color.w);
-  vec3 ambientColorContribution = (baseColor * lightInfoUbo.ambientLightColor.xyz) * lightInfoUbo.ambientLightColor.w;
+  vec3 ambientColorContribution = baseColor * ambientLight(inNormal);
   outColor = vec4(dirColorContribution + ambientColorContribution, 1.0);
+}
+
+// NOTE: SH coefficients are in the skybox's y-up space and already convolved with the cosine lobe
+highp vec3 ambientLight(highp vec3 normal) {
+  highp vec3 n = vec3(normal.x, normal.z, -normal.y);
+  highp vec3 irradiance = lightInfoUbo.ambientSH[0].rgb * 0.282095
+                  + lightInfoUbo.ambientSH[1].rgb * (0.488603 * n.y)
+                  + lightInfoUbo.ambientSH[2].rgb * (0.488603 * n.z)
+                  + lightInfoUbo.ambientSH[3].rgb * (0.488603 * n.x)
+                  + lightInfoUbo.ambientSH[4].rgb * (1.092548 * n.x * n.y)
+                  + lightInfoUbo.ambientSH[5].rgb * (1.092548 * n.y * n.z)
+                  + lightInfoUbo.ambientSH[6].rgb * (0.315392 * (3.0 * n.z * n.z - 1.0))
+                  + lightInfoUbo.ambientSH[7].rgb * (1.092548 * n.x * n.z)
+                  + lightInfoUbo.ambientSH[8].rgb * (0.546274 * (n.x * n.x - n.y * n.y));
+  return max(irradiance, vec3(0.0));
 }
\ No newline at end of file
@@ -1,10 +1,32 @@
 #version 310 es
+#extension GL_EXT_texture_cube_map_array : enable
 
 precision lowp float;
 
 layout (location = 0) in vec3 inTexCoord;
 
+struct InLight {
+  vec4 color;
+  vec4 pos;
+};
+
+layout (binding = 2, std140) uniform MultiLightInfoUBO {
+  vec4 ambientSH[9];
+  InLight dirPosLightStack[8];
+  uint dirLightCount;
+  uint posLightCount;
+  uint skyboxLayer;
+  uint padding;
+} lightInfoUbo;
+
+// NOTE: Skyboxes are cube map arrays whenever the device supports them, with the scene's layer in the light UBO
+#ifdef GL_EXT_texture_cube_map_array
+uniform mediump samplerCubeArray skyboxTex;
+#define SKYBOX_COORD(dir) vec4(dir, float(lightInfoUbo.skyboxLayer))
+#else
 uniform samplerCube skyboxTex;
+#define SKYBOX_COORD(dir) dir
+#endif
 
 layout (location = 0) out vec4 outColor;
 
@@ -12,5 +34,6 @@ void main()
 {
   // NOTE: samplerCubes assume inputY is up, so we must adjust accordingly
   vec3 yIsUpTexCoord = vec3(inTexCoord.x, inTexCoord.z, -inTexCoord.y);
-  outColor = texture(skyboxTex, yIsUpTexCoord);
+  // NOTE: Mip levels past 0 are prefiltered for rough reflections, not minification
+  outColor = textureLod(skyboxTex, SKYBOX_COORD(yIsUpTexCoord), 0.0);
 }
\ No newline at end of file
@@ -0,0 +1,154 @@
+#pragma once
+
+/*
+ * Frustum culling of world space axis aligned bounding boxes, four boxes at a time.
+ *  - Boxes are stored as structure of arrays, padded to a multiple of four.
+ *  - Planes are pulled straight out of the view's projection * view matrix, so an oblique projection's near plane (the
+ *    portal plane) is culled against like any other.
+ *  - The SIMD path (NEON or SSE, picked at compile time) has a scalar reference, cullBoundsScalar().
+ */
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define FRUSTUM_CULLING_NEON 1
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#define FRUSTUM_CULLING_SSE 1
+#include <emmintrin.h>
+#endif
+
+#define FRUSTUM_PLANE_COUNT 6
+
+struct Frustum {
+  f32 planes[FRUSTUM_PLANE_COUNT][4]; // a * x + b * y + c * z + d >= 0 inside, not normalized
+};
+
+struct CullBounds {
+  std::vector<f32> centerX, centerY, centerZ;
+  std::vector<f32> extentX, extentY, extentZ;
+  u32 count;
+};
+
+struct CullStats {
+  u32 viewCount;
+  u32 testedCount;
+  u32 visibleCount;
+};
+
+// NOTE: Expects a column-major matrix mapping to GL clip space, where -w <= x, y, z <= w is inside
+Frustum extractFrustum(const mat4& projectionView) {
+  const f32* m = projectionView.values;
+  auto row = [m](u32 r, f32 out[4]) {
+    for(u32 c = 0; c < 4; c++) { out[c] = m[(c * 4) + r]; }
+  };
+  f32 rows[4][4];
+  for(u32 r = 0; r < 4; r++) { row(r, rows[r]); }
+
+  Frustum frustum;
+  for(u32 c = 0; c < 4; c++) {
+    frustum.planes[0][c] = rows[3][c] + rows[0][c]; // left
+    frustum.planes[1][c] = rows[3][c] - rows[0][c]; // right
+    frustum.planes[2][c] = rows[3][c] + rows[1][c]; // bottom
+    frustum.planes[3][c] = rows[3][c] - rows[1][c]; // top
+    frustum.planes[4][c] = rows[3][c] + rows[2][c]; // near, the portal plane of oblique projections
+    frustum.planes[5][c] = rows[3][c] - rows[2][c]; // far
+  }
+  return frustum;
+}
+
+void addCullBounds(CullBounds* bounds, const f32 min[3], const f32 max[3]) {
+  bounds->centerX.push_back((min[0] + max[0]) * 0.5f);
+  bounds->centerY.push_back((min[1] + max[1]) * 0.5f);
+  bounds->centerZ.push_back((min[2] + max[2]) * 0.5f);
+  bounds->extentX.push_back((max[0] - min[0]) * 0.5f);
+  bounds->extentY.push_back((max[1] - min[1]) * 0.5f);
+  bounds->extentZ.push_back((max[2] - min[2]) * 0.5f);
+  bounds->count++;
+}
+
+// NOTE: Must be called once every box has been added, before culling
+void padCullBounds(CullBounds* bounds) {
+  u32 paddedCount = (bounds->count + 3) & ~3u;
+  std::vector<f32>* arrays[] = { &bounds->centerX, &bounds->centerY, &bounds->centerZ, &bounds->extentX, &bounds->extentY, &bounds->extentZ };
+  for(std::vector<f32>* array: arrays) { array->resize(paddedCount, 0.0f); }
+}
+
+void clearCullBounds(CullBounds* bounds) {
+  *bounds = {};
+}
+
+// A box is outside when it is entirely on the negative side of any plane
+void cullBoundsScalar(const Frustum& frustum, const CullBounds& bounds, u8* visible) {
+  for(u32 i = 0; i < bounds.count; i++) {
+    bool inside = true;
+    for(u32 p = 0; p < FRUSTUM_PLANE_COUNT && inside; p++) {
+      const f32* plane = frustum.planes[p];
+      f32 distance = (plane[0] * bounds.centerX[i]) + (plane[1] * bounds.centerY[i]) + (plane[2] * bounds.centerZ[i]) + plane[3];
+      f32 radius = (fabsf(plane[0]) * bounds.extentX[i]) + (fabsf(plane[1]) * bounds.extentY[i]) + (fabsf(plane[2]) * bounds.extentZ[i]);
+      inside = (distance + radius) >= 0.0f;
+    }
+    visible[i] = inside;
+  }
+}
+
+// NOTE: visible must hold at least the padded count of bounds
+void cullBounds(const Frustum& frustum, const CullBounds& bounds, u8* visible, CullStats* stats) {
+  u32 visibleCount = 0;
+#if FRUSTUM_CULLING_NEON || FRUSTUM_CULLING_SSE
+  for(u32 i = 0; i < bounds.count; i += 4) {
+#if FRUSTUM_CULLING_NEON
+    float32x4_t cx = vld1q_f32(&bounds.centerX[i]), cy = vld1q_f32(&bounds.centerY[i]), cz = vld1q_f32(&bounds.centerZ[i]);
+    float32x4_t ex = vld1q_f32(&bounds.extentX[i]), ey = vld1q_f32(&bounds.extentY[i]), ez = vld1q_f32(&bounds.extentZ[i]);
+    uint32x4_t inside = vdupq_n_u32(U32_MAX);
+    for(u32 p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+      const f32* plane = frustum.planes[p];
+      float32x4_t distance = vfmaq_n_f32(vfmaq_n_f32(vfmaq_n_f32(vdupq_n_f32(plane[3]), cx, plane[0]), cy, plane[1]), cz, plane[2]);
+      float32x4_t radius = vfmaq_n_f32(vfmaq_n_f32(vmulq_n_f32(ex, fabsf(plane[0])), ey, fabsf(plane[1])), ez, fabsf(plane[2]));
+      inside = vandq_u32(inside, vcgeq_f32(vaddq_f32(distance, radius), vdupq_n_f32(0.0f)));
+    }
+    u32 lanes[4];
+    vst1q_u32(lanes, inside);
+    for(u32 lane = 0; lane < 4; lane++) { visible[i + lane] = lanes[lane] != 0; }
+#else
+    __m128 cx = _mm_loadu_ps(&bounds.centerX[i]), cy = _mm_loadu_ps(&bounds.centerY[i]), cz = _mm_loadu_ps(&bounds.centerZ[i]);
+    __m128 ex = _mm_loadu_ps(&bounds.extentX[i]), ey = _mm_loadu_ps(&bounds.extentY[i]), ez = _mm_loadu_ps(&bounds.extentZ[i]);
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for(u32 p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+      const f32* plane = frustum.planes[p];
+      __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane[0])), _mm_mul_ps(cy, _mm_set1_ps(plane[1]))),
+                                   _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane[2])), _mm_set1_ps(plane[3])));
+      __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(fabsf(plane[0]))), _mm_mul_ps(ey, _mm_set1_ps(fabsf(plane[1])))),
+                                 _mm_mul_ps(ez, _mm_set1_ps(fabsf(plane[2]))));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+    }
+    s32 laneMask = _mm_movemask_ps(inside);
+    for(u32 lane = 0; lane < 4; lane++) { visible[i + lane] = (laneMask >> lane) & 1; }
+#endif
+  }
+#else
+  cullBoundsScalar(frustum, bounds, visible);
+#endif
+  for(u32 i = 0; i < bounds.count; i++) { visibleCount += visible[i]; }
+
+  stats->viewCount++;
+  stats->testedCount += bounds.count;
+  stats->visibleCount += visibleCount;
+}
+
+// World space bounds of a model space box transformed by a column-major matrix
+void transformBoundingBox(const BoundingBox& box, const mat4& modelMatrix, f32 min[3], f32 max[3]) {
+  const f32* m = modelMatrix.values;
+  for(u32 corner = 0; corner < 8; corner++) {
+    f32 p[3];
+    for(u32 axis = 0; axis < 3; axis++) {
+      p[axis] = box.min[axis] + ((corner >> axis) & 1 ? box.diagonal[axis] : 0.0f);
+    }
+    for(u32 axis = 0; axis < 3; axis++) {
+      f32 value = (m[axis] * p[0]) + (m[4 + axis] * p[1]) + (m[8 + axis] * p[2]) + m[12 + axis];
+      if(corner == 0 || value < min[axis]) { min[axis] = value; }
+      if(corner == 0 || value > max[axis]) { max[axis] = value; }
+    }
+  }
+}
+
+void logCullStats(const CullStats& stats) {
+  LOGI("Frustum culling: %u views, %u of %u bounds visible\n", stats.viewCount, stats.visibleCount, stats.testedCount);
+}
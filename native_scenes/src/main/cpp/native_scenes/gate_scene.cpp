@@ -72,6 +72,7 @@ void android_main(android_app *app) {
 
   initGLEnvironment(&engine.glEnv);
   logDeviceGLEnvironment();
+  initTextureBudget();
 #ifndef NDEBUG
   logAllAssets(assetManager_GLOBAL, app);
 #endif
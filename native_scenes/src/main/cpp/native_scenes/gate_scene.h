@@ -9,6 +9,7 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm> // std::sort
 
 #include <EGL/egl.h> // interface between OpenGL ES and underlying native platform window system
 #include <GLES3/gl32.h> // OpenGL ES 3.2
@@ -34,6 +35,7 @@ using namespace noop;
 #include "texture_asset.h"
 #include "cubemap_asset.h"
 #include "model_asset.h"
+#include "ktx2.h"
 
 #include "android_platform.cpp"
 #include "shader_types_and_constants.h"
@@ -45,7 +47,11 @@ using namespace noop;
 #include "shader_program.h"
 #include "model.h"
 #include "camera.h"
+#include "frustum_culling.h"
 #include "gl_util.h"
+#include "gl_state_cache.h"
+#include "render_commands.h"
+#include "portal_depth_controller.h"
 
 #include "vertex_attributes.h"
 #include "rotation_sensor_helper.h"
@@ -0,0 +1,203 @@
+#pragma once
+
+#define GL_STATE_UNKNOWN U32_MAX
+#define GL_STATE_CACHE_TEXTURE_UNITS 8
+#define GL_STATE_CACHE_UNIFORM_BUFFER_BINDINGS 4
+
+/*
+ * Shadow copy of the GL state set while drawing a frame. Calls that would not change the state are skipped & counted.
+ * NOTE: Anything bypassing the cache (ex: loading textures, creating vertex attributes) leaves it out of date, so it
+ * must be invalidated before being trusted again. Unknown state never matches, so the first call always goes through.
+ */
+enum GLStateCall : u8 {
+#define GLStateCall(name) GLStateCall_##name,
+#include "gl_state_call.incl"
+#undef GLStateCall
+  GLStateCall_Count
+};
+
+const char* mapGLStateCallToString[] = {
+#define GLStateCall(name) #name,
+#include "gl_state_call.incl"
+#undef GLStateCall
+};
+
+struct GLStateCache {
+  GLuint program;
+  GLuint vertexArray;
+  GLuint uniformBuffer;
+  struct {
+    GLuint bufferId;
+    u32 offset;
+    u32 size;
+  } uniformBufferRanges[GL_STATE_CACHE_UNIFORM_BUFFER_BINDINGS];
+  GLenum activeTexture;
+  struct {
+    GLenum target;
+    GLuint textureId;
+  } textureUnits[GL_STATE_CACHE_TEXTURE_UNITS];
+  u32 colorMask; // GL_STATE_UNKNOWN, true or false
+  GLenum depthFunc;
+  struct {
+    GLenum func;
+    s32 ref;
+    u32 mask;
+  } stencilFunc;
+  struct {
+    GLenum stencilFail;
+    GLenum depthFail;
+    GLenum depthPass;
+  } stencilOp;
+  u32 stencilWriteMask;
+  struct {
+    s32 x;
+    s32 y;
+    s32 width; // -1 when unknown
+    s32 height;
+  } scissor;
+  f32 clearDepth; // NaN when unknown
+  u32 clearStencil;
+
+  u32 issuedCalls[GLStateCall_Count];
+  u32 skippedCalls[GLStateCall_Count];
+};
+
+void invalidateGLStateCache(GLStateCache* cache) {
+  cache->program = GL_STATE_UNKNOWN;
+  cache->vertexArray = GL_STATE_UNKNOWN;
+  cache->uniformBuffer = GL_STATE_UNKNOWN;
+  for(u32 binding = 0; binding < GL_STATE_CACHE_UNIFORM_BUFFER_BINDINGS; binding++) {
+    cache->uniformBufferRanges[binding] = {GL_STATE_UNKNOWN, 0, 0};
+  }
+  cache->activeTexture = GL_STATE_UNKNOWN;
+  for(u32 unit = 0; unit < GL_STATE_CACHE_TEXTURE_UNITS; unit++) {
+    cache->textureUnits[unit] = {GL_STATE_UNKNOWN, GL_STATE_UNKNOWN};
+  }
+  cache->colorMask = GL_STATE_UNKNOWN;
+  cache->depthFunc = GL_STATE_UNKNOWN;
+  cache->stencilFunc = {GL_STATE_UNKNOWN, 0, 0};
+  cache->stencilOp = {GL_STATE_UNKNOWN, GL_STATE_UNKNOWN, GL_STATE_UNKNOWN};
+  cache->stencilWriteMask = GL_STATE_UNKNOWN;
+  cache->scissor = {0, 0, -1, -1};
+  cache->clearDepth = NAN;
+  cache->clearStencil = GL_STATE_UNKNOWN;
+}
+
+void resetGLStateCacheCounts(GLStateCache* cache) {
+  memset(cache->issuedCalls, 0, sizeof(cache->issuedCalls));
+  memset(cache->skippedCalls, 0, sizeof(cache->skippedCalls));
+}
+
+u32 glStateCacheSkippedCallCount(const GLStateCache& cache) {
+  u32 count = 0;
+  for(u32 call = 0; call < GLStateCall_Count; call++) { count += cache.skippedCalls[call]; }
+  return count;
+}
+
+// NOTE: Returns true when the call must be issued
+internal_func inline bool glStateChanged(GLStateCache* cache, GLStateCall call, bool changed) {
+  if(changed) { cache->issuedCalls[call]++; }
+  else { cache->skippedCalls[call]++; }
+  return changed;
+}
+
+void cachedUseProgram(GLStateCache* cache, GLuint program) {
+  if(!glStateChanged(cache, GLStateCall_UseProgram, cache->program != program)) { return; }
+  glUseProgram(program);
+  cache->program = program;
+}
+
+void cachedBindVertexArray(GLStateCache* cache, GLuint vertexArray) {
+  if(!glStateChanged(cache, GLStateCall_BindVertexArray, cache->vertexArray != vertexArray)) { return; }
+  glBindVertexArray(vertexArray);
+  cache->vertexArray = vertexArray;
+}
+
+// NOTE: Only the GL_UNIFORM_BUFFER binding is tracked
+void cachedBindUniformBuffer(GLStateCache* cache, GLuint buffer) {
+  if(!glStateChanged(cache, GLStateCall_BindBuffer, cache->uniformBuffer != buffer)) { return; }
+  glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+  cache->uniformBuffer = buffer;
+}
+
+// NOTE: Binding a range also binds the buffer to the GL_UNIFORM_BUFFER target
+void cachedBindUniformBufferRange(GLStateCache* cache, u32 bindingIndex, GLuint buffer, u32 offset, u32 size) {
+  assert(bindingIndex < GL_STATE_CACHE_UNIFORM_BUFFER_BINDINGS);
+  auto& range = cache->uniformBufferRanges[bindingIndex];
+  bool changed = range.bufferId != buffer || range.offset != offset || range.size != size;
+  if(!glStateChanged(cache, GLStateCall_BindBufferRange, changed)) { return; }
+  glBindBufferRange(GL_UNIFORM_BUFFER, bindingIndex, buffer, offset, size);
+  range = {buffer, offset, size};
+  cache->uniformBuffer = buffer;
+}
+
+void cachedBindActiveTexture(GLStateCache* cache, s32 activeIndex, GLuint textureId, GLenum target) {
+  assert(activeIndex >= 0 && activeIndex < GL_STATE_CACHE_TEXTURE_UNITS);
+  auto& unit = cache->textureUnits[activeIndex];
+  if(!glStateChanged(cache, GLStateCall_BindTexture, unit.target != target || unit.textureId != textureId)) { return; }
+  GLenum activeTexture = GL_TEXTURE0 + activeIndex;
+  if(glStateChanged(cache, GLStateCall_ActiveTexture, cache->activeTexture != activeTexture)) {
+    glActiveTexture(activeTexture);
+    cache->activeTexture = activeTexture;
+  }
+  glBindTexture(target, textureId);
+  unit = {target, textureId};
+}
+
+void cachedColorMask(GLStateCache* cache, bool enabled) {
+  if(!glStateChanged(cache, GLStateCall_ColorMask, cache->colorMask != (u32)enabled)) { return; }
+  glColorMask(enabled, enabled, enabled, enabled);
+  cache->colorMask = enabled;
+}
+
+void cachedDepthFunc(GLStateCache* cache, GLenum func) {
+  if(!glStateChanged(cache, GLStateCall_DepthFunc, cache->depthFunc != func)) { return; }
+  glDepthFunc(func);
+  cache->depthFunc = func;
+}
+
+void cachedStencilFunc(GLStateCache* cache, GLenum func, s32 ref, u32 mask) {
+  bool changed = cache->stencilFunc.func != func || cache->stencilFunc.ref != ref || cache->stencilFunc.mask != mask;
+  if(!glStateChanged(cache, GLStateCall_StencilFunc, changed)) { return; }
+  glStencilFunc(func, ref, mask);
+  cache->stencilFunc = {func, ref, mask};
+}
+
+void cachedStencilOp(GLStateCache* cache, GLenum stencilFail, GLenum depthFail, GLenum depthPass) {
+  bool changed = cache->stencilOp.stencilFail != stencilFail || cache->stencilOp.depthFail != depthFail || cache->stencilOp.depthPass != depthPass;
+  if(!glStateChanged(cache, GLStateCall_StencilOp, changed)) { return; }
+  glStencilOp(stencilFail, depthFail, depthPass);
+  cache->stencilOp = {stencilFail, depthFail, depthPass};
+}
+
+void cachedStencilMask(GLStateCache* cache, u32 mask) {
+  if(!glStateChanged(cache, GLStateCall_StencilMask, cache->stencilWriteMask != mask)) { return; }
+  glStencilMask(mask);
+  cache->stencilWriteMask = mask;
+}
+
+void cachedScissor(GLStateCache* cache, s32 x, s32 y, s32 width, s32 height) {
+  bool changed = cache->scissor.x != x || cache->scissor.y != y || cache->scissor.width != width || cache->scissor.height != height;
+  if(!glStateChanged(cache, GLStateCall_Scissor, changed)) { return; }
+  glScissor(x, y, width, height);
+  cache->scissor = {x, y, width, height};
+}
+
+void cachedClearDepth(GLStateCache* cache, f32 depth) {
+  if(!glStateChanged(cache, GLStateCall_ClearDepth, !(cache->clearDepth == depth))) { return; }
+  glClearDepthf(depth);
+  cache->clearDepth = depth;
+}
+
+void cachedClearStencil(GLStateCache* cache, s32 stencil) {
+  if(!glStateChanged(cache, GLStateCall_ClearStencil, cache->clearStencil != (u32)stencil)) { return; }
+  glClearStencil(stencil);
+  cache->clearStencil = stencil;
+}
+
+void logGLStateCacheCounts(const GLStateCache& cache) {
+  LOGI("GL state calls skipped: %u\n", glStateCacheSkippedCallCount(cache));
+  for(u32 call = 0; call < GLStateCall_Count; call++) {
+    LOGI("\t%s: %u issued, %u skipped\n", mapGLStateCallToString[call], cache.issuedCalls[call], cache.skippedCalls[call]);
+  }
+}
@@ -137,4 +137,82 @@ s64 sizeOfUniformBlock(GLuint programId, const char* name) {
   GLint blockDataSize = 0;
   glGetActiveUniformBlockiv(programId,uniformBlockId, GL_UNIFORM_BLOCK_DATA_SIZE,  &blockDataSize);
   return blockDataSize;
-}
\ No newline at end of file
+}
+
+// NOTE: From GL_EXT_disjoint_timer_query, which gl32.h does not define
+#ifndef GL_TIME_ELAPSED_EXT
+#define GL_TIME_ELAPSED_EXT 0x88BF
+#endif
+#ifndef GL_GPU_DISJOINT_EXT
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+#define GPU_FRAME_TIMER_QUERIES 4 // NOTE: Results arrive a few frames late, reading them sooner would stall
+
+/*
+ * Times the GPU work of each frame with GL_EXT_disjoint_timer_query, when the device has it.
+ * NOTE: Results come back in nanoseconds through glGetQueryObjectuiv(), so no extension functions have to be loaded.
+ */
+struct GPUFrameTimer {
+  GLuint queries[GPU_FRAME_TIMER_QUERIES];
+  u32 nextQuery;
+  u32 pendingCount;
+  bool supported;
+  bool timing; // NOTE: Frames are left untimed while every query is still pending
+};
+
+// NOTE: Requires a current GL context
+void initGPUFrameTimer(GPUFrameTimer* timer) {
+  *timer = {};
+  GLint extensionCount = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+  for(GLint extensionIndex = 0; extensionIndex < extensionCount; extensionIndex++) {
+    const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, extensionIndex);
+    if(strcmp(extension, "GL_EXT_disjoint_timer_query") == 0) {
+      timer->supported = true;
+    }
+  }
+  if(timer->supported) { glGenQueries(GPU_FRAME_TIMER_QUERIES, timer->queries); }
+  LOGI("GPU frame timer supported: %d\n", timer->supported);
+}
+
+void deinitGPUFrameTimer(GPUFrameTimer* timer) {
+  if(timer->supported) { glDeleteQueries(GPU_FRAME_TIMER_QUERIES, timer->queries); }
+  *timer = {};
+}
+
+void beginGPUFrameTimer(GPUFrameTimer* timer) {
+  timer->timing = timer->supported && timer->pendingCount < GPU_FRAME_TIMER_QUERIES;
+  if(!timer->timing) { return; }
+  glBeginQuery(GL_TIME_ELAPSED_EXT, timer->queries[timer->nextQuery]);
+}
+
+void endGPUFrameTimer(GPUFrameTimer* timer) {
+  if(!timer->timing) { return; }
+  glEndQuery(GL_TIME_ELAPSED_EXT);
+  timer->nextQuery = (timer->nextQuery + 1) % GPU_FRAME_TIMER_QUERIES;
+  timer->pendingCount++;
+  timer->timing = false;
+}
+
+// NOTE: Returns the average milliseconds of every frame whose result came in, or a negative value when there are none
+f32 readGPUFrameTimer(GPUFrameTimer* timer) {
+  if(!timer->supported) { return -1.0f; }
+  f32 totalMs = 0.0f;
+  u32 resultCount = 0;
+  while(timer->pendingCount > 0) {
+    u32 oldestQuery = (timer->nextQuery + GPU_FRAME_TIMER_QUERIES - timer->pendingCount) % GPU_FRAME_TIMER_QUERIES;
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(timer->queries[oldestQuery], GL_QUERY_RESULT_AVAILABLE, &available);
+    if(!available) { break; }
+    GLuint elapsedNs = 0;
+    glGetQueryObjectuiv(timer->queries[oldestQuery], GL_QUERY_RESULT, &elapsedNs);
+    timer->pendingCount--;
+    totalMs += elapsedNs / 1000000.0f;
+    resultCount++;
+  }
+  // NOTE: Results are meaningless when the GPU was disjoint (ex: its clock changed) while they were measured
+  GLint disjoint = GL_FALSE;
+  glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+  if(disjoint || resultCount == 0) { return -1.0f; }
+  return totalMs / resultCount;
+}
@@ -17,49 +17,79 @@ struct Model {
   Mesh* meshes;
   u32 meshCount;
   BoundingBox boundingBox;
+  assets::BVH bvh; // model space, empty if the model was baked without one
   std::string fileName;
 };
 
-void loadModelAsset(const char* filePath, Model* returnModel) {
-  const u32 positionAttributeIndex = 0;
-  const u32 normalAttributeIndex = 1;
-  const u32 texture0AttributeIndex = 2;
+// CPU side copy of a model's vertex attributes, indices are always widened to u32
+struct ModelGeometry {
+  std::vector<f32> positions;
+  std::vector<f32> normals;
+  std::vector<f32> uvs;
+  std::vector<f32> tangents;
+  std::vector<u32> indices;
+};
 
-  returnModel->fileName = filePath;
+// Shared atlases the asset baker packed small model textures into, keyed by atlas name
+global_variable std::unordered_map<std::string, GLuint> textureAtlases_GLOBAL;
 
-  // TODO: This is NOT where exported assets directory should be stored. Move this or related solution to assetlib or potentially a asset_baker header.
-  std::string bakedModelsDir = "models/";
-  std::string assetPath = bakedModelsDir + filePath + ".modl";
+internal_func GLuint loadTextureAtlas(const std::string& atlasName) {
+  auto cachedAtlas = textureAtlases_GLOBAL.find(atlasName);
+  if(cachedAtlas != textureAtlases_GLOBAL.end()) { return cachedAtlas->second; }
 
-  assets::AssetFile modelAssetFile;
-  {
-    assets::loadAssetFile(assetManager_GLOBAL, assetPath.c_str(), &modelAssetFile);
-  }
+  std::string assetPath = "textures/" + atlasName + ".tx";
+  assets::AssetFile atlasAssetFile;
+  assets::TextureInfo atlasInfo;
+  loadTieredAssetFile(assetPath, &atlasAssetFile, &atlasInfo, assets::readTextureInfo);
 
-  assets::ModelInfo modelInfo;
-  {
-    assets::readModelInfo(modelAssetFile, &modelInfo);
-  }
+  GLuint textureId;
+  glGenTextures(1, &textureId);
+  glBindTexture(GL_TEXTURE_2D, textureId);
 
-  assets::ModelDataPtrs modelDataPtrs = modelInfo.calcDataPts(modelAssetFile.binaryBlob.data());
+  // NOTE: Atlased uvs never leave their rect, the gutter baked around each rect covers filtering at its edges
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 
-  returnModel->boundingBox.min = {modelInfo.boundingBoxMin[0],modelInfo.boundingBoxMin[1], modelInfo.boundingBoxMin[2]};
-  returnModel->boundingBox.diagonal = {modelInfo.boundingBoxDiagonal[0],modelInfo.boundingBoxDiagonal[1], modelInfo.boundingBoxDiagonal[2]};
+  GLenum compressedFormat = compressedTextureFormatToGL(atlasInfo.format);
+  assert(compressedFormat != GL_INVALID_ENUM && "Unsupported texture atlas format");
+  glCompressedTexImage2D(GL_TEXTURE_2D,
+                         0,
+                         compressedFormat,
+                         atlasInfo.width,
+                         atlasInfo.height,
+                         0,
+                         atlasInfo.size,
+                         atlasAssetFile.binaryBlob.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
 
-  // ==== VERTEX ATTRIBUTES ==== //
-  // TODO: Handle models with more than 1 mesh
-  returnModel->meshes = new Mesh[1];
-  returnModel->meshCount = 1;
-  Mesh& mesh = returnModel->meshes[0];
-  glGenVertexArrays(1, &mesh.vertexAtt.arrayObject);
-  glGenBuffers(1, &mesh.vertexAtt.bufferObject);
-  glGenBuffers(1, &mesh.vertexAtt.indexObject);
+  textureAtlases_GLOBAL[atlasName] = textureId;
+  return textureId;
+}
+
+// NOTE: Vertex attributes are expected to be tightly packed in position, normal, uv, tangent order
+void createVertexAtt(VertexAtt* vertexAtt, const void* vertAtts,
+                     u64 positionAttributeSize, u64 normalAttributeSize, u64 uvAttributeSize, u64 tangentAttributeSize,
+                     const void* indices, u32 indexCount, u32 indexTypeSize) {
+  const u32 positionAttributeIndex = 0;
+  const u32 normalAttributeIndex = 1;
+  const u32 texture0AttributeIndex = 2;
+  const u32 tangentAttributeIndex = 3;
 
-  glBindVertexArray(mesh.vertexAtt.arrayObject);
-  glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexAtt.bufferObject);
+  const u64 normalVertAttOffset = positionAttributeSize;
+  const u64 uvVertAttOffset = normalVertAttOffset + normalAttributeSize;
+  const u64 tangentVertAttOffset = uvVertAttOffset + uvAttributeSize;
+
+  glGenVertexArrays(1, &vertexAtt->arrayObject);
+  glGenBuffers(1, &vertexAtt->bufferObject);
+  glGenBuffers(1, &vertexAtt->indexObject);
+
+  glBindVertexArray(vertexAtt->arrayObject);
+  glBindBuffer(GL_ARRAY_BUFFER, vertexAtt->bufferObject);
   glBufferData(GL_ARRAY_BUFFER,
-               modelInfo.positionAttributeSize + modelInfo.normalAttributeSize + modelInfo.uvAttributeSize,
-               modelDataPtrs.vertAtts,
+               positionAttributeSize + normalAttributeSize + uvAttributeSize + tangentAttributeSize,
+               vertAtts,
                GL_STATIC_DRAW);
 
   // set the vertex attributes (position and texture)
@@ -69,46 +99,123 @@ void loadModelAsset(const char* filePath, Model* returnModel) {
                         GL_FLOAT,
                         GL_FALSE,
                         0,// stride
-                        (void*)modelDataPtrs.posVertAttOffset);
+                        (void*)0);
   glEnableVertexAttribArray(positionAttributeIndex);
 
   // normal attribute
-  if(modelInfo.normalAttributeSize > 0) {
+  if(normalAttributeSize > 0) {
     glVertexAttribPointer(normalAttributeIndex,
                           3, // NORMAL ASSUMED TO ALWAYS BE 3-COMPONENTS
                           GL_FLOAT,
                           GL_FALSE,
                           0,
-                          (void*)modelDataPtrs.normalVertAttOffset);
+                          (void*)normalVertAttOffset);
     glEnableVertexAttribArray(normalAttributeIndex);
   }
 
   // texture 0 UV Coord attribute
-  if(modelInfo.uvAttributeSize > 0) {
+  if(uvAttributeSize > 0) {
     glVertexAttribPointer(texture0AttributeIndex,
                           2, // UV ASSUMED TO ALWAYS BE 2-COMPONENTS
                           GL_FLOAT,
                           GL_FALSE,
                           0,
-                          (void*)modelDataPtrs.uvVertAttOffset);
+                          (void*)uvVertAttOffset);
     glEnableVertexAttribArray(texture0AttributeIndex);
   }
 
+  // tangent attribute
+  if(tangentAttributeSize > 0) {
+    glVertexAttribPointer(tangentAttributeIndex,
+                          4, // TANGENT ASSUMED TO ALWAYS BE 4-COMPONENTS, W IS BITANGENT HANDEDNESS
+                          GL_FLOAT,
+                          GL_FALSE,
+                          0,
+                          (void*)tangentVertAttOffset);
+    glEnableVertexAttribArray(tangentAttributeIndex);
+  }
+
   // bind element buffer object to give indices
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.vertexAtt.indexObject);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, modelInfo.indicesSize, modelDataPtrs.indices, GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vertexAtt->indexObject);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, (u64)indexCount * indexTypeSize, indices, GL_STATIC_DRAW);
 
-  mesh.vertexAtt.indexCount = modelInfo.indexCount;
-  mesh.vertexAtt.indexTypeSizeInBytes = modelInfo.indexTypeSize;
+  vertexAtt->indexCount = indexCount;
+  vertexAtt->indexTypeSizeInBytes = indexTypeSize;
 
   // unbind VBO & VAO
   glBindBuffer(GL_ARRAY_BUFFER, 0);
   glBindVertexArray(0);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+internal_func void loadModelAssetFile(const char* filePath, assets::AssetFile* modelAssetFile, assets::ModelInfo* modelInfo) {
+  // TODO: This is NOT where exported assets directory should be stored. Move this or related solution to assetlib or potentially a asset_baker header.
+  std::string bakedModelsDir = "models/";
+  std::string assetPath = bakedModelsDir + filePath + ".modl";
+  assets::loadAssetFile(assetManager_GLOBAL, assetPath.c_str(), modelAssetFile);
+  assets::readModelInfo(*modelAssetFile, modelInfo);
+}
+
+void loadModelGeometry(const char* filePath, ModelGeometry* returnGeometry) {
+  assets::AssetFile modelAssetFile;
+  assets::ModelInfo modelInfo;
+  loadModelAssetFile(filePath, &modelAssetFile, &modelInfo);
+
+  std::vector<char> unpackedGeometryBuffer;
+  char* geometry = assets::unpackModelGeometry(modelInfo, modelAssetFile.binaryBlob.data(), &unpackedGeometryBuffer);
+  assets::ModelDataPtrs modelDataPtrs = modelInfo.calcDataPts(modelAssetFile.binaryBlob.data(), geometry);
+
+  const char* vertAtts = (const char*)modelDataPtrs.vertAtts;
+  returnGeometry->positions.assign((const f32*)(vertAtts + modelDataPtrs.posVertAttOffset), (const f32*)(vertAtts + modelDataPtrs.posVertAttOffset + modelInfo.positionAttributeSize));
+  returnGeometry->normals.assign((const f32*)(vertAtts + modelDataPtrs.normalVertAttOffset), (const f32*)(vertAtts + modelDataPtrs.normalVertAttOffset + modelInfo.normalAttributeSize));
+  returnGeometry->uvs.assign((const f32*)(vertAtts + modelDataPtrs.uvVertAttOffset), (const f32*)(vertAtts + modelDataPtrs.uvVertAttOffset + modelInfo.uvAttributeSize));
+  returnGeometry->tangents.assign((const f32*)(vertAtts + modelDataPtrs.tangentVertAttOffset), (const f32*)(vertAtts + modelDataPtrs.tangentVertAttOffset + modelInfo.tangentAttributeSize));
+
+  returnGeometry->indices.resize(modelInfo.indexCount);
+  if(modelInfo.indexTypeSize == sizeof(u16)) {
+    const u16* shortIndices = (const u16*)modelDataPtrs.indices;
+    for(u32 i = 0; i < modelInfo.indexCount; i++) { returnGeometry->indices[i] = shortIndices[i]; }
+  } else {
+    assert(modelInfo.indexTypeSize == sizeof(u32));
+    memcpy(returnGeometry->indices.data(), modelDataPtrs.indices, modelInfo.indicesSize);
+  }
+}
+
+void loadModelAsset(const char* filePath, Model* returnModel) {
+  returnModel->fileName = filePath;
+
+  assets::AssetFile modelAssetFile;
+  assets::ModelInfo modelInfo;
+  loadModelAssetFile(filePath, &modelAssetFile, &modelInfo);
+
+  std::vector<char> unpackedGeometryBuffer;
+  char* geometry = assets::unpackModelGeometry(modelInfo, modelAssetFile.binaryBlob.data(), &unpackedGeometryBuffer);
+  assets::ModelDataPtrs modelDataPtrs = modelInfo.calcDataPts(modelAssetFile.binaryBlob.data(), geometry);
+
+  returnModel->boundingBox.min = {modelInfo.boundingBoxMin[0],modelInfo.boundingBoxMin[1], modelInfo.boundingBoxMin[2]};
+  returnModel->boundingBox.diagonal = {modelInfo.boundingBoxDiagonal[0],modelInfo.boundingBoxDiagonal[1], modelInfo.boundingBoxDiagonal[2]};
+
+  returnModel->bvh.nodes.resize(modelInfo.bvhNodesSize / sizeof(assets::BVHNode));
+  returnModel->bvh.triangles.resize(modelInfo.bvhTrianglesSize / sizeof(assets::BVHTriangle));
+  if(modelInfo.bvhNodesSize > 0) {
+    memcpy(returnModel->bvh.nodes.data(), modelDataPtrs.bvhNodes, modelInfo.bvhNodesSize);
+    memcpy(returnModel->bvh.triangles.data(), modelDataPtrs.bvhTriangles, modelInfo.bvhTrianglesSize);
+  }
+
+  // ==== VERTEX ATTRIBUTES ==== //
+  // TODO: Handle models with more than 1 mesh
+  returnModel->meshes = new Mesh[1];
+  returnModel->meshCount = 1;
+  Mesh& mesh = returnModel->meshes[0];
+  createVertexAtt(&mesh.vertexAtt, modelDataPtrs.vertAtts,
+                  modelInfo.positionAttributeSize, modelInfo.normalAttributeSize, modelInfo.uvAttributeSize, modelInfo.tangentAttributeSize,
+                  modelDataPtrs.indices, modelInfo.indexCount, modelInfo.indexTypeSize);
 
   mesh.textureData.baseColor = {modelInfo.baseColor[0], modelInfo.baseColor[1], modelInfo.baseColor[2], modelInfo.baseColor[3] };
 
-  if(modelInfo.albedoTexSize > 0) {
+  if(!modelInfo.albedoAtlasName.empty()) {
+    mesh.textureData.albedoTextureId = loadTextureAtlas(modelInfo.albedoAtlasName);
+  } else if(modelInfo.albedoTexSize > 0) {
     glGenTextures(1, &mesh.textureData.albedoTextureId);
     glBindTexture(GL_TEXTURE_2D, mesh.textureData.albedoTextureId);
 
@@ -135,7 +242,9 @@ void loadModelAsset(const char* filePath, Model* returnModel) {
     mesh.textureData.albedoTextureId = TEXTURE_ID_NO_TEXTURE;
   }
 
-  if(modelInfo.normalTexSize > 0) {
+  if(!modelInfo.normalAtlasName.empty()) {
+    mesh.textureData.normalTextureId = loadTextureAtlas(modelInfo.normalAtlasName);
+  } else if(modelInfo.normalTexSize > 0) {
     glGenTextures(1, &mesh.textureData.normalTextureId);
     glBindTexture(GL_TEXTURE_2D, mesh.textureData.normalTextureId);
 
@@ -171,6 +280,8 @@ void loadModelAsset(const char* filePath, Model* returnModel) {
   } else {
     mesh.textureData.normalTextureId = TEXTURE_ID_NO_TEXTURE;
   }
+  // NOTE: gate.frag builds its tangent frame from baked tangents alone, the asset baker refuses normal maps without them
+  assert(mesh.textureData.normalTextureId == TEXTURE_ID_NO_TEXTURE || modelInfo.tangentAttributeSize > 0);
 }
 
 void deleteModels(Model* models, u32 count) {
@@ -194,6 +305,11 @@ void deleteModels(Model* models, u32 count) {
     *modelPtr = {}; // clear model to zero
   }
 
+  // NOTE: Models sharing a texture atlas hold the same texture ids
+  std::sort(textureData.begin(), textureData.end());
+  textureData.erase(std::unique(textureData.begin(), textureData.end()), textureData.end());
+  textureAtlases_GLOBAL.clear();
+
   deleteVertexAtts(vertexAtts.data(), (u32)vertexAtts.size());
   glDeleteTextures((GLsizei)textureData.size(), textureData.data());
 }
\ No newline at end of file
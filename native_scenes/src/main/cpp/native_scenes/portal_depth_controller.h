@@ -0,0 +1,93 @@
+#pragma once
+
+#define PORTAL_DEPTH_WINDOW_FRAMES 30 // frames averaged for every decision
+#define PORTAL_DEPTH_RAISE_BUDGET 0.6f // fraction of the target frame time a window must stay under to raise the depth
+#define PORTAL_DEPTH_LOWER_BUDGET 0.9f // fraction of the target frame time a window must go over to lower the depth
+#define PORTAL_DEPTH_RAISE_WINDOWS 2 // windows in a row under budget before raising
+#define PORTAL_DEPTH_MAX_RAISE_WINDOWS 32
+
+/*
+ * Picks the portal recursion depth that holds a target frame time.
+ *  - The frame time of a window is the slower of its average CPU & GPU times, whichever is the bottleneck.
+ *  - The depth is lowered as soon as a window runs over budget, but only raised after several windows well under it.
+ *    The gap between the two budgets keeps the depth from flipping back & forth around the target.
+ *  - A raise that is undone by the very next window doubles the windows needed before raising again.
+ * NOTE: Only the frame times given to it are looked at, so it can be driven by synthetic traces off device.
+ */
+struct PortalDepthController {
+  f32 targetFrameMs;
+  u32 minDepth;
+  u32 maxDepth;
+  u32 depth;
+
+  f32 windowCpuMs; // sums over the current window
+  f32 windowGpuMs;
+  u32 windowFrameCount;
+  u32 windowGpuFrameCount; // NOTE: GPU times may be missing for some or all frames
+
+  u32 underBudgetWindowCount; // in a row
+  u32 raiseWindowCount; // needed before raising
+  u32 windowsSinceRaise; // U32_MAX when the last change was not a raise
+};
+
+void initPortalDepthController(PortalDepthController* controller, f32 targetFrameMs, u32 minDepth, u32 maxDepth, u32 depth) {
+  assert(minDepth <= depth && depth <= maxDepth);
+  *controller = {};
+  controller->targetFrameMs = targetFrameMs;
+  controller->minDepth = minDepth;
+  controller->maxDepth = maxDepth;
+  controller->depth = depth;
+  controller->raiseWindowCount = PORTAL_DEPTH_RAISE_WINDOWS;
+  controller->windowsSinceRaise = U32_MAX;
+}
+
+// NOTE: gpuFrameMs is negative when unknown. Returns true when the depth changed.
+bool updatePortalDepthController(PortalDepthController* controller, f32 cpuFrameMs, f32 gpuFrameMs) {
+  controller->windowCpuMs += cpuFrameMs;
+  controller->windowFrameCount++;
+  if(gpuFrameMs >= 0.0f) {
+    controller->windowGpuMs += gpuFrameMs;
+    controller->windowGpuFrameCount++;
+  }
+  if(controller->windowFrameCount < PORTAL_DEPTH_WINDOW_FRAMES) { return false; }
+
+  f32 cpuMs = controller->windowCpuMs / controller->windowFrameCount;
+  f32 gpuMs = controller->windowGpuFrameCount > 0 ? (controller->windowGpuMs / controller->windowGpuFrameCount) : -1.0f;
+  f32 frameMs = Max(cpuMs, gpuMs);
+  controller->windowCpuMs = 0.0f;
+  controller->windowGpuMs = 0.0f;
+  controller->windowFrameCount = 0;
+  controller->windowGpuFrameCount = 0;
+  if(controller->windowsSinceRaise != U32_MAX) { controller->windowsSinceRaise++; }
+
+  u32 previousDepth = controller->depth;
+  if(frameMs > (controller->targetFrameMs * PORTAL_DEPTH_LOWER_BUDGET)) {
+    controller->underBudgetWindowCount = 0;
+    if(controller->depth > controller->minDepth) {
+      if(controller->windowsSinceRaise == 1) {
+        controller->raiseWindowCount = Min(controller->raiseWindowCount * 2, (u32)PORTAL_DEPTH_MAX_RAISE_WINDOWS);
+      }
+      controller->depth--;
+      controller->windowsSinceRaise = U32_MAX;
+    }
+  } else if(frameMs < (controller->targetFrameMs * PORTAL_DEPTH_RAISE_BUDGET)) {
+    controller->underBudgetWindowCount++;
+    if(controller->underBudgetWindowCount >= controller->raiseWindowCount && controller->depth < controller->maxDepth) {
+      controller->depth++;
+      controller->underBudgetWindowCount = 0;
+      controller->windowsSinceRaise = 0;
+    }
+  } else {
+    controller->underBudgetWindowCount = 0;
+  }
+
+  // NOTE: A raise that has held for a while earns back the usual patience
+  if(controller->windowsSinceRaise != U32_MAX && controller->windowsSinceRaise >= controller->raiseWindowCount) {
+    controller->raiseWindowCount = PORTAL_DEPTH_RAISE_WINDOWS;
+  }
+
+  if(controller->depth == previousDepth) { return false; }
+  LOGI("Portal depth %u -> %u: frame %.2fms (cpu %.2fms, gpu %.2fms) against a %.2fms target, %u windows needed to raise\n",
+       previousDepth, controller->depth, frameMs, cpuMs, gpuMs, controller->targetFrameMs, controller->raiseWindowCount);
+  return true;
+}
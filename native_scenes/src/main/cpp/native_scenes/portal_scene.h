@@ -3,6 +3,16 @@
 #define MAX_SCENE_COUNT 8
 #define STENCIL_MASK_BITS 8
 #define CLEAR_STENCIL_VALUE 0x01
+#define PLAYER_COLLISION_RADIUS 0.3f
+#define PLAYER_COLLISION_SKIN 0.01f // distance kept between the player and anything it slides along
+#define PLAYER_COLLISION_MAX_SLIDES 3
+#define PLAYER_MIN_RADIUS 1.5f // NOTE: The "shape" at the origin is assumed to fit inside this
+#define PLAYER_MAX_RADIUS 75.0f
+#define MAX_PORTAL_DEPTH 4 // NOTE: Each level uses one more stencil value
+#define MIN_PORTAL_DEPTH 1
+#define START_PORTAL_DEPTH 2
+#define TARGET_FRAME_MS (1000.0f / 60.0f)
+#define FRAME_STATS_LOG_INTERVAL 600 // frames, stats are of a single frame & logged every so often to keep logcat readable
 
 struct PlayerPosition {
   struct {
@@ -53,18 +63,72 @@ struct Portal {
   bool transient;
   s32 backingModelIndex;
   s32 backingShaderIndex;
+  assets::BVH backingCollider; // world space, empty when there is no backing model
+};
+
+// Non-rotating entities sharing a shader & material, pre-transformed into world space and drawn with a single call
+struct StaticBatch {
+  Mesh mesh;
+  u32 shaderIndex;
+  u32 entityCount;
+  f32 boundsMin[3]; // world space, like the batch's vertices
+  f32 boundsMax[3];
+};
+
+// Entities sharing a model & shader that could not be statically batched, drawn with a single instanced call per mesh
+struct InstanceGroup {
+  u32 modelIndex;
+  u32 shaderIndex; // of the INSTANCED variant of the entities' shader
+  u32 entityIndices[MAX_INSTANCES];
+  u32 entityCount;
+};
+
+enum SceneDrawSource : u8 {
+  SceneDrawSource_StaticBatch,
+  SceneDrawSource_InstanceGroup,
+  SceneDrawSource_Entity,
+  SceneDrawSource_PortalBacking,
+};
+
+// A single mesh drawn by a scene, with everything it needs from the shader & model resolved ahead of time
+struct SceneDraw {
+  GLuint programId;
+  GLuint noiseTextureId;
+  GLuint albedoTextureId;
+  GLuint normalTextureId;
+  const VertexAtt* vertexAtt;
+  GLint baseColorLocation; // -1 when the mesh has no base color
+  vec3 baseColor;
+  SceneDrawSource source;
+  u32 sourceIndex; // of the static batch, instance group, entity or portal
+  bool modelMatrixChanges; // NOTE: Rotating entities recompute theirs, instance groups record theirs per view
+  mat4 modelMatrix;
+};
+
+struct SceneDrawList {
+  std::vector<SceneDraw> draws; // sorted by program, textures & vertex array
+  bool valid; // NOTE: Rebuilt by the next drawScene() once the scene's entities or portals change
 };
 
 struct Scene {
   Entity entities[16];
   u32 entityCount;
+  StaticBatch staticBatches[16];
+  u32 staticBatchCount;
+  InstanceGroup instanceGroups[8];
+  u32 instanceGroupCount;
+  CullBounds cullBounds; // NOTE: One per entity followed by one per static batch
   Portal portals[MAX_PORTALS];
   u32 portalCount;
+  std::vector<assets::BVH> colliders; // world space copies of the static entities' BVHs
   Light dirPosLightStack[8];
   u32 dirLightCount;
   u32 posLightCount;
-  vec4 ambientLightColorAndPower;
-  GLuint skyboxTexture;
+  vec4 ambientSH[9];
+  GLuint skyboxTexture; // NOTE: May be shared with other scenes, when it is one of the world's skyboxArrays
+  u32 skyboxLayer;
+  GLuint lightUboId; // NOTE: Lights never change once loaded, views of the scene only bind it
+  SceneDrawList drawList;
   std::string title;
   std::string skyboxFileName;
 };
@@ -85,6 +149,12 @@ struct World
   u32 sceneCount;
   Model models[128];
   u32 modelCount;
+  CubeMapArray skyboxArrays[4];
+  u32 skyboxArrayCount;
+  GLuint boundSkyboxTexture;
+  // NOTE: Models sharing a texture atlas skip rebinding it, reset every frame as loading textures may bind over them
+  GLuint boundAlbedoTexture;
+  GLuint boundNormalTexture;
   struct {
     f32 fov;
     f32 aspect;
@@ -93,11 +163,9 @@ struct World
   } display;
   struct {
     ProjectionViewModelUBO projectionViewModelUbo;
-    GLuint projectionViewModelUboId;
+    UniformBufferRing projectionViewModelRing;
     FragUBO fragUbo;
     GLuint fragUboId;
-    MultiLightUBO multiLightUbo;
-    GLuint multiLightUboId;
   } UBOs;
   struct {
     SceneInput previousInputs[4];
@@ -111,12 +179,35 @@ struct World
   ShaderProgram clearDepthShader;
   CommonVertAtts commonVertAtts;
   u32 shaderCount;
+  RenderCommandList renderCommands; // NOTE: Re-recorded every frame, kept around to reuse its allocations
+  CullStats cullStats; // NOTE: Of the last frame recorded
+  PortalDepthController portalDepthController;
+  GPUFrameTimer gpuFrameTimer;
+  GLStateCache glState; // NOTE: Counts are of the last frame drawn
+  u32 frameCount;
 };
 
 const f32 near = 0.1f;
 const f32 far = 200.0f;
+const f32 portalClipMinW = 0.0001f; // NOTE: Portal quads are clipped just in front of the eye before being projected
+
+void drawScene(World* world, RenderCommandList* commands, const u32 sceneIndex, const mat4& projectionMat, u32 sceneMask);
+
+mat4 entityModelMatrix(const Entity& entity) {
+  return scaleRotTrans_mat4(entity.scaleXYZ, vec3{0.0f, 0.0f, 1.0f}, entity.yaw, entity.posXYZ);
+}
+
+mat4 portalBackModelMatrix(const Portal& portal) {
+  f32 yaw = atan2(portal.normal[1], portal.normal[0]) + PiOverTwo32;
+  vec3 portalBackOffset = Vec3(-(0.5 * portal.dimens[1]) * portal.normal, 0.0f);
+  return scaleRotTrans_mat4(portal.dimens, vec3{0.0f, 0.0f, 1.0f}, yaw, portal.centerPosition + portalBackOffset);
+}
+
+void createCollider(const Model& model, const mat4& modelMatrix, assets::BVH* collider) {
+  *collider = model.bvh;
+  assets::transformBVH(collider, modelMatrix.values);
+}
 
-void drawScene(World* world, const u32 sceneIndex, u32 sceneMask);
 void addPortal(World* world, u32 sourceSceneIndex, const u32 destinationSceneIndex, PortalInfo* portalInfo, bool transient = false) {
 
   Scene* sourceScene = world->scenes + sourceSceneIndex;
@@ -131,8 +222,12 @@ void addPortal(World* world, u32 sourceSceneIndex, const u32 destinationSceneInd
   portal.sceneDestination = destinationSceneIndex;
   portal.backingModelIndex = portalInfo->backingModelIndex;
   portal.backingShaderIndex = portalInfo->backingShaderIndex;
+  if(portal.backingModelIndex != WORLD_INFO_NO_INDEX) {
+    createCollider(world->models[portal.backingModelIndex], portalBackModelMatrix(portal), &portal.backingCollider);
+  }
 
-  sourceScene->portals[sourceScene->portalCount++] = portal;
+  sourceScene->portals[sourceScene->portalCount++] = std::move(portal);
+  sourceScene->drawList.valid = false;
 }
 
 u32 addNewScene(World* world, const char* title) {
@@ -154,6 +249,26 @@ u32 addNewShader(World* world, const char* vertexShaderFileLoc, const char* frag
   return shaderIndex;
 }
 
+// NOTE: The variant shares the noise texture of the original, which keeps ownership of it
+u32 addInstancedShaderVariant(World* world, u32 shaderIndex) {
+  const ShaderProgram& shader = world->shaders[shaderIndex];
+  for(u32 variantIndex = 0; variantIndex < world->shaderCount; variantIndex++) {
+    const ShaderProgram& variant = world->shaders[variantIndex];
+    if(variant.instanced && variant.vertexFileName == shader.vertexFileName && variant.fragmentFileName == shader.fragmentFileName &&
+       variant.noiseTextureFileName == shader.noiseTextureFileName) {
+      return variantIndex;
+    }
+  }
+
+  assert(ArrayCount(world->shaders) > world->shaderCount);
+  u32 variantIndex = world->shaderCount++;
+  ShaderProgram* variant = world->shaders + variantIndex;
+  *variant = createShaderProgram(shader.vertexFileName.c_str(), shader.fragmentFileName.c_str(), nullptr, true);
+  variant->noiseTextureId = shader.noiseTextureId;
+  variant->noiseTextureFileName = shader.noiseTextureFileName;
+  return variantIndex;
+}
+
 u32 addNewEntity(World* world, u32 sceneIndex, u32 modelIndex,
                  vec3 pos, vec3 scale, f32 yaw,
                  u32 shaderIndex, b32 entityTypeFlags = 0) {
@@ -168,6 +283,12 @@ u32 addNewEntity(World* world, u32 sceneIndex, u32 modelIndex,
   entity->yaw = yaw;
   entity->shaderIndex = shaderIndex;
   entity->flags = entityTypeFlags;
+  // NOTE: Rotating entities are kept out of the way by a bounding sphere in collisionDetectionAndCorrection()
+  if(!(entity->flags & EntityType_Rotating) && !world->models[modelIndex].bvh.nodes.empty()) {
+    scene->colliders.emplace_back();
+    createCollider(world->models[modelIndex], entityModelMatrix(*entity), &scene->colliders.back());
+  }
+  scene->drawList.valid = false;
   return sceneEntityIndex;
 }
 
@@ -190,9 +311,15 @@ u32 addNewPositionalLight(World* world, u32 sceneIndex, vec4 colorAndPower, vec3
   return newLightIndex;
 }
 
+// NOTE: Replaces the ambient light baked from the skybox with a constant one, which only requires the first SH coefficient
 void adjustAmbientLight(World* world, u32 sceneIndex, vec4 lightColorAndPower) {
   Scene* scene = world->scenes + sceneIndex;
-  scene->ambientLightColorAndPower = {lightColorAndPower[0], lightColorAndPower[1], lightColorAndPower[2], lightColorAndPower[3]};
+  const f32 shBand0 = 0.282095f;
+  f32 coefficient = lightColorAndPower[3] / shBand0;
+  scene->ambientSH[0] = {lightColorAndPower[0] * coefficient, lightColorAndPower[1] * coefficient, lightColorAndPower[2] * coefficient, 0.0f};
+  for(u32 i = 1; i < ArrayCount(scene->ambientSH); i++) {
+    scene->ambientSH[i] = {0.0f, 0.0f, 0.0f, 0.0f};
+  }
 }
 
 u32 addNewModel(World* world, const char* modelFileLoc) {
@@ -201,60 +328,450 @@ u32 addNewModel(World* world, const char* modelFileLoc) {
   return modelIndex;
 }
 
-void drawPortals(World *world, const u32 sceneIndex,
+// Appends the geometry transformed by the model matrix, normals & tangents are kept in world space as well
+internal_func void appendTransformedGeometry(const ModelGeometry& geometry, const mat4& modelMatrix, ModelGeometry* batchGeometry) {
+  const f32* m = modelMatrix.values; // column-major
+  // NOTE: The cofactor matrix is the inverse transpose scaled by the determinant, scaling doesn't matter after normalizing
+  f32 cofactor[3][3];
+  for(u32 row = 0; row < 3; row++) {
+    for(u32 col = 0; col < 3; col++) {
+      u32 r1 = (row + 1) % 3, r2 = (row + 2) % 3;
+      u32 c1 = (col + 1) % 3, c2 = (col + 2) % 3;
+      cofactor[row][col] = (m[c1 * 4 + r1] * m[c2 * 4 + r2]) - (m[c2 * 4 + r1] * m[c1 * 4 + r2]);
+    }
+  }
+  f32 determinant = (m[0] * cofactor[0][0]) + (m[4] * cofactor[0][1]) + (m[8] * cofactor[0][2]);
+  f32 handedness = determinant < 0.0f ? -1.0f : 1.0f;
+
+  const u32 baseVertex = (u32)(batchGeometry->positions.size() / 3);
+  const u32 vertexCount = (u32)(geometry.positions.size() / 3);
+  for(u32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
+    const f32* p = &geometry.positions[vertexIndex * 3];
+    for(u32 row = 0; row < 3; row++) {
+      batchGeometry->positions.push_back((m[row] * p[0]) + (m[4 + row] * p[1]) + (m[8 + row] * p[2]) + m[12 + row]);
+    }
+
+    if(!geometry.normals.empty()) {
+      const f32* n = &geometry.normals[vertexIndex * 3];
+      f32 normal[3];
+      for(u32 row = 0; row < 3; row++) {
+        normal[row] = handedness * ((cofactor[row][0] * n[0]) + (cofactor[row][1] * n[1]) + (cofactor[row][2] * n[2]));
+      }
+      f32 invLength = 1.0f / sqrtf((normal[0] * normal[0]) + (normal[1] * normal[1]) + (normal[2] * normal[2]));
+      for(u32 row = 0; row < 3; row++) { batchGeometry->normals.push_back(normal[row] * invLength); }
+    }
+
+    if(!geometry.uvs.empty()) {
+      batchGeometry->uvs.push_back(geometry.uvs[vertexIndex * 2]);
+      batchGeometry->uvs.push_back(geometry.uvs[(vertexIndex * 2) + 1]);
+    }
+
+    if(!geometry.tangents.empty()) {
+      const f32* t = &geometry.tangents[vertexIndex * 4];
+      f32 tangent[3];
+      for(u32 row = 0; row < 3; row++) {
+        tangent[row] = (m[row] * t[0]) + (m[4 + row] * t[1]) + (m[8 + row] * t[2]);
+      }
+      f32 invLength = 1.0f / sqrtf((tangent[0] * tangent[0]) + (tangent[1] * tangent[1]) + (tangent[2] * tangent[2]));
+      for(u32 row = 0; row < 3; row++) { batchGeometry->tangents.push_back(tangent[row] * invLength); }
+      batchGeometry->tangents.push_back(t[3] * handedness);
+    }
+  }
+
+  for(u32 index: geometry.indices) {
+    batchGeometry->indices.push_back(baseVertex + index);
+  }
+}
+
+// Merges every group of two or more non-rotating entities that share a shader, material & vertex attributes
+void buildStaticBatches(World* world, u32 sceneIndex) {
+  Scene* scene = world->scenes + sceneIndex;
+
+  struct LOCAL_FUNCS {
+    static bool sameMaterial(const TextureData& a, const TextureData& b) {
+      return a.albedoTextureId == b.albedoTextureId && a.normalTextureId == b.normalTextureId &&
+             a.baseColor[0] == b.baseColor[0] && a.baseColor[1] == b.baseColor[1] &&
+             a.baseColor[2] == b.baseColor[2] && a.baseColor[3] == b.baseColor[3];
+    }
+    static bool sameAttributes(const ModelGeometry& a, const ModelGeometry& b) {
+      return a.normals.empty() == b.normals.empty() && a.uvs.empty() == b.uvs.empty() && a.tangents.empty() == b.tangents.empty();
+    }
+    static bool batchable(const World* world, const Entity& entity) {
+      const Model& model = world->models[entity.modelIndex];
+      return !(entity.flags & (EntityType_Rotating | EntityType_StaticBatched)) && model.meshCount == 1;
+    }
+  };
+
+  std::unordered_map<u32, ModelGeometry> modelGeometries;
+  auto geometryForModel = [&](u32 modelIndex) -> const ModelGeometry& {
+    auto it = modelGeometries.find(modelIndex);
+    if(it == modelGeometries.end()) {
+      it = modelGeometries.emplace(modelIndex, ModelGeometry{}).first;
+      loadModelGeometry(world->models[modelIndex].fileName.c_str(), &it->second);
+    }
+    return it->second;
+  };
+
+  u32 batchedEntityCount = 0;
+  for(u32 entityIndex = 0; entityIndex < scene->entityCount; entityIndex++) {
+    const Entity& entity = scene->entities[entityIndex];
+    if(!LOCAL_FUNCS::batchable(world, entity)) { continue; }
+    const TextureData& textureData = world->models[entity.modelIndex].meshes[0].textureData;
+
+    u32 batchEntityIndices[ArrayCount(scene->entities)];
+    u32 batchEntityCount = 0;
+    batchEntityIndices[batchEntityCount++] = entityIndex;
+    for(u32 otherIndex = entityIndex + 1; otherIndex < scene->entityCount; otherIndex++) {
+      const Entity& other = scene->entities[otherIndex];
+      if(!LOCAL_FUNCS::batchable(world, other) || other.shaderIndex != entity.shaderIndex ||
+         !LOCAL_FUNCS::sameMaterial(world->models[other.modelIndex].meshes[0].textureData, textureData) ||
+         !LOCAL_FUNCS::sameAttributes(geometryForModel(other.modelIndex), geometryForModel(entity.modelIndex))) {
+        continue;
+      }
+      batchEntityIndices[batchEntityCount++] = otherIndex;
+    }
+    if(batchEntityCount < 2) { continue; } // nothing to be gained from batching a single entity
+    // NOTE: Entities left unbatched are drawn on their own, as they would be without batching
+    if(scene->staticBatchCount == ArrayCount(scene->staticBatches)) {
+      LOGW("Scene \"%s\": out of static batches, the remaining static entities are drawn unbatched\n", scene->title.c_str());
+      break;
+    }
+
+    ModelGeometry batchGeometry;
+    for(u32 i = 0; i < batchEntityCount; i++) {
+      Entity& batchEntity = scene->entities[batchEntityIndices[i]];
+      appendTransformedGeometry(geometryForModel(batchEntity.modelIndex), entityModelMatrix(batchEntity), &batchGeometry);
+      batchEntity.flags |= EntityType_StaticBatched;
+    }
+
+    StaticBatch& batch = scene->staticBatches[scene->staticBatchCount++];
+    batch.shaderIndex = entity.shaderIndex;
+    batch.entityCount = batchEntityCount;
+    for(u32 axis = 0; axis < 3; axis++) {
+      batch.boundsMin[axis] = batchGeometry.positions[axis];
+      batch.boundsMax[axis] = batchGeometry.positions[axis];
+    }
+    for(u32 i = 0; i < batchGeometry.positions.size(); i++) {
+      batch.boundsMin[i % 3] = Min(batch.boundsMin[i % 3], batchGeometry.positions[i]);
+      batch.boundsMax[i % 3] = Max(batch.boundsMax[i % 3], batchGeometry.positions[i]);
+    }
+    batch.mesh.textureData = textureData;
+    createVertexAtt(&batch.mesh.vertexAtt,
+                    nullptr,
+                    batchGeometry.positions.size() * sizeof(f32),
+                    batchGeometry.normals.size() * sizeof(f32),
+                    batchGeometry.uvs.size() * sizeof(f32),
+                    batchGeometry.tangents.size() * sizeof(f32),
+                    batchGeometry.indices.data(), (u32)batchGeometry.indices.size(), sizeof(u32));
+    glBindBuffer(GL_ARRAY_BUFFER, batch.mesh.vertexAtt.bufferObject);
+    u64 offset = 0;
+    const std::vector<f32>* attributes[] = { &batchGeometry.positions, &batchGeometry.normals, &batchGeometry.uvs, &batchGeometry.tangents };
+    for(const std::vector<f32>* attribute: attributes) {
+      glBufferSubData(GL_ARRAY_BUFFER, offset, attribute->size() * sizeof(f32), attribute->data());
+      offset += attribute->size() * sizeof(f32);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    batchedEntityCount += batchEntityCount;
+  }
+
+  if(scene->staticBatchCount > 0) {
+    LOGI("Scene \"%s\": %u static entities merged into %u draw(s)\n", scene->title.c_str(), batchedEntityCount, scene->staticBatchCount);
+  }
+}
+
+// Groups the entities left over by buildStaticBatches() that share a model & shader
+void buildInstanceGroups(World* world, u32 sceneIndex) {
+  Scene* scene = world->scenes + sceneIndex;
+  const b32 groupedFlags = EntityType_StaticBatched | EntityType_Instanced;
+
+  u32 instancedEntityCount = 0;
+  for(u32 entityIndex = 0; entityIndex < scene->entityCount; entityIndex++) {
+    const Entity& entity = scene->entities[entityIndex];
+    if(entity.flags & groupedFlags) { continue; }
+
+    InstanceGroup group{};
+    group.modelIndex = entity.modelIndex;
+    group.entityIndices[group.entityCount++] = entityIndex;
+    for(u32 otherIndex = entityIndex + 1; otherIndex < scene->entityCount && group.entityCount < MAX_INSTANCES; otherIndex++) {
+      const Entity& other = scene->entities[otherIndex];
+      if((other.flags & groupedFlags) || other.modelIndex != entity.modelIndex || other.shaderIndex != entity.shaderIndex) {
+        continue;
+      }
+      group.entityIndices[group.entityCount++] = otherIndex;
+    }
+    if(group.entityCount < 2) { continue; } // nothing to be gained from instancing a single entity
+
+    for(u32 i = 0; i < group.entityCount; i++) {
+      scene->entities[group.entityIndices[i]].flags |= EntityType_Instanced;
+    }
+    group.shaderIndex = addInstancedShaderVariant(world, entity.shaderIndex);
+    assert(ArrayCount(scene->instanceGroups) > scene->instanceGroupCount);
+    scene->instanceGroups[scene->instanceGroupCount++] = group;
+    instancedEntityCount += group.entityCount;
+  }
+
+  if(scene->instanceGroupCount > 0) {
+    LOGI("Scene \"%s\": %u entities drawn as %u instance group(s)\n", scene->title.c_str(), instancedEntityCount, scene->instanceGroupCount);
+  }
+}
+
+// NOTE: Requires the scene's lights & skybox to be loaded
+void uploadSceneLights(World* world, u32 sceneIndex) {
+  Scene* scene = world->scenes + sceneIndex;
+  MultiLightUBO lightUbo = {};
+  const u32 maxLights = ArrayCount(lightUbo.dirPosLightStack);
+  assert((scene->dirLightCount + scene->posLightCount) <= maxLights);
+
+  // NOTE: The lights are on a single double ended array where directional lights are added to the beginning
+  // and positional lights are added to the end.
+  lightUbo.dirLightCount = scene->dirLightCount;
+  for(u32 i = 0; i < scene->dirLightCount; ++i) {
+    lightUbo.dirPosLightStack[i].colorAndPower = scene->dirPosLightStack[i].colorAndPower;
+    lightUbo.dirPosLightStack[i].pos.xyz = scene->dirPosLightStack[i].pos;
+  }
+
+  lightUbo.posLightCount = scene->posLightCount;
+  for(u32 i = 0; i < scene->posLightCount; ++i) {
+    lightUbo.dirPosLightStack[maxLights - 1 - i].colorAndPower = scene->dirPosLightStack[maxLights - 1 - i].colorAndPower;
+    lightUbo.dirPosLightStack[maxLights - 1 - i].pos.xyz = scene->dirPosLightStack[maxLights - 1 - i].pos;
+  }
+
+  memcpy(lightUbo.ambientSH, scene->ambientSH, sizeof(scene->ambientSH));
+  lightUbo.skyboxLayer = scene->skyboxLayer;
+
+  if(scene->lightUboId == 0) { glGenBuffers(1, &scene->lightUboId); }
+  glBindBuffer(GL_UNIFORM_BUFFER, scene->lightUboId);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(MultiLightUBO), &lightUbo, GL_STATIC_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// NOTE: Never touches GL, only resolves what the scene's draws need from the shaders & models
+void buildSceneDrawList(World* world, u32 sceneIndex) {
+  Scene* scene = world->scenes + sceneIndex;
+  std::vector<SceneDraw>& draws = scene->drawList.draws;
+  draws.clear();
+
+  struct LOCAL_FUNCS {
+    static void addMeshDraws(std::vector<SceneDraw>* draws, const ShaderProgram& shader, const Mesh* meshes, u32 meshCount,
+                             SceneDrawSource source, u32 sourceIndex, const mat4& modelMatrix, bool modelMatrixChanges = false) {
+      for(u32 meshIndex = 0; meshIndex < meshCount; ++meshIndex) {
+        const Mesh& mesh = meshes[meshIndex];
+        SceneDraw draw;
+        draw.programId = shader.id;
+        draw.noiseTextureId = shader.noiseTextureId;
+        draw.albedoTextureId = mesh.textureData.albedoTextureId;
+        draw.normalTextureId = mesh.textureData.normalTextureId;
+        draw.vertexAtt = &mesh.vertexAtt;
+        draw.baseColorLocation = mesh.textureData.baseColor[3] != 0.0f ? shader.uniformLocations[ShaderUniform_baseColor] : -1;
+        draw.baseColor = mesh.textureData.baseColor.xyz;
+        draw.source = source;
+        draw.sourceIndex = sourceIndex;
+        draw.modelMatrixChanges = modelMatrixChanges;
+        draw.modelMatrix = modelMatrix;
+        draws->push_back(draw);
+      }
+    }
+  };
+
+  const mat4 identityMat4 = identity_mat4();
+  for(u32 batchIndex = 0; batchIndex < scene->staticBatchCount; ++batchIndex) {
+    const StaticBatch& batch = scene->staticBatches[batchIndex];
+    LOCAL_FUNCS::addMeshDraws(&draws, world->shaders[batch.shaderIndex], &batch.mesh, 1, SceneDrawSource_StaticBatch, batchIndex, identityMat4);
+  }
+
+  for(u32 groupIndex = 0; groupIndex < scene->instanceGroupCount; ++groupIndex) {
+    const InstanceGroup& group = scene->instanceGroups[groupIndex];
+    const Model& model = world->models[group.modelIndex];
+    LOCAL_FUNCS::addMeshDraws(&draws, world->shaders[group.shaderIndex], model.meshes, model.meshCount, SceneDrawSource_InstanceGroup, groupIndex,
+                              identityMat4, true);
+  }
+
+  for(u32 entityIndex = 0; entityIndex < scene->entityCount; ++entityIndex) {
+    const Entity& entity = scene->entities[entityIndex];
+    if(entity.flags & (EntityType_StaticBatched | EntityType_Instanced)) { continue; }
+    const Model& model = world->models[entity.modelIndex];
+    LOCAL_FUNCS::addMeshDraws(&draws, world->shaders[entity.shaderIndex], model.meshes, model.meshCount, SceneDrawSource_Entity, entityIndex,
+                              entityModelMatrix(entity), entity.flags & EntityType_Rotating);
+  }
+
+  for(u32 portalIndex = 0; portalIndex < scene->portalCount; ++portalIndex) {
+    const Portal& portal = scene->portals[portalIndex];
+    if(portal.backingModelIndex == WORLD_INFO_NO_INDEX) { continue; }
+    const Model& model = world->models[portal.backingModelIndex];
+    LOCAL_FUNCS::addMeshDraws(&draws, world->shaders[portal.backingShaderIndex], model.meshes, model.meshCount, SceneDrawSource_PortalBacking, portalIndex,
+                              portalBackModelMatrix(portal));
+  }
+
+  // NOTE: Everything drawn here is opaque, so the order only matters for how much state changes in between
+  std::sort(draws.begin(), draws.end(), [](const SceneDraw& a, const SceneDraw& b) {
+    if(a.programId != b.programId) { return a.programId < b.programId; }
+    if(a.noiseTextureId != b.noiseTextureId) { return a.noiseTextureId < b.noiseTextureId; }
+    if(a.albedoTextureId != b.albedoTextureId) { return a.albedoTextureId < b.albedoTextureId; }
+    if(a.normalTextureId != b.normalTextureId) { return a.normalTextureId < b.normalTextureId; }
+    return a.vertexAtt->arrayObject < b.vertexAtt->arrayObject;
+  });
+  scene->drawList.valid = true;
+}
+
+// Where the portals of a frame are seen from, the player's camera
+struct PortalViewpoint {
+  vec3 eye;
+  mat4 view;
+  u32 sceneIndex; // scene the eye is in
+};
+
+// NOTE: Portals are seen through the rect of the view they are in, so the result never extends past viewRect
+ScreenRect portalScreenRect(const World* world, const Portal& portal, const mat4& projectionView, const ScreenRect& viewRect) {
+  vec2 centerToSide = vec2{portal.normal[1], -portal.normal[0]} * (portal.dimens[0] * 0.5f);
+  f32 halfHeight = portal.dimens[2] * 0.5f;
+  vec4 corners[4] = {
+          projectionView * Vec4(portal.centerPosition + Vec3(centerToSide, -halfHeight), 1.0f),
+          projectionView * Vec4(portal.centerPosition + Vec3(-centerToSide, -halfHeight), 1.0f),
+          projectionView * Vec4(portal.centerPosition + Vec3(-centerToSide, halfHeight), 1.0f),
+          projectionView * Vec4(portal.centerPosition + Vec3(centerToSide, halfHeight), 1.0f),
+  };
+
+  // clip the quad to the front of the eye, one plane of Sutherland-Hodgman
+  vec4 clipped[5];
+  u32 clippedCount = 0;
+  for(u32 i = 0; i < 4; i++) {
+    const vec4& a = corners[i];
+    const vec4& b = corners[(i + 1) % 4];
+    bool aInside = a[3] >= portalClipMinW;
+    bool bInside = b[3] >= portalClipMinW;
+    if(aInside) { clipped[clippedCount++] = a; }
+    if(aInside != bInside) {
+      f32 t = (portalClipMinW - a[3]) / (b[3] - a[3]);
+      vec4& intersection = clipped[clippedCount++];
+      for(u32 c = 0; c < 4; c++) { intersection[c] = a[c] + ((b[c] - a[c]) * t); }
+    }
+  }
+  if(clippedCount == 0) { return ScreenRect{viewRect.x, viewRect.y, 0, 0}; }
+
+  f32 minNdc[2] = {1.0f, 1.0f};
+  f32 maxNdc[2] = {-1.0f, -1.0f};
+  for(u32 i = 0; i < clippedCount; i++) {
+    for(u32 axis = 0; axis < 2; axis++) {
+      f32 ndc = clipped[i][axis] / clipped[i][3];
+      minNdc[axis] = Min(minNdc[axis], ndc);
+      maxNdc[axis] = Max(maxNdc[axis], ndc);
+    }
+  }
+
+  f32 displaySize[2] = {(f32)world->display.width, (f32)world->display.height};
+  s32 minPixel[2], maxPixel[2];
+  for(u32 axis = 0; axis < 2; axis++) {
+    minPixel[axis] = (s32)floorf((Min(Max(minNdc[axis], -1.0f), 1.0f) * 0.5f + 0.5f) * displaySize[axis]);
+    maxPixel[axis] = (s32)ceilf((Min(Max(maxNdc[axis], -1.0f), 1.0f) * 0.5f + 0.5f) * displaySize[axis]);
+  }
+  ScreenRect portalRect{minPixel[0], minPixel[1], maxPixel[0] - minPixel[0], maxPixel[1] - minPixel[1]};
+  return intersectScreenRects(portalRect, viewRect);
+}
+
+// NOTE: The player may be standing inside the backing box of a portal in focus
+bool portalInFocus(const PortalViewpoint& viewpoint, u32 sceneIndex, const Portal& portal) {
+  vec2 portalNormalPerp = vec2{portal.normal[1], -portal.normal[0]};
+  vec2 portalToEye = viewpoint.eye.xy - portal.centerPosition.xy;
+  return viewpoint.sceneIndex == sceneIndex && abs(dot(portalToEye, portalNormalPerp)) < (portal.dimens[0] * 0.5f);
+}
+
+// NOTE: An empty rect is returned for portals that can't be seen
+ScreenRect visiblePortalRect(const World* world, const PortalViewpoint& viewpoint, u32 sceneIndex, const Portal& portal,
+                             const vec3& vantagePoint, const mat4& projectionMat, const ScreenRect& viewRect) {
+  vec2 portalToVantagePoint = vantagePoint.xy - portal.centerPosition.xy;
+  if(!similarDirection(portalToVantagePoint, portal.normal)) { return ScreenRect{viewRect.x, viewRect.y, 0, 0}; }
+  // NOTE: The backing box of a portal in focus reaches behind the quad, it is given the whole view
+  if(portalInFocus(viewpoint, sceneIndex, portal)) { return viewRect; }
+  return portalScreenRect(world, portal, projectionMat * viewpoint.view, viewRect);
+}
+
+mat4 portalProjectionMatrix(const World* world, const mat4& view, const Portal& portal) {
+  vec3 portalNormal_viewSpace = (view * Vec4(-portal.normal, 0.0f, 0.0f)).xyz;
+  vec3 portalCenterPos_viewSpace = (view * Vec4(portal.centerPosition, 1.0f)).xyz;
+  return world->display.width > world->display.height ?
+         obliquePerspective_fovHorz(world->display.fov, world->display.aspect, near, far, portalNormal_viewSpace, portalCenterPos_viewSpace) :
+         obliquePerspective(world->display.fov, world->display.aspect, near, far, portalNormal_viewSpace, portalCenterPos_viewSpace);
+}
+
+// NOTE: Rotating entities are given bounds that hold them at any yaw, so they never have to be updated
+void buildCullBounds(World* world, u32 sceneIndex) {
+  Scene* scene = world->scenes + sceneIndex;
+  clearCullBounds(&scene->cullBounds);
+
+  for(u32 entityIndex = 0; entityIndex < scene->entityCount; entityIndex++) {
+    const Entity& entity = scene->entities[entityIndex];
+    const BoundingBox& box = world->models[entity.modelIndex].boundingBox;
+    f32 min[3], max[3];
+    if(entity.flags & EntityType_Rotating) {
+      Entity unrotated = entity;
+      unrotated.yaw = 0.0f;
+      transformBoundingBox(box, entityModelMatrix(unrotated), min, max);
+      // NOTE: Yaw rotates about the entity's position, so the xy bounds become the circle swept by the furthest corner
+      f32 radiusSq = 0.0f;
+      for(u32 corner = 0; corner < 4; corner++) {
+        f32 x = (min[0] + ((corner & 1) ? (max[0] - min[0]) : 0.0f)) - entity.posXYZ[0];
+        f32 y = (min[1] + ((corner & 2) ? (max[1] - min[1]) : 0.0f)) - entity.posXYZ[1];
+        radiusSq = Max(radiusSq, (x * x) + (y * y));
+      }
+      f32 radius = sqrtf(radiusSq);
+      for(u32 axis = 0; axis < 2; axis++) {
+        min[axis] = entity.posXYZ[axis] - radius;
+        max[axis] = entity.posXYZ[axis] + radius;
+      }
+    } else {
+      transformBoundingBox(box, entityModelMatrix(entity), min, max);
+    }
+    addCullBounds(&scene->cullBounds, min, max);
+  }
+
+  for(u32 batchIndex = 0; batchIndex < scene->staticBatchCount; batchIndex++) {
+    const StaticBatch& batch = scene->staticBatches[batchIndex];
+    addCullBounds(&scene->cullBounds, batch.boundsMin, batch.boundsMax);
+  }
+  padCullBounds(&scene->cullBounds);
+}
+
+void drawPortals(World *world, RenderCommandList* commands, const u32 sceneIndex,
                  const vec3 vantagePoint,
                  const mat4 &projectionMat,
+                 const ScreenRect &viewRect,
                  const u32 portalsMaxDepth,
                  const u32 portalDepth = 0,
                  const u32 sceneMask = CLEAR_STENCIL_VALUE) {
   if(portalDepth == portalsMaxDepth) { return; }
+  assert(portalsMaxDepth <= MAX_PORTAL_DEPTH);
 
   Scene* scene = world->scenes + sceneIndex;
   mat4 focusPortalAdjustmentModelMat =
           scale_mat4(vec3{1.0f, PORTAL_BACKING_BOX_DEPTH, 1.0f}) *
           translate_mat4({0.0f, 0.5f, 0.0f});
-  vec2 playerViewDir = -(world->player.pos.xyz.xy / world->player.pos.radius);
+  PortalViewpoint viewpoint{world->player.pos.xyz, world->UBOs.projectionViewModelUbo.view, world->currentSceneIndex};
 
   bool portalMightBeOnScreens[MAX_PORTALS];
+  ScreenRect portalRects[MAX_PORTALS];
   mat4 portalModelMats[MAX_PORTALS];
   VertexAtt* portalVertAtts[MAX_PORTALS];
-  vec3 portalVantagePoint[MAX_PORTALS];
 
-  glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.projectionViewModelUboId);
-  glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, projection), sizeof(mat4), &projectionMat);
-  glColorMask(false, false, false, false);
-  glStencilFunc(GL_EQUAL, sceneMask, 0xFF);
-  glUseProgram(world->vertexStageOnlyShader.id);
+  recordProjectionMatrix(commands, projectionMat);
+  pushColorMask(commands, false);
+  pushStencilFunc(commands, GL_EQUAL, sceneMask, 0xFF);
+  pushUseProgram(commands, world->vertexStageOnlyShader.id);
 
   // draw portal quads to depth buffer to properly handle occlusion amongst portals
   for(u32 portalIndex = 0; portalIndex < scene->portalCount; portalIndex++) {
     const Portal &portal = scene->portals[portalIndex];
-    vec2 portalNormalPerp = vec2{portal.normal[1], -portal.normal[0]};
-    f32 halfPortalWidth = portal.dimens[0] * 0.5f;
-    vec2 centerToSide = (portalNormalPerp * halfPortalWidth);
-
-    vec2 portalToVantagePoint = vantagePoint.xy - portal.centerPosition.xy;
-    vec2 portalToPlayer = world->player.pos.xyz.xy - portal.centerPosition.xy;
-    vec2 playerToPortal = -portalToPlayer;
-    // Player assumed to always face the origin. The radius is assumed to never be zero.
-    bool playerInFrontOfPortal = similarDirection(portalToVantagePoint, portal.normal);
-    vec2 playerToPortalSide1 = playerToPortal + centerToSide;
-    vec2 playerToPortalSide2 = playerToPortal - centerToSide;
-    bool playerLookingInDirOfPortal = similarDirection(playerViewDir, playerToPortalSide1) ||
-                                      similarDirection(playerViewDir, playerToPortalSide2);
-    portalMightBeOnScreens[portalIndex] = playerInFrontOfPortal && playerLookingInDirOfPortal;
+    portalRects[portalIndex] = visiblePortalRect(world, viewpoint, sceneIndex, portal, vantagePoint, projectionMat, viewRect);
+    portalMightBeOnScreens[portalIndex] = !screenRectEmpty(portalRects[portalIndex]);
     if(!portalMightBeOnScreens[portalIndex]) continue;
-    portalVantagePoint[portalIndex] = portal.centerPosition;
-    bool portalMightBeInFocus = world->currentSceneIndex == sceneIndex &&
-                                abs(dot(portalToPlayer, portalNormalPerp)) < halfPortalWidth;
 
+    bool portalMightBeInFocus = portalInFocus(viewpoint, sceneIndex, portal);
     portalModelMats[portalIndex] = quadModelMatrix(portal.centerPosition, Vec3(portal.normal, 0.0f), portal.dimens[0], portal.dimens[2]);
     if(portalMightBeInFocus) portalModelMats[portalIndex] = portalModelMats[portalIndex] * focusPortalAdjustmentModelMat;
     portalVertAtts[portalIndex] = portalMightBeInFocus ?
                                  world->commonVertAtts.cube(true, true) :
                                  world->commonVertAtts.quad(false);
-    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, model), sizeof(mat4), &portalModelMats[portalIndex]);
-    drawTriangles(portalVertAtts[portalIndex]);
+    recordModelMatrix(commands, portalModelMats[portalIndex]);
+    pushDrawTriangles(commands, portalVertAtts[portalIndex]);
   }
 
   u8 portalMask = sceneMask + 1;
@@ -264,171 +781,202 @@ void drawPortals(World *world, const u32 sceneIndex,
     const Portal& portal = scene->portals[portalIndex];
     const VertexAtt* portalVertAtt = portalVertAtts[portalIndex];
     const mat4& portalModelMat = portalModelMats[portalIndex];
-    glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.projectionViewModelUboId);
-    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, projection), sizeof(mat4), &projectionMat);
-    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, model), sizeof(mat4), &portalModelMat);
-    glColorMask(false, false, false, false);
+    pushScissor(commands, portalRects[portalIndex]);
+    recordProjectionMatrix(commands, projectionMat);
+    recordModelMatrix(commands, portalModelMat);
+    pushColorMask(commands, false);
     { // increment stencil mask to desired value for portal
-      glUseProgram(world->vertexStageOnlyShader.id);
-      glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
-      glDepthFunc(GL_EQUAL);
-      glStencilFunc(GL_EQUAL, sceneMask, 0xFF);
-      drawTriangles(portalVertAtt);
-      glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+      pushUseProgram(commands, world->vertexStageOnlyShader.id);
+      pushStencilOp(commands, GL_KEEP, GL_KEEP, GL_INCR);
+      pushDepthFunc(commands, GL_EQUAL);
+      pushStencilFunc(commands, GL_EQUAL, sceneMask, 0xFF);
+      pushDrawTriangles(commands, portalVertAtt);
+      pushStencilOp(commands, GL_KEEP, GL_KEEP, GL_KEEP);
     }
     { // clear depth buffer where the stencil for the portal was drawn
-      glDepthFunc(GL_ALWAYS);
-      glUseProgram(world->clearDepthShader.id);
-      glStencilFunc(GL_EQUAL, portalMask, 0xFF);
-      drawTriangles(portalVertAtt);
-      glDepthFunc(GL_LEQUAL);
+      pushDepthFunc(commands, GL_ALWAYS);
+      pushUseProgram(commands, world->clearDepthShader.id);
+      pushStencilFunc(commands, GL_EQUAL, portalMask, 0xFF);
+      pushDrawTriangles(commands, portalVertAtt);
+      pushDepthFunc(commands, GL_LEQUAL);
     }
-    glColorMask(true, true, true, true);
-
-    vec3 portalNormal_viewSpace = (world->UBOs.projectionViewModelUbo.view * Vec4(-portal.normal, 0.0f, 0.0f)).xyz;
-    vec3 portalCenterPos_viewSpace = (world->UBOs.projectionViewModelUbo.view * Vec4(portal.centerPosition, 1.0f)).xyz;
-    mat4 portalProjectionMat = world->display.width > world->display.height ?
-                               obliquePerspective_fovHorz(world->display.fov, world->display.aspect, near, far, portalNormal_viewSpace, portalCenterPos_viewSpace) :
-                               obliquePerspective(world->display.fov, world->display.aspect, near, far, portalNormal_viewSpace, portalCenterPos_viewSpace);
+    pushColorMask(commands, true);
 
-    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, projection), sizeof(mat4), &portalProjectionMat);
-    drawScene(world, portal.sceneDestination, portalMask);
-    drawPortals(world, portal.sceneDestination, portalVantagePoint[portalIndex], portalProjectionMat, portalsMaxDepth, innerPortalDepth, portalMask);
+    mat4 portalProjectionMat = portalProjectionMatrix(world, viewpoint.view, portal);
+    recordProjectionMatrix(commands, portalProjectionMat);
+    drawScene(world, commands, portal.sceneDestination, portalProjectionMat, portalMask);
+    drawPortals(world, commands, portal.sceneDestination, portal.centerPosition, portalProjectionMat, portalRects[portalIndex],
+                portalsMaxDepth, innerPortalDepth, portalMask);
 
     { // Clear stencil value after everything has been drawn
-      glColorMask(false, false, false, false);
-      glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.projectionViewModelUboId);
-      glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, projection), sizeof(mat4), &projectionMat);
-      glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, model), sizeof(mat4), &portalModelMat);
-      glUseProgram(world->vertexStageOnlyShader.id);
-      glStencilOp(GL_KEEP, GL_ZERO, GL_ZERO);
-      glStencilFunc(GL_EQUAL, portalMask, 0xFF);
-      drawTriangles(portalVertAtt);
-      glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
-      glColorMask(true, true, true, true);
+      pushScissor(commands, portalRects[portalIndex]);
+      pushColorMask(commands, false);
+      recordProjectionMatrix(commands, projectionMat);
+      recordModelMatrix(commands, portalModelMat);
+      pushUseProgram(commands, world->vertexStageOnlyShader.id);
+      pushStencilOp(commands, GL_KEEP, GL_ZERO, GL_ZERO);
+      pushStencilFunc(commands, GL_EQUAL, portalMask, 0xFF);
+      pushDrawTriangles(commands, portalVertAtt);
+      pushStencilOp(commands, GL_KEEP, GL_KEEP, GL_KEEP);
+      pushColorMask(commands, true);
     }
   }
-  glColorMask(true, true, true, true);
-  glStencilFunc(GL_ALWAYS, 0xFF, 0xFF);
+  pushScissor(commands, viewRect);
+  pushColorMask(commands, true);
+  pushStencilFunc(commands, GL_ALWAYS, 0xFF, 0xFF);
 }
 
-void drawScene(World* world, const u32 sceneIndex, u32 sceneMask) {
+void drawScene(World* world, RenderCommandList* commands, const u32 sceneIndex, const mat4& projectionMat, u32 sceneMask) {
   Scene* scene = world->scenes + sceneIndex;
-
-  glStencilFunc(GL_EQUAL, sceneMask, 0xFF);
-
-  if(scene->skyboxTexture != TEXTURE_ID_NO_TEXTURE) {
-    bindActiveTextureCubeMap(skyboxActiveTextureIndex, scene->skyboxTexture);
-    setSamplerCube(world->skyboxShader.id, skyboxTexUniformName, skyboxActiveTextureIndex);
+  if(!scene->drawList.valid) { buildSceneDrawList(world, sceneIndex); }
+
+  // NOTE: Padded, as the SIMD culling writes whole groups of four
+  u8 visible[ArrayCount(scene->entities) + ArrayCount(scene->staticBatches) + 3];
+  assert(scene->cullBounds.count == scene->entityCount + scene->staticBatchCount);
+  Frustum frustum = extractFrustum(projectionMat * world->UBOs.projectionViewModelUbo.view);
+  cullBounds(frustum, scene->cullBounds, visible, &world->cullStats);
+  const u8* visibleEntities = visible;
+  const u8* visibleStaticBatches = visible + scene->entityCount;
+
+  pushStencilFunc(commands, GL_EQUAL, sceneMask, 0xFF);
+
+  // NOTE: Scenes sharing a skybox array only differ by the skybox layer in the light UBO
+  if(scene->skyboxTexture != TEXTURE_ID_NO_TEXTURE && scene->skyboxTexture != world->boundSkyboxTexture) {
+    pushBindTexture(commands, skyboxActiveTextureIndex, skyboxTextureTarget(), scene->skyboxTexture);
+    world->boundSkyboxTexture = scene->skyboxTexture;
   }
 
-  // update scene light uniform buffer object
-  {
-    const u32 maxLights = ArrayCount(world->UBOs.multiLightUbo.dirPosLightStack);
-    assert((scene->dirLightCount + scene->posLightCount) <= maxLights);
-
-    // NOTE: The lights are on a single double ended array where directional lights are added to the beginning
-    // and directional lights are added to the end.
-    world->UBOs.multiLightUbo.dirLightCount = scene->dirLightCount;
-    for(u32 i = 0; i < scene->dirLightCount; ++i) {
-      world->UBOs.multiLightUbo.dirPosLightStack[i].colorAndPower = scene->dirPosLightStack[i].colorAndPower;
-      world->UBOs.multiLightUbo.dirPosLightStack[i].pos.xyz = scene->dirPosLightStack[i].pos;
-    }
-
-    world->UBOs.multiLightUbo.posLightCount = scene->posLightCount;
-    for(u32 i = 0; i < scene->posLightCount; ++i) {
-      world->UBOs.multiLightUbo.dirPosLightStack[maxLights - i].colorAndPower = scene->dirPosLightStack[maxLights - i].colorAndPower;
-      world->UBOs.multiLightUbo.dirPosLightStack[maxLights - i].pos.xyz = scene->dirPosLightStack[maxLights - i].pos;
+  pushBindUniformBuffer(commands, multiLightUBOBindingIndex, scene->lightUboId, sizeof(MultiLightUBO));
+
+  // instance matrices of the visible instances of each group, shared by all of the group's draws
+  u32 instanceSlotOffsets[ArrayCount(scene->instanceGroups)];
+  u32 instanceCounts[ArrayCount(scene->instanceGroups)];
+  for(u32 groupIndex = 0; groupIndex < scene->instanceGroupCount; ++groupIndex) {
+    const InstanceGroup& group = scene->instanceGroups[groupIndex];
+    mat4 instanceModelMatrices[MAX_INSTANCES];
+    u32 instanceCount = 0;
+    for(u32 i = 0; i < group.entityCount; i++) {
+      if(!visibleEntities[group.entityIndices[i]]) { continue; }
+      instanceModelMatrices[instanceCount++] = entityModelMatrix(scene->entities[group.entityIndices[i]]);
     }
-
-    world->UBOs.multiLightUbo.ambientLight = scene->ambientLightColorAndPower;
-
-    glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.multiLightUboId);
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(MultiLightUBO), &world->UBOs.multiLightUbo);
+    instanceCounts[groupIndex] = instanceCount;
+    if(instanceCount > 0) { instanceSlotOffsets[groupIndex] = addInstanceMatrices(commands, instanceModelMatrices, instanceCount); }
   }
 
-  struct LOCAL_FUNCS {
-    static void drawModel(World* world, const ShaderProgram& shader, const Model& model, const mat4& modelMat) {
-      glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.projectionViewModelUboId);
-      glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, model), sizeof(mat4), &modelMat);
-
-      glUseProgram(shader.id);
-      if(shader.noiseTextureId != TEXTURE_ID_NO_TEXTURE) {
-        bindActiveTextureSampler2d(noiseActiveTextureIndex, shader.noiseTextureId);
-        setSampler2D(shader.id, noiseTexUniformName, noiseActiveTextureIndex);
+  // NOTE: Draws are sorted, so state is only recorded when it differs from the draw before
+  GLuint program = 0;
+  GLuint noiseTexture = TEXTURE_ID_NO_TEXTURE;
+  u32 boundInstanceGroup = U32_MAX;
+  for(const SceneDraw& draw: scene->drawList.draws) {
+    u32 instanceCount = 1;
+    switch(draw.source) {
+      case SceneDrawSource_StaticBatch: {
+        if(!visibleStaticBatches[draw.sourceIndex]) { continue; }
+        recordModelMatrix(commands, draw.modelMatrix);
+        break;
       }
-      // TODO: Should some of this logic be moved to drawModel()?
-      for(u32 meshIndex = 0; meshIndex < model.meshCount; ++meshIndex) {
-        Mesh* mesh = model.meshes + meshIndex;
-        if(mesh->textureData.baseColor[3] != 0.0f) {
-          setUniform(shader.id, baseColorUniformName, mesh->textureData.baseColor.xyz);
+      case SceneDrawSource_InstanceGroup: {
+        instanceCount = instanceCounts[draw.sourceIndex];
+        if(instanceCount == 0) { continue; }
+        if(boundInstanceGroup != draw.sourceIndex) {
+          pushBindInstanceMatrices(commands, instanceSlotOffsets[draw.sourceIndex], instanceCount);
+          boundInstanceGroup = draw.sourceIndex;
         }
-        if(mesh->textureData.albedoTextureId != TEXTURE_ID_NO_TEXTURE) {
-          bindActiveTextureSampler2d(albedoActiveTextureIndex, mesh->textureData.albedoTextureId);
-          setSampler2D(shader.id, albedoTexUniformName, albedoActiveTextureIndex);
-        }
-        if(mesh->textureData.normalTextureId != TEXTURE_ID_NO_TEXTURE) {
-          bindActiveTextureSampler2d(normalActiveTextureIndex, mesh->textureData.normalTextureId);
-          setSampler2D(shader.id, normalTexUniformName, normalActiveTextureIndex);
-        }
-
-        drawTriangles(&mesh->vertexAtt);
+        break;
+      }
+      case SceneDrawSource_Entity: {
+        if(!visibleEntities[draw.sourceIndex]) { continue; }
+        recordModelMatrix(commands, draw.modelMatrixChanges ? entityModelMatrix(scene->entities[draw.sourceIndex]) : draw.modelMatrix);
+        break;
+      }
+      case SceneDrawSource_PortalBacking: {
+        recordModelMatrix(commands, draw.modelMatrix);
+        break;
       }
     }
-  };
 
-  // draw entities
-  for(u32 sceneEntityIndex = 0; sceneEntityIndex < scene->entityCount; ++sceneEntityIndex) {
-    Entity* entity = &scene->entities[sceneEntityIndex];
-    ShaderProgram shader = world->shaders[entity->shaderIndex];
-    Model model = world->models[entity->modelIndex];
-    mat4 modelMatrix = scaleRotTrans_mat4(entity->scaleXYZ, vec3{0.0f, 0.0f, 1.0f}, entity->yaw, entity->posXYZ);
-    LOCAL_FUNCS::drawModel(world, shader, model, modelMatrix);
-  }
-
-  // draw portal backs
-  for(u32 portalIndex = 0; portalIndex < scene->portalCount; ++portalIndex) {
-    const Portal& portal = scene->portals[portalIndex];
-    if(portal.backingModelIndex == WORLD_INFO_NO_INDEX) { continue; }
-    ShaderProgram shader = world->shaders[portal.backingShaderIndex];
-    Model model = world->models[portal.backingModelIndex];
-    f32 yaw = atan2(portal.normal[1], portal.normal[0]) + PiOverTwo32;
-    vec3 portalBackOffset = Vec3(-(0.5 * portal.dimens[1]) * portal.normal, 0.0f);
-    mat4 modelMatrix = scaleRotTrans_mat4(portal.dimens, vec3{0.0f, 0.0f, 1.0f}, yaw, portal.centerPosition + portalBackOffset);
-    LOCAL_FUNCS::drawModel(world, shader, model, modelMatrix);
+    if(draw.programId != program) {
+      pushUseProgram(commands, draw.programId);
+      program = draw.programId;
+    }
+    if(draw.noiseTextureId != TEXTURE_ID_NO_TEXTURE && draw.noiseTextureId != noiseTexture) {
+      pushBindTexture(commands, noiseActiveTextureIndex, GL_TEXTURE_2D, draw.noiseTextureId);
+      noiseTexture = draw.noiseTextureId;
+    }
+    if(draw.baseColorLocation != -1) {
+      pushSetUniform(commands, draw.programId, draw.baseColorLocation, draw.baseColor);
+    }
+    if(draw.albedoTextureId != TEXTURE_ID_NO_TEXTURE && draw.albedoTextureId != world->boundAlbedoTexture) {
+      pushBindTexture(commands, albedoActiveTextureIndex, GL_TEXTURE_2D, draw.albedoTextureId);
+      world->boundAlbedoTexture = draw.albedoTextureId;
+    }
+    if(draw.normalTextureId != TEXTURE_ID_NO_TEXTURE && draw.normalTextureId != world->boundNormalTexture) {
+      pushBindTexture(commands, normalActiveTextureIndex, GL_TEXTURE_2D, draw.normalTextureId);
+      world->boundNormalTexture = draw.normalTextureId;
+    }
+    pushDrawTriangles(commands, draw.vertexAtt, draw.vertexAtt->indexCount, 0, instanceCount);
   }
 
   // draw skybox if one exists
   if(scene->skyboxTexture != TEXTURE_ID_NO_TEXTURE) {
-    glUseProgram(world->skyboxShader.id);
-    const mat4 identityMat4 = identity_mat4();
-    glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.projectionViewModelUboId);
-    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, model), sizeof(mat4), &identityMat4);
-    drawTriangles(world->commonVertAtts.cube(true));
+    pushUseProgram(commands, world->skyboxShader.id);
+    recordModelMatrix(commands, identity_mat4());
+    pushDrawTriangles(commands, world->commonVertAtts.cube(true));
   }
 }
 
-// Fuse this properly with drawPortals()
-void drawCurrentScene(World* world)
+// NOTE: Returns false when none of the world's skybox arrays hold the scene's skybox
+bool loadSceneSkyboxLayer(World* world, Scene* scene) {
+  for(u32 arrayIndex = 0; arrayIndex < world->skyboxArrayCount; arrayIndex++) {
+    const CubeMapArray& skyboxArray = world->skyboxArrays[arrayIndex];
+    u32 layer = skyboxArray.info.layerIndex(scene->skyboxFileName);
+    if(layer != U32_MAX) {
+      loadCubeMapArrayLayer(skyboxArray, layer, scene->ambientSH);
+      scene->skyboxTexture = skyboxArray.textureId;
+      scene->skyboxLayer = layer;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Records the whole frame without touching GL, which lets it be replayed by either render command backend
+void recordCurrentScene(World* world, RenderCommandList* commands)
 {
-    // draw
+    commands->clear();
+
     u8 sceneMask = CLEAR_STENCIL_VALUE;
-    glClearDepthf(1.0f);
-    glClearStencil(sceneMask);
-    glStencilMask(0xFF);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    ScreenRect displayRect{0, 0, (s32)world->display.width, (s32)world->display.height};
+    pushScissor(commands, displayRect);
+    pushClear(commands, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, 1.0f, sceneMask);
+
+    // NOTE: The skybox is bound again every frame, as the GL state may have changed in between recording & replaying
+    world->boundSkyboxTexture = TEXTURE_ID_NO_TEXTURE;
+    world->boundAlbedoTexture = TEXTURE_ID_NO_TEXTURE;
+    world->boundNormalTexture = TEXTURE_ID_NO_TEXTURE;
+    world->cullStats = {};
 
     // universal matrices in UBO
-    glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.fragUboId);
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FragUBO), &world->UBOs.fragUbo);
-    glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.projectionViewModelUboId);
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, offsetof(ProjectionViewModelUBO, model), &world->UBOs.projectionViewModelUbo);
+    pushUpdateUniformBuffer(commands, world->UBOs.fragUboId, 0, sizeof(FragUBO), &world->UBOs.fragUbo);
+    recordProjectionMatrix(commands, world->UBOs.projectionViewModelUbo.projection);
+    recordViewMatrix(commands, world->UBOs.projectionViewModelUbo.view);
 
     // draw scene
-    drawScene(world, world->currentSceneIndex, sceneMask);
+    drawScene(world, commands, world->currentSceneIndex, world->UBOs.projectionViewModelUbo.projection, sceneMask);
 
     // draw portals
-    drawPortals(world, world->currentSceneIndex, world->player.pos.xyz, world->UBOs.projectionViewModelUbo.projection, 2);
+    drawPortals(world, commands, world->currentSceneIndex, world->player.pos.xyz, world->UBOs.projectionViewModelUbo.projection, displayRect,
+                world->portalDepthController.depth);
+}
+
+void drawCurrentScene(World* world)
+{
+    recordCurrentScene(world, &world->renderCommands);
+
+    // NOTE: Loading & GL calls made outside of the render commands can change the state between frames
+    invalidateGLStateCache(&world->glState);
+    resetGLStateCacheCounts(&world->glState);
+    executeRenderCommandsGL(world->renderCommands, &world->UBOs.projectionViewModelRing, &world->glState);
 }
 
 void updateEntities(World* world) {
@@ -458,17 +1006,50 @@ void cleanupScene(Scene* scene) {
   }
   scene->portalCount = 0;
 
+  scene->colliders.clear();
+
+  VertexAtt batchVertexAtts[ArrayCount(scene->staticBatches)];
+  for(u32 batchIndex = 0; batchIndex < scene->staticBatchCount; batchIndex++) {
+    batchVertexAtts[batchIndex] = scene->staticBatches[batchIndex].mesh.vertexAtt;
+    scene->staticBatches[batchIndex] = {};
+  }
+  deleteVertexAtts(batchVertexAtts, scene->staticBatchCount);
+  scene->staticBatchCount = 0;
+
+  for(u32 groupIndex = 0; groupIndex < scene->instanceGroupCount; groupIndex++) {
+    scene->instanceGroups[groupIndex] = {};
+  }
+  scene->instanceGroupCount = 0;
+
+  clearCullBounds(&scene->cullBounds);
+
+  if(scene->lightUboId != 0) {
+    glDeleteBuffers(1, &scene->lightUboId);
+    scene->lightUboId = 0;
+  }
+  scene->drawList = {};
+
   glDeleteTextures(1, &scene->skyboxTexture);
   scene->skyboxTexture = TEXTURE_ID_NO_TEXTURE;
 }
 
 void cleanupWorld(World* world) {
   for(u32 sceneIndex = 0; sceneIndex < world->sceneCount; sceneIndex++) {
-    cleanupScene(world->scenes + sceneIndex);
+    Scene* scene = world->scenes + sceneIndex;
+    for(u32 arrayIndex = 0; arrayIndex < world->skyboxArrayCount; arrayIndex++) {
+      if(scene->skyboxTexture == world->skyboxArrays[arrayIndex].textureId) { // NOTE: Shared, deleted below
+        scene->skyboxTexture = TEXTURE_ID_NO_TEXTURE;
+      }
+    }
+    cleanupScene(scene);
+  }
+
+  for(u32 arrayIndex = 0; arrayIndex < world->skyboxArrayCount; arrayIndex++) {
+    glDeleteTextures(1, &world->skyboxArrays[arrayIndex].textureId);
+    world->skyboxArrays[arrayIndex] = {};
   }
 
-  deleteModels(world->models, world->modelCount);
-  memset(world->models, 0, sizeof(Model) * world->modelCount);
+  deleteModels(world->models, world->modelCount); // NOTE: also clears the models
 
   deleteShaderPrograms(world->shaders, world->shaderCount);
   deleteShaderPrograms(&world->vertexStageOnlyShader, 1);
@@ -514,6 +1095,18 @@ void loadWorld(World* world) {
     }
   }
 
+  { // skybox arrays
+    // NOTE: Only storage is allocated here, each layer is streamed in as the scene using it is loaded
+    if(cubeMapArraySupport_GLOBAL) {
+      for(const std::string& skyboxArrayFileName: worldInfo.skyboxArrayFileNames) {
+        assert(world->skyboxArrayCount < ArrayCount(world->skyboxArrays));
+        if(loadCubeMapArrayTexture(skyboxArrayFileName.c_str(), world->skyboxArrays + world->skyboxArrayCount)) {
+          world->skyboxArrayCount++;
+        }
+      }
+    }
+  }
+
   u32 worldSceneIndices[ArrayCount(world->scenes)] = {};
   { // scenes
     for(u32 sceneIndex = 0; sceneIndex < sceneCount; sceneIndex++) {
@@ -527,7 +1120,13 @@ void loadWorld(World* world) {
 
       if(!sceneInfo.skyboxFileName.empty()) { // if we have a skybox...
         scene->skyboxFileName = sceneInfo.skyboxFileName;
-        loadCubeMapTexture(scene->skyboxFileName.c_str(), &scene->skyboxTexture);
+        if(!loadSceneSkyboxLayer(world, scene)) {
+          scene->skyboxLayer = 0;
+          if(!loadCubeMapTexture(scene->skyboxFileName.c_str(), &scene->skyboxTexture, scene->ambientSH)) {
+            LOGE("Skybox %s could not be loaded on its own, it may only have been baked into a cube map array\n", scene->skyboxFileName.c_str());
+            scene->skyboxTexture = TEXTURE_ID_NO_TEXTURE;
+          }
+        }
       } else {
         scene->skyboxTexture = TEXTURE_ID_NO_TEXTURE;
       }
@@ -555,6 +1154,11 @@ void loadWorld(World* world) {
         adjustAmbientLight(world, worldSceneIndices[sceneInfo.index],
                            sceneInfo.ambientLightColorAndPower);
       }
+
+      buildStaticBatches(world, worldSceneIndices[sceneInfo.index]);
+      buildInstanceGroups(world, worldSceneIndices[sceneInfo.index]);
+      buildCullBounds(world, worldSceneIndices[sceneInfo.index]);
+      uploadSceneLights(world, worldSceneIndices[sceneInfo.index]);
     }
 
     // we have to iterate over the worlds once more for portals, as the scene destination index requires
@@ -586,8 +1190,6 @@ void updatePortalSceneWindow(World* world, u32 width, u32 height) {
   world->UBOs.projectionViewModelUbo.projection = width > height ?
       perspective_fovHorz(world->display.fov, world->display.aspect, near, far) :
       perspective(world->display.fov, world->display.aspect, near, far);
-  glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.projectionViewModelUboId);
-  glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, projection), sizeof(mat4), &world->UBOs.projectionViewModelUbo.projection);
 }
 
 void initPortalScene(World* world) {
@@ -603,6 +1205,7 @@ void initPortalScene(World* world) {
   glFrontFace(GL_CCW);
   glCullFace(GL_BACK);
   glEnable(GL_STENCIL_TEST);
+  glEnable(GL_SCISSOR_TEST); // NOTE: Portals limit the passes drawn through them to their screen rect
 
   // Universal shaders
   {
@@ -613,117 +1216,94 @@ void initPortalScene(World* world) {
 
   // UBOs
   {
-    glGenBuffers(1, &world->UBOs.projectionViewModelUboId);
-    glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.projectionViewModelUboId);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(ProjectionViewModelUBO), NULL, GL_STREAM_DRAW);
-    glBindBufferRange(GL_UNIFORM_BUFFER, projectionViewModelUBOBindingIndex, world->UBOs.projectionViewModelUboId, 0, sizeof(ProjectionViewModelUBO));
+    // NOTE: Bound per draw, to the range holding that draw's matrices
+    initUniformBufferRing(&world->UBOs.projectionViewModelRing, projectionViewModelUBOBindingIndex);
 
     glGenBuffers(1, &world->UBOs.fragUboId);
     glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.fragUboId);
     glBufferData(GL_UNIFORM_BUFFER, sizeof(FragUBO), NULL, GL_STREAM_DRAW);
     glBindBufferRange(GL_UNIFORM_BUFFER, fragUBOBindingIndex, world->UBOs.fragUboId, 0, sizeof(FragUBO));
-
-    glGenBuffers(1, &world->UBOs.multiLightUboId);
-    glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.multiLightUboId);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(MultiLightUBO), NULL, GL_DYNAMIC_DRAW);
-    glBindBufferRange(GL_UNIFORM_BUFFER, multiLightUBOBindingIndex, world->UBOs.multiLightUboId, 0, sizeof(MultiLightUBO));
     glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
-    glGenBuffers(1, &world->UBOs.multiLightUboId);
-    glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.multiLightUboId);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(MultiLightUBO), NULL, GL_DYNAMIC_DRAW);
-    glBindBufferRange(GL_UNIFORM_BUFFER, multiLightUBOBindingIndex, world->UBOs.multiLightUboId, 0, sizeof(MultiLightUBO));
+    // NOTE: Each scene's lights are in a uniform buffer of its own, see uploadSceneLights()
   }
 
+  initGPUFrameTimer(&world->gpuFrameTimer);
+  initPortalDepthController(&world->portalDepthController, TARGET_FRAME_MS, MIN_PORTAL_DEPTH, MAX_PORTAL_DEPTH, START_PORTAL_DEPTH);
+
   world->stopWatch = StopWatch();
 
   loadWorld(world);
 }
 
 /*
-  NOTE: Although the scenes visual representation is all neatly stored in a structure that can be edited by the developer willy nilly
-    And rendering things will work just as anticipated. That is currently not true for any sort of collision detection and resolution.
-    This collision detection is hard baked for the current state of the worlds as of it's creation.
-
+  NOTE: The player is treated as a sphere sliding in the z = 1.5 plane. Static entities and portal backings are collided
+    against their baked BVHs. Rotating entities are assumed to fit inside a bounding sphere around the origin.
 */
 void collisionDetectionAndCorrection(World* world, PlayerPosition desiredPosition) {
   PlayerPosition startingPlayerPos = world->player;
   PlayerPosition correctedPlayerPos = desiredPosition;
-  const f32 outerBoundingSphereRadius = 75.0f;
-
-  if(world->currentSceneIndex == 0) { // if gate scene...
-    const vec2 quarterFoldedXY = vec2{abs(correctedPlayerPos.pos.xyz[0]), abs(correctedPlayerPos.pos.xyz[1])};
-    const vec2 columnXY = vec2{1.768f, 1.768 };
-    const f32 columnRadius = 0.5f;
-    const f32 columnRadiusSq = columnRadius * columnRadius;
-
-    // intersecting column? Taking advantage of column symmetry.
-    const vec2 foldedXY_columnOrigin = quarterFoldedXY - columnXY;
-    if(magnitudeSquared(foldedXY_columnOrigin) < columnRadiusSq) { // intersecting with a column
-      vec2 foldedXY_dirFromColumn = normalize(foldedXY_columnOrigin);
-      vec2 foldedCorrection = (foldedXY_dirFromColumn * columnRadius) - foldedXY_columnOrigin;
-      vec2 unfoldedCorrection = vec2{
-          correctedPlayerPos.pos.xyz[0] > 0 ? foldedCorrection[0]: -foldedCorrection[0],
-          correctedPlayerPos.pos.xyz[1] > 0 ? foldedCorrection[1]: -foldedCorrection[1]
-      };
-      correctedPlayerPos = PlayerPosition::fromXYZ(correctedPlayerPos.pos.xyz[0] + unfoldedCorrection[0], correctedPlayerPos.pos.xyz[1] + unfoldedCorrection[1], correctedPlayerPos.pos.xyz[2]);
-    }
-  }
 
   // correct potential collision with "shape"
-  const f32 shapeBoundingSphereRadius = 1.5f;
-  f32 newRadius = Max(correctedPlayerPos.pos.radius, shapeBoundingSphereRadius);
+  f32 newRadius = Max(correctedPlayerPos.pos.radius, PLAYER_MIN_RADIUS);
   correctedPlayerPos = PlayerPosition::fromPolar(correctedPlayerPos.pos.theta, newRadius);
 
-  // prevent collision with portal backings
   Scene &scene = world->scenes[world->currentSceneIndex];
+  const assets::BVH* colliders[ArrayCount(scene.entities) + MAX_PORTALS];
+  u32 colliderCount = 0;
+  for(const assets::BVH& collider: scene.colliders) {
+    colliders[colliderCount++] = &collider;
+  }
   for (u32 i = 0; i < scene.portalCount; i++) {
-    Portal &portal = scene.portals[i];
-    if(portal.backingModelIndex == WORLD_INFO_NO_INDEX) { continue; }
-    // this logic assumes the portals normal never points even partially in the z dimension
-    vec3 portalForward = Vec3(portal.normal, 0.0f); // forward == opening
-    vec3 portalRight = cross(portalForward, vec3{0.f, 0.f, 1.f});
-    vec3 deltaFromCenterLeftRight = (0.5f * portal.dimens[0] * portalRight);
-    // check if the old position was not in front of the portal
-    f32 maxPortalForwardDirection = dot(portal.centerPosition, portalForward);
-    f32 startingPlayerInForwardDirection = dot(startingPlayerPos.pos.xyz, portalForward);
-    bool playerWasInFrontOfPortal = startingPlayerInForwardDirection >= maxPortalForwardDirection;
-    if (!playerWasInFrontOfPortal) { // only check collision detection if player was not in front of the portal.
-      f32 portalBufferDepth = 0.5f;
-      f32 minPortalForwardDirection =
-          maxPortalForwardDirection - portal.dimens[1] - portalBufferDepth;
-      f32 maxPortalRightDirection =
-          dot(portal.centerPosition + deltaFromCenterLeftRight, portalRight) + portalBufferDepth;
-      f32 minPortalRightDirection =
-          maxPortalRightDirection - portal.dimens[0] - (2.0f * portalBufferDepth);
-      f32 desiredPosInForwardDir = dot(correctedPlayerPos.pos.xyz, portalForward);
-      f32 desiredPosInRightDir = dot(correctedPlayerPos.pos.xyz, portalRight);
-      if (desiredPosInForwardDir > minPortalForwardDirection &&
-          desiredPosInForwardDir < maxPortalForwardDirection &&
-          desiredPosInRightDir > minPortalRightDirection &&
-          desiredPosInRightDir < maxPortalRightDirection) {
-        // desired position will cause a collision and is in need of correction
-        // either push it out the back or out the side
-        f32 correctionDeltaForward = minPortalForwardDirection - desiredPosInForwardDir;
-        f32 correctionDeltaLeft = minPortalRightDirection - desiredPosInRightDir;
-        f32 correctionDeltaRight = maxPortalRightDirection - desiredPosInRightDir;
-        correctionDeltaRight =
-            abs(correctionDeltaLeft) < abs(correctionDeltaRight) ? correctionDeltaLeft
-                                                                 : correctionDeltaRight;
-        if (abs(correctionDeltaForward) < abs(correctionDeltaRight)) {
-          // push out the bottom
-          correctedPlayerPos = PlayerPosition::fromXYZ(
-              correctedPlayerPos.pos.xyz + (correctionDeltaForward * portalForward));
-        } else {
-          // push out the side
-          correctedPlayerPos = PlayerPosition::fromXYZ(
-              correctedPlayerPos.pos.xyz + (correctionDeltaRight * portalRight));
+    const Portal &portal = scene.portals[i];
+    if(portal.backingCollider.nodes.empty()) { continue; }
+    // only collide with portal backings from behind, walking in from the front is handled by the portal crossing below
+    bool playerWasInFrontOfPortal = dot(startingPlayerPos.pos.xyz, Vec3(portal.normal, 0.0f)) >= dot(portal.centerPosition, Vec3(portal.normal, 0.0f));
+    if(!playerWasInFrontOfPortal) {
+      colliders[colliderCount++] = &portal.backingCollider;
+    }
+  }
+
+  if(colliderCount > 0) {
+    // sweep and slide: move until the first hit, then project the remaining movement onto the surface that was hit
+    vec3 position = startingPlayerPos.pos.xyz;
+    vec3 target = correctedPlayerPos.pos.xyz;
+    for(u32 slide = 0; slide < PLAYER_COLLISION_MAX_SLIDES; slide++) {
+      vec3 delta = target - position;
+      f32 deltaMagnitudeSq = dot(delta, delta);
+      if(deltaMagnitudeSq < 1e-10f) { break; }
+
+      const f32 start[3] = {position[0], position[1], position[2]};
+      const f32 end[3] = {target[0], target[1], target[2]};
+      assets::BVHHit closestHit;
+      closestHit.t = 1.0f;
+      bool hit = false;
+      for(u32 colliderIndex = 0; colliderIndex < colliderCount; colliderIndex++) {
+        assets::BVHHit colliderHit;
+        if(assets::sphereSweepBVH(*colliders[colliderIndex], start, end, PLAYER_COLLISION_RADIUS, &colliderHit) && colliderHit.t <= closestHit.t) {
+          closestHit = colliderHit;
+          hit = true;
         }
       }
+      if(!hit) {
+        position = target;
+        break;
+      }
+
+      f32 deltaMagnitude = sqrtf(deltaMagnitudeSq);
+      f32 travel = Max((closestHit.t * deltaMagnitude) - PLAYER_COLLISION_SKIN, 0.0f);
+      position = position + ((travel / deltaMagnitude) * delta);
+
+      // player height is fixed, so only slide along the horizontal part of the surface normal
+      vec3 slideNormal = vec3{closestHit.normal[0], closestHit.normal[1], 0.0f};
+      if(dot(slideNormal, slideNormal) < 1e-6f) { break; }
+      slideNormal = normalize(slideNormal);
+      vec3 remaining = target - position;
+      target = position + (remaining - (dot(remaining, slideNormal) * slideNormal));
     }
+    correctedPlayerPos = PlayerPosition::fromXYZ(position);
   }
 
-  correctedPlayerPos.pos.radius = Min(correctedPlayerPos.pos.radius, outerBoundingSphereRadius);
+  correctedPlayerPos.pos.radius = Min(correctedPlayerPos.pos.radius, PLAYER_MAX_RADIUS);
   world->player = correctedPlayerPos;
 
   // check portal collision
@@ -757,6 +1337,7 @@ void collisionDetectionAndCorrection(World* world, PlayerPosition desiredPositio
       // remove any transient portal in current scene. If any exist, it will be the last one.
       if(currentScene->portals[currentScene->portalCount - 1].transient) {
         currentScene->portalCount -= 1;
+        currentScene->drawList.valid = false;
       }
 
       world->currentSceneIndex = portal->sceneDestination;
@@ -827,10 +1408,24 @@ void drawPortalScene(World* world) {
   mat4 cameraMat = getViewMat(frameCamera);
   world->UBOs.projectionViewModelUbo.view = cameraMat;
 
-    drawCurrentScene(world);
+  // NOTE: CPU time is of recording & issuing the frame, eglSwapBuffers() waiting on the display is left out
+  // NOTE: So is the uniform buffer ring waiting on the GPU, which the GPU time already counts
+  f64 frameStartTime = getTime();
+  beginGPUFrameTimer(&world->gpuFrameTimer);
+  drawCurrentScene(world);
+  endGPUFrameTimer(&world->gpuFrameTimer);
+  f32 cpuFrameMs = (f32)((getTime() - frameStartTime) * 1000.0) - world->UBOs.projectionViewModelRing.lastFenceWaitMs;
+  updatePortalDepthController(&world->portalDepthController, cpuFrameMs, readGPUFrameTimer(&world->gpuFrameTimer));
+
+  if((world->frameCount++ % FRAME_STATS_LOG_INTERVAL) == 0) {
+    logCullStats(world->cullStats);
+    logGLStateCacheCounts(world->glState);
+  }
 }
 
 void deinitPortalScene(World* world) {
+  deinitGPUFrameTimer(&world->gpuFrameTimer);
+  deinitUniformBufferRing(&world->UBOs.projectionViewModelRing);
   cleanupWorld(world);
   deinitCommonVertexAtts(&world->commonVertAtts);
 }
\ No newline at end of file
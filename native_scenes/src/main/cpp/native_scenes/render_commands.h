@@ -0,0 +1,493 @@
+#pragma once
+
+/*
+ * Frames are recorded into a RenderCommandList instead of being issued to GL as they are built, keeping the frame logic
+ * free of GL calls. A backend then replays the list:
+ *  - executeRenderCommandsGL() issues the commands to GL through a GLStateCache, on device.
+ *  - executeRenderCommandsHeadless() only counts & validates the commands, so frames can be measured without a GPU.
+ * NOTE: Recording never touches GL, uniform locations come from the tables filled in when programs are linked.
+ *
+ * The projection, view & model matrices are recorded as state rather than commands. Every draw that follows a change
+ * copies them into a new slot of matrixSlots, which the GL backend uploads once per frame into a UniformBufferRing.
+ * Draws then only bind their slot's range. Instanced draws bind an InstanceUBO slot from the same buffer as well.
+ */
+#define UNIFORM_BUFFER_RING_FRAMES 3 // NOTE: Lets the CPU write a frame while the GPU may still read the last two
+#define UNIFORM_BUFFER_RING_INITIAL_SLOTS 128
+#define UNIFORM_BUFFER_RING_FENCE_TIMEOUT_NS 1000000000
+
+// NOTE: GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT may be no larger than 256, the actual value is queried by initUniformBufferRing()
+global_variable u32 uniformBufferOffsetAlignment_GLOBAL = 256;
+
+// NOTE: In pixels, with the origin at the bottom left like glScissor()
+struct ScreenRect {
+  s32 x;
+  s32 y;
+  s32 width;
+  s32 height;
+};
+
+ScreenRect intersectScreenRects(const ScreenRect& a, const ScreenRect& b) {
+  s32 minX = Max(a.x, b.x);
+  s32 minY = Max(a.y, b.y);
+  s32 maxX = Min(a.x + a.width, b.x + b.width);
+  s32 maxY = Min(a.y + a.height, b.y + b.height);
+  return ScreenRect{minX, minY, Max(maxX - minX, 0), Max(maxY - minY, 0)};
+}
+
+inline bool screenRectEmpty(const ScreenRect& rect) {
+  return rect.width <= 0 || rect.height <= 0;
+}
+
+enum RenderCommandType : u8 {
+#define RenderCommand(name) RenderCommandType_##name,
+#include "render_command.incl"
+#undef RenderCommand
+  RenderCommandType_Count
+};
+
+const char* mapRenderCommandTypeToString[] = {
+#define RenderCommand(name) #name,
+#include "render_command.incl"
+#undef RenderCommand
+};
+
+struct RenderCommand {
+  RenderCommandType type;
+  union {
+    struct { GLbitfield mask; f32 depth; s32 stencil; } clear;
+    struct { GLuint programId; } useProgram;
+    struct { GLuint arrayObject; } bindVertexArray;
+    struct { s32 activeIndex; GLenum target; GLuint textureId; } bindTexture;
+    struct { GLuint programId; GLint location; f32 values[3]; } setUniformVec3; // NOTE: programId is only for validation
+    struct { GLuint bufferId; u32 offset; u32 size; u32 dataOffset; } updateUniformBuffer; // data is in uniformData
+    struct { u32 bindingIndex; GLuint bufferId; u32 size; } bindUniformBuffer;
+    struct { u32 slotOffset; } bindMatrices; // into matrixSlots
+    struct { u32 slotOffset; u32 instanceCount; } bindInstanceMatrices; // into matrixSlots
+    struct { bool enabled; } colorMask;
+    struct { GLenum func; } depthFunc;
+    struct { GLenum func; s32 ref; u32 mask; } stencilFunc;
+    struct { GLenum stencilFail; GLenum depthFail; GLenum depthPass; } stencilOp;
+    ScreenRect scissor; // NOTE: Limits clears as well as draws
+    struct { u32 indexCount; u32 indexOffset; u8 indexTypeSize; u32 instanceCount; } drawTriangles;
+  };
+};
+
+struct RenderCommandList {
+  std::vector<RenderCommand> commands;
+  std::vector<u8> uniformData; // bytes of every uniform buffer update, kept out of the commands to keep them small
+  std::vector<u8> matrixSlots; // ProjectionViewModelUBOs & InstanceUBOs, each starting on a uniform buffer offset alignment
+  ProjectionViewModelUBO matrices; // NOTE: Only copied into a slot by the next draw
+  bool matricesChanged;
+
+  // NOTE: Keeps the allocations, lists are expected to be re-recorded every frame
+  void clear() {
+    commands.clear();
+    uniformData.clear();
+    matrixSlots.clear();
+    matricesChanged = true;
+  }
+};
+
+struct UniformBufferRing {
+  GLuint bufferId;
+  u32 bindingIndex;
+  u32 frameCapacity; // bytes, a multiple of the uniform buffer offset alignment
+  u32 frameIndex;
+  GLsync fences[UNIFORM_BUFFER_RING_FRAMES]; // NOTE: Signaled once the GPU is done with that frame's part of the ring
+  f32 lastFenceWaitMs; // time the last frame spent blocked on the GPU
+};
+
+struct RenderCommandStats {
+  u32 commandCounts[RenderCommandType_Count];
+  u32 commandCount;
+  u32 drawCount;
+  u32 triangleCount;
+  u32 stateChangeCount; // every command other than clears & draws
+  u64 uniformBufferBytes; // including the matrix slots
+  u32 validationErrorCount;
+};
+
+// ==== RECORDING ==== //
+internal_func inline RenderCommand* pushRenderCommand(RenderCommandList* list, RenderCommandType type) {
+  list->commands.emplace_back();
+  RenderCommand* command = &list->commands.back();
+  command->type = type;
+  return command;
+}
+
+void pushClear(RenderCommandList* list, GLbitfield mask, f32 depth, s32 stencil) {
+  RenderCommand* command = pushRenderCommand(list, RenderCommandType_Clear);
+  command->clear = {mask, depth, stencil};
+}
+
+void pushUseProgram(RenderCommandList* list, GLuint programId) {
+  pushRenderCommand(list, RenderCommandType_UseProgram)->useProgram = {programId};
+}
+
+void pushBindTexture(RenderCommandList* list, s32 activeIndex, GLenum target, GLuint textureId) {
+  pushRenderCommand(list, RenderCommandType_BindTexture)->bindTexture = {activeIndex, target, textureId};
+}
+
+void pushSetUniform(RenderCommandList* list, GLuint programId, GLint location, const vec3& value) {
+  pushRenderCommand(list, RenderCommandType_SetUniformVec3)->setUniformVec3 = {programId, location, {value[0], value[1], value[2]}};
+}
+
+void pushSetUniform(RenderCommandList* list, const ShaderProgram& shader, ShaderUniform uniform, const vec3& value) {
+  pushSetUniform(list, shader.id, shader.uniformLocations[uniform], value);
+}
+
+void pushUpdateUniformBuffer(RenderCommandList* list, GLuint bufferId, u32 offset, u32 size, const void* data) {
+  u32 dataOffset = (u32)list->uniformData.size();
+  list->uniformData.insert(list->uniformData.end(), (const u8*)data, (const u8*)data + size);
+  pushRenderCommand(list, RenderCommandType_UpdateUniformBuffer)->updateUniformBuffer = {bufferId, offset, size, dataOffset};
+}
+
+// NOTE: For buffers that are uploaded ahead of time, binds the whole buffer
+void pushBindUniformBuffer(RenderCommandList* list, u32 bindingIndex, GLuint bufferId, u32 size) {
+  pushRenderCommand(list, RenderCommandType_BindUniformBuffer)->bindUniformBuffer = {bindingIndex, bufferId, size};
+}
+
+void pushColorMask(RenderCommandList* list, bool enabled) {
+  pushRenderCommand(list, RenderCommandType_ColorMask)->colorMask = {enabled};
+}
+
+void pushDepthFunc(RenderCommandList* list, GLenum func) {
+  pushRenderCommand(list, RenderCommandType_DepthFunc)->depthFunc = {func};
+}
+
+void pushStencilFunc(RenderCommandList* list, GLenum func, s32 ref, u32 mask) {
+  pushRenderCommand(list, RenderCommandType_StencilFunc)->stencilFunc = {func, ref, mask};
+}
+
+void pushStencilOp(RenderCommandList* list, GLenum stencilFail, GLenum depthFail, GLenum depthPass) {
+  pushRenderCommand(list, RenderCommandType_StencilOp)->stencilOp = {stencilFail, depthFail, depthPass};
+}
+
+void pushScissor(RenderCommandList* list, const ScreenRect& rect) {
+  pushRenderCommand(list, RenderCommandType_Scissor)->scissor = rect;
+}
+
+internal_func inline u32 alignToUniformBufferOffset(u64 size) {
+  u32 alignment = uniformBufferOffsetAlignment_GLOBAL;
+  return (u32)(((size + alignment - 1) / alignment) * alignment);
+}
+
+// NOTE: Returns the offset of the new slot
+internal_func inline u32 addMatrixSlot(RenderCommandList* list, const void* data, u32 size) {
+  u32 slotOffset = (u32)list->matrixSlots.size();
+  list->matrixSlots.resize(slotOffset + alignToUniformBufferOffset(size));
+  memcpy(list->matrixSlots.data() + slotOffset, data, size);
+  return slotOffset;
+}
+
+internal_func inline void recordMatrix(RenderCommandList* list, mat4* matrix, const mat4& value) {
+  if(memcmp(matrix, &value, sizeof(mat4)) == 0) { return; }
+  *matrix = value;
+  list->matricesChanged = true;
+}
+
+void recordProjectionMatrix(RenderCommandList* list, const mat4& projection) {
+  recordMatrix(list, &list->matrices.projection, projection);
+}
+
+void recordViewMatrix(RenderCommandList* list, const mat4& view) {
+  recordMatrix(list, &list->matrices.view, view);
+}
+
+void recordModelMatrix(RenderCommandList* list, const mat4& model) {
+  recordMatrix(list, &list->matrices.model, model);
+}
+
+// NOTE: Returns the offset of the slot, to be bound with pushBindInstanceMatrices()
+u32 addInstanceMatrices(RenderCommandList* list, const mat4* models, u32 instanceCount) {
+  assert(instanceCount <= MAX_INSTANCES);
+  InstanceUBO instanceUbo;
+  memcpy(instanceUbo.models, models, instanceCount * sizeof(mat4));
+  // NOTE: The whole InstanceUBO is reserved, as the bound range may not be smaller than the shader's uniform block
+  return addMatrixSlot(list, &instanceUbo, sizeof(InstanceUBO));
+}
+
+// NOTE: Used by the instanced draws that follow, in place of the model matrix
+void pushBindInstanceMatrices(RenderCommandList* list, u32 slotOffset, u32 instanceCount) {
+  pushRenderCommand(list, RenderCommandType_BindInstanceMatrices)->bindInstanceMatrices = {slotOffset, instanceCount};
+}
+
+void pushDrawTriangles(RenderCommandList* list, const VertexAtt* vertexAtt, u32 count, u32 offset, u32 instanceCount = 1) {
+  assert(vertexAtt->indexCount >= (offset + count));
+  if(list->matricesChanged) {
+    u32 slotOffset = addMatrixSlot(list, &list->matrices, sizeof(ProjectionViewModelUBO));
+    pushRenderCommand(list, RenderCommandType_BindMatrices)->bindMatrices = {slotOffset};
+    list->matricesChanged = false;
+  }
+  pushRenderCommand(list, RenderCommandType_BindVertexArray)->bindVertexArray = {vertexAtt->arrayObject};
+  pushRenderCommand(list, RenderCommandType_DrawTriangles)->drawTriangles = {count, offset, (u8)vertexAtt->indexTypeSizeInBytes, instanceCount};
+}
+
+void pushDrawTriangles(RenderCommandList* list, const VertexAtt* vertexAtt) {
+  pushDrawTriangles(list, vertexAtt, vertexAtt->indexCount, 0);
+}
+
+void pushDrawTrianglesInstanced(RenderCommandList* list, const VertexAtt* vertexAtt, u32 instanceCount) {
+  pushDrawTriangles(list, vertexAtt, vertexAtt->indexCount, 0, instanceCount);
+}
+
+// ==== BACKENDS ==== //
+// NOTE: Requires a current GL context
+void initUniformBufferRing(UniformBufferRing* ring, u32 bindingIndex) {
+  GLint alignment = 0;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  if(alignment > 0) { uniformBufferOffsetAlignment_GLOBAL = (u32)alignment; }
+
+  *ring = {};
+  ring->bindingIndex = bindingIndex;
+  ring->frameCapacity = UNIFORM_BUFFER_RING_INITIAL_SLOTS * alignToUniformBufferOffset(sizeof(ProjectionViewModelUBO));
+  glGenBuffers(1, &ring->bufferId);
+  glBindBuffer(GL_UNIFORM_BUFFER, ring->bufferId);
+  glBufferData(GL_UNIFORM_BUFFER, ring->frameCapacity * UNIFORM_BUFFER_RING_FRAMES, NULL, GL_STREAM_DRAW);
+}
+
+void deinitUniformBufferRing(UniformBufferRing* ring) {
+  for(GLsync fence: ring->fences) {
+    if(fence != nullptr) { glDeleteSync(fence); }
+  }
+  glDeleteBuffers(1, &ring->bufferId);
+  *ring = {};
+}
+
+// Writes the frame's data to the next part of the ring in a single upload, returns the offset it was written at
+internal_func u32 beginUniformBufferRingFrame(UniformBufferRing* ring, const std::vector<u8>& data, GLStateCache* glState) {
+  ring->frameIndex = (ring->frameIndex + 1) % UNIFORM_BUFFER_RING_FRAMES;
+  GLsync& fence = ring->fences[ring->frameIndex];
+  ring->lastFenceWaitMs = 0.0f;
+  if(fence != nullptr) {
+    f64 waitStartTime = getTime();
+    if(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, UNIFORM_BUFFER_RING_FENCE_TIMEOUT_NS) == GL_TIMEOUT_EXPIRED) {
+      LOGW("Uniform buffer ring waited over a second on the GPU\n");
+    }
+    ring->lastFenceWaitMs = (f32)((getTime() - waitStartTime) * 1000.0);
+    glDeleteSync(fence);
+    fence = nullptr;
+  }
+
+  cachedBindUniformBuffer(glState, ring->bufferId);
+  if(data.size() > ring->frameCapacity) {
+    // NOTE: Re-specifying the storage orphans the old one, nothing in flight has to be waited on
+    ring->frameCapacity = alignToUniformBufferOffset(data.size() * 2);
+    glBufferData(GL_UNIFORM_BUFFER, ring->frameCapacity * UNIFORM_BUFFER_RING_FRAMES, NULL, GL_STREAM_DRAW);
+    LOGI("Uniform buffer ring grown to %u bytes per frame\n", ring->frameCapacity);
+  }
+
+  u32 frameOffset = ring->frameIndex * ring->frameCapacity;
+  if(!data.empty()) {
+    // NOTE: Unsynchronized is safe, the fence above guarantees the GPU is done with this part of the ring
+    void* mapped = glMapBufferRange(GL_UNIFORM_BUFFER, frameOffset, data.size(),
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if(mapped != nullptr) {
+      memcpy(mapped, data.data(), data.size());
+      glUnmapBuffer(GL_UNIFORM_BUFFER);
+    } else {
+      glBufferSubData(GL_UNIFORM_BUFFER, frameOffset, data.size(), data.data());
+    }
+  }
+  return frameOffset;
+}
+
+internal_func void endUniformBufferRingFrame(UniformBufferRing* ring) {
+  ring->fences[ring->frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void executeRenderCommandsGL(const RenderCommandList& list, UniformBufferRing* matrixRing, GLStateCache* glState) {
+  u32 matrixFrameOffset = beginUniformBufferRingFrame(matrixRing, list.matrixSlots, glState);
+  for(const RenderCommand& command: list.commands) {
+    switch(command.type) {
+      case RenderCommandType_Clear: {
+        cachedClearDepth(glState, command.clear.depth);
+        cachedClearStencil(glState, command.clear.stencil);
+        cachedStencilMask(glState, 0xFF);
+        glClear(command.clear.mask);
+        break;
+      }
+      case RenderCommandType_UseProgram: {
+        cachedUseProgram(glState, command.useProgram.programId);
+        break;
+      }
+      case RenderCommandType_BindVertexArray: {
+        cachedBindVertexArray(glState, command.bindVertexArray.arrayObject);
+        break;
+      }
+      case RenderCommandType_BindTexture: {
+        cachedBindActiveTexture(glState, command.bindTexture.activeIndex, command.bindTexture.textureId, command.bindTexture.target);
+        break;
+      }
+      case RenderCommandType_SetUniformVec3: {
+        glUniform3fv(command.setUniformVec3.location, 1, command.setUniformVec3.values);
+        break;
+      }
+      case RenderCommandType_UpdateUniformBuffer: {
+        cachedBindUniformBuffer(glState, command.updateUniformBuffer.bufferId);
+        glBufferSubData(GL_UNIFORM_BUFFER, command.updateUniformBuffer.offset, command.updateUniformBuffer.size,
+                        list.uniformData.data() + command.updateUniformBuffer.dataOffset);
+        break;
+      }
+      case RenderCommandType_BindUniformBuffer: {
+        const auto& bind = command.bindUniformBuffer;
+        cachedBindUniformBufferRange(glState, bind.bindingIndex, bind.bufferId, 0, bind.size);
+        break;
+      }
+      case RenderCommandType_BindMatrices: {
+        cachedBindUniformBufferRange(glState, matrixRing->bindingIndex, matrixRing->bufferId,
+                                     matrixFrameOffset + command.bindMatrices.slotOffset, sizeof(ProjectionViewModelUBO));
+        break;
+      }
+      case RenderCommandType_BindInstanceMatrices: {
+        cachedBindUniformBufferRange(glState, instanceUBOBindingIndex, matrixRing->bufferId,
+                                     matrixFrameOffset + command.bindInstanceMatrices.slotOffset, sizeof(InstanceUBO));
+        break;
+      }
+      case RenderCommandType_ColorMask: {
+        cachedColorMask(glState, command.colorMask.enabled);
+        break;
+      }
+      case RenderCommandType_DepthFunc: {
+        cachedDepthFunc(glState, command.depthFunc.func);
+        break;
+      }
+      case RenderCommandType_StencilFunc: {
+        cachedStencilFunc(glState, command.stencilFunc.func, command.stencilFunc.ref, command.stencilFunc.mask);
+        break;
+      }
+      case RenderCommandType_StencilOp: {
+        cachedStencilOp(glState, command.stencilOp.stencilFail, command.stencilOp.depthFail, command.stencilOp.depthPass);
+        break;
+      }
+      case RenderCommandType_Scissor: {
+        cachedScissor(glState, command.scissor.x, command.scissor.y, command.scissor.width, command.scissor.height);
+        break;
+      }
+      case RenderCommandType_DrawTriangles: {
+        const auto& draw = command.drawTriangles;
+        GLenum indexType = convertSizeInBytesToOpenGLUIntType(draw.indexTypeSize);
+        void* indexOffset = (void*)((u64)draw.indexOffset * draw.indexTypeSize);
+        if(draw.instanceCount == 1) {
+          glDrawElements(GL_TRIANGLES, draw.indexCount, indexType, indexOffset);
+        } else {
+          glDrawElementsInstanced(GL_TRIANGLES, draw.indexCount, indexType, indexOffset, draw.instanceCount);
+        }
+        break;
+      }
+      default: InvalidCodePath
+    }
+  }
+  endUniformBufferRingFrame(matrixRing);
+}
+
+// NOTE: Validation errors are logged & counted, the list is always walked to the end
+void executeRenderCommandsHeadless(const RenderCommandList& list, RenderCommandStats* stats) {
+  *stats = {};
+  GLuint boundProgram = 0;
+  GLuint boundArrayObject = 0;
+  bool matricesBound = false;
+  u32 boundInstanceCount = 0;
+  bool colorMaskEnabled = true;
+  stats->uniformBufferBytes = list.matrixSlots.size();
+
+  auto validate = [stats, &list](bool valid, u32 commandIndex, const char* error) {
+    if(valid) { return; }
+    stats->validationErrorCount++;
+    RenderCommandType type = list.commands[commandIndex].type;
+    LOGE("Render command %u (%s): %s\n", commandIndex, type < RenderCommandType_Count ? mapRenderCommandTypeToString[type] : "?", error);
+  };
+
+  for(u32 commandIndex = 0; commandIndex < list.commands.size(); commandIndex++) {
+    const RenderCommand& command = list.commands[commandIndex];
+    if(command.type >= RenderCommandType_Count) {
+      validate(false, commandIndex, "unknown command type");
+      continue;
+    }
+    stats->commandCounts[command.type]++;
+    stats->commandCount++;
+    if(command.type != RenderCommandType_Clear && command.type != RenderCommandType_DrawTriangles) { stats->stateChangeCount++; }
+
+    switch(command.type) {
+      case RenderCommandType_UseProgram: {
+        boundProgram = command.useProgram.programId;
+        validate(boundProgram != 0, commandIndex, "program 0 bound");
+        break;
+      }
+      case RenderCommandType_BindVertexArray: {
+        boundArrayObject = command.bindVertexArray.arrayObject;
+        validate(boundArrayObject != 0, commandIndex, "vertex array 0 bound");
+        break;
+      }
+      case RenderCommandType_BindTexture: {
+        validate(command.bindTexture.textureId != TEXTURE_ID_NO_TEXTURE, commandIndex, "texture 0 bound");
+        break;
+      }
+      case RenderCommandType_SetUniformVec3: {
+        validate(command.setUniformVec3.programId == boundProgram, commandIndex, "uniform set on a program that is not in use");
+        break;
+      }
+      case RenderCommandType_UpdateUniformBuffer: {
+        const auto& update = command.updateUniformBuffer;
+        stats->uniformBufferBytes += update.size;
+        validate(update.bufferId != 0, commandIndex, "uniform buffer 0 updated");
+        validate(update.size > 0 && (u64)update.dataOffset + update.size <= list.uniformData.size(), commandIndex, "update data out of range");
+        break;
+      }
+      case RenderCommandType_BindUniformBuffer: {
+        validate(command.bindUniformBuffer.bufferId != 0, commandIndex, "uniform buffer 0 bound");
+        validate(command.bindUniformBuffer.bindingIndex < GL_STATE_CACHE_UNIFORM_BUFFER_BINDINGS, commandIndex, "binding index out of range");
+        break;
+      }
+      case RenderCommandType_BindMatrices: {
+        u32 slotOffset = command.bindMatrices.slotOffset;
+        matricesBound = true;
+        validate((slotOffset % uniformBufferOffsetAlignment_GLOBAL) == 0, commandIndex, "matrix slot is not aligned");
+        validate((u64)slotOffset + sizeof(ProjectionViewModelUBO) <= list.matrixSlots.size(), commandIndex, "matrix slot out of range");
+        break;
+      }
+      case RenderCommandType_BindInstanceMatrices: {
+        u32 slotOffset = command.bindInstanceMatrices.slotOffset;
+        boundInstanceCount = command.bindInstanceMatrices.instanceCount;
+        validate((slotOffset % uniformBufferOffsetAlignment_GLOBAL) == 0, commandIndex, "instance matrix slot is not aligned");
+        validate((u64)slotOffset + sizeof(InstanceUBO) <= list.matrixSlots.size(), commandIndex, "instance matrix slot out of range");
+        validate(boundInstanceCount > 0 && boundInstanceCount <= MAX_INSTANCES, commandIndex, "instance count out of range");
+        break;
+      }
+      case RenderCommandType_ColorMask: {
+        colorMaskEnabled = command.colorMask.enabled;
+        break;
+      }
+      case RenderCommandType_Scissor: {
+        validate(!screenRectEmpty(command.scissor), commandIndex, "empty scissor rect, the views behind it should have been skipped");
+        break;
+      }
+      case RenderCommandType_DrawTriangles: {
+        stats->drawCount++;
+        stats->triangleCount += (command.drawTriangles.indexCount / 3) * command.drawTriangles.instanceCount;
+        validate(boundProgram != 0, commandIndex, "draw without a program");
+        validate(boundArrayObject != 0, commandIndex, "draw without a vertex array");
+        validate(matricesBound, commandIndex, "draw without matrices");
+        validate(command.drawTriangles.indexCount > 0 && (command.drawTriangles.indexCount % 3) == 0, commandIndex, "index count is not a positive multiple of 3");
+        validate(command.drawTriangles.indexTypeSize == 2 || command.drawTriangles.indexTypeSize == 4, commandIndex, "unsupported index type");
+        validate(command.drawTriangles.instanceCount == 1 || command.drawTriangles.instanceCount <= boundInstanceCount, commandIndex, "more instances drawn than instance matrices bound");
+        break;
+      }
+      default: break;
+    }
+  }
+
+  // NOTE: The next frame, and anything drawn after the list such as UI, expects color writes to be on
+  if(!list.commands.empty()) {
+    validate(colorMaskEnabled, (u32)list.commands.size() - 1, "color mask left disabled at the end of the list");
+  }
+}
+
+void logRenderCommandStats(const RenderCommandStats& stats) {
+  LOGI("Render commands: %u, draws: %u, triangles: %u, state changes: %u, uniform buffer bytes: %llu, validation errors: %u\n",
+       stats.commandCount, stats.drawCount, stats.triangleCount, stats.stateChangeCount,
+       (unsigned long long)stats.uniformBufferBytes, stats.validationErrorCount);
+  for(u32 type = 0; type < RenderCommandType_Count; type++) {
+    LOGI("\t%s: %u\n", mapRenderCommandTypeToString[type], stats.commandCounts[type]);
+  }
+}
@@ -1,12 +1,17 @@
 #pragma once
 
-internal_func u32 loadShader(const char* shaderFileName, GLenum shaderType);
+internal_func u32 loadShader(const char* shaderFileName, GLenum shaderType, const char* defines = nullptr);
 
-ShaderProgram createShaderProgram(const char* vertexPath, const char* fragmentPath, const char* noiseTexture = nullptr) {
+#define STRINGIFY_(x) #x
+#define STRINGIFY(x) STRINGIFY_(x)
+const char* instancedVertexShaderDefines = "#define INSTANCED\n#define MAX_INSTANCES " STRINGIFY(MAX_INSTANCES) "\n";
+
+ShaderProgram createShaderProgram(const char* vertexPath, const char* fragmentPath, const char* noiseTexture = nullptr, bool instanced = false) {
   ShaderProgram shaderProgram{};
   shaderProgram.vertexFileName = vertexPath;
   shaderProgram.fragmentFileName = fragmentPath;
-  shaderProgram.vertexShader = loadShader(shaderProgram.vertexFileName.c_str(), GL_VERTEX_SHADER);
+  shaderProgram.instanced = instanced;
+  shaderProgram.vertexShader = loadShader(shaderProgram.vertexFileName.c_str(), GL_VERTEX_SHADER, instanced ? instancedVertexShaderDefines : nullptr);
   shaderProgram.fragmentShader = loadShader(shaderProgram.fragmentFileName.c_str(), GL_FRAGMENT_SHADER);
 
   // shader program
@@ -26,6 +31,16 @@ ShaderProgram createShaderProgram(const char* vertexPath, const char* fragmentPa
 
   glDetachShader(shaderProgram.id, shaderProgram.vertexShader);
   glDetachShader(shaderProgram.id, shaderProgram.fragmentShader);
+
+  // NOTE: Locations are looked up & samplers tied to their texture unit once here, never while drawing
+  glUseProgram(shaderProgram.id);
+  for(u32 uniform = 0; uniform < ShaderUniform_Count; uniform++) {
+    GLint location = glGetUniformLocation(shaderProgram.id, mapShaderUniformToName[uniform]);
+    shaderProgram.uniformLocations[uniform] = location;
+    if(location != -1 && mapShaderUniformToActiveTextureIndex[uniform] >= 0) {
+      glUniform1i(location, mapShaderUniformToActiveTextureIndex[uniform]);
+    }
+  }
   if(noiseTexture != nullptr) {
     shaderProgram.noiseTextureFileName = noiseTexture;
     load2DTexture(shaderProgram.noiseTextureFileName.c_str(), &shaderProgram.noiseTextureId);
@@ -41,7 +56,8 @@ void deleteShaderPrograms(ShaderProgram* shaderPrograms, u32 count) {
     // delete the shaders
     glDeleteShader(shader->vertexShader);
     glDeleteShader(shader->fragmentShader);
-    if(!shader->noiseTextureFileName.empty()) glDeleteTextures(1, &shader->noiseTextureId);
+    // NOTE: Instanced variants share the noise texture of the shader they were made from
+    if(!shader->instanced && !shader->noiseTextureFileName.empty()) glDeleteTextures(1, &shader->noiseTextureId);
     glDeleteProgram(shader->id);
 
     *shader = {};
@@ -123,11 +139,12 @@ inline void bindBlockIndex(GLuint shaderId, const std::string& name, u32 index)
 /*
  * parameters:
  *  - shaderType can be GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, or GL_GEOMETRY_SHADER
+ *  - defines are inserted right after the #version line, which must be the first line of the shader
  * returns:
  *  - Shader id
  *    - 0 is returned on error to load shader
  */
-internal_func GLuint loadShader(const char* shaderFileName, GLenum shaderType) {
+internal_func GLuint loadShader(const char* shaderFileName, GLenum shaderType, const char* defines) {
   std::string shaderDir = "shaders/";
   std::string assetPath = shaderDir + shaderFileName;
   Asset shaderAsset = Asset(assetManager_GLOBAL, assetPath.c_str());
@@ -137,9 +154,17 @@ internal_func GLuint loadShader(const char* shaderFileName, GLenum shaderType) {
   }
 
   GLuint shader = glCreateShader(shaderType);
-  const GLint shaderLengths[] = { (GLint)shaderAsset.bufferLengthInBytes };
   const GLchar* shaderCode = (const GLchar *)shaderAsset.buffer;
-  glShaderSource(shader, 1, &shaderCode, shaderLengths);
+  GLint shaderCodeLength = (GLint)shaderAsset.bufferLengthInBytes;
+  if(defines == nullptr) {
+    glShaderSource(shader, 1, &shaderCode, &shaderCodeLength);
+  } else {
+    GLint versionLength = 0;
+    while(versionLength < shaderCodeLength && shaderCode[versionLength++] != '\n') {}
+    const GLchar* sources[] = { shaderCode, defines, shaderCode + versionLength };
+    const GLint sourceLengths[] = { versionLength, (GLint)strlen(defines), shaderCodeLength - versionLength };
+    glShaderSource(shader, ArrayCount(sources), sources, sourceLengths);
+  }
   glCompileShader(shader);
 
   s32 shaderSuccess;
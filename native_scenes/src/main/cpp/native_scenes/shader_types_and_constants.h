@@ -7,6 +7,40 @@
 // NOTE: Assuming 8 bits per stencil value
 #define MAX_STENCIL_VALUE 0xFF
 
+// NOTE: Also defined for the INSTANCED shader variants, where it sizes InstanceUBO
+#define MAX_INSTANCES 16
+
+const s32 skyboxActiveTextureIndex = 0;
+const s32 albedoActiveTextureIndex = 1;
+const s32 normalActiveTextureIndex = 2;
+const s32 noiseActiveTextureIndex = 3;
+
+/* NOTE: GLSL Shader Texture Usage Examples
+uniform vec4 baseColor;
+uniform samplerCube skyboxTex;
+uniform sampler2D albedoTex;
+uniform sampler2D normalTex;
+uniform sampler2D noiseTex;
+ */
+enum ShaderUniform : u8 {
+#define ShaderUniform(name, activeTextureIndex) ShaderUniform_##name,
+#include "shader_uniform.incl"
+#undef ShaderUniform
+  ShaderUniform_Count
+};
+
+const char* mapShaderUniformToName[] = {
+#define ShaderUniform(name, activeTextureIndex) #name,
+#include "shader_uniform.incl"
+#undef ShaderUniform
+};
+
+const s32 mapShaderUniformToActiveTextureIndex[] = {
+#define ShaderUniform(name, activeTextureIndex) activeTextureIndex,
+#include "shader_uniform.incl"
+#undef ShaderUniform
+};
+
 struct ShaderProgram {
   GLuint id = GL_INVALID_ENUM;
   GLuint vertexShader = GL_INVALID_ENUM;
@@ -15,6 +49,8 @@ struct ShaderProgram {
   std::string vertexFileName = "";
   std::string fragmentFileName = "";
   std::string noiseTextureFileName = "";
+  GLint uniformLocations[ShaderUniform_Count]; // NOTE: -1 for uniforms the program does not use
+  bool instanced = false; // vertex shader compiled with INSTANCED defined, see InstanceUBO
 };
 
 u32 projectionViewModelUBOBindingIndex = 0;
@@ -37,12 +73,18 @@ struct LightUniform {
 // TODO: w component of pos currently undefined and potentially dangerous. Determine if it can be used.
 };
 struct MultiLightUBO {
-  vec4 ambientLight;
+  vec4 ambientSH[9]; // NOTE: rgb are the scene's ambient irradiance SH coefficients (see assets::CubeMapInfo), w is padding
   LightUniform dirPosLightStack[8];
   u32 dirLightCount;
   u32 posLightCount;
-  u32 padding1;
-  u32 padding2;
+  u32 skyboxLayer; // NOTE: layer of the scene's skybox when skyboxes are cube map arrays
+  u32 padding;
+};
+
+// NOTE: Bound for instanced draws only, which take their model matrix from here instead of ProjectionViewModelUBO
+u32 instanceUBOBindingIndex = 3;
+struct InstanceUBO {
+  mat4 models[MAX_INSTANCES];
 };
 
 /*NOTE: GLSL Shader UBO Examples
@@ -62,21 +104,3 @@ layout (binding = 2, std140) uniform LightInfoUBO {
         vec3 directionalLightDirToSource;
 } lightInfoUbo;
 */
-
-const char* baseColorUniformName = "baseColor";
-const char* skyboxTexUniformName = "skyboxTex";
-const char* albedoTexUniformName = "albedoTex";
-const char* normalTexUniformName = "normalTex";
-const char* noiseTexUniformName = "noiseTex";
-/* NOTE: GLSL Shader Texture Usage Examples
-uniform vec4 baseColor;
-uniform samplerCube skyboxTex;
-uniform sampler2D albedoTex;
-uniform sampler2D normalTex;
-uniform sampler2D noiseTex;
- */
-
-const s32 skyboxActiveTextureIndex = 0;
-const s32 albedoActiveTextureIndex = 1;
-const s32 normalActiveTextureIndex = 2;
-const s32 noiseActiveTextureIndex = 3;
\ No newline at end of file
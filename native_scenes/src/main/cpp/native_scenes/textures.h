@@ -1,5 +1,81 @@
 #pragma once
 
+#include <unistd.h> // sysconf
+
+// NOTE: Each texture may take up to this fraction of the device's physical memory before a lower tier is loaded instead
+#define TEXTURE_BUDGET_MEMORY_DIVISOR 512
+
+// Decides which of the baked tiers of a texture is loaded, see assets::TextureTier
+struct TextureBudget {
+  u64 sizeBudget;
+  u32 supportedFormats; // TEXTURE_FORMAT_BIT mask
+};
+global_variable TextureBudget textureBudget_GLOBAL = {
+        U32_MAX,
+        TEXTURE_FORMAT_BIT(assets::TextureFormat_R8) | TEXTURE_FORMAT_BIT(assets::TextureFormat_RGB8) | TEXTURE_FORMAT_BIT(assets::TextureFormat_ETC2_RGB)
+};
+// NOTE: When supported, every skybox is a cube map array (the skybox shaders check for the same extension)
+global_variable bool cubeMapArraySupport_GLOBAL = false;
+
+internal_func GLenum compressedTextureFormatToGL(assets::TextureFormat format) {
+  switch(format) {
+    case assets::TextureFormat_ETC1_RGB: // NOTE: ETC2 decoders are backwards compatible with ETC1
+    case assets::TextureFormat_ETC2_RGB: return GL_COMPRESSED_RGB8_ETC2;
+    case assets::TextureFormat_ETC2_SRGB: return GL_COMPRESSED_SRGB8_ETC2;
+    case assets::TextureFormat_ETC2_RGBA: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+    case assets::TextureFormat_ASTC_RGBA_4x4: return GL_COMPRESSED_RGBA_ASTC_4x4;
+    case assets::TextureFormat_R11_EAC: return GL_COMPRESSED_R11_EAC;
+    default: return GL_INVALID_ENUM;
+  }
+}
+
+// NOTE: Requires a current GL context
+void initTextureBudget() {
+  u64 physicalMemory = (u64)sysconf(_SC_PHYS_PAGES) * (u64)sysconf(_SC_PAGESIZE);
+  textureBudget_GLOBAL.sizeBudget = physicalMemory / TEXTURE_BUDGET_MEMORY_DIVISOR;
+
+  GLint compressedFormatCount = 0;
+  glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &compressedFormatCount);
+  std::vector<GLint> compressedFormats(compressedFormatCount);
+  glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, compressedFormats.data());
+
+  textureBudget_GLOBAL.supportedFormats = TEXTURE_FORMAT_BIT(assets::TextureFormat_R8) | TEXTURE_FORMAT_BIT(assets::TextureFormat_RGB8);
+  for(u32 format = assets::TextureFormat_Unknown + 1; format < assets::TextureFormat_Count; format++) {
+    GLenum glFormat = compressedTextureFormatToGL(assets::TextureFormat(format));
+    for(GLint supportedFormat: compressedFormats) {
+      if((GLenum)supportedFormat == glFormat) {
+        textureBudget_GLOBAL.supportedFormats |= TEXTURE_FORMAT_BIT(format);
+      }
+    }
+  }
+
+  GLint extensionCount = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+  cubeMapArraySupport_GLOBAL = false;
+  for(GLint extensionIndex = 0; extensionIndex < extensionCount; extensionIndex++) {
+    const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, extensionIndex);
+    if(strcmp(extension, "GL_EXT_texture_cube_map_array") == 0) {
+      cubeMapArraySupport_GLOBAL = true;
+    }
+  }
+
+  LOGI("Texture budget: %llu bytes per texture, supported formats mask: 0x%x, cube map arrays: %d",
+       (unsigned long long)textureBudget_GLOBAL.sizeBudget, textureBudget_GLOBAL.supportedFormats, cubeMapArraySupport_GLOBAL);
+}
+
+// Reads the tier 0 json to pick a tier, then loads that tier's file in full
+template<typename AssetInfo>
+internal_func bool loadTieredAssetFile(const std::string& assetPath, assets::AssetFile* assetFile, AssetInfo* info,
+                                       void (*readInfo)(const assets::AssetFile&, AssetInfo*)) {
+  if(!assets::loadAssetFile(assetManager_GLOBAL, assetPath.c_str(), assetFile, false)) { return false; }
+  readInfo(*assetFile, info);
+  u32 tier = assets::selectTextureTier(info->tiers, textureBudget_GLOBAL.sizeBudget, textureBudget_GLOBAL.supportedFormats);
+  std::string tierPath = assets::textureTierPath(assetPath, tier);
+  if(!assets::loadAssetFile(assetManager_GLOBAL, tierPath.c_str(), assetFile)) { return false; }
+  readInfo(*assetFile, info);
+  return true;
+}
+
 internal_func inline void bindActiveTexture(s32 activeIndex, GLuint textureId, GLenum target) {
   glActiveTexture(GL_TEXTURE0 + activeIndex);
   glBindTexture(target, textureId);
@@ -13,6 +89,86 @@ void inline bindActiveTextureCubeMap(s32 activeIndex, GLuint textureId) {
   bindActiveTexture(activeIndex, textureId, GL_TEXTURE_CUBE_MAP);
 }
 
+internal_func inline GLenum skyboxTextureTarget() {
+  return cubeMapArraySupport_GLOBAL ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_CUBE_MAP;
+}
+
+internal_func void upload2DTextureMips(assets::TextureFormat format, u32 width, u32 height, u32 mipCount,
+                                      const char* const* mipData, const u64* mipSizes) {
+  // NOTE: Only textures imported from KTX2 come with their own mip levels
+  if(format == assets::TextureFormat_R8) {
+    for(u32 mip = 0; mip < mipCount; mip++) {
+      glTexImage2D(GL_TEXTURE_2D,
+                   mip,
+                   GL_R8,
+                   Max(width >> mip, 1u),
+                   Max(height >> mip, 1u),
+                   0,
+                   GL_RED,
+                   GL_UNSIGNED_BYTE,
+                   mipData[mip]);
+    }
+    if(mipCount == 1) { glGenerateMipmap(GL_TEXTURE_2D); }
+  } else if (compressedTextureFormatToGL(format) != GL_INVALID_ENUM) {
+    for(u32 mip = 0; mip < mipCount; mip++) {
+      glCompressedTexImage2D(GL_TEXTURE_2D,
+                             mip,
+                             compressedTextureFormatToGL(format),
+                             Max(width >> mip, 1u),
+                             Max(height >> mip, 1u),
+                             0,
+                             (GLsizei)mipSizes[mip],
+                             mipData[mip]);
+    }
+    // NOTE: Compressed mips can't be generated, the max level keeps a texture with fewer levels complete
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipCount - 1);
+  } else {
+    InvalidCodePath
+  }
+}
+
+// NOTE: A .ktx2 shipped in place of a .tx is uploaded straight out of the mapped APK asset, without copying its levels.
+// Returns false when there is no .ktx2 or the device can't sample its format, in which case the .tx is loaded instead.
+internal_func bool loadKTX2Texture2D(const std::string& assetPath, u32* width, u32* height) {
+  AAsset* asset = AAssetManager_open(assetManager_GLOBAL, assetPath.c_str(), AASSET_MODE_BUFFER);
+  if(asset == nullptr) { return false; }
+
+  assets::KTX2Texture ktx2;
+  const char* fileData = (const char*)AAsset_getBuffer(asset);
+  bool loaded = fileData != nullptr &&
+                assets::readKTX2(fileData, (u64)AAsset_getLength64(asset), &ktx2) &&
+                ktx2.faceCount == 1 &&
+                (textureBudget_GLOBAL.supportedFormats & TEXTURE_FORMAT_BIT(ktx2.format)) &&
+                (ktx2.format == assets::TextureFormat_R8 || compressedTextureFormatToGL(ktx2.format) != GL_INVALID_ENUM);
+  if(loaded) {
+    // NOTE: Levels are skipped until the rest of the chain fits the budget, the same tiers the baker cuts from a KTX2
+    const u32 levelCount = (u32)ktx2.levels.size();
+    u64 chainSize = 0;
+    for(u32 level = 0; level < levelCount; level++) { chainSize += ktx2.levels[level].size; }
+    u32 firstLevel = 0;
+    while(chainSize > textureBudget_GLOBAL.sizeBudget && firstLevel + 1 < levelCount) {
+      chainSize -= ktx2.levels[firstLevel].size;
+      firstLevel++;
+    }
+
+    u32 mipCount = levelCount - firstLevel;
+    std::vector<const char*> mipData(mipCount);
+    std::vector<u64> mipSizes(mipCount);
+    for(u32 mip = 0; mip < mipCount; mip++) {
+      mipData[mip] = ktx2.levels[firstLevel + mip].data;
+      mipSizes[mip] = ktx2.levels[firstLevel + mip].size;
+    }
+    *width = Max(ktx2.width >> firstLevel, 1u);
+    *height = Max(ktx2.height >> firstLevel, 1u);
+    upload2DTextureMips(ktx2.format, *width, *height, mipCount, mipData.data(), mipSizes.data());
+  } else {
+    LOGE("KTX2 texture %s could not be used, falling back to the baked texture\n", assetPath.c_str());
+  }
+
+  AAsset_close(asset);
+  return loaded;
+}
+
 void load2DTexture(const char* imgLocation, u32* textureId, bool flipImageVert = false, bool inputSRGB = false, u32* width = NULL, u32* height = NULL)
 {
   glGenTextures(1, textureId);
@@ -26,84 +182,161 @@ void load2DTexture(const char* imgLocation, u32* textureId, bool flipImageVert =
 
   // TODO: This is NOT where exported assets directory should be stored. Move this or related solution to assetlib or potentially a asset_baker header.
   std::string textureDir = "textures/";
-  std::string assetPath = textureDir + imgLocation + ".tx";
-
-  assets::AssetFile textureAssetFile;
-  {
-    assets::loadAssetFile(assetManager_GLOBAL, assetPath.c_str(), &textureAssetFile);
-  }
+  u32 textureWidth, textureHeight;
+  if(!loadKTX2Texture2D(textureDir + imgLocation + ".ktx2", &textureWidth, &textureHeight)) {
+    std::string assetPath = textureDir + imgLocation + ".tx";
 
-  assets::TextureInfo textureInfo;
-  {
-    assets::readTextureInfo(textureAssetFile, &textureInfo);
-  }
+    assets::AssetFile textureAssetFile;
+    assets::TextureInfo textureInfo;
+    loadTieredAssetFile(assetPath, &textureAssetFile, &textureInfo, assets::readTextureInfo);
 
-  char* textureData = textureAssetFile.binaryBlob.data();
-
-  if(textureInfo.format == assets::TextureFormat_R8) {
-    glTexImage2D(GL_TEXTURE_2D,
-                 0,
-                 GL_R8,
-                 textureInfo.width,
-                 textureInfo.height,
-                 0,
-                 GL_RED,
-                 GL_UNSIGNED_BYTE,
-                 textureData);
-    glGenerateMipmap(GL_TEXTURE_2D);
-  } else if (textureInfo.format == assets::TextureFormat_ETC2_RGB) {
-    glCompressedTexImage2D(GL_TEXTURE_2D,
-                           0,
-                           GL_COMPRESSED_RGB8_ETC2,
-                           textureInfo.width,
-                           textureInfo.height,
-                           0,
-                           textureInfo.size,
-                           textureData);
-    // TODO: Can you generate compressed mipmaps?
-  } else {
-    InvalidCodePath
+    char* textureData = textureAssetFile.binaryBlob.data();
+    const u32 mipCount = textureInfo.mipCount();
+    std::vector<const char*> mipData(mipCount);
+    std::vector<u64> mipSizes(mipCount);
+    for(u32 mip = 0; mip < mipCount; mip++) {
+      mipData[mip] = textureInfo.mipData(textureData, mip);
+      mipSizes[mip] = textureInfo.mipSizes[mip];
+    }
+    upload2DTextureMips(textureInfo.format, textureInfo.width, textureInfo.height, mipCount, mipData.data(), mipSizes.data());
+    textureWidth = textureInfo.width;
+    textureHeight = textureInfo.height;
   }
 
-  if (width != NULL) *width = textureInfo.width;
-  if (height != NULL) *height = textureInfo.height;
+  if (width != NULL) *width = textureWidth;
+  if (height != NULL) *height = textureHeight;
 
   glBindTexture(GL_TEXTURE_2D, 0);
 }
 
-void loadCubeMapTexture(const char* fileName, GLuint* textureId) {
-  glGenTextures(1, textureId);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, *textureId);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+internal_func void setSkyboxTextureParameters(GLenum target, u32 mipCount) {
+  glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+  // NOTE: Mip levels past 0 hold the skybox prefiltered for rough reflections, they are only meant to be reached through
+  // an explicit textureLod() and the chain stops at 4x4, hence the max level
+  glTexParameteri(target, GL_TEXTURE_MIN_FILTER, mipCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, mipCount - 1);
+}
 
+internal_func void copyIrradianceSH(const f32* srcSH, vec4* irradianceSH) {
+  for(u32 i = 0; i < CUBE_MAP_SH_COEFFICIENT_COUNT; i++) {
+    irradianceSH[i] = {srcSH[i * 3 + 0], srcSH[i * 3 + 1], srcSH[i * 3 + 2], 0.0f};
+  }
+}
+
+// NOTE: irradianceSH, if provided, receives the skybox's 9 ambient irradiance SH coefficients in rgb
+// NOTE: Loaded as a single layer cube map array when cube map arrays are supported, see skyboxTextureTarget()
+// NOTE: Returns false when the skybox was only baked into a cube map array (see the asset baker's --skybox-array-fallback)
+bool loadCubeMapTexture(const char* fileName, GLuint* textureId, vec4* irradianceSH = nullptr) {
   // TODO: This is NOT where exported assets directory should be stored. Move this or related solution to assetlib or potentially a asset_baker header.
   std::string bakedSkyboxesDir = "skyboxes/";
   std::string assetPath = bakedSkyboxesDir + fileName + ".cbtx";
 
   // TODO: Investigate what can be done, if anything, to load cubemap assets faster
   assets::AssetFile cubeMapAssetFile;
+  assets::CubeMapInfo cubeMapInfo;
+  if(!loadTieredAssetFile(assetPath, &cubeMapAssetFile, &cubeMapInfo, assets::readCubeMapInfo)) { return false; }
+
+  const GLenum target = skyboxTextureTarget();
+  glGenTextures(1, textureId);
+  glBindTexture(target, *textureId);
+
+  setSkyboxTextureParameters(target, cubeMapInfo.mipCount);
+
   {
-    assets::loadAssetFile(assetManager_GLOBAL, assetPath.c_str(), &cubeMapAssetFile);
+    char* cubeMapData = cubeMapAssetFile.binaryBlob.data();
+    GLenum compressionFormat = compressedTextureFormatToGL(cubeMapInfo.format);
+    assert(compressionFormat != GL_INVALID_ENUM);
+    // NOTE: Order matches SkyboxFace
+    const GLenum faceTargets[6] = {
+            GL_TEXTURE_CUBE_MAP_POSITIVE_X, GL_TEXTURE_CUBE_MAP_NEGATIVE_X,
+            GL_TEXTURE_CUBE_MAP_POSITIVE_Y, GL_TEXTURE_CUBE_MAP_NEGATIVE_Y,
+            GL_TEXTURE_CUBE_MAP_POSITIVE_Z, GL_TEXTURE_CUBE_MAP_NEGATIVE_Z,
+    };
+    for(u32 mip = 0; mip < cubeMapInfo.mipCount; mip++) {
+      u32 mipWidth = cubeMapInfo.faceWidth >> mip;
+      u32 mipHeight = cubeMapInfo.faceHeight >> mip;
+      if(target == GL_TEXTURE_CUBE_MAP_ARRAY) { // NOTE: The six faces of a mip level are contiguous in the blob
+        glCompressedTexImage3D(target, mip, compressionFormat, mipWidth, mipHeight, 6, 0, cubeMapInfo.mipFaceSizes[mip] * 6,
+                               cubeMapInfo.faceData(cubeMapData, SKYBOX_FACE_FRONT, mip));
+        continue;
+      }
+      for(u32 face = 0; face < ArrayCount(faceTargets); face++) {
+        glCompressedTexImage2D(faceTargets[face], mip, compressionFormat, mipWidth, mipHeight, 0, cubeMapInfo.mipFaceSizes[mip],
+                               cubeMapInfo.faceData(cubeMapData, SkyboxFace(face), mip));
+      }
+    }
   }
 
-  assets::CubeMapInfo cubeMapInfo;
-  {
-    assets::readCubeMapInfo(cubeMapAssetFile, &cubeMapInfo);
+  if(irradianceSH != nullptr) {
+    copyIrradianceSH(&cubeMapInfo.irradianceSH[0][0], irradianceSH);
   }
+  return true;
+}
 
-  {
-    char* cubeMapData = cubeMapAssetFile.binaryBlob.data();
-    GLenum compressionFormat = GL_COMPRESSED_RGB8_ETC2;
-    // TODO: If we ever support other formats besides RGB8 we will need to explicitly translate the CubeMapInfo.format to a GL_{format}
-    glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, compressionFormat, cubeMapInfo.faceWidth, cubeMapInfo.faceHeight, 0, cubeMapInfo.faceSize, cubeMapInfo.faceData(cubeMapData, SKYBOX_FACE_FRONT));
-    glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_X, 0, compressionFormat, cubeMapInfo.faceWidth, cubeMapInfo.faceHeight, 0, cubeMapInfo.faceSize, cubeMapInfo.faceData(cubeMapData, SKYBOX_FACE_BACK));
-    glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Y, 0, compressionFormat, cubeMapInfo.faceWidth, cubeMapInfo.faceHeight, 0, cubeMapInfo.faceSize, cubeMapInfo.faceData(cubeMapData, SKYBOX_FACE_TOP));
-    glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_Y, 0, compressionFormat, cubeMapInfo.faceWidth, cubeMapInfo.faceHeight, 0, cubeMapInfo.faceSize, cubeMapInfo.faceData(cubeMapData, SKYBOX_FACE_BOTTOM));
-    glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Z, 0, compressionFormat, cubeMapInfo.faceWidth, cubeMapInfo.faceHeight, 0, cubeMapInfo.faceSize, cubeMapInfo.faceData(cubeMapData, SKYBOX_FACE_RIGHT));
-    glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_Z, 0, compressionFormat, cubeMapInfo.faceWidth, cubeMapInfo.faceHeight, 0, cubeMapInfo.faceSize, cubeMapInfo.faceData(cubeMapData, SKYBOX_FACE_LEFT));
+// A world's same-sized skyboxes packed as the layers of one cube map array, sparing portal views any skybox rebinds
+struct CubeMapArray {
+  GLuint textureId;
+  std::string tierPath; // asset file of the selected tier, layers are read from it as they are needed
+  assets::CubeMapArrayInfo info;
+};
+
+// NOTE: Selects a tier & allocates storage for every layer, layers are then uploaded one at a time by loadCubeMapArrayLayer()
+// NOTE: Returns false if the asset was not found, in which case skyboxes are expected to fall back to loadCubeMapTexture()
+bool loadCubeMapArrayTexture(const char* fileName, CubeMapArray* cubeMapArray) {
+  assert(cubeMapArraySupport_GLOBAL);
+
+  // TODO: This is NOT where exported assets directory should be stored. Move this or related solution to assetlib or potentially a asset_baker header.
+  std::string bakedSkyboxesDir = "skyboxes/";
+  std::string assetPath = bakedSkyboxesDir + fileName + ".cbta";
+
+  assets::AssetFile cubeMapArrayAssetFile;
+  assets::CubeMapArrayInfo& info = cubeMapArray->info;
+  if(!assets::loadAssetFile(assetManager_GLOBAL, assetPath.c_str(), &cubeMapArrayAssetFile, false)) {
+    return false;
+  }
+  assets::readCubeMapArrayInfo(cubeMapArrayAssetFile, &info);
+
+  // NOTE: The array stands in for one texture per layer, so it gets the budget of all of them
+  u32 tier = assets::selectTextureTier(info.tiers, textureBudget_GLOBAL.sizeBudget * info.layerCount, textureBudget_GLOBAL.supportedFormats);
+  cubeMapArray->tierPath = assets::textureTierPath(assetPath, tier);
+  if(!assets::loadAssetFile(assetManager_GLOBAL, cubeMapArray->tierPath.c_str(), &cubeMapArrayAssetFile, false)) {
+    return false;
+  }
+  assets::readCubeMapArrayInfo(cubeMapArrayAssetFile, &info);
+
+  GLenum compressionFormat = compressedTextureFormatToGL(info.format);
+  assert(compressionFormat != GL_INVALID_ENUM);
+  glGenTextures(1, &cubeMapArray->textureId);
+  glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, cubeMapArray->textureId);
+  setSkyboxTextureParameters(GL_TEXTURE_CUBE_MAP_ARRAY, info.mipCount);
+  glTexStorage3D(GL_TEXTURE_CUBE_MAP_ARRAY, info.mipCount, compressionFormat, info.faceWidth, info.faceHeight, info.layerCount * 6);
+
+  return true;
+}
+
+// NOTE: Only the layer's bytes are read from the asset
+// NOTE: irradianceSH, if provided, receives the layer's 9 ambient irradiance SH coefficients in rgb
+void loadCubeMapArrayLayer(const CubeMapArray& cubeMapArray, u32 layer, vec4* irradianceSH = nullptr) {
+  const assets::CubeMapArrayInfo& info = cubeMapArray.info;
+  assert(layer < info.layerCount);
+
+  std::vector<char> layerData(info.layerSize());
+  if(!assets::loadAssetFileBlobRange(assetManager_GLOBAL, cubeMapArray.tierPath.c_str(), info.layerOffset(layer), layerData.size(), layerData.data())) {
+    LOGE("Failed to load layer %d of cube map array %s", layer, cubeMapArray.tierPath.c_str());
+    return;
+  }
+
+  GLenum compressionFormat = compressedTextureFormatToGL(info.format);
+  glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, cubeMapArray.textureId);
+  for(u32 mip = 0; mip < info.mipCount; mip++) {
+    glCompressedTexSubImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, mip, 0, 0, layer * 6, info.faceWidth >> mip, info.faceHeight >> mip, 6,
+                              compressionFormat, info.mipFaceSizes[mip] * 6, info.mipData(layerData.data(), mip));
+  }
+
+  if(irradianceSH != nullptr) {
+    copyIrradianceSH(info.layerIrradianceSH.data() + (layer * CUBE_MAP_SH_COEFFICIENT_COUNT * 3), irradianceSH);
   }
 }
\ No newline at end of file
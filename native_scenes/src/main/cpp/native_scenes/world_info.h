@@ -4,6 +4,8 @@
 
 enum EntityFlags {
   EntityType_Rotating = 1 << 0,
+  EntityType_StaticBatched = 1 << 1, // set at load time, drawn as part of a scene's static batch
+  EntityType_Instanced = 1 << 2, // set at load time, drawn as part of one of a scene's instance groups
 };
 
 struct Entity {
@@ -55,11 +57,12 @@ struct SceneInfo {
   std::vector<PortalInfo> portals;
   std::vector<Light> directionalLights;
   std::vector<Light> positionalLights;
-  vec4 ambientLightColorAndPower;
+  vec4 ambientLightColorAndPower = {}; // NOTE: When power is non-zero, overrides the ambient light baked from the skybox
 };
 
 struct WorldInfo {
   u32 startingSceneIndex;
+  std::vector<std::string> skyboxArrayFileNames; // optional, cube map arrays packing the scenes' skyboxes
   std::vector<SceneInfo> scenes;
   std::vector<ModelInfo> models;
   std::vector<ShaderInfo> shaders;
@@ -73,6 +76,10 @@ WorldInfo originalWorld() {
 
   worldInfo.startingSceneIndex = 0;
 
+  // NOTE: Skyboxes of the same size, packed by the asset baker from the matching .skyboxarray lists
+  worldInfo.skyboxArrayFileNames.push_back("original_world_1024");
+  worldInfo.skyboxArrayFileNames.push_back("original_world_2048");
+
   // shaders
   shaders.reserve(3);
   shaders.push_back({
@@ -133,7 +140,6 @@ WorldInfo originalWorld() {
   gateScene.index = 0;
   gateScene.title = "Gate";
   gateScene.skyboxFileName = "cave";
-  gateScene.ambientLightColorAndPower = vec4{1, 1, 1, 0.3f};
   gateScene.entities.reserve(1);
   gateScene.entities.push_back({
     0,
@@ -191,7 +197,6 @@ WorldInfo originalWorld() {
   tetrahedronScene.index = 1;
   tetrahedronScene.title = "Tetrahedron";
   tetrahedronScene.skyboxFileName = "yellow_cloud";
-  tetrahedronScene.ambientLightColorAndPower = vec4{1, 1, 1, 0.85};
   tetrahedronScene.entities.reserve(2);
   tetrahedronScene.entities.push_back({
       1,
@@ -221,7 +226,6 @@ WorldInfo originalWorld() {
   octahedronScene.index = 2;
   octahedronScene.title = "Octahedron";
   octahedronScene.skyboxFileName = "interstellar";
-  octahedronScene.ambientLightColorAndPower = vec4{1, 1, 1, 0.8f};
   octahedronScene.entities.reserve(2);
   octahedronScene.entities.push_back({
       2,
@@ -251,7 +255,6 @@ WorldInfo originalWorld() {
   dodecahedronScene.index = 3;
   dodecahedronScene.title = "Dodecahedron";
   dodecahedronScene.skyboxFileName = "calm_sea";
-  dodecahedronScene.ambientLightColorAndPower = vec4{1, 1, 1, 0.7f};
   dodecahedronScene.entities.reserve(2);
   dodecahedronScene.entities.push_back({
       4,
@@ -281,7 +284,6 @@ WorldInfo originalWorld() {
   icosahedronScene.index = 4;
   icosahedronScene.title = "Icosahedron";
   icosahedronScene.skyboxFileName = "polluted_earth";
-  icosahedronScene.ambientLightColorAndPower = vec4{1, 1, 1, 0.7f};
   icosahedronScene.entities.reserve(2);
   icosahedronScene.entities.push_back({
       3,
@@ -1,7 +1,17 @@
 #include "asset_loader.h"
 
+const char* mapCompressionModeToString[] = {
+    "None",
+#define CompressionMode(name) #name,
+#include "compression_mode.incl"
+#undef CompressionMode
+};
+
+u32 assets::compressionModeToEnumVal(assets::CompressionMode mode) { return static_cast<u32>(mode); }
+const char* assets::compressionModeToString(assets::CompressionMode mode) { return mapCompressionModeToString[compressionModeToEnumVal(mode)]; }
+
 #if defined(ANDROID) || defined(__ANDROID___)
-bool assets::loadAssetFile(AAssetManager* assetManager, const char* path, AssetFile* outputFile) {
+bool assets::loadAssetFile(AAssetManager* assetManager, const char* path, AssetFile* outputFile, bool loadBinaryBlob) {
   AAsset *androidAsset = AAssetManager_open(assetManager, path, AASSET_MODE_STREAMING);
 
   if(androidAsset == nullptr) {
@@ -15,7 +25,8 @@ bool assets::loadAssetFile(AAssetManager* assetManager, const char* path, AssetF
   // version
   AAsset_read(androidAsset, &outputFile->version, sizeof(outputFile->version));
   if(outputFile->version != ASSET_LIB_VERSION) {
-    LOGI("Attempting to load asset (%s) with version #%d. Asset Loader version is currently #%d.", path, outputFile->version, ASSET_LIB_VERSION);
+    LOGE("Attempting to load asset (%s) with version #%d. Asset Loader version is currently #%d.\n", path, outputFile->version, ASSET_LIB_VERSION);
+    AAsset_close(androidAsset);
     return false;
   }
 
@@ -32,19 +43,56 @@ bool assets::loadAssetFile(AAssetManager* assetManager, const char* path, AssetF
   AAsset_read(androidAsset, outputFile->json.data(), jsonLength);
 
   // blob
-  outputFile->binaryBlob.resize(blobLength);
-  AAsset_read(androidAsset, outputFile->binaryBlob.data(), blobLength);
+  if(loadBinaryBlob) {
+    outputFile->binaryBlob.resize(blobLength);
+    AAsset_read(androidAsset, outputFile->binaryBlob.data(), blobLength);
+  }
 
   AAsset_close(androidAsset);
 
   return true;
 }
-#else
 
-#include <fstream>
+bool assets::loadAssetFileBlobRange(AAssetManager* assetManager, const char* path, u64 offset, u64 size, char* output) {
+  AAsset *androidAsset = AAssetManager_open(assetManager, path, AASSET_MODE_RANDOM);
+
+  if(androidAsset == nullptr) {
+    LOGI("Asset manager could not find asset: %s", path);
+    return false;
+  }
+
+  // skip file type & version
+  AAsset_seek(androidAsset, FILE_TYPE_SIZE_IN_BYTES + sizeof(u32), SEEK_SET);
+
+  u32 jsonLength;
+  AAsset_read(androidAsset, &jsonLength, sizeof(jsonLength));
+  u32 blobLength;
+  AAsset_read(androidAsset, &blobLength, sizeof(blobLength));
+  if(offset + size > blobLength) {
+    LOGE("Requested range [%llu, %llu) is outside of the blob of asset (%s), which is %d bytes", (unsigned long long)offset,
+         (unsigned long long)(offset + size), path, blobLength);
+    AAsset_close(androidAsset);
+    return false;
+  }
+
+  AAsset_seek(androidAsset, jsonLength + offset, SEEK_CUR);
+  AAsset_read(androidAsset, output, size);
+
+  AAsset_close(androidAsset);
+
+  return true;
+}
+#else
 
 bool assets::saveAssetFile(const char* path, const AssetFile& file) {
-  std::ofstream outfile;
+  AssetFileWriter writer;
+  if(!beginAssetFile(path, file, (u32)file.binaryBlob.size(), &writer)) { return false; }
+  writeAssetFileBlob(&writer, file.binaryBlob.data(), file.binaryBlob.size());
+  return endAssetFile(&writer);
+}
+
+bool assets::beginAssetFile(const char* path, const AssetFile& file, u32 blobLength, AssetFileWriter* writer) {
+  std::ofstream& outfile = writer->stream;
   outfile.open(path, std::ios::binary | std::ios::out);
 
   if(!outfile.is_open()) {
@@ -63,21 +111,36 @@ bool assets::saveAssetFile(const char* path, const AssetFile& file) {
   outfile.write((const char*)&jsonLength, sizeof(jsonLength));
 
   // blob length
-  u32 blobLength = file.binaryBlob.size();
   outfile.write((const char*)&blobLength, sizeof(blobLength));
 
   //json
   outfile.write(file.json.data(), jsonLength);
 
-  //blob data
-  outfile.write(file.binaryBlob.data(), blobLength);
+  writer->blobRemaining = blobLength;
+  return outfile.good();
+}
 
-  outfile.close();
+bool assets::writeAssetFileBlob(AssetFileWriter* writer, const void* data, u64 size) {
+  if(size > writer->blobRemaining) {
+    printf("Asset file blob write of %llu bytes overruns the remaining %llu bytes\n", (unsigned long long)size,
+           (unsigned long long)writer->blobRemaining);
+    return false;
+  }
+  writer->stream.write((const char*)data, size);
+  writer->blobRemaining -= size;
+  return writer->stream.good();
+}
 
-  return true;
+bool assets::endAssetFile(AssetFileWriter* writer) {
+  bool complete = writer->blobRemaining == 0 && writer->stream.good();
+  if(writer->blobRemaining != 0) {
+    printf("Asset file was closed with %llu bytes of its blob never written\n", (unsigned long long)writer->blobRemaining);
+  }
+  writer->stream.close();
+  return complete;
 }
 
-bool assets::loadAssetFile(const char* path, AssetFile* outputFile) {
+bool assets::loadAssetFile(const char* path, AssetFile* outputFile, bool loadBinaryBlob) {
   std::ifstream infile;
   infile.open(path, std::ios::binary);
 
@@ -95,7 +158,8 @@ bool assets::loadAssetFile(const char* path, AssetFile* outputFile) {
   // version
   infile.read((char*)&outputFile->version, sizeof(outputFile->version));
   if(outputFile->version != ASSET_LIB_VERSION) {
-    printf("Attempting to load asset (%s) with version #%d. Asset Loader version is currently #%d.", path, outputFile->version, ASSET_LIB_VERSION);
+    LOGE("Attempting to load asset (%s) with version #%d. Asset Loader version is currently #%d.\n", path, outputFile->version, ASSET_LIB_VERSION);
+    return false;
   }
 
   // json length
@@ -111,8 +175,38 @@ bool assets::loadAssetFile(const char* path, AssetFile* outputFile) {
   infile.read(outputFile->json.data(), jsonLength);
 
   // blob
-  outputFile->binaryBlob.resize(blobLength);
-  infile.read(outputFile->binaryBlob.data(), blobLength);
+  if(loadBinaryBlob) {
+    outputFile->binaryBlob.resize(blobLength);
+    infile.read(outputFile->binaryBlob.data(), blobLength);
+  }
+
+  return true;
+}
+
+bool assets::loadAssetFileBlobRange(const char* path, u64 offset, u64 size, char* output) {
+  std::ifstream infile;
+  infile.open(path, std::ios::binary);
+
+  if (!infile.is_open()) {
+    printf("Could not open asset file %s", path);
+    return false;
+  }
+
+  // skip file type & version
+  infile.seekg(FILE_TYPE_SIZE_IN_BYTES + sizeof(u32));
+
+  u32 jsonLength;
+  infile.read((char*)&jsonLength, sizeof(jsonLength));
+  u32 blobLength;
+  infile.read((char*)&blobLength, sizeof(blobLength));
+  if(offset + size > blobLength) {
+    printf("Requested range [%llu, %llu) is outside of the blob of asset (%s), which is %d bytes", (unsigned long long)offset,
+           (unsigned long long)(offset + size), path, blobLength);
+    return false;
+  }
+
+  infile.seekg(jsonLength + offset, std::ios::cur);
+  infile.read(output, size);
 
   return true;
 }
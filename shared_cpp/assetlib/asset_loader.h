@@ -15,15 +15,24 @@
 #if defined(ANDROID) || defined(__ANDROID___)
 #include "android_platform.h"
 #else
+#include <fstream>
 #define LOGI(...) printf(__VA_ARGS__)
 #define LOGW(...) printf(__VA_ARGS__)
 #define LOGE(...) printf(__VA_ARGS__)
 #endif
 
 #define FILE_TYPE_SIZE_IN_BYTES 4
-#define ASSET_LIB_VERSION 1
+#define ASSET_LIB_VERSION 6
 
 namespace assets {
+  enum CompressionMode : u32
+  {
+    CompressionMode_None = 0,
+#define CompressionMode(name) CompressionMode_##name,
+#include "compression_mode.incl"
+#undef CompressionMode
+  };
+
   struct AssetFile{
     char type[FILE_TYPE_SIZE_IN_BYTES];
     u32 version;
@@ -32,10 +41,28 @@ namespace assets {
     std::vector<char> binaryBlob; // the actual asset
   };
 
+  u32 compressionModeToEnumVal(CompressionMode mode);
+  const char* compressionModeToString(CompressionMode mode);
+
+  // NOTE: When loadBinaryBlob is false only the header & json are read, which is enough to inspect an asset cheaply
+  // NOTE: loadAssetFileBlobRange reads size bytes starting at offset into the binary blob, without reading the rest of it
 #if defined(ANDROID) || defined(__ANDROID___)
-  bool loadAssetFile(AAssetManager* assetManager, const char* path, AssetFile* outputFile);
+  bool loadAssetFile(AAssetManager* assetManager, const char* path, AssetFile* outputFile, bool loadBinaryBlob = true);
+  bool loadAssetFileBlobRange(AAssetManager* assetManager, const char* path, u64 offset, u64 size, char* output);
 #else
   bool saveAssetFile(const char* path, const AssetFile& file);
-  bool loadAssetFile(const char* path, AssetFile* outputFile);
+  bool loadAssetFile(const char* path, AssetFile* outputFile, bool loadBinaryBlob = true);
+  bool loadAssetFileBlobRange(const char* path, u64 offset, u64 size, char* output);
+
+  // Streams an asset to disk, letting a large binary blob be written piece by piece instead of held in memory at once
+  struct AssetFileWriter {
+    std::ofstream stream;
+    u64 blobRemaining;
+  };
+  // NOTE: Only the type, version & json of file are written, the blob must then be blobLength bytes of writes
+  bool beginAssetFile(const char* path, const AssetFile& file, u32 blobLength, AssetFileWriter* writer);
+  bool writeAssetFileBlob(AssetFileWriter* writer, const void* data, u64 size);
+  // NOTE: Returns false if the blob was not written in full, or if any write failed
+  bool endAssetFile(AssetFileWriter* writer);
 #endif
 }
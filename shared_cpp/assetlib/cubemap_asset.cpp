@@ -1,6 +1,7 @@
 #include "cubemap_asset.h"
 
 const internal_func char* CUBE_MAP_FOURCC = "CBMP";
+const internal_func char* CUBE_MAP_ARRAY_FOURCC = "CBMA";
 
 const struct {
   const char* faceSize = "face_size";
@@ -9,6 +10,13 @@ const struct {
   const char* originalFolder = "original_folder";
   const char* faceWidth = "face_width";
   const char* faceHeight = "face_height";
+  const char* mipCount = "mip_count";
+  const char* mipFaceSizes = "mip_face_sizes";
+  const char* mipRoughness = "mip_roughness";
+  const char* irradianceSH = "irradiance_sh";
+  const char* layerCount = "layer_count";
+  const char* layerNames = "layer_names";
+  const char* layerIrradianceSH = "layer_irradiance_sh";
 } jsonKeys;
 
 void assets::readCubeMapInfo(const assets::AssetFile &file, assets::CubeMapInfo *info) {
@@ -19,6 +27,14 @@ void assets::readCubeMapInfo(const assets::AssetFile &file, assets::CubeMapInfo
   info->faceWidth = cubeMapJson[jsonKeys.faceWidth];
   info->faceHeight = cubeMapJson[jsonKeys.faceHeight];
   info->originalFolder = cubeMapJson[jsonKeys.originalFolder];
+  info->mipCount = cubeMapJson[jsonKeys.mipCount];
+  info->mipFaceSizes = cubeMapJson[jsonKeys.mipFaceSizes].get<std::vector<u32>>();
+  info->mipRoughness = cubeMapJson[jsonKeys.mipRoughness].get<std::vector<f32>>();
+  std::vector<f32> irradianceSH = cubeMapJson[jsonKeys.irradianceSH];
+  assert(info->mipFaceSizes.size() == info->mipCount && info->mipRoughness.size() == info->mipCount);
+  assert(irradianceSH.size() == CUBE_MAP_SH_COEFFICIENT_COUNT * 3);
+  memcpy(info->irradianceSH, irradianceSH.data(), sizeof(info->irradianceSH));
+  readTextureTiers(cubeMapJson, &info->tiers);
 }
 
 assets::AssetFile assets::packCubeMap(CubeMapInfo *info, void *data_FBTBLR) {
@@ -29,16 +45,75 @@ assets::AssetFile assets::packCubeMap(CubeMapInfo *info, void *data_FBTBLR) {
   file.version = ASSET_LIB_VERSION;
 
   nlohmann::json cubeMapJson;
-  cubeMapJson[jsonKeys.format] = textureFormatToString(TextureFormat_RGB8);
-  cubeMapJson[jsonKeys.formatEnum] = textureFormatToEnumVal(TextureFormat_RGB8);
+  cubeMapJson[jsonKeys.format] = textureFormatToString(info->format);
+  cubeMapJson[jsonKeys.formatEnum] = textureFormatToEnumVal(info->format);
   cubeMapJson[jsonKeys.faceSize] = info->faceSize;
   cubeMapJson[jsonKeys.originalFolder] = info->originalFolder;
   cubeMapJson[jsonKeys.faceWidth] = info->faceWidth;
   cubeMapJson[jsonKeys.faceHeight] = info->faceHeight;
+  assert(info->mipFaceSizes.size() == info->mipCount && info->mipFaceSizes[0] == info->faceSize);
+  assert(info->mipRoughness.size() == info->mipCount);
+  cubeMapJson[jsonKeys.mipCount] = info->mipCount;
+  cubeMapJson[jsonKeys.mipFaceSizes] = info->mipFaceSizes;
+  cubeMapJson[jsonKeys.mipRoughness] = info->mipRoughness;
+  const f32* irradianceSH = &info->irradianceSH[0][0];
+  cubeMapJson[jsonKeys.irradianceSH] = std::vector<f32>(irradianceSH, irradianceSH + CUBE_MAP_SH_COEFFICIENT_COUNT * 3);
+  writeTextureTiers(info->tiers, &cubeMapJson);
   file.json = cubeMapJson.dump(); // json map to string
 
   file.binaryBlob.resize(info->size());
-  memcpy(&file.binaryBlob[0], data_FBTBLR, info->size());
+  if(data_FBTBLR != nullptr) {
+    memcpy(&file.binaryBlob[0], data_FBTBLR, info->size());
+  }
+
+  return file;
+}
+void assets::readCubeMapArrayInfo(const assets::AssetFile &file, assets::CubeMapArrayInfo *info) {
+  nlohmann::json cubeMapArrayJson = nlohmann::json::parse(file.json);
+  u32 cubeMapFormatEnum = cubeMapArrayJson[jsonKeys.formatEnum];
+  info->format = TextureFormat(cubeMapFormatEnum);
+  info->faceWidth = cubeMapArrayJson[jsonKeys.faceWidth];
+  info->faceHeight = cubeMapArrayJson[jsonKeys.faceHeight];
+  info->mipCount = cubeMapArrayJson[jsonKeys.mipCount];
+  info->mipFaceSizes = cubeMapArrayJson[jsonKeys.mipFaceSizes].get<std::vector<u32>>();
+  info->mipRoughness = cubeMapArrayJson[jsonKeys.mipRoughness].get<std::vector<f32>>();
+  info->layerCount = cubeMapArrayJson[jsonKeys.layerCount];
+  info->layerNames = cubeMapArrayJson[jsonKeys.layerNames].get<std::vector<std::string>>();
+  info->layerIrradianceSH = cubeMapArrayJson[jsonKeys.layerIrradianceSH].get<std::vector<f32>>();
+  assert(info->mipFaceSizes.size() == info->mipCount && info->mipRoughness.size() == info->mipCount);
+  assert(info->layerNames.size() == info->layerCount);
+  assert(info->layerIrradianceSH.size() == info->layerCount * CUBE_MAP_SH_COEFFICIENT_COUNT * 3);
+  readTextureTiers(cubeMapArrayJson, &info->tiers);
+}
+
+assets::AssetFile assets::packCubeMapArray(CubeMapArrayInfo *info, void *data) {
+
+  //core file header
+  AssetFile file;
+  strncpy(file.type, CUBE_MAP_ARRAY_FOURCC, 4);
+  file.version = ASSET_LIB_VERSION;
+
+  nlohmann::json cubeMapArrayJson;
+  cubeMapArrayJson[jsonKeys.format] = textureFormatToString(info->format);
+  cubeMapArrayJson[jsonKeys.formatEnum] = textureFormatToEnumVal(info->format);
+  cubeMapArrayJson[jsonKeys.faceWidth] = info->faceWidth;
+  cubeMapArrayJson[jsonKeys.faceHeight] = info->faceHeight;
+  assert(info->mipFaceSizes.size() == info->mipCount && info->mipRoughness.size() == info->mipCount);
+  cubeMapArrayJson[jsonKeys.mipCount] = info->mipCount;
+  cubeMapArrayJson[jsonKeys.mipFaceSizes] = info->mipFaceSizes;
+  cubeMapArrayJson[jsonKeys.mipRoughness] = info->mipRoughness;
+  assert(info->layerNames.size() == info->layerCount);
+  assert(info->layerIrradianceSH.size() == info->layerCount * CUBE_MAP_SH_COEFFICIENT_COUNT * 3);
+  cubeMapArrayJson[jsonKeys.layerCount] = info->layerCount;
+  cubeMapArrayJson[jsonKeys.layerNames] = info->layerNames;
+  cubeMapArrayJson[jsonKeys.layerIrradianceSH] = info->layerIrradianceSH;
+  writeTextureTiers(info->tiers, &cubeMapArrayJson);
+  file.json = cubeMapArrayJson.dump(); // json map to string
+
+  if(data != nullptr) {
+    file.binaryBlob.resize(info->size());
+    memcpy(&file.binaryBlob[0], data, info->size());
+  }
 
   return file;
 }
\ No newline at end of file
@@ -12,18 +12,82 @@ enum SkyboxFace: size_t {
   SKYBOX_FACE_LEFT,
 };
 
+#define CUBE_MAP_SH_COEFFICIENT_COUNT 9
+
 namespace assets {
+  /*
+   * Blob holds all six faces of mip level 0, followed by all six faces of mip level 1, and so on.
+   *  - Mip level 0 is the skybox itself. Each following level is the skybox prefiltered with a GGX lobe of increasing
+   *    roughness (mipRoughness), to be sampled with textureLod() by rough reflective surfaces.
+   *  - irradianceSH are the linear RGB coefficients of 3rd order spherical harmonics (in the cube map's y-up space), already
+   *    convolved with the cosine lobe and divided by PI. Evaluating them for a normal gives the diffuse ambient light.
+   */
   struct CubeMapInfo {
     TextureFormat format;
-    u32 faceSize;
+    u32 faceSize; // size of a single face at mip level 0
     u32 faceWidth;
     u32 faceHeight;
+    u32 mipCount = 1;
+    std::vector<u32> mipFaceSizes; // size of a single face at each mip level
+    std::vector<f32> mipRoughness; // NOTE: Lower resolution tiers drop the sharpest prefiltered levels
+    f32 irradianceSH[CUBE_MAP_SH_COEFFICIENT_COUNT][3] = {};
     std::string originalFolder;
+    std::vector<TextureTier> tiers; // NOTE: Only filled for tier 0
+
+    u64 size() const {
+      u64 totalSize = 0;
+      for(u32 mipFaceSize: mipFaceSizes) { totalSize += mipFaceSize * 6; }
+      return totalSize;
+    }
+    char* faceData(char* data, SkyboxFace face, u32 mipLevel = 0) const {
+      for(u32 level = 0; level < mipLevel; level++) { data += mipFaceSizes[level] * 6; }
+      return data + (face * mipFaceSizes[mipLevel]);
+    }
+  };
+
+  /*
+   * Same-sized cube maps packed as the layers of a single cube map array, letting a world's scenes share one texture.
+   *  - Every layer has the exact blob layout of a CubeMapInfo, layers are stored one after the other. Each layer can be
+   *    read & uploaded on its own, with the six faces of each of its mip levels being contiguous.
+   *  - layerNames are the file names of the packed cube maps. layerIrradianceSH holds each layer's irradianceSH.
+   */
+  struct CubeMapArrayInfo {
+    TextureFormat format;
+    u32 faceWidth;
+    u32 faceHeight;
+    u32 mipCount = 1;
+    std::vector<u32> mipFaceSizes;
+    std::vector<f32> mipRoughness;
+    u32 layerCount = 0;
+    std::vector<std::string> layerNames;
+    std::vector<f32> layerIrradianceSH; // CUBE_MAP_SH_COEFFICIENT_COUNT * 3 per layer
+    std::vector<TextureTier> tiers; // NOTE: Only filled for tier 0, sizes are of all layers
 
-    u64 size() const { return faceSize * 6; }
-    char* faceData(char* data, SkyboxFace face) const { return data + (face * faceSize); }
+    u64 layerSize() const {
+      u64 totalSize = 0;
+      for(u32 mipFaceSize: mipFaceSizes) { totalSize += mipFaceSize * 6; }
+      return totalSize;
+    }
+    u64 size() const { return layerSize() * layerCount; }
+    u64 layerOffset(u32 layer) const { return layerSize() * layer; }
+    // NOTE: layerData is the start of a single layer
+    char* mipData(char* layerData, u32 mipLevel) const {
+      for(u32 level = 0; level < mipLevel; level++) { layerData += mipFaceSizes[level] * 6; }
+      return layerData;
+    }
+    u32 layerIndex(const std::string& name) const {
+      for(u32 layer = 0; layer < layerNames.size(); layer++) {
+        if(layerNames[layer] == name) { return layer; }
+      }
+      return U32_MAX;
+    }
   };
 
   void readCubeMapInfo(const AssetFile& file, CubeMapInfo* info);
+  // NOTE: data_FBTBLR may be null, the blob is then sized but left for the caller to fill through faceData()
   AssetFile packCubeMap(CubeMapInfo *info, void* data_FBTBLR);
+
+  void readCubeMapArrayInfo(const AssetFile& file, CubeMapArrayInfo* info);
+  // NOTE: data may be null, only the header & json are then packed, for the layers to be streamed with an AssetFileWriter
+  AssetFile packCubeMapArray(CubeMapArrayInfo* info, void* data);
 }
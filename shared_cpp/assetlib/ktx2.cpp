@@ -0,0 +1,274 @@
+#include "ktx2.h"
+
+#include <algorithm>
+
+const internal_func u8 KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+struct KTX2Header {
+  u8 identifier[12];
+  u32 vkFormat;
+  u32 typeSize;
+  u32 pixelWidth;
+  u32 pixelHeight;
+  u32 pixelDepth;
+  u32 layerCount;
+  u32 faceCount;
+  u32 levelCount;
+  u32 supercompressionScheme;
+  u32 dfdByteOffset;
+  u32 dfdByteLength;
+  u32 kvdByteOffset;
+  u32 kvdByteLength;
+  u64 sgdByteOffset;
+  u64 sgdByteLength;
+};
+static_assert(sizeof(KTX2Header) == 80, "KTX2 header must match the file layout");
+
+struct KTX2LevelIndex {
+  u64 byteOffset;
+  u64 byteLength;
+  u64 uncompressedByteLength;
+};
+
+// Vulkan format numbers & the matching data format descriptor (Khronos Data Format Specification) values
+enum : u32 {
+  VK_FORMAT_UNDEFINED = 0,
+  VK_FORMAT_R8_UNORM = 9,
+  VK_FORMAT_R8G8B8_UNORM = 23,
+  VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK = 147,
+  VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK = 148,
+  VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK = 151,
+  VK_FORMAT_EAC_R11_UNORM_BLOCK = 153,
+  VK_FORMAT_ASTC_4x4_UNORM_BLOCK = 157,
+};
+
+enum : u8 {
+  KHR_DF_MODEL_RGBSDA = 1,
+  KHR_DF_MODEL_ETC2 = 161,
+  KHR_DF_MODEL_ASTC = 162,
+  KHR_DF_TRANSFER_LINEAR = 1,
+  KHR_DF_TRANSFER_SRGB = 2,
+  KHR_DF_PRIMARIES_BT709 = 1,
+};
+
+struct KTX2FormatDesc {
+  u32 vkFormat;
+  u8 colorModel;
+  u8 transfer;
+  u8 blockDimension; // 1 or 4, blocks are always square
+  u8 bytesPerBlock;
+  u32 sampleCount;
+  struct {
+    u16 bitOffset;
+    u8 bitLength;
+    u8 channel;
+    u32 upper;
+  } samples[3];
+};
+
+internal_func bool ktx2FormatDesc(assets::TextureFormat format, KTX2FormatDesc* desc) {
+  switch(format) {
+    case assets::TextureFormat_R8:
+      *desc = {VK_FORMAT_R8_UNORM, KHR_DF_MODEL_RGBSDA, KHR_DF_TRANSFER_LINEAR, 1, 1, 1, {{0, 8, 0, 255}}};
+      return true;
+    case assets::TextureFormat_RGB8:
+      *desc = {VK_FORMAT_R8G8B8_UNORM, KHR_DF_MODEL_RGBSDA, KHR_DF_TRANSFER_LINEAR, 1, 3, 3, {{0, 8, 0, 255}, {8, 8, 1, 255}, {16, 8, 2, 255}}};
+      return true;
+    case assets::TextureFormat_ETC1_RGB: // NOTE: ETC1 is a subset of ETC2
+    case assets::TextureFormat_ETC2_RGB:
+      *desc = {VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK, KHR_DF_MODEL_ETC2, KHR_DF_TRANSFER_LINEAR, 4, 8, 1, {{0, 64, 2, U32_MAX}}};
+      return true;
+    case assets::TextureFormat_ETC2_SRGB:
+      *desc = {VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK, KHR_DF_MODEL_ETC2, KHR_DF_TRANSFER_SRGB, 4, 8, 1, {{0, 64, 2, U32_MAX}}};
+      return true;
+    case assets::TextureFormat_ETC2_RGBA:
+      *desc = {VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK, KHR_DF_MODEL_ETC2, KHR_DF_TRANSFER_LINEAR, 4, 16, 2, {{0, 64, 15, U32_MAX}, {64, 64, 2, U32_MAX}}};
+      return true;
+    case assets::TextureFormat_R11_EAC:
+      *desc = {VK_FORMAT_EAC_R11_UNORM_BLOCK, KHR_DF_MODEL_ETC2, KHR_DF_TRANSFER_LINEAR, 4, 8, 1, {{0, 64, 0, U32_MAX}}};
+      return true;
+    case assets::TextureFormat_ASTC_RGBA_4x4:
+      *desc = {VK_FORMAT_ASTC_4x4_UNORM_BLOCK, KHR_DF_MODEL_ASTC, KHR_DF_TRANSFER_LINEAR, 4, 16, 1, {{0, 128, 0, U32_MAX}}};
+      return true;
+    default:
+      return false;
+  }
+}
+
+u32 assets::textureFormatToVkFormat(TextureFormat format) {
+  KTX2FormatDesc desc;
+  return ktx2FormatDesc(format, &desc) ? desc.vkFormat : VK_FORMAT_UNDEFINED;
+}
+
+assets::TextureFormat assets::vkFormatToTextureFormat(u32 vkFormat) {
+  switch(vkFormat) {
+    case VK_FORMAT_R8_UNORM: return TextureFormat_R8;
+    case VK_FORMAT_R8G8B8_UNORM: return TextureFormat_RGB8;
+    case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK: return TextureFormat_ETC2_RGB;
+    case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK: return TextureFormat_ETC2_SRGB;
+    case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK: return TextureFormat_ETC2_RGBA;
+    case VK_FORMAT_EAC_R11_UNORM_BLOCK: return TextureFormat_R11_EAC;
+    case VK_FORMAT_ASTC_4x4_UNORM_BLOCK: return TextureFormat_ASTC_RGBA_4x4;
+    default: return TextureFormat_Unknown;
+  }
+}
+
+const assets::KTX2KeyValue* assets::KTX2Texture::findKeyValue(const char* key) const {
+  for(const KTX2KeyValue& keyValue: keyValues) {
+    if(keyValue.key == key) { return &keyValue; }
+  }
+  return nullptr;
+}
+
+bool assets::readKTX2(const char* data, u64 size, KTX2Texture* texture) {
+  KTX2Header header;
+  if(size < sizeof(header)) {
+    LOGE("KTX2 file is too small to hold a header\n");
+    return false;
+  }
+  memcpy(&header, data, sizeof(header));
+  if(memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+    LOGE("File is not a KTX2 file\n");
+    return false;
+  }
+  if(header.supercompressionScheme != 0) {
+    LOGE("KTX2 supercompression scheme %u is not supported\n", header.supercompressionScheme);
+    return false;
+  }
+  if(header.pixelDepth > 1 || header.layerCount > 1 || (header.faceCount != 1 && header.faceCount != 6)) {
+    LOGE("Only 2D KTX2 textures & cube maps are supported\n");
+    return false;
+  }
+  texture->format = vkFormatToTextureFormat(header.vkFormat);
+  if(texture->format == TextureFormat_Unknown) {
+    LOGE("KTX2 vkFormat %u is not supported\n", header.vkFormat);
+    return false;
+  }
+  texture->width = header.pixelWidth;
+  texture->height = header.pixelHeight;
+  texture->faceCount = header.faceCount;
+
+  // NOTE: A level count of 0 asks the loader to generate mips, there is still only the one level stored
+  u32 levelCount = header.levelCount == 0 ? 1 : header.levelCount;
+  if(sizeof(header) + ((u64)levelCount * sizeof(KTX2LevelIndex)) > size) {
+    LOGE("KTX2 level index runs past the end of the file\n");
+    return false;
+  }
+  texture->levels.resize(levelCount);
+  for(u32 level = 0; level < levelCount; level++) {
+    KTX2LevelIndex levelIndex;
+    memcpy(&levelIndex, data + sizeof(header) + (level * sizeof(KTX2LevelIndex)), sizeof(levelIndex));
+    if(levelIndex.byteOffset > size || levelIndex.byteLength > size - levelIndex.byteOffset || levelIndex.byteLength % header.faceCount != 0) {
+      LOGE("KTX2 level %u is malformed or runs past the end of the file\n", level);
+      return false;
+    }
+    texture->levels[level] = {data + levelIndex.byteOffset, levelIndex.byteLength};
+  }
+
+  texture->keyValues.clear();
+  if((u64)header.kvdByteOffset + header.kvdByteLength > size) {
+    LOGE("KTX2 key/value data runs past the end of the file\n");
+    return false;
+  }
+  const char* keyValueData = data + header.kvdByteOffset;
+  const char* keyValueEnd = keyValueData + header.kvdByteLength;
+  while(keyValueEnd - keyValueData >= 4) {
+    u32 keyAndValueLength;
+    memcpy(&keyAndValueLength, keyValueData, sizeof(u32));
+    const char* keyAndValue = keyValueData + sizeof(u32);
+    if(keyAndValueLength > (u64)(keyValueEnd - keyAndValue)) { break; }
+    const char* keyEnd = (const char*)memchr(keyAndValue, '\0', keyAndValueLength);
+    if(keyEnd != nullptr) {
+      texture->keyValues.push_back({std::string(keyAndValue, keyEnd), keyEnd + 1, (u32)(keyAndValue + keyAndValueLength - (keyEnd + 1))});
+    }
+    keyValueData = keyAndValue + ((keyAndValueLength + 3) & ~3u);
+  }
+
+  return true;
+}
+
+#if !(defined(ANDROID) || defined(__ANDROID___))
+bool assets::saveKTX2(const char* path, const KTX2Texture& texture) {
+  KTX2FormatDesc desc;
+  if(!ktx2FormatDesc(texture.format, &desc)) {
+    printf("Texture format %s has no KTX2 equivalent\n", textureFormatToString(texture.format));
+    return false;
+  }
+
+  struct LOCAL_FUNCS {
+    static void append(std::vector<char>& bytes, const void* data, u64 size) {
+      bytes.insert(bytes.end(), (const char*)data, (const char*)data + size);
+    }
+    static void appendU32(std::vector<char>& bytes, u32 value) { append(bytes, &value, sizeof(value)); }
+    static void align(std::vector<char>& bytes, u64 alignment) {
+      bytes.resize(((bytes.size() + alignment - 1) / alignment) * alignment, 0);
+    }
+  };
+
+  const u32 levelCount = (u32)texture.levels.size();
+  KTX2Header header = {};
+  memcpy(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+  header.vkFormat = desc.vkFormat;
+  header.typeSize = 1;
+  header.pixelWidth = texture.width;
+  header.pixelHeight = texture.height;
+  header.faceCount = texture.faceCount;
+  header.levelCount = levelCount;
+
+  std::vector<char> fileBytes(sizeof(header) + (levelCount * sizeof(KTX2LevelIndex)), 0);
+
+  // Basic data format descriptor block
+  header.dfdByteOffset = (u32)fileBytes.size();
+  const u32 descriptorBlockSize = 24 + (16 * desc.sampleCount);
+  LOCAL_FUNCS::appendU32(fileBytes, 4 + descriptorBlockSize); // total size
+  LOCAL_FUNCS::appendU32(fileBytes, 0); // vendor & descriptor type, both Khronos basic
+  LOCAL_FUNCS::appendU32(fileBytes, 2 | (descriptorBlockSize << 16)); // version number & block size
+  const u8 model[4] = {desc.colorModel, KHR_DF_PRIMARIES_BT709, desc.transfer, 0};
+  const u8 blockDimensions[4] = {(u8)(desc.blockDimension - 1), (u8)(desc.blockDimension - 1), 0, 0};
+  const u8 bytesPlane[8] = {desc.bytesPerBlock, 0, 0, 0, 0, 0, 0, 0};
+  LOCAL_FUNCS::append(fileBytes, model, sizeof(model));
+  LOCAL_FUNCS::append(fileBytes, blockDimensions, sizeof(blockDimensions));
+  LOCAL_FUNCS::append(fileBytes, bytesPlane, sizeof(bytesPlane));
+  for(u32 sample = 0; sample < desc.sampleCount; sample++) {
+    u32 sampleBits = desc.samples[sample].bitOffset | ((desc.samples[sample].bitLength - 1) << 16) | (desc.samples[sample].channel << 24);
+    LOCAL_FUNCS::appendU32(fileBytes, sampleBits);
+    LOCAL_FUNCS::appendU32(fileBytes, 0); // sample position
+    LOCAL_FUNCS::appendU32(fileBytes, 0); // lower
+    LOCAL_FUNCS::appendU32(fileBytes, desc.samples[sample].upper);
+  }
+  header.dfdByteLength = (u32)fileBytes.size() - header.dfdByteOffset;
+
+  // NOTE: Key/value pairs must be sorted by key
+  std::vector<const KTX2KeyValue*> sortedKeyValues;
+  for(const KTX2KeyValue& keyValue: texture.keyValues) { sortedKeyValues.push_back(&keyValue); }
+  std::sort(sortedKeyValues.begin(), sortedKeyValues.end(), [](const KTX2KeyValue* a, const KTX2KeyValue* b) { return a->key < b->key; });
+  header.kvdByteOffset = sortedKeyValues.empty() ? 0 : (u32)fileBytes.size();
+  for(const KTX2KeyValue* keyValue: sortedKeyValues) {
+    LOCAL_FUNCS::appendU32(fileBytes, (u32)keyValue->key.size() + 1 + keyValue->size);
+    LOCAL_FUNCS::append(fileBytes, keyValue->key.c_str(), keyValue->key.size() + 1);
+    LOCAL_FUNCS::append(fileBytes, keyValue->value, keyValue->size);
+    LOCAL_FUNCS::align(fileBytes, 4);
+  }
+  header.kvdByteLength = sortedKeyValues.empty() ? 0 : (u32)fileBytes.size() - header.kvdByteOffset;
+
+  // NOTE: Levels are stored smallest first, each aligned to the least common multiple of the block size & 4
+  const u64 levelAlignment = (desc.bytesPerBlock % 4 == 0) ? desc.bytesPerBlock : desc.bytesPerBlock * 4;
+  std::vector<KTX2LevelIndex> levelIndices(levelCount);
+  for(s32 level = (s32)levelCount - 1; level >= 0; level--) {
+    LOCAL_FUNCS::align(fileBytes, levelAlignment);
+    levelIndices[level] = {fileBytes.size(), texture.levels[level].size, texture.levels[level].size};
+    LOCAL_FUNCS::append(fileBytes, texture.levels[level].data, texture.levels[level].size);
+  }
+
+  memcpy(fileBytes.data(), &header, sizeof(header));
+  memcpy(fileBytes.data() + sizeof(header), levelIndices.data(), levelCount * sizeof(KTX2LevelIndex));
+
+  std::ofstream outFile(path, std::ios::binary | std::ios::out);
+  outFile.write(fileBytes.data(), fileBytes.size());
+  if(!outFile.good()) {
+    printf("Failed to export KTX2 file: %s\n", path);
+    return false;
+  }
+  return true;
+}
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "asset_loader.h"
+#include "texture_asset.h"
+
+namespace assets {
+  /*
+   * Khronos KTX2 container (https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html), for exchanging textures with
+   * external tools. Only 2D textures & cube maps without supercompression, in a format matching a TextureFormat, are
+   * handled.
+   *  - Levels point straight into the file's bytes, so they can be uploaded without being copied.
+   *  - Each level holds every face of that mip level one after the other, same as the blob of a CubeMapInfo.
+   */
+  struct KTX2Level {
+    const char* data;
+    u64 size; // of all faces
+  };
+
+  struct KTX2KeyValue {
+    std::string key;
+    const char* value;
+    u32 size;
+  };
+
+  struct KTX2Texture {
+    TextureFormat format;
+    u32 width;
+    u32 height;
+    u32 faceCount; // 6 for cube maps
+    std::vector<KTX2Level> levels; // level 0 is the full resolution image
+    std::vector<KTX2KeyValue> keyValues;
+
+    u64 faceSize(u32 level) const { return levels[level].size / faceCount; }
+    const char* faceData(u32 level, u32 face) const { return levels[level].data + (faceSize(level) * face); }
+    // NOTE: Returns nullptr when the key is not present
+    const KTX2KeyValue* findKeyValue(const char* key) const;
+  };
+
+  // NOTE: texture points into data, which must outlive it. Returns false for unsupported or malformed files.
+  bool readKTX2(const char* data, u64 size, KTX2Texture* texture);
+#if !(defined(ANDROID) || defined(__ANDROID___))
+  bool saveKTX2(const char* path, const KTX2Texture& texture);
+#endif
+
+  // NOTE: VK_FORMAT_UNDEFINED (0) is returned for formats with no Vulkan equivalent
+  u32 textureFormatToVkFormat(TextureFormat format);
+  // NOTE: TextureFormat_Unknown is returned for formats the project has no use for
+  TextureFormat vkFormatToTextureFormat(u32 vkFormat);
+}
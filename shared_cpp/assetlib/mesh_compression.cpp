@@ -0,0 +1,204 @@
+#include "mesh_compression.h"
+
+#include <type_traits>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MESH_COMPRESSION_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MESH_COMPRESSION_SSE2 1
+#endif
+
+// NOTE: Number of elements decoded per SIMD iteration, one 16 byte register from each byte plane
+#define PLANE_BLOCK_SIZE 16
+
+template<typename T>
+internal_func inline T zigzagDecode(T value) {
+  return (value >> 1) ^ (T)(0 - (value & 1));
+}
+
+template<typename T>
+internal_func void scalarUntranspose(const u8* planes, u64 planeSize, u64 first, u64 last, T* elements) {
+  for(u64 i = first; i < last; i++) {
+    T element = 0;
+    for(u32 byteIndex = 0; byteIndex < sizeof(T); byteIndex++) {
+      element |= (T)planes[(byteIndex * planeSize) + i] << (byteIndex * 8);
+    }
+    elements[i] = zigzagDecode(element);
+  }
+}
+
+// Untransposes and zigzag decodes PLANE_BLOCK_SIZE 32-bit words
+internal_func inline void untransposeBlock(const u8* planes, u64 planeSize, u64 offset, u32* words) {
+#if MESH_COMPRESSION_NEON
+  uint8x16x4_t bytes;
+  bytes.val[0] = vld1q_u8(planes + offset);
+  bytes.val[1] = vld1q_u8(planes + planeSize + offset);
+  bytes.val[2] = vld1q_u8(planes + (2 * planeSize) + offset);
+  bytes.val[3] = vld1q_u8(planes + (3 * planeSize) + offset);
+  vst4q_u8((u8*)words, bytes);
+  const uint32x4_t one = vdupq_n_u32(1);
+  for(u32 i = 0; i < PLANE_BLOCK_SIZE; i += 4) {
+    uint32x4_t zigzag = vld1q_u32(words + i);
+    uint32x4_t sign = vreinterpretq_u32_s32(vnegq_s32(vreinterpretq_s32_u32(vandq_u32(zigzag, one))));
+    vst1q_u32(words + i, veorq_u32(vshrq_n_u32(zigzag, 1), sign));
+  }
+#elif MESH_COMPRESSION_SSE2
+  __m128i b0 = _mm_loadu_si128((const __m128i*)(planes + offset));
+  __m128i b1 = _mm_loadu_si128((const __m128i*)(planes + planeSize + offset));
+  __m128i b2 = _mm_loadu_si128((const __m128i*)(planes + (2 * planeSize) + offset));
+  __m128i b3 = _mm_loadu_si128((const __m128i*)(planes + (3 * planeSize) + offset));
+  __m128i b01Lo = _mm_unpacklo_epi8(b0, b1);
+  __m128i b01Hi = _mm_unpackhi_epi8(b0, b1);
+  __m128i b23Lo = _mm_unpacklo_epi8(b2, b3);
+  __m128i b23Hi = _mm_unpackhi_epi8(b2, b3);
+  __m128i zigzag[4] = {
+      _mm_unpacklo_epi16(b01Lo, b23Lo),
+      _mm_unpackhi_epi16(b01Lo, b23Lo),
+      _mm_unpacklo_epi16(b01Hi, b23Hi),
+      _mm_unpackhi_epi16(b01Hi, b23Hi)
+  };
+  const __m128i one = _mm_set1_epi32(1);
+  const __m128i zero = _mm_setzero_si128();
+  for(u32 i = 0; i < 4; i++) {
+    __m128i sign = _mm_sub_epi32(zero, _mm_and_si128(zigzag[i], one));
+    _mm_storeu_si128((__m128i*)(words + (i * 4)), _mm_xor_si128(_mm_srli_epi32(zigzag[i], 1), sign));
+  }
+#else
+  scalarUntranspose<u32>(planes, planeSize, offset, offset + PLANE_BLOCK_SIZE, words - offset);
+#endif
+}
+
+// Untransposes and zigzag decodes PLANE_BLOCK_SIZE 16-bit indices
+internal_func inline void untransposeBlock(const u8* planes, u64 planeSize, u64 offset, u16* halfWords) {
+#if MESH_COMPRESSION_NEON
+  uint8x16x2_t bytes;
+  bytes.val[0] = vld1q_u8(planes + offset);
+  bytes.val[1] = vld1q_u8(planes + planeSize + offset);
+  vst2q_u8((u8*)halfWords, bytes);
+  const uint16x8_t one = vdupq_n_u16(1);
+  for(u32 i = 0; i < PLANE_BLOCK_SIZE; i += 8) {
+    uint16x8_t zigzag = vld1q_u16(halfWords + i);
+    uint16x8_t sign = vreinterpretq_u16_s16(vnegq_s16(vreinterpretq_s16_u16(vandq_u16(zigzag, one))));
+    vst1q_u16(halfWords + i, veorq_u16(vshrq_n_u16(zigzag, 1), sign));
+  }
+#elif MESH_COMPRESSION_SSE2
+  __m128i b0 = _mm_loadu_si128((const __m128i*)(planes + offset));
+  __m128i b1 = _mm_loadu_si128((const __m128i*)(planes + planeSize + offset));
+  __m128i zigzag[2] = {
+      _mm_unpacklo_epi8(b0, b1),
+      _mm_unpackhi_epi8(b0, b1)
+  };
+  const __m128i one = _mm_set1_epi16(1);
+  const __m128i zero = _mm_setzero_si128();
+  for(u32 i = 0; i < 2; i++) {
+    __m128i sign = _mm_sub_epi16(zero, _mm_and_si128(zigzag[i], one));
+    _mm_storeu_si128((__m128i*)(halfWords + (i * 8)), _mm_xor_si128(_mm_srli_epi16(zigzag[i], 1), sign));
+  }
+#else
+  scalarUntranspose<u16>(planes, planeSize, offset, offset + PLANE_BLOCK_SIZE, halfWords - offset);
+#endif
+}
+
+void assets::decodeVertexStream(const char* planes, u64 size, u32 vertexStride, char* vertices) {
+  assert((size % sizeof(u32)) == 0 && (vertexStride % sizeof(u32)) == 0);
+  const u8* planeBytes = (const u8*)planes;
+  const u64 wordCount = size / sizeof(u32);
+  const u64 strideInWords = vertexStride / sizeof(u32);
+  u32* words = (u32*)vertices;
+
+  u64 blockEnd = wordCount - (wordCount % PLANE_BLOCK_SIZE);
+  for(u64 i = 0; i < blockEnd; i += PLANE_BLOCK_SIZE) {
+    untransposeBlock(planeBytes, wordCount, i, words + i);
+  }
+  scalarUntranspose<u32>(planeBytes, wordCount, blockEnd, wordCount, words);
+
+  // undo the delta against the previous vertex
+  for(u64 i = strideInWords; i < wordCount; i++) {
+    words[i] += words[i - strideInWords];
+  }
+}
+
+template<typename T>
+internal_func void decodeIndices(const u8* planes, u64 indexCount, T* indices) {
+  u64 blockEnd = 0;
+  if constexpr(sizeof(T) != sizeof(u8)) {
+    blockEnd = indexCount - (indexCount % PLANE_BLOCK_SIZE);
+    for(u64 i = 0; i < blockEnd; i += PLANE_BLOCK_SIZE) {
+      untransposeBlock(planes, indexCount, i, indices + i);
+    }
+  }
+  scalarUntranspose<T>(planes, indexCount, blockEnd, indexCount, indices);
+
+  // undo the delta against the previous index
+  for(u64 i = 1; i < indexCount; i++) {
+    indices[i] += indices[i - 1];
+  }
+}
+
+void assets::decodeIndexStream(const char* planes, u64 size, u32 indexTypeSize, char* indices) {
+  assert((size % indexTypeSize) == 0);
+  const u64 indexCount = size / indexTypeSize;
+  switch(indexTypeSize) {
+    case sizeof(u8): decodeIndices<u8>((const u8*)planes, indexCount, (u8*)indices); break;
+    case sizeof(u16): decodeIndices<u16>((const u8*)planes, indexCount, (u16*)indices); break;
+    case sizeof(u32): decodeIndices<u32>((const u8*)planes, indexCount, (u32*)indices); break;
+    default: InvalidCodePath
+  }
+}
+
+#if !(defined(ANDROID) || defined(__ANDROID___))
+
+template<typename T>
+internal_func inline T zigzagEncode(T delta) {
+  typedef std::make_signed_t<T> S;
+  return (T)((T)delta << 1) ^ (T)((S)delta >> ((sizeof(T) * 8) - 1));
+}
+
+template<typename T>
+internal_func void transpose(const T* elements, u64 count, u8* planes) {
+  for(u64 i = 0; i < count; i++) {
+    for(u32 byteIndex = 0; byteIndex < sizeof(T); byteIndex++) {
+      planes[(byteIndex * count) + i] = (u8)(elements[i] >> (byteIndex * 8));
+    }
+  }
+}
+
+void assets::encodeVertexStream(const char* vertices, u64 size, u32 vertexStride, char* planes) {
+  assert((size % sizeof(u32)) == 0 && (vertexStride % sizeof(u32)) == 0);
+  const u64 wordCount = size / sizeof(u32);
+  const u64 strideInWords = vertexStride / sizeof(u32);
+  const u32* words = (const u32*)vertices;
+
+  std::vector<u32> filtered(wordCount);
+  for(u64 i = 0; i < wordCount; i++) {
+    u32 prediction = (i < strideInWords) ? 0 : words[i - strideInWords];
+    filtered[i] = zigzagEncode<u32>(words[i] - prediction);
+  }
+  transpose(filtered.data(), wordCount, (u8*)planes);
+}
+
+template<typename T>
+internal_func void encodeIndices(const T* indices, u64 indexCount, u8* planes) {
+  std::vector<T> filtered(indexCount);
+  T previous = 0;
+  for(u64 i = 0; i < indexCount; i++) {
+    filtered[i] = zigzagEncode<T>((T)(indices[i] - previous));
+    previous = indices[i];
+  }
+  transpose(filtered.data(), indexCount, planes);
+}
+
+void assets::encodeIndexStream(const char* indices, u64 size, u32 indexTypeSize, char* planes) {
+  assert((size % indexTypeSize) == 0);
+  const u64 indexCount = size / indexTypeSize;
+  switch(indexTypeSize) {
+    case sizeof(u8): encodeIndices<u8>((const u8*)indices, indexCount, (u8*)planes); break;
+    case sizeof(u16): encodeIndices<u16>((const u16*)indices, indexCount, (u8*)planes); break;
+    case sizeof(u32): encodeIndices<u32>((const u32*)indices, indexCount, (u8*)planes); break;
+    default: InvalidCodePath
+  }
+}
+
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "asset_loader.h"
+
+/*
+ * Geometry specific filters applied to vertex and index buffers before they are handed to LZ4.
+ *  - Vertex attributes are treated as 32-bit words. Each word is delta coded against the same component of the previous
+ *    vertex and zigzag encoded. Nearby vertices share most of their high bits, so the high bytes end up mostly zero.
+ *  - Indices are delta coded against the previous index and zigzag encoded.
+ *  - The results are then transposed into byte planes (every byte 0, followed by every byte 1, ...) so that the mostly
+ *    constant high bytes sit next to each other where LZ4 can find them.
+ * Filtered streams are exactly the same size as the unfiltered data.
+ */
+namespace assets {
+  void decodeVertexStream(const char* planes, u64 size, u32 vertexStride, char* vertices);
+  void decodeIndexStream(const char* planes, u64 size, u32 indexTypeSize, char* indices);
+
+#if !(defined(ANDROID) || defined(__ANDROID___))
+  void encodeVertexStream(const char* vertices, u64 size, u32 vertexStride, char* planes);
+  void encodeIndexStream(const char* indices, u64 size, u32 indexTypeSize, char* planes);
+#endif
+}
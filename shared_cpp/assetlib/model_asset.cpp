@@ -1,4 +1,9 @@
 #include "model_asset.h"
+#include "mesh_compression.h"
+
+#if !(defined(ANDROID) || defined(__ANDROID___))
+#include "lz4hc.h"
+#endif
 
 const internal_func char* MODEL_FOURCC = "modl";
 
@@ -6,9 +11,12 @@ const struct {
   const char* positionAttributeSize = "positionAttributeSize";
   const char* normalAttributeSize = "normalAttributeSize";
   const char* uvAttributeSize = "uvAttributeSize";
+  const char* tangentAttributeSize = "tangentAttributeSize";
   const char* indicesSize = "indicesSize";
   const char* indexTypeSize = "indexTypeSize";
   const char* indexCount = "indexCount";
+  const char* geometryCompression = "geometryCompression";
+  const char* packedGeometrySize = "packedGeometrySize";
   const char* baseColor = "baseColor";
   const char* boundingBoxMin = "boundingBoxMin";
   const char* boundingBoxDiagonal = "boundingBoxDiagonal";
@@ -20,7 +28,11 @@ const struct {
   const char* albedoTexSize = "albedoTexSize";
   const char* albedoTexWidth = "albedoTexWidth";
   const char* albedoTexHeight = "albedoTexHeight";
+  const char* bvhNodesSize = "bvhNodesSize";
+  const char* bvhTrianglesSize = "bvhTrianglesSize";
   const char* albedoTexChannels = "albedoTexChannels";
+  const char* albedoAtlasName = "albedoAtlasName";
+  const char* normalAtlasName = "normalAtlasName";
   const char* originalFileName = "originalFileName";
 } jsonKeys;
 
@@ -30,9 +42,13 @@ void assets::readModelInfo(const AssetFile& file, ModelInfo* info) {
   info->positionAttributeSize = modelJson[jsonKeys.positionAttributeSize];
   info->normalAttributeSize = modelJson[jsonKeys.normalAttributeSize];
   info->uvAttributeSize = modelJson[jsonKeys.uvAttributeSize];
+  info->tangentAttributeSize = modelJson.value(jsonKeys.tangentAttributeSize, (u64)0);
   info->indicesSize = modelJson[jsonKeys.indicesSize];
   info->indexTypeSize = modelJson[jsonKeys.indexTypeSize];
   info->indexCount = modelJson[jsonKeys.indexCount];
+  u32 geometryCompressionEnum = modelJson.value(jsonKeys.geometryCompression, compressionModeToEnumVal(CompressionMode_None));
+  info->geometryCompression = CompressionMode(geometryCompressionEnum);
+  info->packedGeometrySize = modelJson.value(jsonKeys.packedGeometrySize, info->geometrySize());
   nlohmann::json baseColor = modelJson[jsonKeys.baseColor];
   info->baseColor[0] = baseColor[0];
   info->baseColor[1] = baseColor[1];
@@ -54,36 +70,97 @@ void assets::readModelInfo(const AssetFile& file, ModelInfo* info) {
   info->albedoTexSize = modelJson[jsonKeys.albedoTexSize];
   info->albedoTexWidth = modelJson[jsonKeys.albedoTexWidth];
   info->albedoTexHeight = modelJson[jsonKeys.albedoTexHeight];
-  info->originalFileName = modelJson[jsonKeys.originalFileName];
+  info->bvhNodesSize = modelJson.value(jsonKeys.bvhNodesSize, (u64)0);
+  info->bvhTrianglesSize = modelJson.value(jsonKeys.bvhTrianglesSize, (u64)0);
+  info->albedoAtlasName = modelJson.value(jsonKeys.albedoAtlasName, "");
+  info->normalAtlasName = modelJson.value(jsonKeys.normalAtlasName, "");
+  info->originalFileName = modelJson.value(jsonKeys.originalFileName, "");
+}
+
+#if !(defined(ANDROID) || defined(__ANDROID___))
+internal_func std::vector<char> compressGeometry(const std::vector<char>& geometry) {
+  std::vector<char> compressedGeometry(LZ4_compressBound((s32)geometry.size()));
+  s32 compressedSize = LZ4_compress_HC(geometry.data(), compressedGeometry.data(), (s32)geometry.size(), (s32)compressedGeometry.size(), LZ4HC_CLEVEL_MAX);
+  assert(compressedSize > 0);
+  compressedGeometry.resize(compressedSize);
+  return compressedGeometry;
 }
 
 assets::AssetFile assets::packModel(ModelInfo* info,
                                       void* posAttData,
                                       void* normalAttData,
                                       void* uvAttData,
+                                      void* tangentAttData,
                                       void* indexData,
                                       void* normalTexData,
-                                      void* albedoTexData) {
+                                      void* albedoTexData,
+                                      const BVH* bvh) {
 
   //core file header
   AssetFile file;
   strncpy(file.type, MODEL_FOURCC, 4);
   file.version = ASSET_LIB_VERSION;
 
-  u64 totalBlobSize = info->positionAttributeSize +
-                      info->uvAttributeSize +
-                      info->normalAttributeSize +
-                      info->indicesSize +
+  std::vector<char> geometry(info->geometrySize());
+  {
+    char* geometryHead = geometry.data();
+    memcpy(geometryHead, posAttData, info->positionAttributeSize);
+    geometryHead += info->positionAttributeSize;
+    memcpy(geometryHead, normalAttData, info->normalAttributeSize);
+    geometryHead += info->normalAttributeSize;
+    memcpy(geometryHead, uvAttData, info->uvAttributeSize);
+    geometryHead += info->uvAttributeSize;
+    memcpy(geometryHead, tangentAttData, info->tangentAttributeSize);
+    geometryHead += info->tangentAttributeSize;
+    memcpy(geometryHead, indexData, info->indicesSize);
+  }
+
+  if(info->geometryCompression != CompressionMode_None) {
+    std::vector<char> compressedGeometry = compressGeometry(geometry);
+    if(info->geometryCompression == CompressionMode_MeshFilterLZ4) {
+      std::vector<char> filteredGeometry(geometry.size());
+      char* filteredHead = filteredGeometry.data();
+      encodeVertexStream((const char*)posAttData, info->positionAttributeSize, 3 * sizeof(f32), filteredHead);
+      filteredHead += info->positionAttributeSize;
+      encodeVertexStream((const char*)normalAttData, info->normalAttributeSize, 3 * sizeof(f32), filteredHead);
+      filteredHead += info->normalAttributeSize;
+      encodeVertexStream((const char*)uvAttData, info->uvAttributeSize, 2 * sizeof(f32), filteredHead);
+      filteredHead += info->uvAttributeSize;
+      encodeVertexStream((const char*)tangentAttData, info->tangentAttributeSize, 4 * sizeof(f32), filteredHead);
+      filteredHead += info->tangentAttributeSize;
+      encodeIndexStream((const char*)indexData, info->indicesSize, info->indexTypeSize, filteredHead);
+
+      // NOTE: Small meshes have too few similar neighbors for the filters to pay off, keep whichever encoding is smaller
+      std::vector<char> compressedFilteredGeometry = compressGeometry(filteredGeometry);
+      if(compressedFilteredGeometry.size() < compressedGeometry.size()) {
+        compressedGeometry.swap(compressedFilteredGeometry);
+      } else {
+        info->geometryCompression = CompressionMode_LZ4;
+      }
+    }
+    geometry.swap(compressedGeometry);
+  }
+  info->packedGeometrySize = geometry.size();
+
+  info->bvhNodesSize = (bvh == nullptr) ? 0 : bvh->nodes.size() * sizeof(BVHNode);
+  info->bvhTrianglesSize = (bvh == nullptr) ? 0 : bvh->triangles.size() * sizeof(BVHTriangle);
+
+  u64 totalBlobSize = info->packedGeometrySize +
                       info->albedoTexSize +
-                      info->normalTexSize;
+                      info->normalTexSize +
+                      info->bvhNodesSize +
+                      info->bvhTrianglesSize;
 
   nlohmann::json modelJson;
   modelJson[jsonKeys.positionAttributeSize] = info->positionAttributeSize;
   modelJson[jsonKeys.normalAttributeSize] = info->normalAttributeSize;
   modelJson[jsonKeys.uvAttributeSize] = info->uvAttributeSize;
+  modelJson[jsonKeys.tangentAttributeSize] = info->tangentAttributeSize;
   modelJson[jsonKeys.indicesSize] = info->indicesSize;
   modelJson[jsonKeys.indexTypeSize] = info->indexTypeSize;
   modelJson[jsonKeys.indexCount] = info->indexCount;
+  modelJson[jsonKeys.geometryCompression] = compressionModeToEnumVal(info->geometryCompression);
+  modelJson[jsonKeys.packedGeometrySize] = info->packedGeometrySize;
   modelJson[jsonKeys.baseColor] = nlohmann::json::array({
     info->baseColor[0],
     info->baseColor[1],
@@ -108,41 +185,87 @@ assets::AssetFile assets::packModel(ModelInfo* info,
   modelJson[jsonKeys.albedoTexSize] = info->albedoTexSize;
   modelJson[jsonKeys.albedoTexWidth] = info->albedoTexWidth;
   modelJson[jsonKeys.albedoTexHeight] = info->albedoTexHeight;
+  modelJson[jsonKeys.bvhNodesSize] = info->bvhNodesSize;
+  modelJson[jsonKeys.bvhTrianglesSize] = info->bvhTrianglesSize;
+  if(!info->albedoAtlasName.empty()) { modelJson[jsonKeys.albedoAtlasName] = info->albedoAtlasName; }
+  if(!info->normalAtlasName.empty()) { modelJson[jsonKeys.normalAtlasName] = info->normalAtlasName; }
   modelJson[jsonKeys.originalFileName] = info->originalFileName;
   file.json = modelJson.dump(); // json map to string
 
   file.binaryBlob.resize(totalBlobSize);
   char* binaryBlobData = file.binaryBlob.data();
-  memcpy(binaryBlobData, posAttData, info->positionAttributeSize);
-  binaryBlobData += info->positionAttributeSize;
-  memcpy(binaryBlobData, normalAttData, info->normalAttributeSize);
-  binaryBlobData += info->normalAttributeSize;
-  memcpy(binaryBlobData, uvAttData, info->uvAttributeSize);
-  binaryBlobData += info->uvAttributeSize;
-  memcpy(binaryBlobData, indexData, info->indicesSize);
-  binaryBlobData += info->indicesSize;
+  memcpy(binaryBlobData, geometry.data(), info->packedGeometrySize);
+  binaryBlobData += info->packedGeometrySize;
   memcpy(binaryBlobData, albedoTexData, info->albedoTexSize);
   binaryBlobData += info->albedoTexSize;
   memcpy(binaryBlobData, normalTexData, info->normalTexSize);
   binaryBlobData += info->normalTexSize;
+  if(bvh != nullptr) {
+    memcpy(binaryBlobData, bvh->nodes.data(), info->bvhNodesSize);
+    binaryBlobData += info->bvhNodesSize;
+    memcpy(binaryBlobData, bvh->triangles.data(), info->bvhTrianglesSize);
+    binaryBlobData += info->bvhTrianglesSize;
+  }
 
-  assert((binaryBlobData - file.binaryBlob.data()) == totalBlobSize);
+  assert((u64)(binaryBlobData - file.binaryBlob.data()) == totalBlobSize);
 
   return file;
 }
+#endif
+
+char* assets::unpackModelGeometry(const ModelInfo& info, char* data, std::vector<char>* geometryBuffer) {
+  const u64 geometrySize = info.geometrySize();
+  switch(info.geometryCompression) {
+    case CompressionMode_None: {
+      return data;
+    }
+    case CompressionMode_LZ4: {
+      geometryBuffer->resize(geometrySize);
+      s32 decompressedSize = LZ4_decompress_safe(data, geometryBuffer->data(), (s32)info.packedGeometrySize, (s32)geometrySize);
+      assert((u64)decompressedSize == geometrySize);
+      return geometryBuffer->data();
+    }
+    case CompressionMode_MeshFilterLZ4: {
+      // NOTE: Second half of the buffer holds the filtered streams before they are decoded into the first half
+      geometryBuffer->resize(geometrySize * 2);
+      char* geometry = geometryBuffer->data();
+      char* filteredGeometry = geometry + geometrySize;
+      s32 decompressedSize = LZ4_decompress_safe(data, filteredGeometry, (s32)info.packedGeometrySize, (s32)geometrySize);
+      assert((u64)decompressedSize == geometrySize);
+
+      decodeVertexStream(filteredGeometry, info.positionAttributeSize, 3 * sizeof(f32), geometry);
+      u64 offset = info.positionAttributeSize;
+      decodeVertexStream(filteredGeometry + offset, info.normalAttributeSize, 3 * sizeof(f32), geometry + offset);
+      offset += info.normalAttributeSize;
+      decodeVertexStream(filteredGeometry + offset, info.uvAttributeSize, 2 * sizeof(f32), geometry + offset);
+      offset += info.uvAttributeSize;
+      decodeVertexStream(filteredGeometry + offset, info.tangentAttributeSize, 4 * sizeof(f32), geometry + offset);
+      offset += info.tangentAttributeSize;
+      decodeIndexStream(filteredGeometry + offset, info.indicesSize, info.indexTypeSize, geometry + offset);
+      return geometry;
+    }
+    default: {
+      InvalidCodePath
+      return nullptr;
+    }
+  }
+}
 
-assets::ModelDataPtrs assets::ModelInfo::calcDataPts(char* data) {
+assets::ModelDataPtrs assets::ModelInfo::calcDataPts(char* data, char* geometry) {
   ModelDataPtrs modelDataPtrs;
-  char* dataTraversalHead = data;
-  modelDataPtrs.vertAtts = dataTraversalHead; // Note: Always assumed to be present
+  modelDataPtrs.vertAtts = geometry; // Note: Always assumed to be present
   modelDataPtrs.posVertAttOffset = 0;
   modelDataPtrs.normalVertAttOffset = positionAttributeSize;
   modelDataPtrs.uvVertAttOffset = positionAttributeSize + normalAttributeSize;
-  dataTraversalHead += positionAttributeSize + normalAttributeSize + uvAttributeSize;
-  modelDataPtrs.indices = (indicesSize == 0) ? nullptr : dataTraversalHead;
-  dataTraversalHead += indicesSize;
+  modelDataPtrs.tangentVertAttOffset = modelDataPtrs.uvVertAttOffset + uvAttributeSize;
+  modelDataPtrs.indices = (indicesSize == 0) ? nullptr : geometry + modelDataPtrs.tangentVertAttOffset + tangentAttributeSize;
+  char* dataTraversalHead = data + packedGeometrySize;
   modelDataPtrs.albedoTex = (albedoTexSize == 0) ? nullptr : dataTraversalHead;
   dataTraversalHead += albedoTexSize;
   modelDataPtrs.normalTex = (normalTexSize == 0) ? nullptr : dataTraversalHead;
+  dataTraversalHead += normalTexSize;
+  modelDataPtrs.bvhNodes = (bvhNodesSize == 0) ? nullptr : dataTraversalHead;
+  dataTraversalHead += bvhNodesSize;
+  modelDataPtrs.bvhTriangles = (bvhTrianglesSize == 0) ? nullptr : dataTraversalHead;
   return modelDataPtrs;
 }
@@ -2,6 +2,7 @@
 
 #include "asset_loader.h"
 #include "texture_asset.h"
+#include "model_bvh.h"
 
 namespace assets {
 
@@ -10,9 +11,12 @@ namespace assets {
     u64 posVertAttOffset;
     u64 normalVertAttOffset;
     u64 uvVertAttOffset;
+    u64 tangentVertAttOffset;
     void* indices;
     void* albedoTex;
     void* normalTex;
+    void* bvhNodes;
+    void* bvhTriangles;
   };
 
   struct ModelInfo {
@@ -21,12 +25,16 @@ namespace assets {
     u64 positionAttributeSize;
     u64 normalAttributeSize;
     u64 uvAttributeSize;
+    u64 tangentAttributeSize; // NOTE: Only baked when a normal map is present
     u64 indicesSize;
     u32 indexTypeSize;
     u32 indexCount;
+    CompressionMode geometryCompression; // applies to vertex attributes & indices, textures are never compressed further
+    u64 packedGeometrySize; // size of the vertex attributes & indices as stored in the blob
     // position num components = 3
     // normal num components = 3
     // uv num components = 2
+    // tangent num components = 4 (xyz tangent, w bitangent handedness)
     // type of data GL_FLOAT
     // should be normalize = false
     // stride = 0
@@ -45,15 +53,34 @@ namespace assets {
     u32 albedoTexWidth;
     u32 albedoTexHeight;
 
-    ModelDataPtrs calcDataPts(char* data);
+    // NOTE: Set when the asset baker packed the model's textures into shared atlases (see --texture-atlas), in which
+    // case the model's own textures are empty and its uvs already address the model's rect within the atlas
+    std::string albedoAtlasName;
+    std::string normalAtlasName;
+
+    // NOTE: BVH is stored uncompressed after the textures so that it can be copied straight out of the blob
+    u64 bvhNodesSize;
+    u64 bvhTrianglesSize;
+
+    u64 geometrySize() const { return positionAttributeSize + normalAttributeSize + uvAttributeSize + tangentAttributeSize + indicesSize; }
+    // NOTE: geometry is the unpacked vertex attributes & indices, see unpackModelGeometry()
+    ModelDataPtrs calcDataPts(char* data, char* geometry);
   };
 
   void readModelInfo(const AssetFile& file, ModelInfo* info);
+#if !(defined(ANDROID) || defined(__ANDROID___))
+  // NOTE: Sets packedGeometrySize based on the requested geometryCompression
+  // NOTE: MeshFilterLZ4 falls back to LZ4, updating geometryCompression, when the filters do not shrink the geometry
   AssetFile packModel(ModelInfo* info,
                           void* posAttData,
                           void* normalAttData,
                           void* uvAttData,
+                          void* tangentAttData,
                           void* indexData,
                           void* normalTexData,
-                          void* albedoTexData);
+                          void* albedoTexData,
+                          const BVH* bvh);
+#endif
+  // Returns pointer to the vertex attributes & indices of the blob, decompressing them into geometryBuffer if necessary
+  char* unpackModelGeometry(const ModelInfo& info, char* data, std::vector<char>* geometryBuffer);
 }
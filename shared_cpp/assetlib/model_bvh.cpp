@@ -0,0 +1,686 @@
+#include "model_bvh.h"
+
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BVH_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BVH_SSE2 1
+#endif
+
+#define BVH_STACK_SIZE 64
+#define BVH_SAH_BIN_COUNT 12
+
+// NOTE: Queries are all treated as a (possibly fat) ray, segments & sweeps use t in [0, 1]
+struct BVHQuery {
+  f32 origin[3];
+  f32 direction[3];
+  f32 invDirection[3];
+  f32 radius;
+};
+
+internal_func inline f32 dot3(const f32 a[3], const f32 b[3]) {
+  return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]);
+}
+
+internal_func inline void sub3(const f32 a[3], const f32 b[3], f32 out[3]) {
+  out[0] = a[0] - b[0];
+  out[1] = a[1] - b[1];
+  out[2] = a[2] - b[2];
+}
+
+internal_func inline void cross3(const f32 a[3], const f32 b[3], f32 out[3]) {
+  out[0] = (a[1] * b[2]) - (a[2] * b[1]);
+  out[1] = (a[2] * b[0]) - (a[0] * b[2]);
+  out[2] = (a[0] * b[1]) - (a[1] * b[0]);
+}
+
+internal_func inline void pointAlong(const f32 origin[3], const f32 direction[3], f32 t, f32 out[3]) {
+  out[0] = origin[0] + (direction[0] * t);
+  out[1] = origin[1] + (direction[1] * t);
+  out[2] = origin[2] + (direction[2] * t);
+}
+
+internal_func inline bool normalize3(f32 v[3]) {
+  f32 lengthSq = dot3(v, v);
+  if(lengthSq <= 0.0f) { return false; }
+  f32 invLength = 1.0f / sqrtf(lengthSq);
+  v[0] *= invLength;
+  v[1] *= invLength;
+  v[2] *= invLength;
+  return true;
+}
+
+internal_func BVHQuery createQuery(const f32 origin[3], const f32 direction[3], f32 radius) {
+  BVHQuery query;
+  for(u32 i = 0; i < 3; i++) {
+    query.origin[i] = origin[i];
+    query.direction[i] = direction[i];
+    // NOTE: A huge finite value instead of infinity keeps 0 * invDirection from turning into NaN in the slab test
+    query.invDirection[i] = (fabsf(direction[i]) > 1e-30f) ? (1.0f / direction[i]) : copysignf(1e30f, direction[i]);
+  }
+  query.radius = radius;
+  return query;
+}
+
+// Slab test against the four children's bounds expanded by the query radius.
+// Returns a bit mask of the children overlapping [0, tMax] and writes the entry t of every child.
+internal_func inline u32 intersectChildren(const assets::BVHNode& node, const BVHQuery& query, f32 tMax, f32 tEnter[BVH_WIDTH]) {
+#if BVH_NEON
+  const float32x4_t radius = vdupq_n_f32(query.radius);
+  const float32x4_t t0x = vmulq_f32(vsubq_f32(vsubq_f32(vld1q_f32(node.minX), radius), vdupq_n_f32(query.origin[0])), vdupq_n_f32(query.invDirection[0]));
+  const float32x4_t t1x = vmulq_f32(vsubq_f32(vaddq_f32(vld1q_f32(node.maxX), radius), vdupq_n_f32(query.origin[0])), vdupq_n_f32(query.invDirection[0]));
+  const float32x4_t t0y = vmulq_f32(vsubq_f32(vsubq_f32(vld1q_f32(node.minY), radius), vdupq_n_f32(query.origin[1])), vdupq_n_f32(query.invDirection[1]));
+  const float32x4_t t1y = vmulq_f32(vsubq_f32(vaddq_f32(vld1q_f32(node.maxY), radius), vdupq_n_f32(query.origin[1])), vdupq_n_f32(query.invDirection[1]));
+  const float32x4_t t0z = vmulq_f32(vsubq_f32(vsubq_f32(vld1q_f32(node.minZ), radius), vdupq_n_f32(query.origin[2])), vdupq_n_f32(query.invDirection[2]));
+  const float32x4_t t1z = vmulq_f32(vsubq_f32(vaddq_f32(vld1q_f32(node.maxZ), radius), vdupq_n_f32(query.origin[2])), vdupq_n_f32(query.invDirection[2]));
+  const float32x4_t enter = vmaxq_f32(vmaxq_f32(vminq_f32(t0x, t1x), vminq_f32(t0y, t1y)), vmaxq_f32(vminq_f32(t0z, t1z), vdupq_n_f32(0.0f)));
+  const float32x4_t exit = vminq_f32(vminq_f32(vmaxq_f32(t0x, t1x), vmaxq_f32(t0y, t1y)), vminq_f32(vmaxq_f32(t0z, t1z), vdupq_n_f32(tMax)));
+  const uint32x4_t valid = vmvnq_u32(vceqq_u32(vld1q_u32(node.children), vdupq_n_u32(BVH_INVALID_CHILD)));
+  const u32 laneBitsArray[BVH_WIDTH] = {1, 2, 4, 8};
+  const uint32x4_t laneBits = vandq_u32(vandq_u32(vcleq_f32(enter, exit), valid), vld1q_u32(laneBitsArray));
+  const uint32x2_t halfSum = vadd_u32(vget_low_u32(laneBits), vget_high_u32(laneBits));
+  vst1q_f32(tEnter, enter);
+  return vget_lane_u32(vpadd_u32(halfSum, halfSum), 0);
+#elif BVH_SSE2
+  const __m128 radius = _mm_set1_ps(query.radius);
+  const __m128 t0x = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(_mm_loadu_ps(node.minX), radius), _mm_set1_ps(query.origin[0])), _mm_set1_ps(query.invDirection[0]));
+  const __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(_mm_loadu_ps(node.maxX), radius), _mm_set1_ps(query.origin[0])), _mm_set1_ps(query.invDirection[0]));
+  const __m128 t0y = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(_mm_loadu_ps(node.minY), radius), _mm_set1_ps(query.origin[1])), _mm_set1_ps(query.invDirection[1]));
+  const __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(_mm_loadu_ps(node.maxY), radius), _mm_set1_ps(query.origin[1])), _mm_set1_ps(query.invDirection[1]));
+  const __m128 t0z = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(_mm_loadu_ps(node.minZ), radius), _mm_set1_ps(query.origin[2])), _mm_set1_ps(query.invDirection[2]));
+  const __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(_mm_loadu_ps(node.maxZ), radius), _mm_set1_ps(query.origin[2])), _mm_set1_ps(query.invDirection[2]));
+  const __m128 enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)), _mm_max_ps(_mm_min_ps(t0z, t1z), _mm_setzero_ps()));
+  const __m128 exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)), _mm_min_ps(_mm_max_ps(t0z, t1z), _mm_set1_ps(tMax)));
+  const __m128i invalid = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)node.children), _mm_set1_epi32((s32)BVH_INVALID_CHILD));
+  _mm_storeu_ps(tEnter, enter);
+  return (u32)(_mm_movemask_ps(_mm_cmple_ps(enter, exit)) & ~_mm_movemask_ps(_mm_castsi128_ps(invalid)));
+#else
+  const f32* mins[3] = {node.minX, node.minY, node.minZ};
+  const f32* maxs[3] = {node.maxX, node.maxY, node.maxZ};
+  u32 hitMask = 0;
+  for(u32 child = 0; child < BVH_WIDTH; child++) {
+    f32 enter = 0.0f;
+    f32 exit = tMax;
+    for(u32 axis = 0; axis < 3; axis++) {
+      f32 t0 = (mins[axis][child] - query.radius - query.origin[axis]) * query.invDirection[axis];
+      f32 t1 = (maxs[axis][child] + query.radius - query.origin[axis]) * query.invDirection[axis];
+      enter = std::max(enter, std::min(t0, t1));
+      exit = std::min(exit, std::max(t0, t1));
+    }
+    tEnter[child] = enter;
+    if(enter <= exit && node.children[child] != BVH_INVALID_CHILD) { hitMask |= 1 << child; }
+  }
+  return hitMask;
+#endif
+}
+
+template<typename TriangleTest>
+internal_func bool closestHit(const assets::BVH& bvh, const BVHQuery& query, f32 tMax, TriangleTest testTriangle, assets::BVHHit* hit) {
+  if(bvh.nodes.empty()) { return false; }
+
+  u32 stack[BVH_STACK_SIZE];
+  u32 stackSize = 0;
+  stack[stackSize++] = 0;
+
+  bool found = false;
+  assets::BVHHit closest;
+  closest.t = tMax;
+  while(stackSize > 0) {
+    const assets::BVHNode& node = bvh.nodes[stack[--stackSize]];
+    f32 tEnter[BVH_WIDTH];
+    u32 hitMask = intersectChildren(node, query, closest.t, tEnter);
+
+    u32 interiorChildren[BVH_WIDTH];
+    u32 interiorCount = 0;
+    for(u32 child = 0; child < BVH_WIDTH; child++) {
+      if(!(hitMask & (1 << child))) { continue; }
+      if(node.triangleCounts[child] == 0) {
+        interiorChildren[interiorCount++] = child;
+        continue;
+      }
+      u32 lastTriangle = node.children[child] + node.triangleCounts[child];
+      for(u32 triangleIndex = node.children[child]; triangleIndex < lastTriangle; triangleIndex++) {
+        assets::BVHHit triangleHit;
+        if(testTriangle(bvh.triangles[triangleIndex], query, closest.t, &triangleHit)) {
+          closest = triangleHit;
+          closest.triangleIndex = triangleIndex;
+          found = true;
+        }
+      }
+    }
+
+    // push the farthest children first so that the nearest child is visited next
+    for(u32 i = 1; i < interiorCount; i++) {
+      u32 child = interiorChildren[i];
+      u32 j = i;
+      for(; j > 0 && tEnter[interiorChildren[j - 1]] < tEnter[child]; j--) {
+        interiorChildren[j] = interiorChildren[j - 1];
+      }
+      interiorChildren[j] = child;
+    }
+    assert(stackSize + interiorCount <= BVH_STACK_SIZE);
+    for(u32 i = 0; i < interiorCount; i++) {
+      stack[stackSize++] = node.children[interiorChildren[i]];
+    }
+  }
+
+  if(found && hit) { *hit = closest; }
+  return found;
+}
+
+internal_func void triangleNormalFacing(const assets::BVHTriangle& triangle, const f32 direction[3], f32 normal[3]) {
+  cross3(triangle.edge1, triangle.edge2, normal);
+  normalize3(normal);
+  if(dot3(normal, direction) > 0.0f) {
+    normal[0] = -normal[0];
+    normal[1] = -normal[1];
+    normal[2] = -normal[2];
+  }
+}
+
+// Möller–Trumbore, two-sided
+internal_func bool rayTriangle(const assets::BVHTriangle& triangle, const BVHQuery& query, f32 tMax, assets::BVHHit* hit) {
+  f32 p[3];
+  cross3(query.direction, triangle.edge2, p);
+  f32 determinant = dot3(triangle.edge1, p);
+  if(fabsf(determinant) < 1e-12f) { return false; }
+  f32 invDeterminant = 1.0f / determinant;
+
+  f32 s[3];
+  sub3(query.origin, triangle.v0, s);
+  f32 u = dot3(s, p) * invDeterminant;
+  if(u < 0.0f || u > 1.0f) { return false; }
+
+  f32 q[3];
+  cross3(s, triangle.edge1, q);
+  f32 v = dot3(query.direction, q) * invDeterminant;
+  if(v < 0.0f || (u + v) > 1.0f) { return false; }
+
+  f32 t = dot3(triangle.edge2, q) * invDeterminant;
+  if(t < 0.0f || t > tMax) { return false; }
+
+  hit->t = t;
+  triangleNormalFacing(triangle, query.direction, hit->normal);
+  return true;
+}
+
+internal_func bool pointInTriangle(const assets::BVHTriangle& triangle, const f32 point[3]) {
+  f32 toPoint[3];
+  sub3(point, triangle.v0, toPoint);
+  f32 d00 = dot3(triangle.edge1, triangle.edge1);
+  f32 d01 = dot3(triangle.edge1, triangle.edge2);
+  f32 d11 = dot3(triangle.edge2, triangle.edge2);
+  f32 d20 = dot3(toPoint, triangle.edge1);
+  f32 d21 = dot3(toPoint, triangle.edge2);
+  f32 denominator = (d00 * d11) - (d01 * d01);
+  if(denominator <= 0.0f) { return false; }
+  f32 v = ((d11 * d20) - (d01 * d21)) / denominator;
+  f32 w = ((d00 * d21) - (d01 * d20)) / denominator;
+  return v >= 0.0f && w >= 0.0f && (v + w) <= 1.0f;
+}
+
+// Earliest t in [0, tMax] where a*t^2 + b*t + c = 0, c < 0 means the sphere already overlaps the feature at t = 0
+internal_func bool earliestContact(f32 a, f32 b, f32 c, f32 tMax, f32* t) {
+  if(c < 0.0f) {
+    if(b >= 0.0f) { return false; } // NOTE: Already overlapping but moving away, allow it to escape
+    *t = 0.0f;
+    return true;
+  }
+  if(a < 1e-12f) { return false; }
+  f32 discriminant = (b * b) - (4.0f * a * c);
+  if(discriminant < 0.0f) { return false; }
+  f32 root = (-b - sqrtf(discriminant)) / (2.0f * a);
+  if(root < 0.0f || root > tMax) { return false; }
+  *t = root;
+  return true;
+}
+
+// Swept sphere vs triangle: the face first, then the vertices & edges (see Fauerby, "Improved Collision detection and Response")
+internal_func bool sphereSweepTriangle(const assets::BVHTriangle& triangle, const BVHQuery& query, f32 tMax, assets::BVHHit* hit) {
+  const f32* start = query.origin;
+  const f32* direction = query.direction;
+  const f32 radius = query.radius;
+
+  f32 normal[3];
+  cross3(triangle.edge1, triangle.edge2, normal);
+  if(normalize3(normal)) {
+    f32 startToV0[3];
+    sub3(start, triangle.v0, startToV0);
+    f32 startDistance = dot3(startToV0, normal);
+    if(startDistance < 0.0f) { // face the side of the triangle the sphere starts on
+      normal[0] = -normal[0];
+      normal[1] = -normal[1];
+      normal[2] = -normal[2];
+      startDistance = -startDistance;
+    }
+    f32 normalDotDirection = dot3(normal, direction);
+
+    f32 faceT = -1.0f;
+    if(startDistance < radius) {
+      if(normalDotDirection < 0.0f) { faceT = 0.0f; }
+    } else if(normalDotDirection < 0.0f) {
+      faceT = (startDistance - radius) / -normalDotDirection;
+    }
+
+    if(faceT >= 0.0f && faceT <= tMax) {
+      f32 planeContact[3];
+      pointAlong(start, direction, faceT, planeContact);
+      pointAlong(planeContact, normal, -radius, planeContact);
+      if(faceT == 0.0f) { pointAlong(start, normal, -startDistance, planeContact); }
+      if(pointInTriangle(triangle, planeContact)) {
+        // NOTE: If the sphere reaches the plane inside of the triangle, nothing else on the triangle can be hit earlier
+        hit->t = faceT;
+        hit->normal[0] = normal[0];
+        hit->normal[1] = normal[1];
+        hit->normal[2] = normal[2];
+        return true;
+      }
+    }
+  }
+
+  f32 vertices[3][3];
+  pointAlong(triangle.v0, triangle.edge1, 0.0f, vertices[0]);
+  pointAlong(triangle.v0, triangle.edge1, 1.0f, vertices[1]);
+  pointAlong(triangle.v0, triangle.edge2, 1.0f, vertices[2]);
+
+  bool found = false;
+  f32 closestT = tMax;
+  f32 contactPoint[3] = {}; // NOTE: Only read when found
+  const f32 radiusSq = radius * radius;
+  const f32 directionSq = dot3(direction, direction);
+
+  for(u32 vertexIndex = 0; vertexIndex < 3; vertexIndex++) {
+    f32 fromVertex[3];
+    sub3(start, vertices[vertexIndex], fromVertex);
+    f32 t;
+    if(earliestContact(directionSq, 2.0f * dot3(direction, fromVertex), dot3(fromVertex, fromVertex) - radiusSq, closestT, &t)) {
+      closestT = t;
+      contactPoint[0] = vertices[vertexIndex][0];
+      contactPoint[1] = vertices[vertexIndex][1];
+      contactPoint[2] = vertices[vertexIndex][2];
+      found = true;
+    }
+  }
+
+  for(u32 edgeIndex = 0; edgeIndex < 3; edgeIndex++) {
+    const f32* edgeStart = vertices[edgeIndex];
+    f32 edge[3];
+    sub3(vertices[(edgeIndex + 1) % 3], edgeStart, edge);
+    f32 edgeSq = dot3(edge, edge);
+    if(edgeSq <= 0.0f) { continue; }
+
+    // distance to the infinite line through the edge, using only the components perpendicular to the edge
+    f32 fromEdge[3];
+    sub3(start, edgeStart, fromEdge);
+    f32 fromEdgeAlong = dot3(fromEdge, edge) / edgeSq;
+    f32 directionAlong = dot3(direction, edge) / edgeSq;
+    f32 fromEdgePerp[3] = { fromEdge[0] - (edge[0] * fromEdgeAlong), fromEdge[1] - (edge[1] * fromEdgeAlong), fromEdge[2] - (edge[2] * fromEdgeAlong) };
+    f32 directionPerp[3] = { direction[0] - (edge[0] * directionAlong), direction[1] - (edge[1] * directionAlong), direction[2] - (edge[2] * directionAlong) };
+    f32 t;
+    if(earliestContact(dot3(directionPerp, directionPerp), 2.0f * dot3(fromEdgePerp, directionPerp), dot3(fromEdgePerp, fromEdgePerp) - radiusSq, closestT, &t)) {
+      f32 edgeFraction = fromEdgeAlong + (directionAlong * t);
+      if(edgeFraction >= 0.0f && edgeFraction <= 1.0f) {
+        closestT = t;
+        pointAlong(edgeStart, edge, edgeFraction, contactPoint);
+        found = true;
+      }
+    }
+  }
+
+  if(!found) { return false; }
+
+  f32 center[3];
+  pointAlong(start, direction, closestT, center);
+  sub3(center, contactPoint, hit->normal);
+  if(!normalize3(hit->normal)) { triangleNormalFacing(triangle, direction, hit->normal); }
+  hit->t = closestT;
+  return true;
+}
+
+bool assets::raycastBVH(const BVH& bvh, const f32 origin[3], const f32 direction[3], f32 maxDistance, BVHHit* hit) {
+  f32 unitDirection[3] = {direction[0], direction[1], direction[2]};
+  if(!normalize3(unitDirection)) { return false; }
+  return closestHit(bvh, createQuery(origin, unitDirection, 0.0f), maxDistance, rayTriangle, hit);
+}
+
+bool assets::segmentBVH(const BVH& bvh, const f32 start[3], const f32 end[3], BVHHit* hit) {
+  f32 delta[3];
+  sub3(end, start, delta);
+  return closestHit(bvh, createQuery(start, delta, 0.0f), 1.0f, rayTriangle, hit);
+}
+
+bool assets::sphereSweepBVH(const BVH& bvh, const f32 start[3], const f32 end[3], f32 radius, BVHHit* hit) {
+  f32 delta[3];
+  sub3(end, start, delta);
+  return closestHit(bvh, createQuery(start, delta, radius), 1.0f, sphereSweepTriangle, hit);
+}
+
+internal_func void growBounds(f32 min[3], f32 max[3], const f32 point[3]) {
+  for(u32 axis = 0; axis < 3; axis++) {
+    min[axis] = std::min(min[axis], point[axis]);
+    max[axis] = std::max(max[axis], point[axis]);
+  }
+}
+
+internal_func void setChildBounds(assets::BVHNode* node, u32 child, const f32 min[3], const f32 max[3]) {
+  node->minX[child] = min[0];
+  node->minY[child] = min[1];
+  node->minZ[child] = min[2];
+  node->maxX[child] = max[0];
+  node->maxY[child] = max[1];
+  node->maxZ[child] = max[2];
+}
+
+void assets::transformBVH(BVH* bvh, const f32 mat[16]) {
+  for(BVHTriangle& triangle: bvh->triangles) {
+    f32 v0[3], edge1[3], edge2[3];
+    for(u32 row = 0; row < 3; row++) {
+      v0[row] = (mat[row] * triangle.v0[0]) + (mat[4 + row] * triangle.v0[1]) + (mat[8 + row] * triangle.v0[2]) + mat[12 + row];
+      edge1[row] = (mat[row] * triangle.edge1[0]) + (mat[4 + row] * triangle.edge1[1]) + (mat[8 + row] * triangle.edge1[2]);
+      edge2[row] = (mat[row] * triangle.edge2[0]) + (mat[4 + row] * triangle.edge2[1]) + (mat[8 + row] * triangle.edge2[2]);
+    }
+    memcpy(triangle.v0, v0, sizeof(v0));
+    memcpy(triangle.edge1, edge1, sizeof(edge1));
+    memcpy(triangle.edge2, edge2, sizeof(edge2));
+  }
+
+  // NOTE: Children always come after their parent, refitting in reverse order visits every child before its parent
+  for(u64 nodeIndex = bvh->nodes.size(); nodeIndex-- > 0;) {
+    BVHNode& node = bvh->nodes[nodeIndex];
+    for(u32 child = 0; child < BVH_WIDTH; child++) {
+      if(node.children[child] == BVH_INVALID_CHILD) { continue; }
+      f32 min[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+      f32 max[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+      if(node.triangleCounts[child] > 0) {
+        u32 lastTriangle = node.children[child] + node.triangleCounts[child];
+        for(u32 triangleIndex = node.children[child]; triangleIndex < lastTriangle; triangleIndex++) {
+          const BVHTriangle& triangle = bvh->triangles[triangleIndex];
+          f32 vertex[3];
+          growBounds(min, max, triangle.v0);
+          pointAlong(triangle.v0, triangle.edge1, 1.0f, vertex);
+          growBounds(min, max, vertex);
+          pointAlong(triangle.v0, triangle.edge2, 1.0f, vertex);
+          growBounds(min, max, vertex);
+        }
+      } else {
+        const BVHNode& childNode = bvh->nodes[node.children[child]];
+        for(u32 grandchild = 0; grandchild < BVH_WIDTH; grandchild++) {
+          if(childNode.children[grandchild] == BVH_INVALID_CHILD) { continue; }
+          f32 grandchildMin[3] = {childNode.minX[grandchild], childNode.minY[grandchild], childNode.minZ[grandchild]};
+          f32 grandchildMax[3] = {childNode.maxX[grandchild], childNode.maxY[grandchild], childNode.maxZ[grandchild]};
+          growBounds(min, max, grandchildMin);
+          growBounds(min, max, grandchildMax);
+        }
+      }
+      setChildBounds(&node, child, min, max);
+    }
+  }
+}
+
+#if !(defined(ANDROID) || defined(__ANDROID___))
+
+struct BuildTriangle {
+  f32 min[3];
+  f32 max[3];
+  f32 centroid[3];
+  u32 index;
+};
+
+struct BuildNode {
+  f32 min[3];
+  f32 max[3];
+  u32 left;
+  u32 right;
+  u32 first;
+  u32 count; // > 0 for leaves
+};
+
+internal_func f32 halfSurfaceArea(const f32 min[3], const f32 max[3]) {
+  f32 dx = max[0] - min[0];
+  f32 dy = max[1] - min[1];
+  f32 dz = max[2] - min[2];
+  return (dx * dy) + (dy * dz) + (dz * dx);
+}
+
+// Binary tree built with a binned SAH, collapsed into a 4-wide tree afterwards
+internal_func u32 buildBinaryNode(std::vector<BuildNode>* buildNodes, BuildTriangle* triangles, u32 first, u32 count) {
+  BuildNode buildNode = {};
+  buildNode.first = first;
+  buildNode.count = count;
+  f32 centroidMin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+  f32 centroidMax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+  for(u32 axis = 0; axis < 3; axis++) {
+    buildNode.min[axis] = FLT_MAX;
+    buildNode.max[axis] = -FLT_MAX;
+  }
+  for(u32 i = first; i < first + count; i++) {
+    growBounds(buildNode.min, buildNode.max, triangles[i].min);
+    growBounds(buildNode.min, buildNode.max, triangles[i].max);
+    growBounds(centroidMin, centroidMax, triangles[i].centroid);
+  }
+
+  u32 nodeIndex = (u32)buildNodes->size();
+  buildNodes->push_back(buildNode);
+  if(count == 1) { return nodeIndex; }
+
+  struct Bin {
+    f32 min[3];
+    f32 max[3];
+    u32 count;
+  };
+
+  // NOTE: Costs are relative to a single triangle test
+  const f32 traversalCost = 1.0f;
+  const f32 leafCost = (f32)count;
+  const f32 invNodeArea = 1.0f / std::max(halfSurfaceArea(buildNode.min, buildNode.max), 1e-20f);
+  f32 bestCost = FLT_MAX;
+  u32 bestAxis = 0;
+  u32 bestSplit = 0;
+  for(u32 axis = 0; axis < 3; axis++) {
+    f32 extent = centroidMax[axis] - centroidMin[axis];
+    if(extent <= 0.0f) { continue; }
+    f32 binScale = BVH_SAH_BIN_COUNT / extent;
+
+    Bin bins[BVH_SAH_BIN_COUNT];
+    for(Bin& bin: bins) {
+      bin.min[0] = bin.min[1] = bin.min[2] = FLT_MAX;
+      bin.max[0] = bin.max[1] = bin.max[2] = -FLT_MAX;
+      bin.count = 0;
+    }
+    for(u32 i = first; i < first + count; i++) {
+      u32 binIndex = std::min((u32)((triangles[i].centroid[axis] - centroidMin[axis]) * binScale), (u32)BVH_SAH_BIN_COUNT - 1);
+      growBounds(bins[binIndex].min, bins[binIndex].max, triangles[i].min);
+      growBounds(bins[binIndex].min, bins[binIndex].max, triangles[i].max);
+      bins[binIndex].count++;
+    }
+
+    // sweep from the right to get the area & count to the right of every split, then from the left to evaluate
+    f32 rightAreas[BVH_SAH_BIN_COUNT];
+    u32 rightCounts[BVH_SAH_BIN_COUNT];
+    f32 sweepMin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    f32 sweepMax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    u32 sweepCount = 0;
+    for(u32 binIndex = BVH_SAH_BIN_COUNT - 1; binIndex > 0; binIndex--) {
+      if(bins[binIndex].count > 0) {
+        growBounds(sweepMin, sweepMax, bins[binIndex].min);
+        growBounds(sweepMin, sweepMax, bins[binIndex].max);
+      }
+      sweepCount += bins[binIndex].count;
+      rightAreas[binIndex] = (sweepCount > 0) ? halfSurfaceArea(sweepMin, sweepMax) : 0.0f;
+      rightCounts[binIndex] = sweepCount;
+    }
+    for(u32 axisIndex = 0; axisIndex < 3; axisIndex++) {
+      sweepMin[axisIndex] = FLT_MAX;
+      sweepMax[axisIndex] = -FLT_MAX;
+    }
+    sweepCount = 0;
+    for(u32 split = 1; split < BVH_SAH_BIN_COUNT; split++) {
+      const Bin& leftBin = bins[split - 1];
+      if(leftBin.count > 0) {
+        growBounds(sweepMin, sweepMax, leftBin.min);
+        growBounds(sweepMin, sweepMax, leftBin.max);
+      }
+      sweepCount += leftBin.count;
+      if(sweepCount == 0 || rightCounts[split] == 0) { continue; }
+      f32 cost = traversalCost + (((halfSurfaceArea(sweepMin, sweepMax) * sweepCount) + (rightAreas[split] * rightCounts[split])) * invNodeArea);
+      if(cost < bestCost) {
+        bestCost = cost;
+        bestAxis = axis;
+        bestSplit = split;
+      }
+    }
+  }
+
+  if(count <= BVH_MAX_LEAF_TRIANGLES && bestCost >= leafCost) { return nodeIndex; }
+
+  u32 leftCount = 0;
+  if(bestCost < FLT_MAX) {
+    f32 extent = centroidMax[bestAxis] - centroidMin[bestAxis];
+    f32 binScale = BVH_SAH_BIN_COUNT / extent;
+    BuildTriangle* middle = std::partition(triangles + first, triangles + first + count, [&](const BuildTriangle& triangle) {
+      u32 binIndex = std::min((u32)((triangle.centroid[bestAxis] - centroidMin[bestAxis]) * binScale), (u32)BVH_SAH_BIN_COUNT - 1);
+      return binIndex < bestSplit;
+    });
+    leftCount = (u32)(middle - (triangles + first));
+  }
+  if(leftCount == 0 || leftCount == count) { // NOTE: All centroids coincide, fall back to splitting down the middle
+    leftCount = count / 2;
+  }
+
+  u32 left = buildBinaryNode(buildNodes, triangles, first, leftCount);
+  u32 right = buildBinaryNode(buildNodes, triangles, first + leftCount, count - leftCount);
+  BuildNode& node = (*buildNodes)[nodeIndex];
+  node.left = left;
+  node.right = right;
+  node.count = 0;
+  return nodeIndex;
+}
+
+internal_func u32 collapseNode(const std::vector<BuildNode>& buildNodes, u32 buildNodeIndex, std::vector<assets::BVHNode>* nodes) {
+  u32 slots[BVH_WIDTH];
+  u32 slotCount = 0;
+  const BuildNode& buildNode = buildNodes[buildNodeIndex];
+  if(buildNode.count > 0) {
+    slots[slotCount++] = buildNodeIndex;
+  } else {
+    slots[slotCount++] = buildNode.left;
+    slots[slotCount++] = buildNode.right;
+    // pull up grandchildren, opening the interior child with the largest surface area first
+    while(slotCount < BVH_WIDTH) {
+      s32 largestSlot = -1;
+      f32 largestArea = -1.0f;
+      for(u32 slot = 0; slot < slotCount; slot++) {
+        const BuildNode& slotNode = buildNodes[slots[slot]];
+        if(slotNode.count > 0) { continue; }
+        f32 area = halfSurfaceArea(slotNode.min, slotNode.max);
+        if(area > largestArea) {
+          largestArea = area;
+          largestSlot = slot;
+        }
+      }
+      if(largestSlot < 0) { break; }
+      const BuildNode& opened = buildNodes[slots[largestSlot]];
+      slots[largestSlot] = opened.left;
+      slots[slotCount++] = opened.right;
+    }
+  }
+
+  u32 nodeIndex = (u32)nodes->size();
+  nodes->push_back(assets::BVHNode{});
+  for(u32 child = 0; child < BVH_WIDTH; child++) {
+    if(child >= slotCount) {
+      const f32 zero[3] = {0.0f, 0.0f, 0.0f};
+      setChildBounds(&(*nodes)[nodeIndex], child, zero, zero);
+      (*nodes)[nodeIndex].children[child] = BVH_INVALID_CHILD;
+      (*nodes)[nodeIndex].triangleCounts[child] = 0;
+      continue;
+    }
+
+    const BuildNode& slotNode = buildNodes[slots[child]];
+    setChildBounds(&(*nodes)[nodeIndex], child, slotNode.min, slotNode.max);
+    if(slotNode.count > 0) {
+      (*nodes)[nodeIndex].children[child] = slotNode.first;
+      (*nodes)[nodeIndex].triangleCounts[child] = slotNode.count;
+    } else {
+      u32 childNodeIndex = collapseNode(buildNodes, slots[child], nodes); // NOTE: May reallocate nodes
+      (*nodes)[nodeIndex].children[child] = childNodeIndex;
+      (*nodes)[nodeIndex].triangleCounts[child] = 0;
+    }
+  }
+  return nodeIndex;
+}
+
+void assets::buildBVH(const f32* positions, const u32* indices, u32 indexCount, BVH* bvh) {
+  bvh->nodes.clear();
+  bvh->triangles.clear();
+  const u32 triangleCount = indexCount / 3;
+  if(triangleCount == 0) { return; }
+
+  std::vector<BuildTriangle> buildTriangles(triangleCount);
+  for(u32 triangleIndex = 0; triangleIndex < triangleCount; triangleIndex++) {
+    BuildTriangle& buildTriangle = buildTriangles[triangleIndex];
+    buildTriangle.index = triangleIndex;
+    for(u32 axis = 0; axis < 3; axis++) {
+      buildTriangle.min[axis] = FLT_MAX;
+      buildTriangle.max[axis] = -FLT_MAX;
+    }
+    for(u32 corner = 0; corner < 3; corner++) {
+      growBounds(buildTriangle.min, buildTriangle.max, positions + (indices[(triangleIndex * 3) + corner] * 3));
+    }
+    for(u32 axis = 0; axis < 3; axis++) {
+      buildTriangle.centroid[axis] = (buildTriangle.min[axis] + buildTriangle.max[axis]) * 0.5f;
+    }
+  }
+
+  std::vector<BuildNode> buildNodes;
+  buildNodes.reserve(triangleCount * 2);
+  buildBinaryNode(&buildNodes, buildTriangles.data(), 0, triangleCount);
+  collapseNode(buildNodes, 0, &bvh->nodes);
+
+  bvh->triangles.resize(triangleCount);
+  for(u32 i = 0; i < triangleCount; i++) {
+    const u32* triangleIndices = indices + (buildTriangles[i].index * 3);
+    const f32* v0 = positions + (triangleIndices[0] * 3);
+    const f32* v1 = positions + (triangleIndices[1] * 3);
+    const f32* v2 = positions + (triangleIndices[2] * 3);
+    BVHTriangle& triangle = bvh->triangles[i];
+    memcpy(triangle.v0, v0, sizeof(triangle.v0));
+    sub3(v1, v0, triangle.edge1);
+    sub3(v2, v0, triangle.edge2);
+  }
+}
+
+f32 assets::bvhSAHCost(const BVH& bvh) {
+  if(bvh.nodes.empty()) { return 0.0f; }
+  f32 rootMin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+  f32 rootMax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+  const BVHNode& root = bvh.nodes[0];
+  for(u32 child = 0; child < BVH_WIDTH; child++) {
+    if(root.children[child] == BVH_INVALID_CHILD) { continue; }
+    f32 childMin[3] = {root.minX[child], root.minY[child], root.minZ[child]};
+    f32 childMax[3] = {root.maxX[child], root.maxY[child], root.maxZ[child]};
+    growBounds(rootMin, rootMax, childMin);
+    growBounds(rootMin, rootMax, childMax);
+  }
+  const f32 invRootArea = 1.0f / std::max(halfSurfaceArea(rootMin, rootMax), 1e-20f);
+
+  // NOTE: Every visited node costs one (4-wide) box test, every visited leaf costs one test per triangle
+  f32 cost = 1.0f;
+  for(const BVHNode& node: bvh.nodes) {
+    for(u32 child = 0; child < BVH_WIDTH; child++) {
+      if(node.children[child] == BVH_INVALID_CHILD) { continue; }
+      f32 childMin[3] = {node.minX[child], node.minY[child], node.minZ[child]};
+      f32 childMax[3] = {node.maxX[child], node.maxY[child], node.maxZ[child]};
+      f32 probability = halfSurfaceArea(childMin, childMax) * invRootArea;
+      cost += probability * ((node.triangleCounts[child] > 0) ? (f32)node.triangleCounts[child] : 1.0f);
+    }
+  }
+  return cost;
+}
+
+#endif
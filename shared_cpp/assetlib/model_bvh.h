@@ -0,0 +1,59 @@
+#pragma once
+
+#include "asset_loader.h"
+
+#define BVH_WIDTH 4
+#define BVH_MAX_LEAF_TRIANGLES 4
+#define BVH_INVALID_CHILD U32_MAX
+
+/*
+ * 4-wide bounding volume hierarchy over a model's triangles, built with a binned SAH at bake time.
+ *  - Each node stores the bounds of its (up to) four children as structure of arrays so that a query can be tested
+ *    against all four children with a single SIMD slab test. A node is exactly two cache lines.
+ *  - Nodes are stored in pre-order, every child node has a greater index than its parent.
+ *  - Triangles are stored in leaf order as a vertex & two edges, ready for intersection tests.
+ * Positions, vectors and matrices are plain f32 arrays. Matrices are column-major.
+ */
+namespace assets {
+  struct BVHNode {
+    f32 minX[BVH_WIDTH];
+    f32 minY[BVH_WIDTH];
+    f32 minZ[BVH_WIDTH];
+    f32 maxX[BVH_WIDTH];
+    f32 maxY[BVH_WIDTH];
+    f32 maxZ[BVH_WIDTH];
+    u32 children[BVH_WIDTH]; // interior: node index, leaf: first triangle index, empty: BVH_INVALID_CHILD
+    u32 triangleCounts[BVH_WIDTH]; // 0 for interior children
+  };
+
+  struct BVHTriangle {
+    f32 v0[3];
+    f32 edge1[3];
+    f32 edge2[3];
+  };
+
+  struct BVH {
+    std::vector<BVHNode> nodes;
+    std::vector<BVHTriangle> triangles;
+  };
+
+  struct BVHHit {
+    f32 t; // distance along the ray or, for segments & sweeps, fraction of the way from start to end
+    f32 normal[3]; // unit length, facing the side of the surface the query came from
+    u32 triangleIndex;
+  };
+
+  // NOTE: All queries return the closest hit, hit may be nullptr if only a yes/no answer is needed
+  bool raycastBVH(const BVH& bvh, const f32 origin[3], const f32 direction[3], f32 maxDistance, BVHHit* hit);
+  bool segmentBVH(const BVH& bvh, const f32 start[3], const f32 end[3], BVHHit* hit);
+  bool sphereSweepBVH(const BVH& bvh, const f32 start[3], const f32 end[3], f32 radius, BVHHit* hit);
+
+  // Transforms the triangles in place and refits the node bounds, the tree topology is left untouched
+  void transformBVH(BVH* bvh, const f32 mat[16]);
+
+#if !(defined(ANDROID) || defined(__ANDROID___))
+  void buildBVH(const f32* positions, const u32* indices, u32 indexCount, BVH* bvh);
+  // NOTE: Expected cost of a random ray relative to testing a single triangle, useful for judging BVH quality
+  f32 bvhSAHCost(const BVH& bvh);
+#endif
+}
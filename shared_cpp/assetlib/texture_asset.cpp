@@ -9,6 +9,8 @@ const struct {
   const char* originalFileName = "original_file_name";
   const char* width = "width";
   const char* height = "height";
+  const char* tiers = "tiers";
+  const char* mipSizes = "mip_sizes";
 } jsonKeys;
 
 const char* mapTextureFormatToString[] = {
@@ -31,6 +33,13 @@ void assets::readTextureInfo(const assets::AssetFile &file, assets::TextureInfo
   info->width = cubeMapJson[jsonKeys.width];
   info->height = cubeMapJson[jsonKeys.height];
   info->originalFileName = cubeMapJson[jsonKeys.originalFileName];
+  info->mipSizes.clear();
+  if(cubeMapJson.find(jsonKeys.mipSizes) != cubeMapJson.end()) {
+    for(u32 mipSize: cubeMapJson[jsonKeys.mipSizes]) { info->mipSizes.push_back(mipSize); }
+  } else {
+    info->mipSizes.push_back(info->size);
+  }
+  readTextureTiers(cubeMapJson, &info->tiers);
 }
 
 assets::AssetFile assets::packTexture(TextureInfo* info, void *data) {
@@ -47,10 +56,65 @@ assets::AssetFile assets::packTexture(TextureInfo* info, void *data) {
   textureJson[jsonKeys.originalFileName] = info->originalFileName;
   textureJson[jsonKeys.width] = info->width;
   textureJson[jsonKeys.height] = info->height;
+  if(info->mipSizes.size() > 1) { textureJson[jsonKeys.mipSizes] = info->mipSizes; }
+  writeTextureTiers(info->tiers, &textureJson);
   file.json = textureJson.dump(); // json map to string
 
-  file.binaryBlob.resize(info->size);
-  memcpy(&file.binaryBlob[0], data, info->size);
+  if(data != nullptr) {
+    file.binaryBlob.resize(info->size);
+    memcpy(&file.binaryBlob[0], data, info->size);
+  }
 
   return file;
+}
+
+void assets::readTextureTiers(const nlohmann::json& json, std::vector<TextureTier>* tiers) {
+  tiers->clear();
+  if(json.find(jsonKeys.tiers) == json.end()) { return; }
+  for(const nlohmann::json& tierJson: json[jsonKeys.tiers]) {
+    TextureTier tier;
+    u32 formatEnum = tierJson[jsonKeys.formatEnum];
+    tier.format = TextureFormat(formatEnum);
+    tier.width = tierJson[jsonKeys.width];
+    tier.height = tierJson[jsonKeys.height];
+    tier.size = tierJson[jsonKeys.size];
+    tiers->push_back(tier);
+  }
+}
+
+void assets::writeTextureTiers(const std::vector<TextureTier>& tiers, nlohmann::json* json) {
+  if(tiers.empty()) { return; }
+  nlohmann::json tiersJson = nlohmann::json::array();
+  for(const TextureTier& tier: tiers) {
+    nlohmann::json tierJson;
+    tierJson[jsonKeys.format] = textureFormatToString(tier.format);
+    tierJson[jsonKeys.formatEnum] = textureFormatToEnumVal(tier.format);
+    tierJson[jsonKeys.width] = tier.width;
+    tierJson[jsonKeys.height] = tier.height;
+    tierJson[jsonKeys.size] = tier.size;
+    tiersJson.push_back(tierJson);
+  }
+  (*json)[jsonKeys.tiers] = tiersJson;
+}
+
+std::string assets::textureTierPath(const std::string& tierZeroPath, u32 tier) {
+  if(tier == 0) { return tierZeroPath; }
+  size_t extensionStart = tierZeroPath.find_last_of('.');
+  assert(extensionStart != std::string::npos);
+  return tierZeroPath.substr(0, extensionStart) + ".t" + std::to_string(tier) + tierZeroPath.substr(extensionStart);
+}
+
+u32 assets::selectTextureTier(const std::vector<TextureTier>& tiers, u64 sizeBudget, u32 supportedFormats) {
+  u32 smallestTier = 0;
+  bool smallestFound = false;
+  for(u32 tier = 0; tier < tiers.size(); tier++) {
+    if((TEXTURE_FORMAT_BIT(tiers[tier].format) & supportedFormats) == 0) { continue; }
+    if(tiers[tier].size <= sizeBudget) { return tier; }
+    if(!smallestFound || tiers[tier].size < tiers[smallestTier].size) {
+      smallestTier = tier;
+      smallestFound = true;
+    }
+  }
+  // NOTE: Tier 0 is the fallback for assets baked without tiers or tiers with no supported format
+  return smallestTier;
 }
\ No newline at end of file
@@ -9,19 +9,51 @@ namespace assets {
 #define Texture(name) TextureFormat_##name,
 #include "texture_format.incl"
 #undef Texture
+    TextureFormat_Count
   };
 
+#define TEXTURE_FORMAT_BIT(format) (1u << (format))
+
+  /*
+   * Textures & cube maps are baked as several tiers of decreasing quality (resolution and/or format), each to its own
+   * file named by textureTierPath(). The tier 0 file lists every tier, so one can be picked by reading only its json.
+   */
+  struct TextureTier {
+    TextureFormat format;
+    u32 width;
+    u32 height;
+    u32 size; // total bytes of pixel data in the tier's file
+  };
+
+  // NOTE: Blob holds each mip level one after the other, most textures are baked with mip level 0 alone
   struct TextureInfo {
     TextureFormat format;
-    u32 size;
+    u32 size; // of all mip levels
     u32 width;
     u32 height;
+    std::vector<u32> mipSizes; // NOTE: readTextureInfo() fills in a single level for textures baked without any
     std::string originalFileName;
+    std::vector<TextureTier> tiers; // NOTE: Only filled for tier 0
+
+    u32 mipCount() const { return mipSizes.empty() ? 1 : (u32)mipSizes.size(); }
+    char* mipData(char* data, u32 mipLevel) const {
+      for(u32 level = 0; level < mipLevel; level++) { data += mipSizes[level]; }
+      return data;
+    }
   };
 
   void readTextureInfo(const AssetFile& file, TextureInfo* info);
+  // NOTE: A null data packs only the header & json, for the blob to be streamed with an AssetFileWriter
   AssetFile packTexture(TextureInfo* info, void* data);
 
+  void readTextureTiers(const nlohmann::json& json, std::vector<TextureTier>* tiers);
+  void writeTextureTiers(const std::vector<TextureTier>& tiers, nlohmann::json* json);
+  // ex: "skyboxes/cave.cbtx" is tier 0, "skyboxes/cave.t2.cbtx" is tier 2
+  std::string textureTierPath(const std::string& tierZeroPath, u32 tier);
+  // Highest quality tier whose format is in supportedFormats (TEXTURE_FORMAT_BIT mask) & whose size fits the budget.
+  // If none fit the budget, the smallest supported tier is picked instead.
+  u32 selectTextureTier(const std::vector<TextureTier>& tiers, u64 sizeBudget, u32 supportedFormats);
+
   u32 textureFormatToEnumVal(assets::TextureFormat format);
   const char* textureFormatToString(assets::TextureFormat format);
 }